@@ -24,7 +24,7 @@ my $rsm_file = dirname($0)."/../src/rsm-schema.tmpl";
 
 my ($state, %output, $eol, $fk_bol, $fk_eol, $ltab, $pkey, $table_name);
 my ($szcol1, $szcol2, $szcol3, $szcol4, $sequences, $sql_suffix);
-my ($fkeys, $fkeys_prefix, $fkeys_suffix, $uniq);
+my ($fkeys, $fkeys_prefix, $fkeys_suffix, $uniq, $changelog);
 
 my %c = (
 	"type"		=>	"code",
@@ -177,7 +177,8 @@ sub newstate
 
 	if ($state eq "field")
 	{
-		if ($output{"type"} eq "sql" && ($new eq "index" || $new eq "table" || $new eq "row"))
+		if ($output{"type"} eq "sql" && ($new eq "index" || $new eq "table" || $new eq "row" ||
+				$new eq "changelog"))
 		{
 			print "${pkey}${eol}\n)$output{'table_options'};${eol}\n";
 		}
@@ -408,7 +409,7 @@ sub process_field
 				$sequences = "${sequences}BEFORE INSERT ON ${table_name}${eol}\n";
 				$sequences = "${sequences}FOR EACH ROW${eol}\n";
 				$sequences = "${sequences}BEGIN${eol}\n";
-				$sequences = "${sequences}SELECT ${table_name}_seq.nextval INTO :new.id FROM dual;${eol}\n";
+				$sequences = "${sequences}SELECT ${table_name}_seq.nextval INTO :new.${name} FROM dual;${eol}\n";
 				$sequences = "${sequences}END;${eol}\n/${eol}\n";
 			}
 		}
@@ -608,6 +609,67 @@ sub process_row
 	print "INSERT INTO $table_name VALUES $values;${eol}\n";
 }
 
+sub process_changelog
+{
+	my $line = $_[0];
+
+	newstate("changelog");
+
+	my ($table, $field, $object, $operations) = split(/\|/, $line, 4);
+
+	# changelog is not maintained in SQLite3 databases
+	if ($output{"type"} eq "code" || $output{"database"} eq "sqlite3")
+	{
+		return;
+	}
+
+	my %operation_ids = ("insert" => 1, "update" => 2, "delete" => 3);
+
+	foreach my $operation (split(/,/, rtrim($operations)))
+	{
+		my $id = $operation_ids{$operation};
+		my $name = "${table}_changelog_${operation}";
+		my $row = ($operation eq "delete" ? "old" : "new");
+		my $event = uc($operation);
+
+		if ($output{"database"} eq "mysql")
+		{
+			if ($changelog eq "")
+			{
+				$changelog = "-- with binary logging enabled creating triggers requires SUPER privilege${eol}\n";
+				$changelog = "${changelog}-- or log_bin_trust_function_creators=1${eol}\n";
+			}
+
+			$changelog = "${changelog}CREATE TRIGGER `${name}` AFTER ${event} ON `${table}`${eol}\n";
+			$changelog = "${changelog}FOR EACH ROW${eol}\n";
+			$changelog = "${changelog}INSERT INTO changelog (object,objectid,operation,clock)${eol}\n";
+			$changelog = "${changelog}VALUES (${object},${row}.${field},${id},unix_timestamp());${eol}\n";
+		}
+		elsif ($output{"database"} eq "postgresql")
+		{
+			$changelog = "${changelog}CREATE FUNCTION changelog_${table}_${operation}() RETURNS TRIGGER LANGUAGE 'plpgsql' AS \$\$${eol}\n";
+			$changelog = "${changelog}BEGIN${eol}\n";
+			$changelog = "${changelog}INSERT INTO changelog (object,objectid,operation,clock)${eol}\n";
+			$changelog = "${changelog}VALUES (${object},${row}.${field},${id},cast(extract(epoch FROM now()) AS int));${eol}\n";
+			$changelog = "${changelog}RETURN NULL;${eol}\n";
+			$changelog = "${changelog}END;${eol}\n";
+			$changelog = "${changelog}\$\$;${eol}\n";
+			$changelog = "${changelog}CREATE TRIGGER ${name} AFTER ${event} ON ${table}${eol}\n";
+			$changelog = "${changelog}FOR EACH ROW EXECUTE PROCEDURE changelog_${table}_${operation}();${eol}\n";
+		}
+		elsif ($output{"database"} eq "oracle")
+		{
+			$changelog = "${changelog}CREATE TRIGGER ${name} AFTER ${event} ON ${table}${eol}\n";
+			$changelog = "${changelog}FOR EACH ROW${eol}\n";
+			$changelog = "${changelog}BEGIN${eol}\n";
+			$changelog = "${changelog}INSERT INTO changelog (object,objectid,operation,clock)${eol}\n";
+			$changelog = "${changelog}VALUES (${object},:${row}.${field},${id},${eol}\n";
+			$changelog = "${changelog}(cast(sys_extract_utc(systimestamp) AS date)-date'1970-01-01')*86400);${eol}\n";
+			$changelog = "${changelog}END;${eol}\n/${eol}\n";
+		}
+	}
+}
+
 sub timescaledb
 {
 	print<<EOF
@@ -712,6 +774,7 @@ sub process
 	$fkeys = "";
 	$sequences = "";
 	$uniq = "";
+	$changelog = "";
 	my ($type, $line);
 
 	open(INFO, $file);	# open the file
@@ -738,6 +801,7 @@ sub process
 			elsif ($type eq 'TABLE')	{ process_table($line); }
 			elsif ($type eq 'UNIQUE')	{ process_index($line, 1); }
 			elsif ($type eq 'ROW' && $output{"type"} ne "code")		{ process_row($line); }
+			elsif ($type eq 'CHANGELOG')	{ process_changelog($line); }
 		}
 	}
 
@@ -745,6 +809,7 @@ sub process
 
 	print $sequences.$sql_suffix;
 	print $fkeys_prefix.$fkeys.$fkeys_suffix;
+	print $changelog;
 	print $output{"after"};
 }
 
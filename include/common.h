@@ -779,6 +779,7 @@ const char	*zbx_item_logtype_string(unsigned char logtype);
 /* proxy_history flags */
 #define PROXY_HISTORY_FLAG_META		0x01
 #define PROXY_HISTORY_FLAG_NOVALUE	0x02
+#define PROXY_HISTORY_FLAG_COMPRESSED	0x04	/* value is base64 encoded size and compressed data */
 
 #define PROXY_HISTORY_MASK_NOVALUE	(PROXY_HISTORY_FLAG_META | PROXY_HISTORY_FLAG_NOVALUE)
 
@@ -739,6 +739,57 @@ void	zbx_db_insert_clean(zbx_db_insert_t *self);
 void	zbx_db_insert_autoincrement(zbx_db_insert_t *self, const char *field_name);
 int	zbx_db_get_database_type(void);
 
+/* columnar bulk insert support */
+
+/* string value reference in bulk insert string arena */
+typedef struct
+{
+	size_t	offset;
+	size_t	len;
+}
+zbx_db_strref_t;
+
+/* columnar bulk insert column */
+typedef struct
+{
+	/* the column field (pointer to the ZBX_FIELD structure from database schema) */
+	const ZBX_FIELD	*field;
+	/* the column values, the array type depends on field type */
+	union
+	{
+		zbx_uint64_t	*ui64;
+		int		*i32;
+		double		*dbl;
+		zbx_db_strref_t	*str;
+	}
+	values;
+}
+zbx_db_column_t;
+
+/* columnar bulk insert data */
+typedef struct
+{
+	/* the target table */
+	const ZBX_TABLE	*table;
+	/* the columns to insert */
+	zbx_db_column_t	*columns;
+	int		columns_num;
+	/* the number of rows added and allocated in column value arrays */
+	int		rows_num;
+	int		rows_alloc;
+	/* the string value arena - zero terminated, not escaped string values */
+	char		*strings;
+	size_t		strings_alloc;
+	size_t		strings_offset;
+}
+zbx_db_colinsert_t;
+
+void	zbx_db_colinsert_prepare(zbx_db_colinsert_t *self, const char *table, ...);
+void	zbx_db_colinsert_reserve(zbx_db_colinsert_t *self, int rows_num);
+void	zbx_db_colinsert_add_values(zbx_db_colinsert_t *self, ...);
+int	zbx_db_colinsert_execute(zbx_db_colinsert_t *self);
+void	zbx_db_colinsert_clean(zbx_db_colinsert_t *self);
+
 /* agent (ZABBIX, SNMP, IPMI, JMX) availability data */
 typedef struct
 {
@@ -600,8 +600,22 @@ typedef struct
 }
 zbx_wcache_info_t;
 
+typedef struct
+{
+	/* the number of records deleted during the current (last) housekeeping cycle */
+	zbx_uint64_t	deleted;
+
+	/* the number of items with expired history and trends left to clean in the current cycle */
+	zbx_uint64_t	backlog;
+
+	/* the time housekeeper was throttled during the current (last) housekeeping cycle, in seconds */
+	double		throttled;
+}
+zbx_hk_stats_t;
+
 int	is_item_processed_by_server(unsigned char type, const char *key);
 int	zbx_is_counted_in_item_queue(unsigned char type, const char *key);
+int	zbx_is_rsm_test_key(const char *key);
 int	in_maintenance_without_data_collection(unsigned char maintenance_status, unsigned char maintenance_type,
 		unsigned char type);
 void	dc_add_history(zbx_uint64_t itemid, unsigned char item_value_type, unsigned char item_flags,
@@ -641,6 +655,10 @@ void	free_database_cache(int);
 void	*DCget_stats(int request);
 void	DCget_stats_all(zbx_wcache_info_t *wcache_info);
 
+double	zbx_dc_get_history_write_latency(void);
+void	zbx_dc_set_hk_stats(const zbx_hk_stats_t *stats);
+void	zbx_dc_get_hk_stats(zbx_hk_stats_t *stats);
+
 zbx_uint64_t	DCget_nextid(const char *table_name, int num);
 
 /* initial sync, get all data */
@@ -670,6 +688,7 @@ zbx_uint64_t	DCget_nextid(const char *table_name, int num);
 #define ZBX_ITEM_GET_PROCESS		(ZBX_ITEM_GET_MAINTENANCE|ZBX_ITEM_GET_MISC|ZBX_ITEM_GET_LOGTIMEFMT)
 
 void	DCsync_configuration(unsigned char mode);
+int	DCconfig_snapshot_loaded(void);
 void	DCsync_kvs_paths(const struct zbx_json_parse *jp_kvs_paths);
 int	init_configuration_cache(char **error);
 void	free_configuration_cache(void);
@@ -849,6 +868,7 @@ void	zbx_dc_get_hostids_by_group_name(const char *name, zbx_vector_uint64_t *hos
 #define ZBX_DC_FLAG_UNDEF	0x08	/* unsupported or undefined (delta calculation failed) value */
 #define ZBX_DC_FLAG_NOHISTORY	0x10	/* values should not be kept in history */
 #define ZBX_DC_FLAG_NOTRENDS	0x20	/* values should not be kept in trends */
+#define ZBX_DC_FLAG_COMPRESSED	0x40	/* text value is compressed in history cache */
 
 typedef struct zbx_hc_data
 {
@@ -1017,6 +1037,27 @@ void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num);
 void	zbx_hc_get_mem_stats(zbx_mem_stats_t *data, zbx_mem_stats_t *index);
 void	zbx_hc_get_items(zbx_vector_uint64_pair_t *items);
 
+typedef struct
+{
+	const char		*name;
+	zbx_hashset_stats_t	stats;
+	zbx_uint64_t		size;	/* slot array and entry memory, excluding memory referenced by entries */
+}
+zbx_dc_hashset_stats_t;
+
+typedef struct
+{
+	zbx_hashset_stats_t	stats;
+	zbx_uint64_t		refs_num;
+	zbx_uint64_t		len_total;
+	zbx_uint64_t		size;
+}
+zbx_dc_strpool_stats_t;
+
+void	zbx_dc_get_mem_stats(zbx_mem_stats_t *stats);
+void	zbx_dc_get_hashset_stats(zbx_vector_ptr_t *hashsets);
+void	zbx_dc_get_strpool_stats(zbx_dc_strpool_stats_t *stats);
+
 typedef struct
 {
 	zbx_uint64_t		objectid;
@@ -28,16 +28,22 @@
 #define MEM_MAX_BUCKET_SIZE	256 /* starting from this size all free chunks are put into the same bucket */
 #define MEM_BUCKET_COUNT	((MEM_MAX_BUCKET_SIZE - MEM_MIN_BUCKET_SIZE) / 8 + 1)
 
+#define MEM_SLAB_MAX_SIZE	128 /* allocations up to this size are served from slabs, if enabled */
+#define MEM_SLAB_COUNT		(MEM_SLAB_MAX_SIZE / 8)
+
 typedef struct
 {
 	void		*base;
 	void		**buckets;
+	void		**slabs;
 	void		*lo_bound;
 	void		*hi_bound;
 	zbx_uint64_t	free_size;
 	zbx_uint64_t	used_size;
 	zbx_uint64_t	orig_size;
 	zbx_uint64_t	total_size;
+	zbx_uint64_t	slab_free_size;	/* size of free objects in slabs, not included in free_size */
+	zbx_uint64_t	slabs_num;
 	int		shm_id;
 
 	/* Continue execution in out of memory situation.                         */
@@ -45,6 +51,9 @@ typedef struct
 	/* Set this flag to 1 to allow execution in out of memory situations.     */
 	char		allow_oom;
 
+	/* serve small allocations from slabs of same size objects */
+	char		use_slabs;
+
 	const char	*mem_descr;
 	const char	*mem_param;
 }
@@ -60,6 +69,8 @@ typedef struct
 	unsigned int	chunks_num[MEM_BUCKET_COUNT];
 	unsigned int	free_chunks;
 	unsigned int	used_chunks;
+	zbx_uint64_t	slab_free_size;
+	unsigned int	slabs_num;
 }
 zbx_mem_stats_t;
 
@@ -83,6 +94,7 @@ void	*__zbx_mem_realloc(const char *file, int line, zbx_mem_info_t *info, void *
 void	__zbx_mem_free(const char *file, int line, zbx_mem_info_t *info, void *ptr);
 
 void	zbx_mem_clear(zbx_mem_info_t *info);
+void	zbx_mem_enable_slabs(zbx_mem_info_t *info);
 
 void	zbx_mem_get_stats(const zbx_mem_info_t *info, zbx_mem_stats_t *stats);
 void	zbx_mem_dump_stats(int level, zbx_mem_info_t *info);
@@ -31,6 +31,9 @@
 typedef wchar_t * zbx_mutex_name_t;
 typedef HANDLE zbx_mutex_t;
 #else	/* not _WINDOWS */
+/* the maximum number of history cache queue shards, each shard has its own mutex */
+#define ZBX_MUTEX_HISTORY_QUEUE_NUM	16
+
 typedef enum
 {
 	ZBX_MUTEX_LOG = 0,
@@ -51,6 +54,8 @@ typedef enum
 	ZBX_MUTEX_MODBUS,
 	ZBX_MUTEX_TREND_FUNC,
 	/* NOTE: Do not forget to sync changes here with mutex names in diag_add_locks_info()! */
+	ZBX_MUTEX_HISTORY_QUEUE,
+	ZBX_MUTEX_HISTORY_QUEUE_LAST = ZBX_MUTEX_HISTORY_QUEUE + ZBX_MUTEX_HISTORY_QUEUE_NUM - 1,
 	ZBX_MUTEX_COUNT
 }
 zbx_mutex_name_t;
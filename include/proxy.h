@@ -46,7 +46,7 @@ int	process_proxyconfig(struct zbx_json_parse *jp_data, struct zbx_json_parse *j
 
 int	get_interface_availability_data(struct zbx_json *json, int *ts);
 
-int	proxy_get_hist_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more);
+int	proxy_get_hist_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more, int json_values);
 int	proxy_get_dhis_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more);
 int	proxy_get_areg_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more);
 void	proxy_set_hist_lastid(const zbx_uint64_t lastid);
@@ -64,11 +64,13 @@ int	proxy_get_history_count(void);
 int	proxy_get_delay(zbx_uint64_t lastid);
 
 int	zbx_get_proxy_protocol_version(struct zbx_json_parse *jp);
+int	zbx_get_proxy_json_values(const struct zbx_json_parse *jp);
 void	zbx_update_proxy_data(DC_PROXY *proxy, int version, int lastaccess, int compress, zbx_uint64_t flags_add);
 
 int	process_proxy_history_data(const DC_PROXY *proxy, struct zbx_json_parse *jp, zbx_timespec_t *ts, char **info);
 int	process_agent_history_data(zbx_socket_t *sock, struct zbx_json_parse *jp, zbx_timespec_t *ts, char **info);
 int	process_sender_history_data(zbx_socket_t *sock, struct zbx_json_parse *jp, zbx_timespec_t *ts, char **info);
+int	process_rsm_slv_history_data(const struct zbx_json_parse *jp, char **info);
 int	process_proxy_data(const DC_PROXY *proxy, struct zbx_json_parse *jp, zbx_timespec_t *ts,
 		unsigned char proxy_status, int *more, char **error);
 int	zbx_check_protocol_version(DC_PROXY *proxy, int version);
@@ -126,7 +126,6 @@ zbx_uint64_pair_t;
 
 ZBX_HASHSET_ENTRY_T
 {
-	ZBX_HASHSET_ENTRY_T	*next;
 	zbx_hash_t		hash;
 #if SIZEOF_VOID_P > 4
 	/* the data member must be properly aligned on 64-bit architectures that require aligned memory access */
@@ -135,9 +134,20 @@ ZBX_HASHSET_ENTRY_T
 	char			data[1];
 };
 
+/* Entries are indexed by an open addressing (linear probing) slot array. Slots keep the entry hash, */
+/* so probing does not touch entries with different hashes. Entries are still allocated separately   */
+/* to keep the data pointers returned by hashset functions valid until the entry is removed.          */
 typedef struct
 {
-	ZBX_HASHSET_ENTRY_T	**slots;
+	ZBX_HASHSET_ENTRY_T	*entry;
+	zbx_hash_t		hash;
+	int			distance;	/* the number of slots from the slot the entry hashes to */
+}
+zbx_hashset_slot_t;
+
+typedef struct
+{
+	zbx_hashset_slot_t	*slots;
 	int			num_slots;
 	int			num_data;
 	zbx_hash_func_t		hash_func;
@@ -151,6 +161,15 @@ zbx_hashset_t;
 
 #define ZBX_HASHSET_ENTRY_OFFSET	offsetof(ZBX_HASHSET_ENTRY_T, data)
 
+typedef struct
+{
+	int		num_data;
+	int		num_slots;
+	int		probe_max;	/* longest distance between entry home slot and its actual slot */
+	zbx_uint64_t	probe_total;	/* sum of distances for all entries */
+}
+zbx_hashset_stats_t;
+
 void	zbx_hashset_create(zbx_hashset_t *hs, size_t init_size,
 				zbx_hash_func_t hash_func,
 				zbx_compare_func_t compare_func);
@@ -166,16 +185,20 @@ void	zbx_hashset_destroy(zbx_hashset_t *hs);
 int	zbx_hashset_reserve(zbx_hashset_t *hs, int num_slots_req);
 void	*zbx_hashset_insert(zbx_hashset_t *hs, const void *data, size_t size);
 void	*zbx_hashset_insert_ext(zbx_hashset_t *hs, const void *data, size_t size, size_t offset);
+void	*zbx_hashset_insert_by_hash(zbx_hashset_t *hs, zbx_hash_t hash, size_t size);
 void	*zbx_hashset_search(zbx_hashset_t *hs, const void *data);
+void	*zbx_hashset_search_by_hash(zbx_hashset_t *hs, const void *data, zbx_hash_t hash);
 void	zbx_hashset_remove(zbx_hashset_t *hs, const void *data);
 void	zbx_hashset_remove_direct(zbx_hashset_t *hs, const void *data);
 
 void	zbx_hashset_clear(zbx_hashset_t *hs);
+void	zbx_hashset_get_stats(const zbx_hashset_t *hs, zbx_hashset_stats_t *stats);
 
 typedef struct
 {
 	zbx_hashset_t		*hashset;
 	int			slot;
+	int			slot_end;	/* the empty slot where iteration starts and ends */
 	ZBX_HASHSET_ENTRY_T	*entry;
 }
 zbx_hashset_iter_t;
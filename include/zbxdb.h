@@ -129,6 +129,23 @@ void		zbx_db_clean_bind_context(zbx_db_bind_context_t *context);
 int		zbx_db_statement_execute(int iters);
 #endif
 int		zbx_db_vexecute(const char *fmt, va_list args);
+#if defined(HAVE_POSTGRESQL)
+int		zbx_db_copy(const char *sql, const char *data, size_t size);
+#elif defined(HAVE_MYSQL)
+/* prepared statement parameter */
+typedef struct
+{
+	/* the parameter type (ZBX_TYPE_*) */
+	unsigned char	type;
+	/* the parameter value - zbx_uint64_t, int, double or char array depending on type */
+	const void	*value;
+	/* the string value length in bytes */
+	size_t		len;
+}
+zbx_db_param_t;
+
+int		zbx_db_execute_params(const char *sql, const zbx_db_param_t *params, int params_num);
+#endif
 DB_RESULT	zbx_db_vselect(const char *fmt, va_list args);
 DB_RESULT	zbx_db_select_n(const char *query, int n);
 
@@ -170,6 +170,10 @@
 #define ZBX_PROTO_TAG_CLIENTIP			"clientip"
 #define ZBX_PROTO_TAG_ITEM_TAGS			"item_tags"
 #define ZBX_PROTO_TAG_PROXY_UPLOAD		"upload"
+#define ZBX_PROTO_TAG_JSON_VALUES		"json_values"
+#define ZBX_PROTO_TAG_ITEMIDS			"itemids"
+#define ZBX_PROTO_TAG_CLOCKS			"clocks"
+#define ZBX_PROTO_TAG_VALUES			"values"
 #define ZBX_PROTO_TAG_DASHBOARDID		"dashboardid"
 #define ZBX_PROTO_TAG_USERID			"userid"
 #define ZBX_PROTO_TAG_PERIOD			"period"
@@ -225,6 +229,8 @@
 
 #define ZBX_PROTO_VALUE_REPORT_TEST		"report.test"
 
+#define ZBX_PROTO_VALUE_RSM_SLV_DATA		"rsm.slv.data"
+
 typedef enum
 {
 	ZBX_JSON_TYPE_UNKNOWN = 0,
@@ -54,6 +54,8 @@ void	collect_selfmon_stats(void);
 void	get_selfmon_stats(unsigned char proc_type, unsigned char aggr_func, int proc_num, unsigned char state,
 		double *value);
 int	zbx_get_all_process_stats(zbx_process_info_t *stats);
+void	zbx_selfmon_set_rsm_lateness(int lateness);
+int	zbx_selfmon_get_rsm_lateness(unsigned char proc_type);
 void	zbx_sleep_loop(int sleeptime);
 void	zbx_wakeup(void);
 int	zbx_sleep_get_remainder(void);
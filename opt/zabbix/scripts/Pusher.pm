@@ -9,7 +9,7 @@ use Carp;
 
 use base 'Exporter';
 
-our @EXPORT = qw(push_to_trapper);
+our @EXPORT = qw(push_to_trapper push_slv_data_to_trapper);
 
 use constant ZBX_HEADER	=> "ZBXD\1";
 
@@ -152,6 +152,52 @@ sub decode_response($)
 	RSMSLV::dbg("decoded successfully, 'info':'" . ($json->{'info'} // "null") . "'");
 }
 
+sub validate_slv_data($$$)
+{
+	my $itemids = shift();
+	my $clocks = shift();
+	my $values = shift();
+
+	RSMSLV::dbg("validating data to send");
+
+	croak("'itemids', 'clocks' and 'values' must be array references")
+		unless (ref($itemids) eq 'ARRAY' && ref($clocks) eq 'ARRAY' && ref($values) eq 'ARRAY');
+
+	croak("'itemids', 'clocks' and 'values' arrays must be of the same size")
+		unless (scalar(@{$itemids}) == scalar(@{$clocks}) && scalar(@{$itemids}) == scalar(@{$values}));
+
+	foreach my $array ($itemids, $clocks, $values)
+	{
+		croak("elements of 'itemids', 'clocks' and 'values' arrays cannot be null")
+			if (grep(!defined($_), @{$array}));
+	}
+
+	RSMSLV::dbg("data successfully validated");
+}
+
+sub send_to_trapper($$$$$)
+{
+	my $server = shift();
+	my $port = shift();
+	my $timeout = shift();
+	my $attempts = shift();
+	my $request = shift();
+
+	my $socket = connect_to_server($server, $port, $timeout, $attempts);
+
+	send_request($socket, $request);
+
+	# Once we've sent a request we must be committed to waiting for trapper to read and fully process it.
+	# There is no guaranteed way to cancel processing and by sending same value again we will definitely
+	# end up with a duplicate in the database. Hence no timeouts and retries below this point.
+
+	my $response = receive_response($socket);
+
+	disconnect_from_server($socket);
+
+	decode_response($response);
+}
+
 sub push_to_trapper($$$$$)
 {
 	my $server = shift();
@@ -170,19 +216,33 @@ sub push_to_trapper($$$$$)
 		'data'		=> $data
 	});
 
-	my $socket = connect_to_server($server, $port, $timeout, $attempts);
-
-	send_request($socket, $request);
+	send_to_trapper($server, $port, $timeout, $attempts, $request);
+}
 
-	# Once we've sent a request we must be committed to waiting for trapper to read and fully process it.
-	# There is no guaranteed way to cancel processing and by sending same value again we will definitely
-	# end up with a duplicate in the database. Hence no timeouts and retries below this point.
+# Values of SLV items are sent by itemid in one batch of columns. Server trusts itemids only
+# from authenticated clients, hence the session or API token of a Super admin user is required.
+sub push_slv_data_to_trapper($$$$$$$$)
+{
+	my $server = shift();
+	my $port = shift();
+	my $timeout = shift();
+	my $attempts = shift();
+	my $token = shift();
+	my $itemids = shift();
+	my $clocks = shift();
+	my $values = shift();
 
-	my $response = receive_response($socket);
+	validate_slv_data($itemids, $clocks, $values);
 
-	disconnect_from_server($socket);
+	my $request = encode_json({
+		'request'	=> "rsm.slv.data",
+		'sid'		=> $token,
+		'itemids'	=> $itemids,
+		'clocks'	=> $clocks,
+		'values'	=> $values
+	});
 
-	decode_response($response);
+	send_to_trapper($server, $port, $timeout, $attempts, $request);
 }
 
 1;
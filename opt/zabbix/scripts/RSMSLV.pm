@@ -21,7 +21,7 @@ use Data::Dumper;
 use Time::HiRes;
 use Fcntl qw(:flock);	# for the LOCK_* constants, logging to stdout by multiple processes
 use RSM;
-use Pusher qw(push_to_trapper);
+use Pusher qw(push_to_trapper push_slv_data_to_trapper);
 use List::Util qw(min max);
 use Devel::StackTrace;
 use FindBin;
@@ -156,6 +156,7 @@ our @EXPORT = qw($result $dbh $tld
 		float_value_exists
 		sql_time_condition get_incidents get_downtime
 		get_event_false_positiveness
+		get_events_false_positiveness
 		history_table
 		get_lastvalue get_itemids_by_hostids get_nsip_values
 		get_valuemaps get_statusmaps get_detailed_result
@@ -2422,12 +2423,12 @@ sub send_values
 			return;
 		}
 
-		my $data = [map($_->{'data'}, @{$_sender_values->{'data'}})];
-
 		$execution_time_sending_values_start = Time::HiRes::time();
 
 		if (opt('output-file'))
 		{
+			my $data = [map($_->{'data'}, @{$_sender_values->{'data'}})];
+
 			my $output_file = getopt('output-file');
 			dbg("writing $total_values values to $output_file");
 			write_file($output_file, Dumper($data));
@@ -2435,7 +2436,23 @@ sub send_values
 		else
 		{
 			dbg("sending $total_values values");	# send everything in one batch since server should be local
-			push_to_trapper($config->{'slv'}->{'zserver'}, $config->{'slv'}->{'zport'}, 10, 5, $data);
+
+			# values identified by itemids spare the server from looking up every host and key,
+			# server accepts them only with the token of a Super admin user
+			if (defined($config->{'slv'}->{'token'}) && resolve_sender_itemids() == SUCCESS)
+			{
+				push_slv_data_to_trapper($config->{'slv'}->{'zserver'}, $config->{'slv'}->{'zport'}, 10, 5,
+						$config->{'slv'}->{'token'},
+						[map($_->{'itemid'}, @{$_sender_values->{'data'}})],
+						[map($_->{'data'}{'clock'}, @{$_sender_values->{'data'}})],
+						[map($_->{'data'}{'value'}, @{$_sender_values->{'data'}})]);
+			}
+			else
+			{
+				my $data = [map($_->{'data'}, @{$_sender_values->{'data'}})];
+
+				push_to_trapper($config->{'slv'}->{'zserver'}, $config->{'slv'}->{'zport'}, 10, 5, $data);
+			}
 		}
 
 		$execution_time_sending_values_end = Time::HiRes::time();
@@ -2459,6 +2476,42 @@ sub send_values
 	check_sent_values()
 }
 
+# Get itemids of all collected values with one query, the itemids are then
+# reused by check_sent_values().
+# Returns SUCCESS if all items were found, E_FAIL otherwise.
+sub resolve_sender_itemids()
+{
+	my $host_key_pairs_hash = {};
+	my $host_key_pairs_list = [];
+
+	foreach my $sender_value (@{$_sender_values->{'data'}})
+	{
+		my $host = $sender_value->{'data'}{'host'};
+		my $key  = $sender_value->{'data'}{'key'};
+
+		if (!exists($host_key_pairs_hash->{$host}{$key}))
+		{
+			$host_key_pairs_hash->{$host}{$key} = undef;
+			push(@{$host_key_pairs_list}, [$host, $key]);
+		}
+	}
+
+	my $itemids = get_itemids_by_hosts_and_keys($host_key_pairs_list);
+	my $result = SUCCESS;
+
+	foreach my $sender_value (@{$_sender_values->{'data'}})
+	{
+		my $host = $sender_value->{'data'}{'host'};
+		my $key  = $sender_value->{'data'}{'key'};
+
+		$sender_value->{'itemid'} = $itemids->{$host}{$key};
+
+		$result = E_FAIL unless (defined($sender_value->{'itemid'}));
+	}
+
+	return $result;
+}
+
 # Returns 0 if hashes are different.
 # Returns 1 if hashes are the same.
 sub compare_hashes($$)
@@ -2512,7 +2565,7 @@ sub check_sent_values()
 				'clock'      => $sender_value->{'data'}{'clock'},
 				'value'      => $sender_value->{'data'}{'value'},
 				'value_type' => $sender_value->{'value_type'},
-				'itemid'     => undef,
+				'itemid'     => $sender_value->{'itemid'},
 			}
 		);
 	}
@@ -2524,6 +2577,8 @@ sub check_sent_values()
 
 	foreach my $value (@{$data})
 	{
+		next if (defined($value->{'itemid'}));	# already resolved when sending
+
 		my $host = $value->{'host'};
 		my $key  = $value->{'key'};
 
@@ -2534,17 +2589,24 @@ sub check_sent_values()
 		}
 	}
 
-	my $itemids = get_itemids_by_hosts_and_keys($host_key_pairs_list);
-	my $itemids_list = [map(values(%{$_}), values(%{$itemids}))];
-
-	foreach my $value (@{$data})
+	if (scalar(@{$host_key_pairs_list}) != 0)
 	{
-		my $host = $value->{'host'};
-		my $key  = $value->{'key'};
+		my $itemids = get_itemids_by_hosts_and_keys($host_key_pairs_list);
+
+		foreach my $value (@{$data})
+		{
+			next if (defined($value->{'itemid'}));
+
+			my $host = $value->{'host'};
+			my $key  = $value->{'key'};
 
-		$value->{'itemid'} = $itemids->{$host}{$key};
+			$value->{'itemid'} = $itemids->{$host}{$key};
+		}
 	}
 
+	my %unique_itemids = map { $_->{'itemid'} => undef } grep { defined($_->{'itemid'}) } @{$data};
+	my $itemids_list = [keys(%unique_itemids)];
+
 	dbg("getting max pushed clock for each item");
 
 	my $pushed_clocks = {};
@@ -3335,6 +3397,39 @@ sub get_event_false_positiveness($)
 	return $rows->[0][0];
 }
 
+# return "false positive" statuses of events as a hash reference:
+#
+# {
+#     '5881' => '0',
+#     '6585' => '1'
+# }
+#
+# The statuses of all events are fetched in one query, use it instead of
+# get_event_false_positiveness() when processing lists of events.
+sub get_events_false_positiveness($)
+{
+	my $eventids = shift;	# reference to an array
+
+	my %false_positives = map { $_ => 0 } (@{$eventids});	# not "false positive" by default
+
+	return \%false_positives if (scalar(@{$eventids}) == 0);
+
+	my $rows = db_select(
+		"select eventid,status".
+		" from rsm_false_positive".
+		" where eventid in (" . join(',', @{$eventids}) . ")".
+		" order by rsm_false_positiveid"
+	);
+
+	# the latest status of the event overwrites the previous ones
+	foreach my $row (@{$rows})
+	{
+		$false_positives{$row->[0]} = $row->[1];
+	}
+
+	return \%false_positives;
+}
+
 # return incidents as an array reference (sorted by time):
 #
 # [
@@ -3368,7 +3463,7 @@ sub get_incidents
 
 	dbg(selected_period($from, $till));
 
-	my (@incidents, $rows_ref, $row_ref);
+	my (@incidents, $rows_ref);
 
 	$rows_ref = db_select(
 		"select distinct t.triggerid".
@@ -3389,55 +3484,22 @@ sub get_incidents
 
 	my $last_trigger_value = TRIGGER_VALUE_FALSE;
 
+	my $preincident_row_ref;
+
 	if (defined($from))
 	{
 		# first check for ongoing incident
 		$rows_ref = db_select(
-			"select max(clock)".
+			"select eventid,clock,value".
 			" from events".
 			" where object=".EVENT_OBJECT_TRIGGER.
 				" and source=".EVENT_SOURCE_TRIGGERS.
 				" and objectid=$triggerid".
-				" and clock<$from");
-
-		$row_ref = $rows_ref->[0];
-
-		if (defined($row_ref) and defined($row_ref->[0]))
-		{
-			my $preincident_clock = $row_ref->[0];
-
-			$rows_ref = db_select(
-				"select eventid,clock,value".
-				" from events".
-				" where object=".EVENT_OBJECT_TRIGGER.
-					" and source=".EVENT_SOURCE_TRIGGERS.
-					" and objectid=$triggerid".
-					" and clock=$preincident_clock".
-				" order by ns desc".
-				" limit 1");
-
-			$row_ref = $rows_ref->[0];
-
-			my $eventid = $row_ref->[0];
-			my $clock = $row_ref->[1];
-			my $value = $row_ref->[2];
-
-			my $false_positive = get_event_false_positiveness($eventid);
-
-			if (opt('debug'))
-			{
-				my $type = ($value == TRIGGER_VALUE_FALSE ? 'closing' : 'opening');
-				dbg("$type pre-event $eventid: clock:" . ts_str($clock) . " ($clock), false_positive:$false_positive");
-			}
-
-			# do not add 'value=TRIGGER_VALUE_TRUE' to SQL above just for corner case of 2 events at the same second
-			if ($value == TRIGGER_VALUE_TRUE)
-			{
-				push(@incidents, __make_incident($eventid, $false_positive, $clock, cycle_start($clock, $delay)));
+				" and clock<$from".
+			" order by clock desc,ns desc".
+			" limit 1");
 
-				$last_trigger_value = TRIGGER_VALUE_TRUE;
-			}
-		}
+		$preincident_row_ref = $rows_ref->[0];
 	}
 
 	# now check for incidents within given period
@@ -3450,13 +3512,42 @@ sub get_incidents
 			" and ".sql_time_condition($from, $till).
 		" order by clock,ns");
 
+	my @eventids = map { $_->[0] } (@{$rows_ref});
+
+	push(@eventids, $preincident_row_ref->[0]) if (defined($preincident_row_ref));
+
+	my $false_positives = get_events_false_positiveness(\@eventids);
+
+	if (defined($preincident_row_ref))
+	{
+		my $eventid = $preincident_row_ref->[0];
+		my $clock = $preincident_row_ref->[1];
+		my $value = $preincident_row_ref->[2];
+
+		my $false_positive = $false_positives->{$eventid};
+
+		if (opt('debug'))
+		{
+			my $type = ($value == TRIGGER_VALUE_FALSE ? 'closing' : 'opening');
+			dbg("$type pre-event $eventid: clock:" . ts_str($clock) . " ($clock), false_positive:$false_positive");
+		}
+
+		# do not add 'value=TRIGGER_VALUE_TRUE' to SQL above just for corner case of 2 events at the same second
+		if ($value == TRIGGER_VALUE_TRUE)
+		{
+			push(@incidents, __make_incident($eventid, $false_positive, $clock, cycle_start($clock, $delay)));
+
+			$last_trigger_value = TRIGGER_VALUE_TRUE;
+		}
+	}
+
 	foreach my $row_ref (@$rows_ref)
 	{
 		my $eventid = $row_ref->[0];
 		my $clock = $row_ref->[1];
 		my $value = $row_ref->[2];
 
-		my $false_positive = get_event_false_positiveness($eventid);
+		my $false_positive = $false_positives->{$eventid};
 
 		# NB! Incident start/end times must not be truncated to first/last second
 		# of a minute (do not use truncate_from and truncate_till) because they
@@ -6121,11 +6212,13 @@ sub __fp_get_false_positive_ranges($$$)
 
 	my @ranges = ();
 
+	my $false_positives = get_events_false_positiveness([map { $_->[0] } @{$rows}]);
+
 	for my $row (@{$rows})
 	{
 		my ($eventid, $source, $object, $from, $till) = @{$row};
 
-		next if (get_event_false_positiveness($eventid) == 0);
+		next if ($false_positives->{$eventid} == 0);
 
 		fail("unexpected value of events.source for incident #$eventid: $source") if ($source != EVENT_SOURCE_TRIGGERS);
 		fail("unexpected value of events.object for incident #$eventid: $object") if ($object != EVENT_OBJECT_TRIGGER);
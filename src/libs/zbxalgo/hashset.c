@@ -22,9 +22,10 @@
 
 #include "zbxalgo.h"
 
+
 static void	__hashset_free_entry(zbx_hashset_t *hs, ZBX_HASHSET_ENTRY_T *entry);
 
-#define	CRIT_LOAD_FACTOR	4/5
+#define	CRIT_LOAD_FACTOR	2/3
 #define	SLOT_GROWTH_FACTOR	3/2
 
 #define ZBX_HASHSET_DEFAULT_SLOTS	10
@@ -47,10 +48,10 @@ static int	zbx_hashset_init_slots(zbx_hashset_t *hs, size_t init_size)
 	{
 		hs->num_slots = next_prime(init_size);
 
-		if (NULL == (hs->slots = (ZBX_HASHSET_ENTRY_T **)hs->mem_malloc_func(NULL, hs->num_slots * sizeof(ZBX_HASHSET_ENTRY_T *))))
+		if (NULL == (hs->slots = (zbx_hashset_slot_t *)hs->mem_malloc_func(NULL, hs->num_slots * sizeof(zbx_hashset_slot_t))))
 			return FAIL;
 
-		memset(hs->slots, 0, hs->num_slots * sizeof(ZBX_HASHSET_ENTRY_T *));
+		memset(hs->slots, 0, hs->num_slots * sizeof(zbx_hashset_slot_t));
 	}
 	else
 	{
@@ -61,6 +62,134 @@ static int	zbx_hashset_init_slots(zbx_hashset_t *hs, size_t init_size)
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: moves entries to a new slot array                                 *
+ *                                                                            *
+ * Parameters: hs        - [IN] the hashset                                   *
+ *             num_slots - [IN] the number of slots in the new array          *
+ *                                                                            *
+ * Comments: The new array is allocated before the old one is freed, so the   *
+ *           memory for both must be available.                               *
+ *                                                                            *
+ ******************************************************************************/
+static int	hashset_rehash(zbx_hashset_t *hs, int num_slots)
+{
+	int			i, slot, distance;
+	zbx_hashset_slot_t	*slots;
+
+	if (NULL == (slots = (zbx_hashset_slot_t *)hs->mem_malloc_func(NULL, num_slots * sizeof(zbx_hashset_slot_t))))
+		return FAIL;
+
+	memset(slots, 0, num_slots * sizeof(zbx_hashset_slot_t));
+
+	for (i = 0; i < hs->num_slots; i++)
+	{
+		if (NULL == hs->slots[i].entry)
+			continue;
+
+		slot = hs->slots[i].hash % num_slots;
+
+		for (distance = 0; NULL != slots[slot].entry; distance++)
+		{
+			if (++slot == num_slots)
+				slot = 0;
+		}
+
+		slots[slot] = hs->slots[i];
+		slots[slot].distance = distance;
+	}
+
+	hs->mem_free_func(hs->slots);
+
+	hs->slots = slots;
+	hs->num_slots = num_slots;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds the slot of an entry matching the given data                *
+ *                                                                            *
+ * Parameters: hs        - [IN] the hashset                                   *
+ *             data      - [IN] the data to match                             *
+ *             hash      - [IN] the data hash                                 *
+ *             free_slot - [OUT] the empty slot ending the probing sequence,  *
+ *                               where the data can be inserted (optional)    *
+ *             distance  - [OUT] the free slot distance from the slot the     *
+ *                               data hashes to (optional)                    *
+ *                                                                            *
+ * Return value: the matching slot index or -1 if the data was not found      *
+ *                                                                            *
+ ******************************************************************************/
+static int	hashset_find_slot(const zbx_hashset_t *hs, const void *data, zbx_hash_t hash, int *free_slot,
+		int *distance)
+{
+	int			slot, i;
+	zbx_hashset_slot_t	*s;
+
+	slot = hash % hs->num_slots;
+
+	for (i = 0; NULL != (s = &hs->slots[slot])->entry; i++)
+	{
+		if (s->hash == hash && 0 == hs->compare_func(s->entry->data, data))
+			return slot;
+
+		if (++slot == hs->num_slots)
+			slot = 0;
+	}
+
+	if (NULL != free_slot)
+		*free_slot = slot;
+
+	if (NULL != distance)
+		*distance = i;
+
+	return -1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes entry from the specified slot                             *
+ *                                                                            *
+ * Comments: The following entries of the probing cluster are shifted back    *
+ *           into the freed slot when it is still on their probing sequence,  *
+ *           so no removed entry marks are left and probing sequences do not  *
+ *           grow with insert/remove churn. Only slots are moved, entries     *
+ *           stay at their addresses.                                         *
+ *           Entries are moved only from the following slots of the cluster   *
+ *           to the freed slot or to slots freed by previous moves, which is  *
+ *           taken into account by hashset iterator.                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	hashset_remove_slot(zbx_hashset_t *hs, int slot)
+{
+	int	next, shift;
+
+	__hashset_free_entry(hs, hs->slots[slot].entry);
+	hs->num_data--;
+
+	for (next = slot + 1 == hs->num_slots ? 0 : slot + 1; NULL != hs->slots[next].entry;)
+	{
+		if (0 > (shift = next - slot))
+			shift += hs->num_slots;
+
+		/* the entry can be moved if the freed slot is not before the slot the entry hashes to */
+		if (shift <= hs->slots[next].distance)
+		{
+			hs->slots[slot] = hs->slots[next];
+			hs->slots[slot].distance -= shift;
+			slot = next;
+		}
+
+		if (++next == hs->num_slots)
+			next = 0;
+	}
+
+	hs->slots[slot].entry = NULL;
+}
+
 /* public hashset interface */
 
 void	zbx_hashset_create(zbx_hashset_t *hs, size_t init_size,
@@ -93,19 +222,12 @@ void	zbx_hashset_create_ext(zbx_hashset_t *hs, size_t init_size,
 
 void	zbx_hashset_destroy(zbx_hashset_t *hs)
 {
-	int			i;
-	ZBX_HASHSET_ENTRY_T	*entry, *next_entry;
+	int	i;
 
 	for (i = 0; i < hs->num_slots; i++)
 	{
-		entry = hs->slots[i];
-
-		while (NULL != entry)
-		{
-			next_entry = entry->next;
-			__hashset_free_entry(hs, entry);
-			entry = next_entry;
-		}
+		if (NULL != hs->slots[i].entry)
+			__hashset_free_entry(hs, hs->slots[i].entry);
 	}
 
 	hs->num_data = 0;
@@ -145,47 +267,38 @@ int	zbx_hashset_reserve(zbx_hashset_t *hs, int num_slots_req)
 	}
 	else if (num_slots_req >= hs->num_slots * CRIT_LOAD_FACTOR)
 	{
-		int			inc_slots, new_slot, slot;
-		void			*slots;
-		ZBX_HASHSET_ENTRY_T	**prev_next, *curr_entry, *tmp;
+		int	inc_slots;
 
-		inc_slots = next_prime(hs->num_slots * SLOT_GROWTH_FACTOR);
+		inc_slots = next_prime(MAX(hs->num_slots * SLOT_GROWTH_FACTOR, num_slots_req * 2 + 1));
 
-		if (NULL == (slots = hs->mem_realloc_func(hs->slots, inc_slots * sizeof(ZBX_HASHSET_ENTRY_T *))))
+		if (SUCCEED != hashset_rehash(hs, inc_slots))
 			return FAIL;
+	}
 
-		hs->slots = (ZBX_HASHSET_ENTRY_T **)slots;
+	return SUCCEED;
+}
 
-		memset(hs->slots + hs->num_slots, 0, (inc_slots - hs->num_slots) * sizeof(ZBX_HASHSET_ENTRY_T *));
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocates entry and stores it in the specified free slot          *
+ *                                                                            *
+ ******************************************************************************/
+static ZBX_HASHSET_ENTRY_T	*hashset_add_entry(zbx_hashset_t *hs, int slot, int distance, zbx_hash_t hash,
+		size_t size)
+{
+	ZBX_HASHSET_ENTRY_T	*entry;
 
-		for (slot = 0; slot < hs->num_slots; slot++)
-		{
-			prev_next = &hs->slots[slot];
-			curr_entry = hs->slots[slot];
-
-			while (NULL != curr_entry)
-			{
-				if (slot != (new_slot = curr_entry->hash % inc_slots))
-				{
-					tmp = curr_entry->next;
-					curr_entry->next = hs->slots[new_slot];
-					hs->slots[new_slot] = curr_entry;
-
-					*prev_next = tmp;
-					curr_entry = tmp;
-				}
-				else
-				{
-					prev_next = &curr_entry->next;
-					curr_entry = curr_entry->next;
-				}
-			}
-		}
+	if (NULL == (entry = (ZBX_HASHSET_ENTRY_T *)hs->mem_malloc_func(NULL, ZBX_HASHSET_ENTRY_OFFSET + size)))
+		return NULL;
 
-		hs->num_slots = inc_slots;
-	}
+	entry->hash = hash;
 
-	return SUCCEED;
+	hs->slots[slot].entry = entry;
+	hs->slots[slot].hash = hash;
+	hs->slots[slot].distance = distance;
+	hs->num_data++;
+
+	return entry;
 }
 
 void	*zbx_hashset_insert(zbx_hashset_t *hs, const void *data, size_t size)
@@ -195,7 +308,7 @@ void	*zbx_hashset_insert(zbx_hashset_t *hs, const void *data, size_t size)
 
 void	*zbx_hashset_insert_ext(zbx_hashset_t *hs, const void *data, size_t size, size_t offset)
 {
-	int			slot;
+	int			slot, free_slot, distance, num_slots;
 	zbx_hash_t		hash;
 	ZBX_HASHSET_ENTRY_T	*entry;
 
@@ -204,61 +317,90 @@ void	*zbx_hashset_insert_ext(zbx_hashset_t *hs, const void *data, size_t size, s
 
 	hash = hs->hash_func(data);
 
-	slot = hash % hs->num_slots;
-	entry = hs->slots[slot];
-
-	while (NULL != entry)
-	{
-		if (entry->hash == hash && hs->compare_func(entry->data, data) == 0)
-			break;
+	if (-1 != (slot = hashset_find_slot(hs, data, hash, &free_slot, &distance)))
+		return hs->slots[slot].entry->data;
 
-		entry = entry->next;
-	}
+	num_slots = hs->num_slots;
 
-	if (NULL == entry)
-	{
-		if (SUCCEED != zbx_hashset_reserve(hs, hs->num_data + 1))
-			return NULL;
+	if (SUCCEED != zbx_hashset_reserve(hs, hs->num_data + 1))
+		return NULL;
 
-		/* recalculate new slot */
-		slot = hash % hs->num_slots;
+	/* recalculate new slot if entries were moved */
+	if (num_slots != hs->num_slots)
+		hashset_find_slot(hs, data, hash, &free_slot, &distance);
 
-		if (NULL == (entry = (ZBX_HASHSET_ENTRY_T *)hs->mem_malloc_func(NULL, ZBX_HASHSET_ENTRY_OFFSET + size)))
-			return NULL;
+	if (NULL == (entry = hashset_add_entry(hs, free_slot, distance, hash, size)))
+		return NULL;
 
-		memcpy((char *)entry->data + offset, (const char *)data + offset, size - offset);
-		entry->hash = hash;
-		entry->next = hs->slots[slot];
-		hs->slots[slot] = entry;
-		hs->num_data++;
-	}
+	memcpy((char *)entry->data + offset, (const char *)data + offset, size - offset);
 
 	return entry->data;
 }
 
-void	*zbx_hashset_search(zbx_hashset_t *hs, const void *data)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: inserts new entry with precalculated hash                         *
+ *                                                                            *
+ * Parameters: hs   - [IN] the hashset                                        *
+ *             hash - [IN] the entry hash                                     *
+ *             size - [IN] the entry data size                                *
+ *                                                                            *
+ * Return value: the uninitialized entry data or NULL on allocation failure   *
+ *                                                                            *
+ * Comments: The entry must not exist in hashset, so the caller must search   *
+ *           for it with zbx_hashset_search_by_hash() first. This allows to   *
+ *           search by a key that differs from the entry data layout.         *
+ *                                                                            *
+ ******************************************************************************/
+void	*zbx_hashset_insert_by_hash(zbx_hashset_t *hs, zbx_hash_t hash, size_t size)
 {
-	int			slot;
-	zbx_hash_t		hash;
+	int			slot, distance;
 	ZBX_HASHSET_ENTRY_T	*entry;
 
-	if (0 == hs->num_slots)
+	if (SUCCEED != zbx_hashset_reserve(hs, hs->num_data + 1))
 		return NULL;
 
-	hash = hs->hash_func(data);
-
 	slot = hash % hs->num_slots;
-	entry = hs->slots[slot];
 
-	while (NULL != entry)
+	for (distance = 0; NULL != hs->slots[slot].entry; distance++)
 	{
-		if (entry->hash == hash && hs->compare_func(entry->data, data) == 0)
-			break;
-
-		entry = entry->next;
+		if (++slot == hs->num_slots)
+			slot = 0;
 	}
 
-	return (NULL != entry ? entry->data : NULL);
+	if (NULL == (entry = hashset_add_entry(hs, slot, distance, hash, size)))
+		return NULL;
+
+	return entry->data;
+}
+
+void	*zbx_hashset_search(zbx_hashset_t *hs, const void *data)
+{
+	return zbx_hashset_search_by_hash(hs, data, hs->hash_func(data));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: searches for entry using precalculated hash                       *
+ *                                                                            *
+ * Parameters: hs   - [IN] the hashset                                        *
+ *             data - [IN] the data passed to compare function                *
+ *             hash - [IN] the data hash                                      *
+ *                                                                            *
+ * Return value: the entry data or NULL if not found                          *
+ *                                                                            *
+ ******************************************************************************/
+void	*zbx_hashset_search_by_hash(zbx_hashset_t *hs, const void *data, zbx_hash_t hash)
+{
+	int	slot;
+
+	if (0 == hs->num_slots)
+		return NULL;
+
+	if (-1 == (slot = hashset_find_slot(hs, data, hash, NULL, NULL)))
+		return NULL;
+
+	return hs->slots[slot].entry->data;
 }
 
 /******************************************************************************
@@ -268,48 +410,13 @@ void	*zbx_hashset_search(zbx_hashset_t *hs, const void *data)
  ******************************************************************************/
 void	zbx_hashset_remove(zbx_hashset_t *hs, const void *data)
 {
-	int			slot;
-	zbx_hash_t		hash;
-	ZBX_HASHSET_ENTRY_T	*entry;
+	int	slot;
 
 	if (0 == hs->num_slots)
 		return;
 
-	hash = hs->hash_func(data);
-
-	slot = hash % hs->num_slots;
-	entry = hs->slots[slot];
-
-	if (NULL != entry)
-	{
-		if (entry->hash == hash && hs->compare_func(entry->data, data) == 0)
-		{
-			hs->slots[slot] = entry->next;
-			__hashset_free_entry(hs, entry);
-			hs->num_data--;
-		}
-		else
-		{
-			ZBX_HASHSET_ENTRY_T	*prev_entry;
-
-			prev_entry = entry;
-			entry = entry->next;
-
-			while (NULL != entry)
-			{
-				if (entry->hash == hash && hs->compare_func(entry->data, data) == 0)
-				{
-					prev_entry->next = entry->next;
-					__hashset_free_entry(hs, entry);
-					hs->num_data--;
-					break;
-				}
-
-				prev_entry = entry;
-				entry = entry->next;
-			}
-		}
-	}
+	if (-1 != (slot = hashset_find_slot(hs, data, hs->hash_func(data), NULL, NULL)))
+		hashset_remove_slot(hs, slot);
 }
 
 /******************************************************************************
@@ -321,7 +428,7 @@ void	zbx_hashset_remove(zbx_hashset_t *hs, const void *data)
 void	zbx_hashset_remove_direct(zbx_hashset_t *hs, const void *data)
 {
 	int			slot;
-	ZBX_HASHSET_ENTRY_T	*data_entry, *iter_entry;
+	ZBX_HASHSET_ENTRY_T	*data_entry;
 
 	if (0 == hs->num_slots)
 		return;
@@ -329,52 +436,70 @@ void	zbx_hashset_remove_direct(zbx_hashset_t *hs, const void *data)
 	data_entry = (ZBX_HASHSET_ENTRY_T *)((const char *)data - ZBX_HASHSET_ENTRY_OFFSET);
 
 	slot = data_entry->hash % hs->num_slots;
-	iter_entry = hs->slots[slot];
 
-	if (NULL != iter_entry)
+	while (NULL != hs->slots[slot].entry)
 	{
-		if (iter_entry == data_entry)
+		if (hs->slots[slot].entry == data_entry)
 		{
-			hs->slots[slot] = data_entry->next;
-			__hashset_free_entry(hs, data_entry);
-			hs->num_data--;
-		}
-		else
-		{
-			while (NULL != iter_entry->next)
-			{
-				if (iter_entry->next == data_entry)
-				{
-					iter_entry->next = data_entry->next;
-					__hashset_free_entry(hs, data_entry);
-					hs->num_data--;
-					break;
-				}
-
-				iter_entry = iter_entry->next;
-			}
+			hashset_remove_slot(hs, slot);
+			break;
 		}
+
+		if (++slot == hs->num_slots)
+			slot = 0;
 	}
 }
 
 void	zbx_hashset_clear(zbx_hashset_t *hs)
 {
-	int			slot;
-	ZBX_HASHSET_ENTRY_T	*entry;
+	int	slot;
 
 	for (slot = 0; slot < hs->num_slots; slot++)
 	{
-		while (NULL != hs->slots[slot])
-		{
-			entry = hs->slots[slot];
-			hs->slots[slot] = entry->next;
-			__hashset_free_entry(hs, entry);
-		}
+		if (NULL != hs->slots[slot].entry)
+			__hashset_free_entry(hs, hs->slots[slot].entry);
+
+		hs->slots[slot].entry = NULL;
 	}
 
 	hs->num_data = 0;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets hashset slot usage and probing statistics                    *
+ *                                                                            *
+ * Parameters: hs    - [IN] the hashset                                       *
+ *             stats - [OUT] the statistics                                   *
+ *                                                                            *
+ * Comments: Probe distance is the number of slots between the slot an entry  *
+ *           hashes to and the slot where it is actually stored.              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_hashset_get_stats(const zbx_hashset_t *hs, zbx_hashset_stats_t *stats)
+{
+	int	slot, distance;
+
+	memset(stats, 0, sizeof(zbx_hashset_stats_t));
+
+	stats->num_data = hs->num_data;
+	stats->num_slots = hs->num_slots;
+
+	for (slot = 0; slot < hs->num_slots; slot++)
+	{
+		if (NULL == hs->slots[slot].entry)
+			continue;
+
+		if (0 > (distance = slot - (int)(hs->slots[slot].hash % hs->num_slots)))
+			distance += hs->num_slots;
+
+		stats->probe_total += distance;
+
+		if (distance > stats->probe_max)
+			stats->probe_max = distance;
+	}
+}
+
 #define	ITER_START	(-1)
 #define	ITER_FINISH	(-2)
 
@@ -382,65 +507,71 @@ void	zbx_hashset_iter_reset(zbx_hashset_t *hs, zbx_hashset_iter_t *iter)
 {
 	iter->hashset = hs;
 	iter->slot = ITER_START;
+	iter->entry = NULL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns the next hashset entry                                    *
+ *                                                                            *
+ * Comments: Iteration starts after an empty slot and wraps around the slot   *
+ *           array up to that slot, so no probing cluster crosses the         *
+ *           iteration boundary and removing an entry can move only not yet   *
+ *           visited entries - to the removed entry slot or further.          *
+ *                                                                            *
+ ******************************************************************************/
 void	*zbx_hashset_iter_next(zbx_hashset_iter_t *iter)
 {
+	zbx_hashset_t	*hs = iter->hashset;
+
 	if (ITER_FINISH == iter->slot)
 		return NULL;
 
-	if (ITER_START != iter->slot && NULL != iter->entry && NULL != iter->entry->next)
+	if (ITER_START == iter->slot)
 	{
-		iter->entry = iter->entry->next;
-		return iter->entry->data;
+		if (0 == hs->num_data)
+		{
+			iter->slot = ITER_FINISH;
+			return NULL;
+		}
+
+		for (iter->slot_end = 0; NULL != hs->slots[iter->slot_end].entry; iter->slot_end++)
+			;
+
+		iter->slot = iter->slot_end;
 	}
 
 	while (1)
 	{
-		iter->slot++;
+		if (++iter->slot == hs->num_slots)
+			iter->slot = 0;
 
-		if (iter->slot == iter->hashset->num_slots)
+		if (iter->slot == iter->slot_end)
 		{
 			iter->slot = ITER_FINISH;
+			iter->entry = NULL;
 			return NULL;
 		}
 
-		if (NULL != iter->hashset->slots[iter->slot])
-		{
-			iter->entry = iter->hashset->slots[iter->slot];
+		if (NULL != (iter->entry = hs->slots[iter->slot].entry))
 			return iter->entry->data;
-		}
 	}
 }
 
 void	zbx_hashset_iter_remove(zbx_hashset_iter_t *iter)
 {
-	if (ITER_START == iter->slot || ITER_FINISH == iter->slot || NULL == iter->entry)
+	zbx_hashset_t	*hs = iter->hashset;
+
+	if (ITER_START == iter->slot || ITER_FINISH == iter->slot || NULL == iter->entry ||
+			hs->slots[iter->slot].entry != iter->entry)
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "removing a hashset entry through a bad iterator");
 		exit(EXIT_FAILURE);
 	}
 
-	if (iter->hashset->slots[iter->slot] == iter->entry)
-	{
-		iter->hashset->slots[iter->slot] = iter->entry->next;
-		__hashset_free_entry(iter->hashset, iter->entry);
-		iter->hashset->num_data--;
+	hashset_remove_slot(hs, iter->slot);
 
-		iter->slot--;
-		iter->entry = NULL;
-	}
-	else
-	{
-		ZBX_HASHSET_ENTRY_T	*prev_entry = iter->hashset->slots[iter->slot];
-
-		while (prev_entry->next != iter->entry)
-			prev_entry = prev_entry->next;
-
-		prev_entry->next = iter->entry->next;
-		__hashset_free_entry(iter->hashset, iter->entry);
-		iter->hashset->num_data--;
-
-		iter->entry = prev_entry;
-	}
+	/* the slot might have been taken by the following entry, so it must be checked again */
+	iter->slot = (0 == iter->slot ? hs->num_slots : iter->slot) - 1;
+	iter->entry = NULL;
 }
@@ -26,6 +26,7 @@
 #	include "mysql.h"
 #	include "errmsg.h"
 #	include "mysqld_error.h"
+#	include "dbschema.h"
 #elif defined(HAVE_ORACLE)
 #	include "dbschema.h"
 #	include "oci.h"
@@ -1614,6 +1615,236 @@ clean:
 	return ret;
 }
 
+#if defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: handle PostgreSQL statement error                                 *
+ *                                                                            *
+ * Parameters: result - [IN] the statement result (can be NULL)               *
+ *             sql    - [IN] the executed statement                           *
+ *                                                                            *
+ * Return value: ZBX_DB_DOWN - the database connection was lost               *
+ *               ZBX_DB_FAIL - the statement failed                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_db_pg_statement_error(const PGresult *result, const char *sql)
+{
+	zbx_err_codes_t	errcode;
+	char		*error = NULL;
+
+	if (NULL == result)
+	{
+		zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), sql);
+		return CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN;
+	}
+
+	zbx_postgresql_error(&error, result);
+
+	if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), "23505"))
+		errcode = ERR_Z3008;
+	else
+		errcode = ERR_Z3005;
+
+	zbx_db_errlog(errcode, 0, error, sql);
+	zbx_free(error);
+
+	return SUCCEED == is_recoverable_postgresql_error(conn, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: load data into table with COPY ... FROM STDIN statement           *
+ *                                                                            *
+ * Parameters: sql  - [IN] the copy statement                                 *
+ *             data - [IN] the data in format specified by copy statement     *
+ *             size - [IN] the data size                                      *
+ *                                                                            *
+ * Return value: number of copied rows or ZBX_DB_FAIL/ZBX_DB_DOWN on error    *
+ *                                                                            *
+ * Comments: The errors are handled in the same way as for insert statements, *
+ *           so duplicate rows are reported with ERR_Z3008 error code.        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_copy(const char *sql, const char *data, size_t size)
+{
+	int		ret = ZBX_DB_OK;
+	double		sec = 0;
+	PGresult	*result;
+
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+		sec = zbx_time();
+
+	if (0 == txn_level)
+		zabbix_log(LOG_LEVEL_DEBUG, "query without transaction detected");
+
+	if (ZBX_DB_OK != txn_error)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", txn_level,
+				sql);
+		return ZBX_DB_FAIL;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s] [" ZBX_FS_SIZE_T " bytes]", txn_level, sql,
+			(zbx_fs_size_t)size);
+
+	result = PQexec(conn, sql);
+
+	if (NULL == result || PGRES_COPY_IN != PQresultStatus(result))
+	{
+		ret = zbx_db_pg_statement_error(result, sql);
+		PQclear(result);
+		goto out;
+	}
+
+	PQclear(result);
+
+	if (1 != PQputCopyData(conn, data, (int)size) || 1 != PQputCopyEnd(conn, NULL))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), sql);
+		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+	}
+
+	/* the copy command is finished by the last result, which must be read even after failure */
+	while (NULL != (result = PQgetResult(conn)))
+	{
+		if (ZBX_DB_OK == ret)
+		{
+			if (PGRES_COMMAND_OK != PQresultStatus(result))
+				ret = zbx_db_pg_statement_error(result, sql);
+			else
+				ret = atoi(PQcmdTuples(result));
+		}
+
+		PQclear(result);
+	}
+out:
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+	{
+		sec = zbx_time() - sec;
+		if (sec > (double)CONFIG_LOG_SLOW_QUERIES / 1000.0)
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"%s\"", sec, sql);
+	}
+
+	if (ZBX_DB_FAIL == ret && 0 < txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [%s] failed, setting transaction as failed", sql);
+		txn_error = ZBX_DB_FAIL;
+	}
+
+	return ret;
+}
+#elif defined(HAVE_MYSQL)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute a non-select prepared statement with bound parameters     *
+ *                                                                            *
+ * Parameters: sql        - [IN] the statement with '?' parameter markers     *
+ *             params     - [IN] the parameter values                         *
+ *             params_num - [IN] the number of parameters                     *
+ *                                                                            *
+ * Return value: number of affected rows or ZBX_DB_FAIL/ZBX_DB_DOWN on error  *
+ *                                                                            *
+ * Comments: The parameter values are bound directly, without copying.        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_execute_params(const char *sql, const zbx_db_param_t *params, int params_num)
+{
+	int		i, err_no, ret = ZBX_DB_OK;
+	double		sec = 0;
+	MYSQL_STMT	*stmt = NULL;
+	MYSQL_BIND	*binds;
+	unsigned long	*lengths;
+
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+		sec = zbx_time();
+
+	if (0 == txn_level)
+		zabbix_log(LOG_LEVEL_DEBUG, "query without transaction detected");
+
+	if (ZBX_DB_OK != txn_error)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", txn_level,
+				sql);
+		return ZBX_DB_FAIL;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s] [%d parameters]", txn_level, sql, params_num);
+
+	if (NULL == conn)
+	{
+		zbx_db_errlog(ERR_Z3003, 0, NULL, NULL);
+		return ZBX_DB_FAIL;
+	}
+
+	binds = (MYSQL_BIND *)zbx_malloc(NULL, sizeof(MYSQL_BIND) * (size_t)params_num);
+	lengths = (unsigned long *)zbx_malloc(NULL, sizeof(unsigned long) * (size_t)params_num);
+	memset(binds, 0, sizeof(MYSQL_BIND) * (size_t)params_num);
+
+	for (i = 0; i < params_num; i++)
+	{
+		binds[i].buffer = (void *)params[i].value;
+
+		switch (params[i].type)
+		{
+			case ZBX_TYPE_ID:
+			case ZBX_TYPE_UINT:
+				binds[i].buffer_type = MYSQL_TYPE_LONGLONG;
+				binds[i].is_unsigned = 1;
+				break;
+			case ZBX_TYPE_INT:
+				binds[i].buffer_type = MYSQL_TYPE_LONG;
+				break;
+			case ZBX_TYPE_FLOAT:
+				binds[i].buffer_type = MYSQL_TYPE_DOUBLE;
+				break;
+			default:
+				lengths[i] = (unsigned long)params[i].len;
+				binds[i].buffer_type = MYSQL_TYPE_STRING;
+				binds[i].buffer_length = lengths[i];
+				binds[i].length = &lengths[i];
+				break;
+		}
+	}
+
+	if (NULL == (stmt = mysql_stmt_init(conn)))
+	{
+		err_no = (int)mysql_errno(conn);
+		zbx_db_errlog(ERR_Z3005, err_no, mysql_error(conn), sql);
+		ret = (SUCCEED == is_recoverable_mysql_error(err_no) ? ZBX_DB_DOWN : ZBX_DB_FAIL);
+	}
+	else if (0 != mysql_stmt_prepare(stmt, sql, (unsigned long)strlen(sql)) ||
+			0 != mysql_stmt_bind_param(stmt, binds) || 0 != mysql_stmt_execute(stmt))
+	{
+		err_no = (int)mysql_stmt_errno(stmt);
+		zbx_db_errlog((ER_DUP_ENTRY == err_no ? ERR_Z3008 : ERR_Z3005), err_no, mysql_stmt_error(stmt), sql);
+		ret = (SUCCEED == is_recoverable_mysql_error(err_no) ? ZBX_DB_DOWN : ZBX_DB_FAIL);
+	}
+	else
+		ret = (int)mysql_stmt_affected_rows(stmt);
+
+	if (NULL != stmt)
+		mysql_stmt_close(stmt);
+
+	zbx_free(lengths);
+	zbx_free(binds);
+
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+	{
+		sec = zbx_time() - sec;
+		if (sec > (double)CONFIG_LOG_SLOW_QUERIES / 1000.0)
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"%s\"", sec, sql);
+	}
+
+	if (ZBX_DB_FAIL == ret && 0 < txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [%s] failed, setting transaction as failed", sql);
+		txn_error = ZBX_DB_FAIL;
+	}
+
+	return ret;
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: execute a select statement                                        *
@@ -32,6 +32,8 @@
 #include "daemon.h"
 #include "zbxavailability.h"
 #include "zbxtrends.h"
+#include "zbxcompress.h"
+#include "base64.h"
 #include "../zbxalgo/vectorimpl.h"
 
 static zbx_mem_info_t	*hc_index_mem = NULL;
@@ -44,17 +46,24 @@ static zbx_mem_info_t	*trend_mem = NULL;
 #define	UNLOCK_TRENDS	zbx_mutex_unlock(trends_lock)
 #define	LOCK_CACHE_IDS		zbx_mutex_lock(cache_ids_lock)
 #define	UNLOCK_CACHE_IDS	zbx_mutex_unlock(cache_ids_lock)
+#define	LOCK_HISTORY_QUEUE(shard)	zbx_mutex_lock(history_queue_locks[shard])
+#define	UNLOCK_HISTORY_QUEUE(shard)	zbx_mutex_unlock(history_queue_locks[shard])
 
 static zbx_mutex_t	cache_lock = ZBX_MUTEX_NULL;
 static zbx_mutex_t	trends_lock = ZBX_MUTEX_NULL;
 static zbx_mutex_t	cache_ids_lock = ZBX_MUTEX_NULL;
+static zbx_mutex_t	history_queue_locks[ZBX_MUTEX_HISTORY_QUEUE_NUM];
 
 static char		*sql = NULL;
 static size_t		sql_alloc = 4 * ZBX_KIBIBYTE;
 
 extern unsigned char	program_type;
+extern ZBX_THREAD_LOCAL unsigned char	process_type;
+extern ZBX_THREAD_LOCAL int		process_num;
 extern int		CONFIG_DOUBLE_PRECISION;
 extern char		*CONFIG_EXPORT_DIR;
+extern int		CONFIG_HISTORY_CACHE_COMPRESS_SIZE;
+extern int		CONFIG_PROXY_HISTORY_COMPRESS_SIZE;
 
 #define ZBX_IDS_SIZE	10
 
@@ -62,6 +71,12 @@ extern char		*CONFIG_EXPORT_DIR;
 
 #define ZBX_TRENDS_CLEANUP_TIME	((SEC_PER_HOUR * 55) / 60)
 
+/* the period the last flushed trend hour of an item without new values is kept in cache */
+#define ZBX_TRENDS_FLUSHED_HOUR_TTL	SEC_PER_DAY
+
+/* the maximum number of rows in one trend upsert statement */
+#define ZBX_TRENDS_UPSERT_ROWS	1000
+
 /* the maximum time spent synchronizing history */
 #define ZBX_HC_SYNC_TIME_MAX	10
 
@@ -73,6 +88,12 @@ extern char		*CONFIG_EXPORT_DIR;
 /* the minimum processed item percentage of item candidates to continue synchronizing */
 #define ZBX_HC_SYNC_MIN_PCNT	10
 
+/* the weight of the last history write time in the history write latency average */
+#define ZBX_HC_WRITE_LATENCY_WEIGHT	0.1
+
+/* the history write latency is ignored if no values were written for this number of seconds */
+#define ZBX_HC_WRITE_LATENCY_TTL	10
+
 /* the maximum number of characters for history cache values */
 #define ZBX_HISTORY_VALUE_LEN	(1024 * 64)
 
@@ -113,7 +134,11 @@ typedef struct
 	ZBX_DC_STATS		stats;
 
 	zbx_hashset_t		history_items;
-	zbx_binary_heap_t	history_queue;
+
+	/* History queue is split into shards by itemid hash. Each shard is locked by its own */
+	/* mutex and is processed by its own history syncers, see hc_pop_items().             */
+	zbx_binary_heap_t	history_queues[ZBX_MUTEX_HISTORY_QUEUE_NUM];
+	int			history_queues_num;
 
 	int			history_num;
 	int			trends_num;
@@ -121,6 +146,15 @@ typedef struct
 	int			history_num_total;
 	int			history_progress_ts;
 
+	/* the average time of writing one history value to database, in seconds */
+	double			history_write_latency;
+
+	/* the time when history write latency was last updated */
+	int			history_write_ts;
+
+	/* housekeeper statistics, exposed as internal items */
+	zbx_hk_stats_t		hk_stats;
+
 	unsigned char		db_trigger_queue_lock;
 
 	zbx_hc_proxyqueue_t     proxyqueue;
@@ -381,12 +415,13 @@ static void	DCupdate_trends(zbx_vector_uint64_pair_t *trends_diff)
 static void	dc_insert_trends_in_db(ZBX_DC_TREND *trends, int trends_num, unsigned char value_type,
 		const char *table_name, int clock)
 {
-	ZBX_DC_TREND	*trend;
-	int		i;
-	zbx_db_insert_t	db_insert;
+	ZBX_DC_TREND		*trend;
+	int			i;
+	zbx_db_colinsert_t	db_insert;
 
-	zbx_db_insert_prepare(&db_insert, table_name, "itemid", "clock", "num", "value_min", "value_avg",
+	zbx_db_colinsert_prepare(&db_insert, table_name, "itemid", "clock", "num", "value_min", "value_avg",
 			"value_max", NULL);
+	zbx_db_colinsert_reserve(&db_insert, trends_num);
 
 	for (i = 0; i < trends_num; i++)
 	{
@@ -400,7 +435,7 @@ static void	dc_insert_trends_in_db(ZBX_DC_TREND *trends, int trends_num, unsigne
 
 		if (ITEM_VALUE_TYPE_FLOAT == value_type)
 		{
-			zbx_db_insert_add_values(&db_insert, trend->itemid, trend->clock, trend->num,
+			zbx_db_colinsert_add_values(&db_insert, trend->itemid, trend->clock, trend->num,
 					trend->value_min.dbl, trend->value_avg.dbl, trend->value_max.dbl);
 		}
 		else
@@ -410,15 +445,15 @@ static void	dc_insert_trends_in_db(ZBX_DC_TREND *trends, int trends_num, unsigne
 			/* calculate the trend average value */
 			udiv128_64(&avg, &trend->value_avg.ui64, trend->num);
 
-			zbx_db_insert_add_values(&db_insert, trend->itemid, trend->clock, trend->num,
+			zbx_db_colinsert_add_values(&db_insert, trend->itemid, trend->clock, trend->num,
 					trend->value_min.ui64, avg.lo, trend->value_max.ui64);
 		}
 
 		trend->itemid = 0;
 	}
 
-	zbx_db_insert_execute(&db_insert);
-	zbx_db_insert_clean(&db_insert);
+	zbx_db_colinsert_execute(&db_insert);
+	zbx_db_colinsert_clean(&db_insert);
 }
 
 /******************************************************************************
@@ -492,6 +527,7 @@ static void	dc_remove_updated_trends(ZBX_DC_TREND *trends, int trends_num, const
 	}
 }
 
+#if !defined(HAVE_MYSQL) && !defined(HAVE_POSTGRESQL)
 /******************************************************************************
  *                                                                            *
  * Purpose: helper function for DCflush trends                                *
@@ -636,6 +672,198 @@ static void	dc_trends_fetch_and_update(ZBX_DC_TREND *trends, int trends_num, zbx
 	if (sql_offset > 16)	/* In ORACLE always present begin..end; */
 		DBexecute("%s", sql);
 }
+#else
+/******************************************************************************
+ *                                                                            *
+ * Purpose: merges trend of the same item hour into another trend             *
+ *                                                                            *
+ * Parameters: dst - [IN/OUT] the trend to merge into                         *
+ *             src - [IN] the trend to merge                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_trend_merge(ZBX_DC_TREND *dst, const ZBX_DC_TREND *src)
+{
+	if (ITEM_VALUE_TYPE_FLOAT == dst->value_type)
+	{
+		if (src->value_min.dbl < dst->value_min.dbl)
+			dst->value_min.dbl = src->value_min.dbl;
+
+		if (src->value_max.dbl > dst->value_max.dbl)
+			dst->value_max.dbl = src->value_max.dbl;
+
+		dst->value_avg.dbl = dst->value_avg.dbl / (dst->num + src->num) * dst->num +
+				src->value_avg.dbl / (dst->num + src->num) * src->num;
+	}
+	else
+	{
+		if (src->value_min.ui64 < dst->value_min.ui64)
+			dst->value_min.ui64 = src->value_min.ui64;
+
+		if (src->value_max.ui64 > dst->value_max.ui64)
+			dst->value_max.ui64 = src->value_max.ui64;
+
+		/* uint64 trends keep value sum until flushed */
+		uinc128_128(&dst->value_avg.ui64, &src->value_avg.ui64);
+	}
+
+	dst->num += src->num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes trend upsert statement                                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_trends_upsert_execute(unsigned char value_type, size_t *sql_offset)
+{
+#if defined(HAVE_MYSQL)
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset,
+				" on duplicate key update"
+				" value_avg=value_avg/(num+values(num))*num+"
+					"values(value_avg)/(num+values(num))*values(num)");
+	}
+	else
+	{
+		zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset,
+				" on duplicate key update"
+				" value_avg=floor((cast(value_avg as decimal(40,0))*num+"
+					"cast(values(value_avg) as decimal(40,0))*values(num))/(num+values(num)))");
+	}
+
+	/* num must be updated last as the assignments see the updated values */
+	zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset,
+			",value_min=least(value_min,values(value_min))"
+			",value_max=greatest(value_max,values(value_max))"
+			",num=num+values(num)");
+#else
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset,
+				" on conflict (itemid,clock) do update set"
+				" value_avg=t.value_avg/(t.num+excluded.num)*t.num+"
+					"excluded.value_avg/(t.num+excluded.num)*excluded.num");
+	}
+	else
+	{
+		zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset,
+				" on conflict (itemid,clock) do update set"
+				" value_avg=trunc((t.value_avg*t.num+excluded.value_avg*excluded.num)/"
+					"(t.num+excluded.num))");
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset,
+			",value_min=least(t.value_min,excluded.value_min)"
+			",value_max=greatest(t.value_max,excluded.value_max)"
+			",num=t.num+excluded.num");
+#endif
+	DBexecute("%s", sql);
+	*sql_offset = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes trends of the hours that might already be in database with *
+ *          upsert statements                                                 *
+ *                                                                            *
+ * Parameters: trends      - [IN/OUT] the trends, written trends are reset    *
+ *             trends_num  - [IN] the number of trends                        *
+ *             value_type  - [IN] the value type of trends to write           *
+ *             table_name  - [IN] the trends table name                       *
+ *             clock       - [IN] the hour of trends to write                 *
+ *             inserts_num - [IN/OUT] the number of trends left for insert    *
+ *                                                                            *
+ * Comments: Database merges the trend with the existing row, so the rows do  *
+ *           not have to be read back. The trends that are known to be after  *
+ *           the last hour flushed to database are left for bulk insert.      *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_trends_upsert(ZBX_DC_TREND *trends, int trends_num, unsigned char value_type,
+		const char *table_name, int clock, int *inserts_num)
+{
+	ZBX_DC_TREND	*trend, *last = NULL;
+	int		i, rows_num = 0;
+	size_t		sql_offset = 0;
+	zbx_uint128_t	avg;
+
+	/* the same item hour can be flushed twice in one batch, while statement cannot update row twice */
+	for (i = 0; i < trends_num; i++)
+	{
+		trend = &trends[i];
+
+		if (0 == trend->itemid || clock != trend->clock || value_type != trend->value_type)
+			continue;
+
+		if (0 != trend->disable_from && clock >= trend->disable_from)
+			continue;
+
+		if (NULL != last && last->itemid == trend->itemid)
+		{
+			dc_trend_merge(last, trend);
+			trend->itemid = 0;
+			--*inserts_num;
+			continue;
+		}
+
+		last = trend;
+	}
+
+	for (i = 0; i < trends_num; i++)
+	{
+		trend = &trends[i];
+
+		if (0 == trend->itemid || clock != trend->clock || value_type != trend->value_type)
+			continue;
+
+		if (0 != trend->disable_from && clock >= trend->disable_from)
+			continue;
+
+		if (0 == sql_offset)
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+#if defined(HAVE_MYSQL)
+					"insert into %s"
+#else
+					"insert into %s as t"
+#endif
+					" (itemid,clock,num,value_min,value_avg,value_max) values ", table_name);
+		}
+		else
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "(" ZBX_FS_UI64 ",%d,%d," ZBX_FS_DBL64_SQL
+					"," ZBX_FS_DBL64_SQL "," ZBX_FS_DBL64_SQL ")",
+					trend->itemid, trend->clock, trend->num, trend->value_min.dbl,
+					trend->value_avg.dbl, trend->value_max.dbl);
+		}
+		else
+		{
+			/* calculate the trend average value */
+			udiv128_64(&avg, &trend->value_avg.ui64, trend->num);
+
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "(" ZBX_FS_UI64 ",%d,%d," ZBX_FS_UI64
+					"," ZBX_FS_UI64 "," ZBX_FS_UI64 ")",
+					trend->itemid, trend->clock, trend->num, trend->value_min.ui64, avg.lo,
+					trend->value_max.ui64);
+		}
+
+		trend->itemid = 0;
+		--*inserts_num;
+
+		if (ZBX_TRENDS_UPSERT_ROWS == ++rows_num)
+		{
+			dc_trends_upsert_execute(value_type, &sql_offset);
+			rows_num = 0;
+		}
+	}
+
+	if (0 != rows_num)
+		dc_trends_upsert_execute(value_type, &sql_offset);
+}
+#endif
 
 /******************************************************************************
  *                                                                            *
@@ -697,6 +925,9 @@ static void	DBflush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uin
 				&itemids_num, clock);
 	}
 
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+	dc_trends_upsert(trends, trends_to, value_type, table_name, clock, &inserts_num);
+#else
 	for (i = 0; i < trends_to; i++)
 	{
 		trend = &trends[i];
@@ -715,6 +946,7 @@ static void	DBflush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uin
 		dc_trends_fetch_and_update(trends, trends_to, itemids, itemids_num,
 				&inserts_num, value_type, table_name, clock);
 	}
+#endif
 
 	zbx_free(itemids);
 
@@ -800,6 +1032,10 @@ static void	DCadd_trend(const ZBX_DC_HISTORY *history, ZBX_DC_TREND **trends, in
 		DCflush_trend(trend, trends, trends_alloc, trends_num);
 	}
 
+	/* the last flushed hour is tracked per trends table */
+	if (trend->value_type != history->value_type)
+		trend->disable_from = 0;
+
 	trend->value_type = history->value_type;
 	trend->clock = hour;
 
@@ -872,18 +1108,35 @@ static void	DCmass_update_trends(const ZBX_DC_HISTORY *history, int history_num,
 			if (trend->clock == hour)
 				continue;
 
-			/* discard trend items that are older than compression age */
-			if (0 != compression_age && trend->clock < compression_age)
+			if (0 != trend->num)
 			{
-				if (SEC_PER_HOUR < (ts.sec - last_trend_discard)) /* log once per hour */
+				/* discard trend items that are older than compression age */
+				if (0 != compression_age && trend->clock < compression_age)
 				{
-					zabbix_log(LOG_LEVEL_TRACE, "discarding trends that are pointing to"
-							" compressed history period");
-					last_trend_discard = ts.sec;
+					if (SEC_PER_HOUR < (ts.sec - last_trend_discard)) /* log once per hour */
+					{
+						zabbix_log(LOG_LEVEL_TRACE, "discarding trends that are pointing to"
+								" compressed history period");
+						last_trend_discard = ts.sec;
+					}
+
+					zbx_hashset_iter_remove(&iter);
+					continue;
 				}
+
+				if (SUCCEED == zbx_history_requires_trends(trend->value_type))
+					DCflush_trend(trend, trends, &trends_alloc, trends_num);
+			}
+
+			/* keep the last flushed hour (disable_from) of items updated less often than */
+			/* hourly while there is enough free memory, so their next trends are        */
+			/* inserted without checking database                                         */
+			if (0 == trend->num && 0 != trend->disable_from &&
+					ZBX_TRENDS_FLUSHED_HOUR_TTL > hour - trend->disable_from &&
+					trend_mem->free_size > trend_mem->orig_size / 4)
+			{
+				continue;
 			}
-			else if (SUCCEED == zbx_history_requires_trends(trend->value_type))
-				DCflush_trend(trend, trends, &trends_alloc, trends_num);
 
 			zbx_hashset_iter_remove(&iter);
 		}
@@ -1506,8 +1759,11 @@ static void	DCsync_trends(void)
 
 	while (NULL != (trend = (ZBX_DC_TREND *)zbx_hashset_iter_next(&iter)))
 	{
-		if (SUCCEED == zbx_history_requires_trends(trend->value_type) && trend->clock >= compression_age)
+		if (0 != trend->num && SUCCEED == zbx_history_requires_trends(trend->value_type) &&
+				trend->clock >= compression_age)
+		{
 			DCflush_trend(trend, &trends, &trends_alloc, &trends_num);
+		}
 	}
 
 	UNLOCK_TRENDS;
@@ -2367,6 +2623,51 @@ static int	DBmass_add_history(ZBX_DC_HISTORY *history, int history_num)
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compresses text value to be stored in proxy history               *
+ *                                                                            *
+ * Parameters: value - [IN] the text value                                    *
+ *                                                                            *
+ * Return value: The base64 encoded original value size and compressed data   *
+ *               or NULL if the value must be stored uncompressed.            *
+ *                                                                            *
+ * Comments: Values larger than ProxyHistoryCompressSize are compressed if it *
+ *           makes them smaller. See proxy_get_history_data() for decoding.   *
+ *                                                                            *
+ ******************************************************************************/
+static char	*dc_proxy_history_compress(const char *value)
+{
+	char		*out = NULL, *data, *b64 = NULL;
+	size_t		len, out_size;
+	zbx_uint32_t	size;
+
+	len = strlen(value);
+
+	if (0 == CONFIG_PROXY_HISTORY_COMPRESS_SIZE || (size_t)CONFIG_PROXY_HISTORY_COMPRESS_SIZE >= len)
+		return NULL;
+
+	if (SUCCEED != zbx_compress(value, len, &out, &out_size))
+		return NULL;
+
+	/* base64 encoding takes 4 bytes for every 3 bytes of data */
+	if ((sizeof(size) + out_size + 2) / 3 * 4 < len)
+	{
+		size = (zbx_uint32_t)len;
+
+		data = (char *)zbx_malloc(NULL, sizeof(size) + out_size);
+		memcpy(data, &size, sizeof(size));
+		memcpy(data + sizeof(size), out, out_size);
+
+		str_base64_encode_dyn(data, &b64, (int)(sizeof(size) + out_size));
+		zbx_free(data);
+	}
+
+	zbx_free(out);
+
+	return b64;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: helper function for DCmass_proxy_add_history()                    *
@@ -2379,7 +2680,7 @@ static void	dc_add_proxy_history(ZBX_DC_HISTORY *history, int history_num)
 {
 	int		i, now;
 	unsigned int	flags;
-	char		buffer[64], *pvalue;
+	char		buffer[64], *pvalue, *compressed;
 	zbx_db_insert_t	db_insert;
 
 	now = (int)time(NULL);
@@ -2399,8 +2700,12 @@ static void	dc_add_proxy_history(ZBX_DC_HISTORY *history, int history_num)
 		if (ITEM_STATE_NOTSUPPORTED == h->state)
 			continue;
 
+		compressed = NULL;
+
 		if (0 == (h->flags & ZBX_DC_FLAG_NOVALUE))
 		{
+			flags = 0;
+
 			switch (h->value_type)
 			{
 				case ITEM_VALUE_TYPE_FLOAT:
@@ -2410,16 +2715,23 @@ static void	dc_add_proxy_history(ZBX_DC_HISTORY *history, int history_num)
 					zbx_snprintf(pvalue = buffer, sizeof(buffer), ZBX_FS_UI64, h->value.ui64);
 					break;
 				case ITEM_VALUE_TYPE_STR:
-				case ITEM_VALUE_TYPE_TEXT:
 					pvalue = h->value.str;
 					break;
+				case ITEM_VALUE_TYPE_TEXT:
+					if (NULL != (compressed = dc_proxy_history_compress(h->value.str)))
+					{
+						pvalue = compressed;
+						flags = PROXY_HISTORY_FLAG_COMPRESSED;
+					}
+					else
+						pvalue = h->value.str;
+					break;
 				case ITEM_VALUE_TYPE_LOG:
 					continue;
 				default:
 					THIS_SHOULD_NEVER_HAPPEN;
 					continue;
 			}
-			flags = 0;
 		}
 		else
 		{
@@ -2428,6 +2740,7 @@ static void	dc_add_proxy_history(ZBX_DC_HISTORY *history, int history_num)
 		}
 
 		zbx_db_insert_add_values(&db_insert, h->itemid, h->ts.sec, h->ts.ns, pvalue, flags, now);
+		zbx_free(compressed);
 	}
 
 	zbx_db_insert_execute(&db_insert);
@@ -2445,7 +2758,7 @@ static void	dc_add_proxy_history(ZBX_DC_HISTORY *history, int history_num)
 static void	dc_add_proxy_history_meta(ZBX_DC_HISTORY *history, int history_num)
 {
 	int		i, now;
-	char		buffer[64], *pvalue;
+	char		buffer[64], *pvalue, *compressed;
 	zbx_db_insert_t	db_insert;
 
 	now = (int)time(NULL);
@@ -2469,6 +2782,8 @@ static void	dc_add_proxy_history_meta(ZBX_DC_HISTORY *history, int history_num)
 		if (ITEM_VALUE_TYPE_LOG == h->value_type)
 			continue;
 
+		compressed = NULL;
+
 		if (0 == (h->flags & ZBX_DC_FLAG_NOVALUE))
 		{
 			switch (h->value_type)
@@ -2480,9 +2795,17 @@ static void	dc_add_proxy_history_meta(ZBX_DC_HISTORY *history, int history_num)
 					zbx_snprintf(pvalue = buffer, sizeof(buffer), ZBX_FS_UI64, h->value.ui64);
 					break;
 				case ITEM_VALUE_TYPE_STR:
-				case ITEM_VALUE_TYPE_TEXT:
 					pvalue = h->value.str;
 					break;
+				case ITEM_VALUE_TYPE_TEXT:
+					if (NULL != (compressed = dc_proxy_history_compress(h->value.str)))
+					{
+						pvalue = compressed;
+						flags |= PROXY_HISTORY_FLAG_COMPRESSED;
+					}
+					else
+						pvalue = h->value.str;
+					break;
 				default:
 					THIS_SHOULD_NEVER_HAPPEN;
 					continue;
@@ -2496,6 +2819,7 @@ static void	dc_add_proxy_history_meta(ZBX_DC_HISTORY *history, int history_num)
 
 		zbx_db_insert_add_values(&db_insert, h->itemid, h->ts.sec, h->ts.ns, pvalue, h->lastlogsize, h->mtime,
 				flags, now);
+		zbx_free(compressed);
 	}
 
 	zbx_db_insert_execute(&db_insert);
@@ -3052,13 +3376,9 @@ static void	sync_proxy_history(int *total_num, int *more)
 	{
 		*more = ZBX_SYNC_DONE;
 
-		LOCK_CACHE;
-
 		hc_pop_items(&history_items);		/* select and take items out of history cache */
 		history_num = history_items.values_num;
 
-		UNLOCK_CACHE;
-
 		if (0 == history_num)
 			break;
 
@@ -3210,14 +3530,13 @@ static void	sync_server_history(int *values_num, int *triggers_num, int *more)
 		int			*errcodes, trends_num = 0, timers_num = 0, ret = SUCCEED;
 		zbx_vector_uint64_t	itemids;
 		ZBX_DC_TREND		*trends = NULL;
+		double			time_write = 0;
 
 		zbx_vector_uint64_create(&itemids);
 
 		*more = ZBX_SYNC_DONE;
 
-		LOCK_CACHE;
 		hc_pop_items(&history_items);		/* select and take items out of history cache */
-		UNLOCK_CACHE;
 
 		if (0 != history_items.values_num)
 		{
@@ -3252,7 +3571,11 @@ static void	sync_server_history(int *values_num, int *triggers_num, int *more)
 			DCmass_prepare_history(history, &itemids, items, errcodes, history_num, &item_diff,
 					&inventory_values, compression_age, &proxy_subscribtions);
 
-			if (FAIL != (ret = DBmass_add_history(history, history_num)))
+			time_write = zbx_time();
+			ret = DBmass_add_history(history, history_num);
+			time_write = zbx_time() - time_write;
+
+			if (FAIL != ret)
 			{
 				DCconfig_items_apply_changes(&item_diff);
 				DCmass_update_trends(history, history_num, &trends, &trends_num, compression_age);
@@ -3362,6 +3685,10 @@ static void	sync_server_history(int *values_num, int *triggers_num, int *more)
 			hc_push_items(&history_items);	/* return items to history cache */
 			cache->history_num -= history_num;
 
+			cache->history_write_latency += (time_write / history_num - cache->history_write_latency) *
+					ZBX_HC_WRITE_LATENCY_WEIGHT;
+			cache->history_write_ts = (int)time(NULL);
+
 			if (0 != hc_queue_get_size())
 			{
 				/* Continue sync if enough of sync candidates were processed       */
@@ -3465,7 +3792,8 @@ static void	sync_history_cache_full(void)
 	int			values_num = 0, triggers_num = 0, more;
 	zbx_hashset_iter_t	iter;
 	zbx_hc_item_t		*item;
-	zbx_binary_heap_t	tmp_history_queue;
+	zbx_binary_heap_t	tmp_history_queues[ZBX_MUTEX_HISTORY_QUEUE_NUM];
+	int			i;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, cache->history_num);
 
@@ -3486,9 +3814,14 @@ static void	sync_history_cache_full(void)
 		DCconfig_unlock_all_triggers();
 	}
 
-	tmp_history_queue = cache->history_queue;
+	memcpy(tmp_history_queues, cache->history_queues, sizeof(tmp_history_queues));
+
+	for (i = 0; i < cache->history_queues_num; i++)
+	{
+		zbx_binary_heap_create(&cache->history_queues[i], hc_queue_elem_compare_func,
+				ZBX_BINARY_HEAP_OPTION_EMPTY);
+	}
 
-	zbx_binary_heap_create(&cache->history_queue, hc_queue_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY);
 	zbx_hashset_iter_reset(&cache->history_items, &iter);
 
 	/* add all items from history index to the new history queue */
@@ -3520,8 +3853,10 @@ static void	sync_history_cache_full(void)
 		zabbix_log(LOG_LEVEL_WARNING, "syncing history data done");
 	}
 
-	zbx_binary_heap_destroy(&cache->history_queue);
-	cache->history_queue = tmp_history_queue;
+	for (i = 0; i < cache->history_queues_num; i++)
+		zbx_binary_heap_destroy(&cache->history_queues[i]);
+
+	memcpy(cache->history_queues, tmp_history_queues, sizeof(tmp_history_queues));
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
@@ -3617,6 +3952,58 @@ static void	dc_string_buffer_realloc(size_t len)
 	string_values = (char *)zbx_realloc(string_values, string_values_alloc);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies text value into local string buffer                        *
+ *                                                                            *
+ * Parameters: str   - [OUT] the string value location in buffer              *
+ *             value - [IN] the value to copy                                 *
+ *             len   - [IN] the value length including terminating zero       *
+ *             flags - [IN/OUT] the value flags                               *
+ *                                                                            *
+ * Comments: Values larger than HistoryCacheCompressSize are compressed and   *
+ *           ZBX_DC_FLAG_COMPRESSED flag is set. Compressed value is stored   *
+ *           as original size, compressed size and compressed data. It is     *
+ *           done here rather than when cloning values into history cache to  *
+ *           keep compression out of history cache lock.                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_string_buffer_add_text(dc_value_str_t *str, const char *value, size_t len, unsigned char *flags)
+{
+	char		*out = NULL;
+	size_t		out_size;
+	zbx_uint32_t	size[2];
+
+	if (0 != CONFIG_HISTORY_CACHE_COMPRESS_SIZE && (size_t)CONFIG_HISTORY_CACHE_COMPRESS_SIZE < len &&
+			SUCCEED == zbx_compress(value, len - 1, &out, &out_size) &&
+			sizeof(size) + out_size < len - 1)
+	{
+		size[0] = (zbx_uint32_t)(len - 1);
+		size[1] = (zbx_uint32_t)out_size;
+
+		str->len = sizeof(size) + out_size + 1;
+		dc_string_buffer_realloc(str->len);
+
+		str->pvalue = string_values_offset;
+		memcpy(&string_values[string_values_offset], size, sizeof(size));
+		memcpy(&string_values[string_values_offset + sizeof(size)], out, out_size);
+		string_values_offset += str->len;
+
+		*flags |= ZBX_DC_FLAG_COMPRESSED;
+	}
+	else
+	{
+		str->len = len;
+		dc_string_buffer_realloc(str->len);
+
+		str->pvalue = string_values_offset;
+		memcpy(&string_values[string_values_offset], value, str->len);
+		string_values_offset += str->len;
+	}
+
+	zbx_free(out);
+}
+
 static dc_item_value_t	*dc_local_get_history_slot(void)
 {
 	if (ZBX_MAX_VALUES_LOCAL == item_values_num)
@@ -3701,12 +4088,8 @@ static void	dc_local_add_history_text(zbx_uint64_t itemid, unsigned char item_va
 
 	if (0 == (item_value->flags & ZBX_DC_FLAG_NOVALUE))
 	{
-		item_value->value.value_str.len = zbx_db_strlen_n(value_orig, ZBX_HISTORY_VALUE_LEN) + 1;
-		dc_string_buffer_realloc(item_value->value.value_str.len);
-
-		item_value->value.value_str.pvalue = string_values_offset;
-		memcpy(&string_values[string_values_offset], value_orig, item_value->value.value_str.len);
-		string_values_offset += item_value->value.value_str.len;
+		dc_string_buffer_add_text(&item_value->value.value_str, value_orig,
+				zbx_db_strlen_n(value_orig, ZBX_HISTORY_VALUE_LEN) + 1, &item_value->flags);
 	}
 	else
 		item_value->value.value_str.len = 0;
@@ -3752,23 +4135,19 @@ static void	dc_local_add_history_log(zbx_uint64_t itemid, unsigned char item_val
 		item_value->source.len = 0;
 	}
 
-	if (0 != item_value->value.value_str.len + item_value->source.len)
+	if (0 != item_value->value.value_str.len)
 	{
-		dc_string_buffer_realloc(item_value->value.value_str.len + item_value->source.len);
+		dc_string_buffer_add_text(&item_value->value.value_str, log->value, item_value->value.value_str.len,
+				&item_value->flags);
+	}
 
-		if (0 != item_value->value.value_str.len)
-		{
-			item_value->value.value_str.pvalue = string_values_offset;
-			memcpy(&string_values[string_values_offset], log->value, item_value->value.value_str.len);
-			string_values_offset += item_value->value.value_str.len;
-		}
+	if (0 != item_value->source.len)
+	{
+		dc_string_buffer_realloc(item_value->source.len);
 
-		if (0 != item_value->source.len)
-		{
-			item_value->source.pvalue = string_values_offset;
-			memcpy(&string_values[string_values_offset], log->source, item_value->source.len);
-			string_values_offset += item_value->source.len;
-		}
+		item_value->source.pvalue = string_values_offset;
+		memcpy(&string_values[string_values_offset], log->source, item_value->source.len);
+		string_values_offset += item_value->source.len;
 	}
 }
 
@@ -4032,12 +4411,20 @@ static void	hc_free_data(zbx_hc_data_t *data)
  *                                                                            *
  * Parameters: data - [IN] history item data                                  *
  *                                                                            *
+ * Comments: History cache must be locked, because the queue shard might be   *
+ *           reallocated in history index cache.                              *
+ *                                                                            *
  ******************************************************************************/
 static void	hc_queue_item(zbx_hc_item_t *item)
 {
 	zbx_binary_heap_elem_t	elem = {item->itemid, (const void *)item};
+	int			shard;
+
+	shard = (int)(ZBX_DEFAULT_UINT64_HASH_FUNC(&item->itemid) % (zbx_hash_t)cache->history_queues_num);
 
-	zbx_binary_heap_insert(&cache->history_queue, &elem);
+	LOCK_HISTORY_QUEUE(shard);
+	zbx_binary_heap_insert(&cache->history_queues[shard], &elem);
+	UNLOCK_HISTORY_QUEUE(shard);
 }
 
 /******************************************************************************
@@ -4348,6 +4735,42 @@ static void	hc_add_item_values(dc_item_value_t *values, int values_num)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies text value from history cache, uncompressing it if needed  *
+ *                                                                            *
+ * Parameters: str   - [IN] the text value in history cache                   *
+ *             flags - [IN] the history data flags                            *
+ *                                                                            *
+ * Return value: the copied text value                                        *
+ *                                                                            *
+ ******************************************************************************/
+static char	*hc_copy_history_text(const char *str, unsigned char flags)
+{
+	char		*out;
+	size_t		out_size;
+	zbx_uint32_t	size[2];
+
+	if (0 == (ZBX_DC_FLAG_COMPRESSED & flags))
+		return zbx_strdup(NULL, str);
+
+	memcpy(size, str, sizeof(size));
+
+	out_size = size[0];
+	out = (char *)zbx_malloc(NULL, out_size + 1);
+
+	if (SUCCEED != zbx_uncompress(str + sizeof(size), size[1], out, &out_size))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot uncompress history cache value: %s",
+				zbx_compress_strerror());
+		out_size = 0;
+	}
+
+	out[out_size] = '\0';
+
+	return out;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: copies item value from history cache into the specified history   *
@@ -4365,7 +4788,7 @@ static void	hc_copy_history_data(ZBX_DC_HISTORY *history, zbx_uint64_t itemid, z
 	history->itemid = itemid;
 	history->ts = data->ts;
 	history->state = data->state;
-	history->flags = data->flags;
+	history->flags = data->flags & (~ZBX_DC_FLAG_COMPRESSED);
 	history->lastlogsize = data->lastlogsize;
 	history->mtime = data->mtime;
 
@@ -4390,11 +4813,11 @@ static void	hc_copy_history_data(ZBX_DC_HISTORY *history, zbx_uint64_t itemid, z
 				break;
 			case ITEM_VALUE_TYPE_STR:
 			case ITEM_VALUE_TYPE_TEXT:
-				history->value.str = zbx_strdup(NULL, data->value.str);
+				history->value.str = hc_copy_history_text(data->value.str, data->flags);
 				break;
 			case ITEM_VALUE_TYPE_LOG:
 				history->value.log = (zbx_log_value_t *)zbx_malloc(NULL, sizeof(zbx_log_value_t));
-				history->value.log->value = zbx_strdup(NULL, data->value.log->value);
+				history->value.log->value = hc_copy_history_text(data->value.log->value, data->flags);
 
 				if (NULL != data->value.log->source)
 					history->value.log->source = zbx_strdup(NULL, data->value.log->source);
@@ -4418,20 +4841,41 @@ static void	hc_copy_history_data(ZBX_DC_HISTORY *history, zbx_uint64_t itemid, z
  *                                                                            *
  * Comments: The history_items must be returned back to history cache with    *
  *           hc_push_items() function after they have been processed.         *
+ *           History syncer takes items from its own queue shard and steals   *
+ *           from the other shards only when its own shard is empty.          *
+ *           History cache does not have to be locked, because removing from  *
+ *           queue does not allocate memory and the oldest value timestamps   *
+ *           of queued items are not changed.                                 *
  *                                                                            *
  ******************************************************************************/
 static void	hc_pop_items(zbx_vector_ptr_t *history_items)
 {
 	zbx_binary_heap_elem_t	*elem;
 	zbx_hc_item_t		*item;
+	zbx_binary_heap_t	*queue;
+	int			i, shard, own_shard = 0;
 
-	while (ZBX_HC_SYNC_MAX > history_items->values_num && FAIL == zbx_binary_heap_empty(&cache->history_queue))
+	if (ZBX_PROCESS_TYPE_HISTSYNCER == process_type && 0 < process_num)
+		own_shard = (process_num - 1) % cache->history_queues_num;
+
+	/* items are taken from other shards only when the own shard is empty */
+	for (i = 0; i < cache->history_queues_num && 0 == history_items->values_num; i++)
 	{
-		elem = zbx_binary_heap_find_min(&cache->history_queue);
-		item = (zbx_hc_item_t *)elem->data;
-		zbx_vector_ptr_append(history_items, item);
+		shard = (own_shard + i) % cache->history_queues_num;
+		queue = &cache->history_queues[shard];
+
+		LOCK_HISTORY_QUEUE(shard);
 
-		zbx_binary_heap_remove_min(&cache->history_queue);
+		while (ZBX_HC_SYNC_MAX > history_items->values_num && FAIL == zbx_binary_heap_empty(queue))
+		{
+			elem = zbx_binary_heap_find_min(queue);
+			item = (zbx_hc_item_t *)elem->data;
+			zbx_vector_ptr_append(history_items, item);
+
+			zbx_binary_heap_remove_min(queue);
+		}
+
+		UNLOCK_HISTORY_QUEUE(shard);
 	}
 }
 
@@ -4511,7 +4955,16 @@ void	hc_push_items(zbx_vector_ptr_t *history_items)
  ******************************************************************************/
 int	hc_queue_get_size(void)
 {
-	return cache->history_queue.elems_num;
+	int	i, size = 0;
+
+	for (i = 0; i < cache->history_queues_num; i++)
+	{
+		LOCK_HISTORY_QUEUE(i);
+		size += cache->history_queues[i].elems_num;
+		UNLOCK_HISTORY_QUEUE(i);
+	}
+
+	return size;
 }
 
 int	hc_get_history_compression_age(void)
@@ -4589,7 +5042,7 @@ out:
  ******************************************************************************/
 int	init_database_cache(char **error)
 {
-	int	ret;
+	int	ret, i;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -4605,12 +5058,24 @@ int	init_database_cache(char **error)
 	if (SUCCEED != (ret = zbx_mutex_create(&cache_ids_lock, ZBX_MUTEX_CACHE_IDS, error)))
 		goto out;
 
+	for (i = 0; i < ZBX_MUTEX_HISTORY_QUEUE_NUM; i++)
+	{
+		if (SUCCEED != (ret = zbx_mutex_create(&history_queue_locks[i],
+				(zbx_mutex_name_t)(ZBX_MUTEX_HISTORY_QUEUE + i), error)))
+		{
+			goto out;
+		}
+	}
+
 	if (SUCCEED != (ret = zbx_mem_create(&hc_mem, CONFIG_HISTORY_CACHE_SIZE, "history cache",
 			"HistoryCacheSize", 1, error)))
 	{
 		goto out;
 	}
 
+	/* history values and strings are small and frequently allocated/freed */
+	zbx_mem_enable_slabs(hc_mem);
+
 	if (SUCCEED != (ret = zbx_mem_create(&hc_index_mem, CONFIG_HISTORY_INDEX_CACHE_SIZE, "history index cache",
 			"HistoryIndexCacheSize", 0, error)))
 	{
@@ -4627,8 +5092,15 @@ int	init_database_cache(char **error)
 			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
 			__hc_index_mem_malloc_func, __hc_index_mem_realloc_func, __hc_index_mem_free_func);
 
-	zbx_binary_heap_create_ext(&cache->history_queue, hc_queue_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY,
-			__hc_index_mem_malloc_func, __hc_index_mem_realloc_func, __hc_index_mem_free_func);
+	/* one queue shard per history syncer, so that syncers do not contend for queue locks */
+	cache->history_queues_num = MAX(MIN(CONFIG_HISTSYNCER_FORKS, ZBX_MUTEX_HISTORY_QUEUE_NUM), 1);
+
+	for (i = 0; i < cache->history_queues_num; i++)
+	{
+		zbx_binary_heap_create_ext(&cache->history_queues[i], hc_queue_elem_compare_func,
+				ZBX_BINARY_HEAP_OPTION_EMPTY, __hc_index_mem_malloc_func, __hc_index_mem_realloc_func,
+				__hc_index_mem_free_func);
+	}
 
 	if (0 != (program_type & ZBX_PROGRAM_TYPE_SERVER))
 	{
@@ -4680,6 +5152,8 @@ static void	DCsync_all(void)
  ******************************************************************************/
 void	free_database_cache(int sync)
 {
+	int	i;
+
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	if (ZBX_SYNC_ALL == sync)
@@ -4695,6 +5169,9 @@ void	free_database_cache(int sync)
 	zbx_mutex_destroy(&cache_lock);
 	zbx_mutex_destroy(&cache_ids_lock);
 
+	for (i = 0; i < ZBX_MUTEX_HISTORY_QUEUE_NUM; i++)
+		zbx_mutex_destroy(&history_queue_locks[i]);
+
 	if (0 != (program_type & ZBX_PROGRAM_TYPE_SERVER))
 	{
 		zbx_mem_destroy(trend_mem);
@@ -5031,3 +5508,57 @@ out:
 
 	return ret;
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get average time of writing one history value to database         *
+ *                                                                            *
+ * Return value: the history write latency in seconds, 0 if no values were    *
+ *               written recently                                             *
+ *                                                                            *
+ * Comments: The latency is measured by history syncers and is used by        *
+ *           housekeeper to detect when it slows down history syncing.        *
+ *                                                                            *
+ ******************************************************************************/
+double	zbx_dc_get_history_write_latency(void)
+{
+	double	latency = 0;
+
+	LOCK_CACHE;
+
+	/* the latency measured before history syncers went idle does not reflect current database load */
+	if (ZBX_HC_WRITE_LATENCY_TTL > (int)time(NULL) - cache->history_write_ts)
+		latency = cache->history_write_latency;
+
+	UNLOCK_CACHE;
+
+	return latency;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: update housekeeper statistics                                     *
+ *                                                                            *
+ * Parameters: stats - [IN] the housekeeper statistics                        *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_set_hk_stats(const zbx_hk_stats_t *stats)
+{
+	LOCK_CACHE;
+	cache->hk_stats = *stats;
+	UNLOCK_CACHE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get housekeeper statistics                                        *
+ *                                                                            *
+ * Parameters: stats - [OUT] the housekeeper statistics                       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_get_hk_stats(zbx_hk_stats_t *stats)
+{
+	LOCK_CACHE;
+	*stats = cache->hk_stats;
+	UNLOCK_CACHE;
+}
@@ -42,6 +42,7 @@ int	sync_in_progress = 0;
 #define ZBX_LOC_NOWHERE	0
 #define ZBX_LOC_QUEUE	1
 #define ZBX_LOC_POLLER	2
+#define ZBX_LOC_WHEEL	3
 
 #define ZBX_SNMP_OID_TYPE_NORMAL	0
 #define ZBX_SNMP_OID_TYPE_DYNAMIC	1
@@ -85,6 +86,8 @@ static zbx_mem_info_t	*config_mem;
 
 extern unsigned char	program_type;
 extern int		CONFIG_TIMER_FORKS;
+extern int		CONFIG_RSM_TEST_WINDOW;
+extern int		CONFIG_CACHE_LOAD_WORKERS;
 
 ZBX_MEM_FUNC_IMPL(__config, config_mem)
 
@@ -93,6 +96,10 @@ static void	dc_item_reset_triggers(ZBX_DC_ITEM *item, ZBX_DC_TRIGGER *trigger_ex
 
 /* by default the macro environment is non-secure and all secret macros are masked with ****** */
 static unsigned char	macro_env = ZBX_MACRO_ENV_NONSECURE;
+
+/* SUCCEED if the initial synchronization loaded configuration from snapshot */
+static int	config_snapshot_loaded = FAIL;
+
 extern char		*CONFIG_VAULTDBPATH;
 extern char		*CONFIG_VAULTTOKEN;
 /******************************************************************************
@@ -266,6 +273,23 @@ int	zbx_is_counted_in_item_queue(unsigned char type, const char *key)
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if simple check item key is RSM test                        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_is_rsm_test_key(const char *key)
+{
+	if (0 == strncmp(key, "rsm.", ZBX_CONST_STRLEN("rsm.")) ||
+			0 == strncmp(key, "rdap[", ZBX_CONST_STRLEN("rdap[")) ||
+			0 == strncmp(key, "resolver.", ZBX_CONST_STRLEN("resolver.")))
+	{
+		return SUCCEED;
+	}
+
+	return FAIL;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get the seed value to be used for item nextcheck calculations     *
@@ -305,6 +329,21 @@ static zbx_uint64_t	get_item_nextcheck_seed(zbx_uint64_t itemid, zbx_uint64_t in
 		{
 			return interfaceid;
 		}
+
+		/* RSM specifics: spread RSM tests over the configured window at the beginning of the cycle, */
+		/* item identifiers are hashed as RSM items of probe hosts are created in batches and their  */
+		/* identifiers modulo delay tend to fall into a few distinct seconds                         */
+		if (SUCCEED == zbx_is_rsm_test_key(key))
+		{
+			zbx_uint64_t	seed;
+
+			seed = ZBX_DEFAULT_UINT64_HASH_FUNC(&itemid);
+
+			if (0 != CONFIG_RSM_TEST_WINDOW)
+				seed %= (zbx_uint64_t)CONFIG_RSM_TEST_WINDOW;
+
+			return seed;
+		}
 	}
 
 	return itemid;
@@ -502,103 +541,365 @@ static ZBX_DC_HOST	*DCfind_proxy(const char *host)
 		return host_p->host_ptr;
 }
 
-/* private strpool functions */
+/* strpool functions */
+
+/* the string pool lookup key, records are searched without copying the string into record layout */
+typedef struct
+{
+	const char	*str;
+	zbx_uint32_t	len;
+}
+zbx_strpool_key_t;
 
-#define	REFCOUNT_FIELD_SIZE	sizeof(zbx_uint32_t)
+#define ZBX_STRPOOL_RECORD_STR(record)	((char *)(record) + ZBX_STRPOOL_HEADER_SIZE)
 
-static zbx_hash_t	__config_strpool_hash(const void *data)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates string pool lookup key hash                            *
+ *                                                                            *
+ * Comments: String pool hashset is accessed only by zbx_strpool_intern_ext() *
+ *           and zbx_strpool_release_ext() functions, so the generic hashset  *
+ *           functions never pass records to the hash function.               *
+ *                                                                            *
+ ******************************************************************************/
+zbx_hash_t	zbx_strpool_hash_func(const void *data)
 {
-	return ZBX_DEFAULT_STRING_HASH_FUNC((char *)data + REFCOUNT_FIELD_SIZE);
+	const zbx_strpool_key_t	*key = (const zbx_strpool_key_t *)data;
+
+	return ZBX_DEFAULT_STRING_HASH_ALGO(key->str, key->len, ZBX_DEFAULT_HASH_SEED);
 }
 
-static int	__config_strpool_compare(const void *d1, const void *d2)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares string pool record with lookup key                       *
+ *                                                                            *
+ * Parameters: d1 - [IN] the string pool record                               *
+ *             d2 - [IN] the lookup key                                       *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_strpool_compare_func(const void *d1, const void *d2)
 {
-	return strcmp((char *)d1 + REFCOUNT_FIELD_SIZE, (char *)d2 + REFCOUNT_FIELD_SIZE);
+	const zbx_strpool_header_t	*header = (const zbx_strpool_header_t *)d1;
+	const zbx_strpool_key_t		*key = (const zbx_strpool_key_t *)d2;
+
+	if (header->len != key->len)
+		return 1;
+
+	return memcmp(ZBX_STRPOOL_RECORD_STR(header), key->str, key->len);
 }
 
-static const char	*zbx_strpool_intern(const char *str)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds or adds string in string pool and increments its reference  *
+ *          counter                                                           *
+ *                                                                            *
+ * Parameters: strpool - [IN] the string pool                                 *
+ *             str     - [IN] the string                                      *
+ *             len     - [IN] the string length                               *
+ *                                                                            *
+ * Return value: the pooled string                                            *
+ *                                                                            *
+ ******************************************************************************/
+char	*zbx_strpool_intern_ext(zbx_hashset_t *strpool, const char *str, size_t len)
 {
-	void		*record;
-	zbx_uint32_t	*refcount;
+	zbx_strpool_key_t	key;
+	zbx_strpool_header_t	*header;
+	zbx_hash_t		hash;
 
-	record = zbx_hashset_search(&config->strpool, str - REFCOUNT_FIELD_SIZE);
+	key.str = str;
+	key.len = (zbx_uint32_t)len;
+	hash = zbx_strpool_hash_func(&key);
 
-	if (NULL == record)
+	if (NULL == (header = (zbx_strpool_header_t *)zbx_hashset_search_by_hash(strpool, &key, hash)))
 	{
-		record = zbx_hashset_insert_ext(&config->strpool, str - REFCOUNT_FIELD_SIZE,
-				REFCOUNT_FIELD_SIZE + strlen(str) + 1, REFCOUNT_FIELD_SIZE);
-		*(zbx_uint32_t *)record = 0;
+		header = (zbx_strpool_header_t *)zbx_hashset_insert_by_hash(strpool, hash,
+				ZBX_STRPOOL_HEADER_SIZE + len + 1);
+		header->refcount = 0;
+		header->len = key.len;
+		memcpy(ZBX_STRPOOL_RECORD_STR(header), str, len + 1);
 	}
 
-	refcount = (zbx_uint32_t *)record;
-	(*refcount)++;
+	header->refcount++;
 
-	return (char *)record + REFCOUNT_FIELD_SIZE;
+	return ZBX_STRPOOL_RECORD_STR(header);
 }
 
-void	zbx_strpool_release(const char *str)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: decrements pooled string reference counter and removes the string *
+ *          when it is not referenced anymore                                 *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_strpool_release_ext(zbx_hashset_t *strpool, const char *str)
 {
-	zbx_uint32_t	*refcount;
+	zbx_strpool_header_t	*header = (zbx_strpool_header_t *)(str - ZBX_STRPOOL_HEADER_SIZE);
 
-	refcount = (zbx_uint32_t *)(str - REFCOUNT_FIELD_SIZE);
-	if (0 == --(*refcount))
-		zbx_hashset_remove(&config->strpool, str - REFCOUNT_FIELD_SIZE);
+	if (0 == --header->refcount)
+		zbx_hashset_remove_direct(strpool, header);
 }
 
-static const char	*zbx_strpool_acquire(const char *str)
+void	zbx_strpool_release(const char *str)
 {
-	zbx_uint32_t	*refcount;
+	zbx_strpool_release_ext(&config->strpool, str);
+}
 
-	refcount = (zbx_uint32_t *)(str - REFCOUNT_FIELD_SIZE);
-	(*refcount)++;
+static const char	*zbx_strpool_acquire(const char *str)
+{
+	((zbx_strpool_header_t *)(str - ZBX_STRPOOL_HEADER_SIZE))->refcount++;
 
 	return str;
 }
 
 int	DCstrpool_replace(int found, const char **curr, const char *new_str)
 {
+	size_t	len;
+
+	len = strlen(new_str);
+
 	if (1 == found)
 	{
-		if (0 == strcmp(*curr, new_str))
+		/* pooled string length is cached, so most changed strings are detected without comparing data */
+		if (ZBX_STRPOOL_STRLEN(*curr) == len && 0 == memcmp(*curr, new_str, len))
 			return FAIL;
 
 		zbx_strpool_release(*curr);
 	}
 
-	*curr = zbx_strpool_intern(new_str);
+	*curr = zbx_strpool_intern_ext(&config->strpool, new_str, len);
 
 	return SUCCEED;	/* indicate that the string has been replaced */
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: replaces several pooled strings of the same object                *
+ *                                                                            *
+ * Parameters: found      - [IN] 1 - the object existed, the fields hold      *
+ *                                   pooled strings                           *
+ *                               0 - new object                               *
+ *             fields     - [IN/OUT] the fields to replace                    *
+ *             fields_num - [IN] the number of fields                         *
+ *                                                                            *
+ * Return value: SUCCEED - at least one string has been replaced              *
+ *               FAIL    - all strings were the same                          *
+ *                                                                            *
+ * Comments: The string pool is grown once for all fields, so it is not       *
+ *           rehashed in the middle of the row. Must be called with           *
+ *           configuration cache write lock.                                  *
+ *                                                                            *
+ ******************************************************************************/
+int	DCstrpool_replace_fields(int found, const zbx_strpool_field_t *fields, int fields_num)
+{
+	int	i, ret = FAIL;
+
+	zbx_hashset_reserve(&config->strpool, config->strpool.num_data + fields_num);
+
+	for (i = 0; i < fields_num; i++)
+	{
+		if (SUCCEED == DCstrpool_replace(found, fields[i].curr, fields[i].value))
+			ret = SUCCEED;
+	}
+
+	return ret;
+}
+
+#define ZBX_DC_QUEUE_WHEEL_WORD_BITS	64
+
+#define ZBX_DC_QUEUE_WHEEL_SET_USED(queue, slot)							\
+	((queue)->wheel_used[(slot) / ZBX_DC_QUEUE_WHEEL_WORD_BITS] |=					\
+			__UINT64_C(1) << ((slot) % ZBX_DC_QUEUE_WHEEL_WORD_BITS))
+
+#define ZBX_DC_QUEUE_WHEEL_SET_UNUSED(queue, slot)							\
+	((queue)->wheel_used[(slot) / ZBX_DC_QUEUE_WHEEL_WORD_BITS] &=					\
+			~(__UINT64_C(1) << ((slot) % ZBX_DC_QUEUE_WHEEL_WORD_BITS)))
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if the time is within poller queue timer wheel window      *
+ *                                                                            *
+ ******************************************************************************/
+static int	dc_item_queue_in_wheel(const zbx_dc_item_queue_t *queue, int nextcheck)
+{
+	if (nextcheck < queue->wheel_start || ZBX_DC_QUEUE_WHEEL_SIZE <= nextcheck - queue->wheel_start)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds item to poller queue                                         *
+ *                                                                            *
+ * Parameters: queue - [IN] the poller queue                                  *
+ *             item  - [IN] the item, must not be in any queue                *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_item_queue_insert(zbx_dc_item_queue_t *queue, ZBX_DC_ITEM *item)
+{
+	if (SUCCEED == dc_item_queue_in_wheel(queue, item->nextcheck))
+	{
+		int	slot = item->nextcheck % ZBX_DC_QUEUE_WHEEL_SIZE;
+
+		if (NULL != (item->queue_next = queue->wheel[slot]))
+			item->queue_next->queue_pprev = &item->queue_next;
+		else
+			ZBX_DC_QUEUE_WHEEL_SET_USED(queue, slot);
+
+		item->queue_pprev = &queue->wheel[slot];
+		queue->wheel[slot] = item;
+		queue->wheel_num++;
+		item->location = ZBX_LOC_WHEEL;
+	}
+	else
+	{
+		zbx_binary_heap_elem_t	elem = {item->itemid, (const void *)item};
+
+		zbx_binary_heap_insert(&queue->heap, &elem);
+		item->location = ZBX_LOC_QUEUE;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes item from poller queue                                    *
+ *                                                                            *
+ * Parameters: queue - [IN] the poller queue                                  *
+ *             item  - [IN] the item in queue heap or timer wheel             *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_item_queue_remove(zbx_dc_item_queue_t *queue, ZBX_DC_ITEM *item)
+{
+	if (ZBX_LOC_WHEEL == item->location)
+	{
+		ZBX_DC_ITEM	**pprev = item->queue_pprev;
+
+		if (NULL != (*pprev = item->queue_next))
+			item->queue_next->queue_pprev = pprev;
+		else if (queue->wheel <= pprev && pprev < queue->wheel + ZBX_DC_QUEUE_WHEEL_SIZE)
+			ZBX_DC_QUEUE_WHEEL_SET_UNUSED(queue, (int)(pprev - queue->wheel));
+
+		queue->wheel_num--;
+	}
+	else
+		zbx_binary_heap_remove_direct(&queue->heap, item->itemid);
+
+	item->location = ZBX_LOC_NOWHERE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: moves poller queue timer wheel slots up to the specified time to  *
+ *          the queue heap                                                    *
+ *                                                                            *
+ * Parameters: queue - [IN] the poller queue                                  *
+ *             now   - [IN] the current time                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_item_queue_advance(zbx_dc_item_queue_t *queue, int now)
+{
+	while (0 != queue->wheel_num && queue->wheel_start <= now)
+	{
+		int		slot = queue->wheel_start % ZBX_DC_QUEUE_WHEEL_SIZE;
+		ZBX_DC_ITEM	*item, *next;
+
+		for (item = queue->wheel[slot]; NULL != item; item = next)
+		{
+			zbx_binary_heap_elem_t	elem = {item->itemid, (const void *)item};
+
+			next = item->queue_next;
+			zbx_binary_heap_insert(&queue->heap, &elem);
+			item->location = ZBX_LOC_QUEUE;
+			queue->wheel_num--;
+		}
+
+		queue->wheel[slot] = NULL;
+		ZBX_DC_QUEUE_WHEEL_SET_UNUSED(queue, slot);
+		queue->wheel_start++;
+	}
+
+	if (queue->wheel_start <= now)
+		queue->wheel_start = now + 1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds the earliest scheduled time in poller queue timer wheel     *
+ *                                                                            *
+ * Return value: the time of the first non-empty slot or FAIL if the wheel is *
+ *               empty                                                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	dc_item_queue_wheel_nextcheck(const zbx_dc_item_queue_t *queue)
+{
+	int	i, start, slot, bit;
+
+	if (0 == queue->wheel_num)
+		return FAIL;
+
+	start = queue->wheel_start % ZBX_DC_QUEUE_WHEEL_SIZE;
+	slot = start - start % ZBX_DC_QUEUE_WHEEL_WORD_BITS;
+	bit = start % ZBX_DC_QUEUE_WHEEL_WORD_BITS;
+
+	/* the word of the start slot is checked twice - first the slots after start, then all of them */
+	for (i = 0; i <= ZBX_DC_QUEUE_WHEEL_SIZE / ZBX_DC_QUEUE_WHEEL_WORD_BITS; i++)
+	{
+		zbx_uint64_t	word = queue->wheel_used[slot / ZBX_DC_QUEUE_WHEEL_WORD_BITS] >> bit;
+
+		if (0 != word)
+		{
+			while (0 == (word & 1))
+			{
+				word >>= 1;
+				bit++;
+			}
+
+			slot += bit;
+
+			return queue->wheel_start + (slot - start + ZBX_DC_QUEUE_WHEEL_SIZE) % ZBX_DC_QUEUE_WHEEL_SIZE;
+		}
+
+		bit = 0;
+
+		if (ZBX_DC_QUEUE_WHEEL_SIZE == (slot += ZBX_DC_QUEUE_WHEEL_WORD_BITS))
+			slot = 0;
+	}
+
+	THIS_SHOULD_NEVER_HAPPEN;
+
+	return FAIL;
+}
+
 static void	DCupdate_item_queue(ZBX_DC_ITEM *item, unsigned char old_poller_type, int old_nextcheck)
 {
-	zbx_binary_heap_elem_t	elem;
+	zbx_dc_item_queue_t	*queue;
 
 	if (ZBX_LOC_POLLER == item->location)
 		return;
 
-	if (ZBX_LOC_QUEUE == item->location && old_poller_type != item->poller_type)
-	{
-		item->location = ZBX_LOC_NOWHERE;
-		zbx_binary_heap_remove_direct(&config->queues[old_poller_type], item->itemid);
-	}
+	if (ZBX_LOC_NOWHERE != item->location && old_poller_type != item->poller_type)
+		dc_item_queue_remove(&config->queues[old_poller_type], item);
 
 	if (item->poller_type == ZBX_NO_POLLER)
 		return;
 
-	if (ZBX_LOC_QUEUE == item->location && old_nextcheck == item->nextcheck)
+	if (ZBX_LOC_NOWHERE != item->location && old_nextcheck == item->nextcheck)
 		return;
 
-	elem.key = item->itemid;
-	elem.data = (const void *)item;
+	queue = &config->queues[item->poller_type];
 
-	if (ZBX_LOC_QUEUE != item->location)
+	/* items staying in heap are reordered in place */
+	if (ZBX_LOC_QUEUE == item->location && FAIL == dc_item_queue_in_wheel(queue, item->nextcheck))
 	{
-		item->location = ZBX_LOC_QUEUE;
-		zbx_binary_heap_insert(&config->queues[item->poller_type], &elem);
+		zbx_binary_heap_elem_t	elem = {item->itemid, (const void *)item};
+
+		zbx_binary_heap_update_direct(&queue->heap, &elem);
+		return;
 	}
-	else
-		zbx_binary_heap_update_direct(&config->queues[item->poller_type], &elem);
+
+	if (ZBX_LOC_NOWHERE != item->location)
+		dc_item_queue_remove(queue, item);
+
+	dc_item_queue_insert(queue, item);
 }
 
 static void	DCupdate_proxy_queue(ZBX_DC_PROXY *proxy)
@@ -2102,6 +2403,18 @@ static void	DCsync_hmacros(zbx_dbsync_t *sync)
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if the initial synchronization loaded configuration from   *
+ *          snapshot, which must be brought up to date by the next            *
+ *          synchronization                                                   *
+ *                                                                            *
+ ******************************************************************************/
+int	DCconfig_snapshot_loaded(void)
+{
+	return config_snapshot_loaded;
+}
+
 void	DCsync_kvs_paths(const struct zbx_json_parse *jp_kvs_paths)
 {
 	zbx_dc_kvs_path_t	*dc_kvs_path;
@@ -2648,6 +2961,51 @@ static void	dc_masteritem_remove_depitem(zbx_uint64_t master_itemid, zbx_uint64_
 	}
 }
 
+static void	dc_sshitem_update(ZBX_DC_SSHITEM *sshitem, int found, char **row)
+{
+	zbx_strpool_field_t	fields[] = {
+					{&sshitem->username, row[14]},
+					{&sshitem->password, row[15]},
+					{&sshitem->publickey, row[16]},
+					{&sshitem->privatekey, row[17]},
+					{&sshitem->params, row[11]}
+				};
+
+	sshitem->authtype = (unsigned short)atoi(row[13]);
+	DCstrpool_replace_fields(found, fields, (int)ARRSIZE(fields));
+}
+
+static void	dc_httpitem_update(ZBX_DC_HTTPITEM *httpitem, int found, char **row)
+{
+	zbx_strpool_field_t	fields[] = {
+					{&httpitem->timeout, row[30]},
+					{&httpitem->url, row[31]},
+					{&httpitem->query_fields, row[32]},
+					{&httpitem->posts, row[33]},
+					{&httpitem->status_codes, row[34]},
+					{&httpitem->http_proxy, row[37]},
+					{&httpitem->headers, row[38]},
+					{&httpitem->ssl_cert_file, row[42]},
+					{&httpitem->ssl_key_file, row[43]},
+					{&httpitem->ssl_key_password, row[44]},
+					{&httpitem->username, row[14]},
+					{&httpitem->password, row[15]},
+					{&httpitem->trapper_hosts, row[9]}
+				};
+
+	DCstrpool_replace_fields(found, fields, (int)ARRSIZE(fields));
+
+	httpitem->follow_redirects = (unsigned char)atoi(row[35]);
+	httpitem->post_type = (unsigned char)atoi(row[36]);
+	httpitem->retrieve_mode = (unsigned char)atoi(row[39]);
+	httpitem->request_method = (unsigned char)atoi(row[40]);
+	httpitem->output_format = (unsigned char)atoi(row[41]);
+	httpitem->verify_peer = (unsigned char)atoi(row[45]);
+	httpitem->verify_host = (unsigned char)atoi(row[46]);
+	httpitem->allow_traps = (unsigned char)atoi(row[47]);
+	httpitem->authtype = (unsigned char)atoi(row[13]);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: update number of items per agent statistics                       *
@@ -3030,12 +3388,7 @@ static void	DCsync_items(zbx_dbsync_t *sync, int flags)
 		{
 			sshitem = (ZBX_DC_SSHITEM *)DCfind_id(&config->sshitems, itemid, sizeof(ZBX_DC_SSHITEM), &found);
 
-			sshitem->authtype = (unsigned short)atoi(row[13]);
-			DCstrpool_replace(found, &sshitem->username, row[14]);
-			DCstrpool_replace(found, &sshitem->password, row[15]);
-			DCstrpool_replace(found, &sshitem->publickey, row[16]);
-			DCstrpool_replace(found, &sshitem->privatekey, row[17]);
-			DCstrpool_replace(found, &sshitem->params, row[11]);
+			dc_sshitem_update(sshitem, found, row);
 		}
 		else if (NULL != (sshitem = (ZBX_DC_SSHITEM *)zbx_hashset_search(&config->sshitems, &itemid)))
 		{
@@ -3160,29 +3513,7 @@ static void	DCsync_items(zbx_dbsync_t *sync, int flags)
 			httpitem = (ZBX_DC_HTTPITEM *)DCfind_id(&config->httpitems, itemid, sizeof(ZBX_DC_HTTPITEM),
 					&found);
 
-			DCstrpool_replace(found, &httpitem->timeout, row[30]);
-			DCstrpool_replace(found, &httpitem->url, row[31]);
-			DCstrpool_replace(found, &httpitem->query_fields, row[32]);
-			DCstrpool_replace(found, &httpitem->posts, row[33]);
-			DCstrpool_replace(found, &httpitem->status_codes, row[34]);
-			httpitem->follow_redirects = (unsigned char)atoi(row[35]);
-			httpitem->post_type = (unsigned char)atoi(row[36]);
-			DCstrpool_replace(found, &httpitem->http_proxy, row[37]);
-			DCstrpool_replace(found, &httpitem->headers, row[38]);
-			httpitem->retrieve_mode = (unsigned char)atoi(row[39]);
-			httpitem->request_method = (unsigned char)atoi(row[40]);
-			httpitem->output_format = (unsigned char)atoi(row[41]);
-			DCstrpool_replace(found, &httpitem->ssl_cert_file, row[42]);
-			DCstrpool_replace(found, &httpitem->ssl_key_file, row[43]);
-			DCstrpool_replace(found, &httpitem->ssl_key_password, row[44]);
-			httpitem->verify_peer = (unsigned char)atoi(row[45]);
-			httpitem->verify_host = (unsigned char)atoi(row[46]);
-			httpitem->allow_traps = (unsigned char)atoi(row[47]);
-
-			httpitem->authtype = (unsigned char)atoi(row[13]);
-			DCstrpool_replace(found, &httpitem->username, row[14]);
-			DCstrpool_replace(found, &httpitem->password, row[15]);
-			DCstrpool_replace(found, &httpitem->trapper_hosts, row[9]);
+			dc_httpitem_update(httpitem, found, row);
 		}
 		else if (NULL != (httpitem = (ZBX_DC_HTTPITEM *)zbx_hashset_search(&config->httpitems, &itemid)))
 		{
@@ -3502,8 +3833,8 @@ static void	DCsync_items(zbx_dbsync_t *sync, int flags)
 			zbx_hashset_remove_direct(&config->items_hk, item_hk);
 		}
 
-		if (ZBX_LOC_QUEUE == item->location)
-			zbx_binary_heap_remove_direct(&config->queues[item->poller_type], item->itemid);
+		if (ZBX_LOC_QUEUE == item->location || ZBX_LOC_WHEEL == item->location)
+			dc_item_queue_remove(&config->queues[item->poller_type], item);
 
 		zbx_strpool_release(item->key);
 		zbx_strpool_release(item->error);
@@ -5962,10 +6293,31 @@ static void	dc_load_trigger_queue(zbx_hashset_t *trend_functions)
 	DBfree_result(result);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get number of changed rows in synchronization object              *
+ *                                                                            *
+ * Comments: In ZBX_DBSYNC_INIT mode the rows are counted while they are      *
+ *           retrieved, so the synchronization object is treated as having    *
+ *           changes.                                                         *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	dc_sync_changes_num(const zbx_dbsync_t *sync)
+{
+	if (ZBX_DBSYNC_INIT == sync->mode)
+		return 1;
+
+	return sync->add_num + sync->update_num + sync->remove_num;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: Synchronize configuration data from database                      *
  *                                                                            *
+ * Comments: Cache write lock is taken only for the synchronization steps     *
+ *           having changed rows, so that during incremental updates the      *
+ *           readers are not blocked by unchanged configuration parts.        *
+ *                                                                            *
  ******************************************************************************/
 void	DCsync_configuration(unsigned char mode)
 {
@@ -5992,6 +6344,36 @@ void	DCsync_configuration(unsigned char mode)
 
 	zbx_hashset_t		trend_queue;
 
+	/* the changesets loaded in ZBX_DBSYNC_INIT mode by zbx_dbsync_compare(), listed in the order they are */
+	/* compared, global configuration and action operations are not included                             */
+	zbx_dbsync_t			*init_syncs[] = {&htmpl_sync, &gmacro_sync, &hmacro_sync, &host_tag_sync,
+						&hosts_sync, &hi_sync, &hgroups_sync, &hgroup_host_sync,
+						&maintenance_sync, &maintenance_tag_sync, &maintenance_period_sync,
+						&maintenance_group_sync, &maintenance_host_sync, &if_sync,
+						&items_sync, &template_items_sync, &prototype_items_sync,
+						&item_discovery_sync, &itempp_sync, &itemscrp_sync, &item_tag_sync,
+						&func_sync, &triggers_sync, &tdep_sync, &expr_sync, &action_sync,
+						&action_condition_sync, &trigger_tag_sync, &correlation_sync,
+						&corr_condition_sync, &corr_operation_sync};
+	zbx_dbsync_compare_func_t	init_funcs[] = {zbx_dbsync_compare_host_templates,
+						zbx_dbsync_compare_global_macros, zbx_dbsync_compare_host_macros,
+						zbx_dbsync_compare_host_tags, zbx_dbsync_compare_hosts,
+						zbx_dbsync_compare_host_inventory, zbx_dbsync_compare_host_groups,
+						zbx_dbsync_compare_host_group_hosts, zbx_dbsync_compare_maintenances,
+						zbx_dbsync_compare_maintenance_tags,
+						zbx_dbsync_compare_maintenance_periods,
+						zbx_dbsync_compare_maintenance_groups,
+						zbx_dbsync_compare_maintenance_hosts, zbx_dbsync_compare_interfaces,
+						zbx_dbsync_compare_items, zbx_dbsync_compare_template_items,
+						zbx_dbsync_compare_prototype_items, zbx_dbsync_compare_item_discovery,
+						zbx_dbsync_compare_item_preprocs, zbx_dbsync_compare_item_script_param,
+						zbx_dbsync_compare_item_tags, zbx_dbsync_compare_functions,
+						zbx_dbsync_compare_triggers, zbx_dbsync_compare_trigger_dependency,
+						zbx_dbsync_compare_expressions, zbx_dbsync_compare_actions,
+						zbx_dbsync_compare_action_conditions, zbx_dbsync_compare_trigger_tags,
+						zbx_dbsync_compare_correlations, zbx_dbsync_compare_corr_conditions,
+						zbx_dbsync_compare_corr_operations};
+
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	config->sync_start_ts = time(NULL);
@@ -6046,6 +6428,23 @@ void	DCsync_configuration(unsigned char mode)
 	zbx_dbsync_init(&maintenance_group_sync, mode);
 	zbx_dbsync_init(&maintenance_host_sync, mode);
 
+	if (ZBX_DBSYNC_INIT == mode)
+		config_snapshot_loaded = zbx_dbsync_load_snapshot(init_syncs, (int)ARRSIZE(init_syncs));
+
+#ifndef HAVE_SQLITE3
+	/* load the tables not loaded from snapshot in parallel */
+	if (ZBX_DBSYNC_INIT == mode && 0 != CONFIG_CACHE_LOAD_WORKERS)
+	{
+		sec = zbx_time();
+		if (SUCCEED != zbx_dbsync_prefetch(init_syncs, init_funcs, (int)ARRSIZE(init_syncs),
+				CONFIG_CACHE_LOAD_WORKERS))
+		{
+			goto out;
+		}
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() prefetch: " ZBX_FS_DBL " sec.", __func__, zbx_time() - sec);
+	}
+#endif
+
 	sec = zbx_time();
 	if (FAIL == zbx_dbsync_compare_config(&config_sync))
 		goto out;
@@ -6070,236 +6469,272 @@ void	DCsync_configuration(unsigned char mode)
 	/* sync macro related data, to support macro resolving during configuration sync */
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_host_templates(&htmpl_sync))
+	if (FAIL == zbx_dbsync_compare(&htmpl_sync, zbx_dbsync_compare_host_templates))
 		goto out;
 	htsec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_global_macros(&gmacro_sync))
+	if (FAIL == zbx_dbsync_compare(&gmacro_sync, zbx_dbsync_compare_global_macros))
 		goto out;
 	gmsec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_host_macros(&hmacro_sync))
+	if (FAIL == zbx_dbsync_compare(&hmacro_sync, zbx_dbsync_compare_host_macros))
 		goto out;
 	hmsec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_host_tags(&host_tag_sync))
+	if (FAIL == zbx_dbsync_compare(&host_tag_sync, zbx_dbsync_compare_host_tags))
 		goto out;
 	host_tag_sec = zbx_time() - sec;
 
-	START_SYNC;
-	sec = zbx_time();
-	DCsync_htmpls(&htmpl_sync);
-	htsec2 = zbx_time() - sec;
+	if (0 != dc_sync_changes_num(&htmpl_sync) + dc_sync_changes_num(&gmacro_sync) +
+			dc_sync_changes_num(&hmacro_sync) + dc_sync_changes_num(&host_tag_sync))
+	{
+		START_SYNC;
+		sec = zbx_time();
+		DCsync_htmpls(&htmpl_sync);
+		htsec2 = zbx_time() - sec;
 
-	sec = zbx_time();
-	DCsync_gmacros(&gmacro_sync);
-	gmsec2 = zbx_time() - sec;
+		sec = zbx_time();
+		DCsync_gmacros(&gmacro_sync);
+		gmsec2 = zbx_time() - sec;
 
-	sec = zbx_time();
-	DCsync_hmacros(&hmacro_sync);
-	hmsec2 = zbx_time() - sec;
+		sec = zbx_time();
+		DCsync_hmacros(&hmacro_sync);
+		hmsec2 = zbx_time() - sec;
 
-	sec = zbx_time();
-	DCsync_host_tags(&host_tag_sync);
-	host_tag_sec2 = zbx_time() - sec;
+		sec = zbx_time();
+		DCsync_host_tags(&host_tag_sync);
+		host_tag_sec2 = zbx_time() - sec;
+		FINISH_SYNC;
+	}
+	else
+		htsec2 = gmsec2 = hmsec2 = host_tag_sec2 = 0;
 
 	/* postpone configuration sync until macro secrets are received from Zabbix server */
 	if (0 == (program_type & ZBX_PROGRAM_TYPE_SERVER) && 0 != config->kvs_paths.values_num &&
 			ZBX_DBSYNC_INIT == mode)
 	{
+		START_SYNC;
 		goto out;
 	}
 
-	FINISH_SYNC;
-
 	/* sync host data to support host lookups when resolving macros during configuration sync */
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_hosts(&hosts_sync))
+	if (FAIL == zbx_dbsync_compare(&hosts_sync, zbx_dbsync_compare_hosts))
 		goto out;
 	hsec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_host_inventory(&hi_sync))
+	if (FAIL == zbx_dbsync_compare(&hi_sync, zbx_dbsync_compare_host_inventory))
 		goto out;
 	hisec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_host_groups(&hgroups_sync))
+	if (FAIL == zbx_dbsync_compare(&hgroups_sync, zbx_dbsync_compare_host_groups))
 		goto out;
-	if (FAIL == zbx_dbsync_compare_host_group_hosts(&hgroup_host_sync))
+	if (FAIL == zbx_dbsync_compare(&hgroup_host_sync, zbx_dbsync_compare_host_group_hosts))
 		goto out;
 	hgroups_sec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_maintenances(&maintenance_sync))
+	if (FAIL == zbx_dbsync_compare(&maintenance_sync, zbx_dbsync_compare_maintenances))
 		goto out;
-	if (FAIL == zbx_dbsync_compare_maintenance_tags(&maintenance_tag_sync))
+	if (FAIL == zbx_dbsync_compare(&maintenance_tag_sync, zbx_dbsync_compare_maintenance_tags))
 		goto out;
-	if (FAIL == zbx_dbsync_compare_maintenance_periods(&maintenance_period_sync))
+	if (FAIL == zbx_dbsync_compare(&maintenance_period_sync, zbx_dbsync_compare_maintenance_periods))
 		goto out;
-	if (FAIL == zbx_dbsync_compare_maintenance_groups(&maintenance_group_sync))
+	if (FAIL == zbx_dbsync_compare(&maintenance_group_sync, zbx_dbsync_compare_maintenance_groups))
 		goto out;
-	if (FAIL == zbx_dbsync_compare_maintenance_hosts(&maintenance_host_sync))
+	if (FAIL == zbx_dbsync_compare(&maintenance_host_sync, zbx_dbsync_compare_maintenance_hosts))
 		goto out;
 	maintenance_sec = zbx_time() - sec;
 
-	START_SYNC;
-	sec = zbx_time();
-	DCsync_hosts(&hosts_sync);
-	hsec2 = zbx_time() - sec;
+	if (0 != dc_sync_changes_num(&hgroups_sync))
+		update_flags |= ZBX_DBSYNC_UPDATE_HOST_GROUPS;
 
-	sec = zbx_time();
-	DCsync_host_inventory(&hi_sync);
-	hisec2 = zbx_time() - sec;
+	if (0 != dc_sync_changes_num(&maintenance_group_sync))
+		update_flags |= ZBX_DBSYNC_UPDATE_MAINTENANCE_GROUPS;
 
-	sec = zbx_time();
-	DCsync_hostgroups(&hgroups_sync);
-	DCsync_hostgroup_hosts(&hgroup_host_sync);
-	hgroups_sec2 = zbx_time() - sec;
+	if (0 != dc_sync_changes_num(&hosts_sync))
+		update_flags |= ZBX_DBSYNC_UPDATE_HOSTS;
 
-	sec = zbx_time();
-	DCsync_maintenances(&maintenance_sync);
-	DCsync_maintenance_tags(&maintenance_tag_sync);
-	DCsync_maintenance_groups(&maintenance_group_sync);
-	DCsync_maintenance_hosts(&maintenance_host_sync);
-	DCsync_maintenance_periods(&maintenance_period_sync);
-	maintenance_sec2 = zbx_time() - sec;
-
-	if (0 != hgroups_sync.add_num + hgroups_sync.update_num + hgroups_sync.remove_num)
-		update_flags |= ZBX_DBSYNC_UPDATE_HOST_GROUPS;
+	if (0 != (update_flags & (ZBX_DBSYNC_UPDATE_HOST_GROUPS | ZBX_DBSYNC_UPDATE_MAINTENANCE_GROUPS |
+			ZBX_DBSYNC_UPDATE_HOSTS)) || 0 != dc_sync_changes_num(&hi_sync) +
+			dc_sync_changes_num(&hgroup_host_sync) + dc_sync_changes_num(&maintenance_sync) + dc_sync_changes_num(&maintenance_tag_sync) +
+			dc_sync_changes_num(&maintenance_period_sync) + dc_sync_changes_num(&maintenance_host_sync))
+	{
+		START_SYNC;
+		sec = zbx_time();
+		DCsync_hosts(&hosts_sync);
+		hsec2 = zbx_time() - sec;
 
-	if (0 != maintenance_group_sync.add_num + maintenance_group_sync.update_num + maintenance_group_sync.remove_num)
-		update_flags |= ZBX_DBSYNC_UPDATE_MAINTENANCE_GROUPS;
+		sec = zbx_time();
+		DCsync_host_inventory(&hi_sync);
+		hisec2 = zbx_time() - sec;
 
-	if (0 != (update_flags & ZBX_DBSYNC_UPDATE_HOST_GROUPS))
-		dc_hostgroups_update_cache();
+		sec = zbx_time();
+		DCsync_hostgroups(&hgroups_sync);
+		DCsync_hostgroup_hosts(&hgroup_host_sync);
+		hgroups_sec2 = zbx_time() - sec;
 
-	/* pre-cache nested groups used in maintenances to allow read lock */
-	/* during host maintenance update calculations                     */
-	if (0 != (update_flags & (ZBX_DBSYNC_UPDATE_HOST_GROUPS | ZBX_DBSYNC_UPDATE_MAINTENANCE_GROUPS)))
-		dc_maintenance_precache_nested_groups();
+		sec = zbx_time();
+		DCsync_maintenances(&maintenance_sync);
+		DCsync_maintenance_tags(&maintenance_tag_sync);
+		DCsync_maintenance_groups(&maintenance_group_sync);
+		DCsync_maintenance_hosts(&maintenance_host_sync);
+		DCsync_maintenance_periods(&maintenance_period_sync);
+		maintenance_sec2 = zbx_time() - sec;
 
-	FINISH_SYNC;
+		if (0 != (update_flags & ZBX_DBSYNC_UPDATE_HOST_GROUPS))
+			dc_hostgroups_update_cache();
+
+		/* pre-cache nested groups used in maintenances to allow read lock */
+		/* during host maintenance update calculations                     */
+		if (0 != (update_flags & (ZBX_DBSYNC_UPDATE_HOST_GROUPS | ZBX_DBSYNC_UPDATE_MAINTENANCE_GROUPS)))
+			dc_maintenance_precache_nested_groups();
+
+		FINISH_SYNC;
+	}
+	else
+		hsec2 = hisec2 = hgroups_sec2 = maintenance_sec2 = 0;
 
 	/* sync item data to support item lookups when resolving macros during configuration sync */
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_interfaces(&if_sync))
+	if (FAIL == zbx_dbsync_compare(&if_sync, zbx_dbsync_compare_interfaces))
 		goto out;
 	ifsec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_items(&items_sync))
+	if (FAIL == zbx_dbsync_compare(&items_sync, zbx_dbsync_compare_items))
 		goto out;
 	isec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_template_items(&template_items_sync))
+	if (FAIL == zbx_dbsync_compare(&template_items_sync, zbx_dbsync_compare_template_items))
 		goto out;
 	tisec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_prototype_items(&prototype_items_sync))
+	if (FAIL == zbx_dbsync_compare(&prototype_items_sync, zbx_dbsync_compare_prototype_items))
 		goto out;
 	pisec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_item_discovery(&item_discovery_sync))
+	if (FAIL == zbx_dbsync_compare(&item_discovery_sync, zbx_dbsync_compare_item_discovery))
 		goto out;
 	idsec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_item_preprocs(&itempp_sync))
+	if (FAIL == zbx_dbsync_compare(&itempp_sync, zbx_dbsync_compare_item_preprocs))
 		goto out;
 	itempp_sec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_item_script_param(&itemscrp_sync))
+	if (FAIL == zbx_dbsync_compare(&itemscrp_sync, zbx_dbsync_compare_item_script_param))
 		goto out;
 	itemscrp_sec = zbx_time() - sec;
 
-	START_SYNC;
+	if (0 != dc_sync_changes_num(&items_sync))
+		update_flags |= ZBX_DBSYNC_UPDATE_ITEMS;
 
-	/* resolves macros for interface_snmpaddrs, must be after DCsync_hmacros() */
-	sec = zbx_time();
-	DCsync_interfaces(&if_sync);
-	ifsec2 = zbx_time() - sec;
+	/* preprocessable items depend also on host status, so item sync timestamp must be updated on host changes */
+	if (0 != (update_flags & (ZBX_DBSYNC_UPDATE_ITEMS | ZBX_DBSYNC_UPDATE_HOSTS)) ||
+			0 != dc_sync_changes_num(&if_sync) + dc_sync_changes_num(&template_items_sync) +
+			dc_sync_changes_num(&prototype_items_sync) + dc_sync_changes_num(&item_discovery_sync) +
+			dc_sync_changes_num(&itempp_sync) + dc_sync_changes_num(&itemscrp_sync))
+	{
+		START_SYNC;
 
-	/* relies on hosts, proxies and interfaces, must be after DCsync_{hosts,interfaces}() */
+		/* resolves macros for interface_snmpaddrs, must be after DCsync_hmacros() */
+		sec = zbx_time();
+		DCsync_interfaces(&if_sync);
+		ifsec2 = zbx_time() - sec;
 
-	sec = zbx_time();
-	DCsync_items(&items_sync, flags);
-	isec2 = zbx_time() - sec;
+		/* relies on hosts, proxies and interfaces, must be after DCsync_{hosts,interfaces}() */
 
-	sec = zbx_time();
-	DCsync_template_items(&template_items_sync);
-	tisec2 = zbx_time() - sec;
+		sec = zbx_time();
+		DCsync_items(&items_sync, flags);
+		isec2 = zbx_time() - sec;
 
-	sec = zbx_time();
-	DCsync_prototype_items(&prototype_items_sync);
-	pisec2 = zbx_time() - sec;
+		sec = zbx_time();
+		DCsync_template_items(&template_items_sync);
+		tisec2 = zbx_time() - sec;
 
-	sec = zbx_time();
-	DCsync_item_discovery(&item_discovery_sync);
-	idsec2 = zbx_time() - sec;
+		sec = zbx_time();
+		DCsync_prototype_items(&prototype_items_sync);
+		pisec2 = zbx_time() - sec;
 
-	/* relies on items, must be after DCsync_items() */
-	sec = zbx_time();
-	DCsync_item_preproc(&itempp_sync, sec);
-	itempp_sec2 = zbx_time() - sec;
+		sec = zbx_time();
+		DCsync_item_discovery(&item_discovery_sync);
+		idsec2 = zbx_time() - sec;
 
-	/* relies on items, must be after DCsync_items() */
-	sec = zbx_time();
-	DCsync_itemscript_param(&itemscrp_sync);
-	itemscrp_sec2 = zbx_time() - sec;
+		/* relies on items, must be after DCsync_items() */
+		sec = zbx_time();
+		DCsync_item_preproc(&itempp_sync, sec);
+		itempp_sec2 = zbx_time() - sec;
 
-	config->item_sync_ts = time(NULL);
-	FINISH_SYNC;
+		/* relies on items, must be after DCsync_items() */
+		sec = zbx_time();
+		DCsync_itemscript_param(&itemscrp_sync);
+		itemscrp_sec2 = zbx_time() - sec;
+
+		config->item_sync_ts = time(NULL);
+		FINISH_SYNC;
 
-	dc_flush_history();	/* misconfigured items generate pseudo-historic values to become notsupported */
+		dc_flush_history();	/* misconfigured items generate pseudo-historic values to become notsupported */
+	}
+	else
+		ifsec2 = isec2 = tisec2 = pisec2 = idsec2 = itempp_sec2 = itemscrp_sec2 = 0;
 
 	/* sync function data to support function lookups when resolving macros during configuration sync */
 
 	/* relies on items, must be after DCsync_items() */
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_item_tags(&item_tag_sync))
+	if (FAIL == zbx_dbsync_compare(&item_tag_sync, zbx_dbsync_compare_item_tags))
 		goto out;
 	item_tag_sec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_functions(&func_sync))
+	if (FAIL == zbx_dbsync_compare(&func_sync, zbx_dbsync_compare_functions))
 		goto out;
 	fsec = zbx_time() - sec;
 
-	START_SYNC;
-	sec = zbx_time();
-	DCsync_functions(&func_sync);
-	fsec2 = zbx_time() - sec;
-	FINISH_SYNC;
+	if (0 != dc_sync_changes_num(&func_sync))
+	{
+		update_flags |= ZBX_DBSYNC_UPDATE_FUNCTIONS;
+
+		START_SYNC;
+		sec = zbx_time();
+		DCsync_functions(&func_sync);
+		fsec2 = zbx_time() - sec;
+		FINISH_SYNC;
+	}
+	else
+		fsec2 = 0;
 
 	/* sync rest of the data */
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_triggers(&triggers_sync))
+	if (FAIL == zbx_dbsync_compare(&triggers_sync, zbx_dbsync_compare_triggers))
 		goto out;
 	tsec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_trigger_dependency(&tdep_sync))
+	if (FAIL == zbx_dbsync_compare(&tdep_sync, zbx_dbsync_compare_trigger_dependency))
 		goto out;
 	dsec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_expressions(&expr_sync))
+	if (FAIL == zbx_dbsync_compare(&expr_sync, zbx_dbsync_compare_expressions))
 		goto out;
 	expr_sec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_actions(&action_sync))
+	if (FAIL == zbx_dbsync_compare(&action_sync, zbx_dbsync_compare_actions))
 		goto out;
 	action_sec = zbx_time() - sec;
 
@@ -6309,110 +6744,115 @@ void	DCsync_configuration(unsigned char mode)
 	action_op_sec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_action_conditions(&action_condition_sync))
+	if (FAIL == zbx_dbsync_compare(&action_condition_sync, zbx_dbsync_compare_action_conditions))
 		goto out;
 	action_condition_sec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_trigger_tags(&trigger_tag_sync))
+	if (FAIL == zbx_dbsync_compare(&trigger_tag_sync, zbx_dbsync_compare_trigger_tags))
 		goto out;
 	trigger_tag_sec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_correlations(&correlation_sync))
+	if (FAIL == zbx_dbsync_compare(&correlation_sync, zbx_dbsync_compare_correlations))
 		goto out;
 	correlation_sec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_corr_conditions(&corr_condition_sync))
+	if (FAIL == zbx_dbsync_compare(&corr_condition_sync, zbx_dbsync_compare_corr_conditions))
 		goto out;
 	corr_condition_sec = zbx_time() - sec;
 
 	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_corr_operations(&corr_operation_sync))
+	if (FAIL == zbx_dbsync_compare(&corr_operation_sync, zbx_dbsync_compare_corr_operations))
 		goto out;
 	corr_operation_sec = zbx_time() - sec;
 
-	START_SYNC;
-
-	sec = zbx_time();
-	DCsync_triggers(&triggers_sync);
-	tsec2 = zbx_time() - sec;
-
-	sec = zbx_time();
-	DCsync_trigdeps(&tdep_sync);
-	dsec2 = zbx_time() - sec;
+	if (0 != dc_sync_changes_num(&triggers_sync))
+		update_flags |= ZBX_DBSYNC_UPDATE_TRIGGERS;
 
-	sec = zbx_time();
-	DCsync_expressions(&expr_sync);
-	expr_sec2 = zbx_time() - sec;
+	if (0 != dc_sync_changes_num(&tdep_sync))
+		update_flags |= ZBX_DBSYNC_UPDATE_TRIGGER_DEPENDENCY;
 
-	sec = zbx_time();
-	DCsync_actions(&action_sync);
-	action_sec2 = zbx_time() - sec;
+	if (0 != (update_flags & (ZBX_DBSYNC_UPDATE_HOSTS | ZBX_DBSYNC_UPDATE_ITEMS | ZBX_DBSYNC_UPDATE_FUNCTIONS |
+			ZBX_DBSYNC_UPDATE_TRIGGERS | ZBX_DBSYNC_UPDATE_TRIGGER_DEPENDENCY)) ||
+			0 != dc_sync_changes_num(&expr_sync) + dc_sync_changes_num(&action_sync) +
+			dc_sync_changes_num(&action_op_sync) + dc_sync_changes_num(&action_condition_sync) +
+			dc_sync_changes_num(&trigger_tag_sync) + dc_sync_changes_num(&item_tag_sync) +
+			dc_sync_changes_num(&correlation_sync) + dc_sync_changes_num(&corr_condition_sync) +
+			dc_sync_changes_num(&corr_operation_sync))
+	{
+		START_SYNC;
 
-	sec = zbx_time();
-	DCsync_action_ops(&action_op_sync);
-	action_op_sec2 = zbx_time() - sec;
+		sec = zbx_time();
+		DCsync_triggers(&triggers_sync);
+		tsec2 = zbx_time() - sec;
 
-	sec = zbx_time();
-	DCsync_action_conditions(&action_condition_sync);
-	action_condition_sec2 = zbx_time() - sec;
+		sec = zbx_time();
+		DCsync_trigdeps(&tdep_sync);
+		dsec2 = zbx_time() - sec;
 
-	sec = zbx_time();
-	/* relies on triggers, must be after DCsync_triggers() */
-	DCsync_trigger_tags(&trigger_tag_sync);
-	trigger_tag_sec2 = zbx_time() - sec;
+		sec = zbx_time();
+		DCsync_expressions(&expr_sync);
+		expr_sec2 = zbx_time() - sec;
 
-	sec = zbx_time();
-	DCsync_item_tags(&item_tag_sync);
-	item_tag_sec2 = zbx_time() - sec;
+		sec = zbx_time();
+		DCsync_actions(&action_sync);
+		action_sec2 = zbx_time() - sec;
 
-	sec = zbx_time();
-	DCsync_correlations(&correlation_sync);
-	correlation_sec2 = zbx_time() - sec;
+		sec = zbx_time();
+		DCsync_action_ops(&action_op_sync);
+		action_op_sec2 = zbx_time() - sec;
 
-	sec = zbx_time();
-	/* relies on correlation rules, must be after DCsync_correlations() */
-	DCsync_corr_conditions(&corr_condition_sync);
-	corr_condition_sec2 = zbx_time() - sec;
+		sec = zbx_time();
+		DCsync_action_conditions(&action_condition_sync);
+		action_condition_sec2 = zbx_time() - sec;
 
-	sec = zbx_time();
-	/* relies on correlation rules, must be after DCsync_correlations() */
-	DCsync_corr_operations(&corr_operation_sync);
-	corr_operation_sec2 = zbx_time() - sec;
+		sec = zbx_time();
+		/* relies on triggers, must be after DCsync_triggers() */
+		DCsync_trigger_tags(&trigger_tag_sync);
+		trigger_tag_sec2 = zbx_time() - sec;
 
-	sec = zbx_time();
+		sec = zbx_time();
+		DCsync_item_tags(&item_tag_sync);
+		item_tag_sec2 = zbx_time() - sec;
 
-	if (0 != hosts_sync.add_num + hosts_sync.update_num + hosts_sync.remove_num)
-		update_flags |= ZBX_DBSYNC_UPDATE_HOSTS;
+		sec = zbx_time();
+		DCsync_correlations(&correlation_sync);
+		correlation_sec2 = zbx_time() - sec;
 
-	if (0 != items_sync.add_num + items_sync.update_num + items_sync.remove_num)
-		update_flags |= ZBX_DBSYNC_UPDATE_ITEMS;
+		sec = zbx_time();
+		/* relies on correlation rules, must be after DCsync_correlations() */
+		DCsync_corr_conditions(&corr_condition_sync);
+		corr_condition_sec2 = zbx_time() - sec;
 
-	if (0 != func_sync.add_num + func_sync.update_num + func_sync.remove_num)
-		update_flags |= ZBX_DBSYNC_UPDATE_FUNCTIONS;
+		sec = zbx_time();
+		/* relies on correlation rules, must be after DCsync_correlations() */
+		DCsync_corr_operations(&corr_operation_sync);
+		corr_operation_sec2 = zbx_time() - sec;
 
-	if (0 != triggers_sync.add_num + triggers_sync.update_num + triggers_sync.remove_num)
-		update_flags |= ZBX_DBSYNC_UPDATE_TRIGGERS;
+		sec = zbx_time();
 
-	if (0 != tdep_sync.add_num + tdep_sync.update_num + tdep_sync.remove_num)
-		update_flags |= ZBX_DBSYNC_UPDATE_TRIGGER_DEPENDENCY;
+		/* update trigger topology if trigger dependency was changed */
+		if (0 != (update_flags & ZBX_DBSYNC_UPDATE_TRIGGER_DEPENDENCY))
+			dc_trigger_update_topology();
 
-	/* update trigger topology if trigger dependency was changed */
-	if (0 != (update_flags & ZBX_DBSYNC_UPDATE_TRIGGER_DEPENDENCY))
-		dc_trigger_update_topology();
+		/* update various trigger related links in cache */
+		if (0 != (update_flags & (ZBX_DBSYNC_UPDATE_HOSTS | ZBX_DBSYNC_UPDATE_ITEMS | ZBX_DBSYNC_UPDATE_FUNCTIONS |
+				ZBX_DBSYNC_UPDATE_TRIGGERS)))
+		{
+			dc_trigger_update_cache();
+			dc_schedule_trigger_timers((ZBX_DBSYNC_INIT == mode ? &trend_queue : NULL), time(NULL));
+		}
 
-	/* update various trigger related links in cache */
-	if (0 != (update_flags & (ZBX_DBSYNC_UPDATE_HOSTS | ZBX_DBSYNC_UPDATE_ITEMS | ZBX_DBSYNC_UPDATE_FUNCTIONS |
-			ZBX_DBSYNC_UPDATE_TRIGGERS)))
+		update_sec = zbx_time() - sec;
+	}
+	else
 	{
-		dc_trigger_update_cache();
-		dc_schedule_trigger_timers((ZBX_DBSYNC_INIT == mode ? &trend_queue : NULL), time(NULL));
+		tsec2 = dsec2 = expr_sec2 = action_sec2 = action_op_sec2 = action_condition_sec2 = trigger_tag_sec2 =
+				item_tag_sec2 = correlation_sec2 = corr_condition_sec2 = corr_operation_sec2 = update_sec = 0;
 	}
 
-	update_sec = zbx_time() - sec;
-
 	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
 	{
 		total = csec + hsec + hisec + htsec + gmsec + hmsec + ifsec + idsec + isec +  tisec + pisec + tsec + dsec + fsec + expr_sec +
@@ -6551,6 +6991,8 @@ void	DCsync_configuration(unsigned char mode)
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() total sql  : " ZBX_FS_DBL " sec.", __func__, total);
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() total sync : " ZBX_FS_DBL " sec.", __func__, total2);
 
+		RDLOCK_CACHE;
+
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() proxies    : %d (%d slots)", __func__,
 				config->proxies.num_data, config->proxies.num_slots);
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() hosts      : %d (%d slots)", __func__,
@@ -6662,8 +7104,9 @@ void	DCsync_configuration(unsigned char mode)
 
 		for (i = 0; ZBX_POLLER_TYPE_COUNT > i; i++)
 		{
-			zabbix_log(LOG_LEVEL_DEBUG, "%s() queue[%d]   : %d (%d allocated)", __func__,
-					i, config->queues[i].elems_num, config->queues[i].elems_alloc);
+			zabbix_log(LOG_LEVEL_DEBUG, "%s() queue[%d]   : %d (%d allocated), wheel: %d", __func__,
+					i, config->queues[i].heap.elems_num, config->queues[i].heap.elems_alloc,
+					config->queues[i].wheel_num);
 		}
 
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() pqueue     : %d (%d allocated)", __func__,
@@ -6679,7 +7122,14 @@ void	DCsync_configuration(unsigned char mode)
 				config->strpool.num_data, config->strpool.num_slots);
 
 		zbx_mem_dump_stats(LOG_LEVEL_DEBUG, config_mem);
+
+		UNLOCK_CACHE;
 	}
+
+	if (ZBX_DBSYNC_UPDATE == mode)
+		zbx_dbsync_write_snapshot(init_funcs, (int)ARRSIZE(init_funcs));
+
+	START_SYNC;
 out:
 	if (0 == sync_in_progress)
 	{
@@ -6693,6 +7143,8 @@ out:
 
 	FINISH_SYNC;
 
+	zbx_dbsync_prefetch_finish();
+
 	zbx_dbsync_clear(&config_sync);
 	zbx_dbsync_clear(&autoreg_config_sync);
 	zbx_dbsync_clear(&hosts_sync);
@@ -6976,6 +7428,36 @@ static int	__config_proxy_compare(const void *d1, const void *d2)
 	return 0;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates poller queue in configuration cache                       *
+ *                                                                            *
+ * Parameters: queue        - [OUT] the poller queue                          *
+ *             compare_func - [IN] the queue heap element compare function    *
+ *                                                                            *
+ * Comments: The timer wheel window starts from the current time, so items    *
+ *           loaded by the initial synchronization are put in timer wheel.    *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_item_queue_create(zbx_dc_item_queue_t *queue, zbx_compare_func_t compare_func)
+{
+	size_t	size;
+
+	zbx_binary_heap_create_ext(&queue->heap, compare_func, ZBX_BINARY_HEAP_OPTION_DIRECT,
+			__config_mem_malloc_func, __config_mem_realloc_func, __config_mem_free_func);
+
+	size = sizeof(ZBX_DC_ITEM *) * ZBX_DC_QUEUE_WHEEL_SIZE;
+	queue->wheel = (ZBX_DC_ITEM **)__config_mem_malloc_func(NULL, size);
+	memset(queue->wheel, 0, size);
+
+	size = sizeof(zbx_uint64_t) * (ZBX_DC_QUEUE_WHEEL_SIZE / ZBX_DC_QUEUE_WHEEL_WORD_BITS);
+	queue->wheel_used = (zbx_uint64_t *)__config_mem_malloc_func(NULL, size);
+	memset(queue->wheel_used, 0, size);
+
+	queue->wheel_start = (int)time(NULL);
+	queue->wheel_num = 0;
+}
+
 /* hash and compare functions for expressions hashset */
 
 static zbx_hash_t	__config_regexp_hash(const void *data)
@@ -7149,7 +7631,7 @@ int	init_configuration_cache(char **error)
 	CREATE_HASHSET_EXT(config->interface_snmpaddrs, 0, __config_interface_addr_hash, __config_interface_addr_compare);
 	CREATE_HASHSET_EXT(config->regexps, 0, __config_regexp_hash, __config_regexp_compare);
 
-	CREATE_HASHSET_EXT(config->strpool, 100, __config_strpool_hash, __config_strpool_compare);
+	CREATE_HASHSET_EXT(config->strpool, 100, zbx_strpool_hash_func, zbx_strpool_compare_func);
 
 #if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
 	CREATE_HASHSET_EXT(config->psks, 0, __config_psk_hash, __config_psk_compare);
@@ -7160,28 +7642,13 @@ int	init_configuration_cache(char **error)
 		switch (i)
 		{
 			case ZBX_POLLER_TYPE_JAVA:
-				zbx_binary_heap_create_ext(&config->queues[i],
-						__config_java_elem_compare,
-						ZBX_BINARY_HEAP_OPTION_DIRECT,
-						__config_mem_malloc_func,
-						__config_mem_realloc_func,
-						__config_mem_free_func);
+				dc_item_queue_create(&config->queues[i], __config_java_elem_compare);
 				break;
 			case ZBX_POLLER_TYPE_PINGER:
-				zbx_binary_heap_create_ext(&config->queues[i],
-						__config_pinger_elem_compare,
-						ZBX_BINARY_HEAP_OPTION_DIRECT,
-						__config_mem_malloc_func,
-						__config_mem_realloc_func,
-						__config_mem_free_func);
+				dc_item_queue_create(&config->queues[i], __config_pinger_elem_compare);
 				break;
 			default:
-				zbx_binary_heap_create_ext(&config->queues[i],
-						__config_heap_elem_compare,
-						ZBX_BINARY_HEAP_OPTION_DIRECT,
-						__config_mem_malloc_func,
-						__config_mem_realloc_func,
-						__config_mem_free_func);
+				dc_item_queue_create(&config->queues[i], __config_heap_elem_compare);
 				break;
 		}
 	}
@@ -9343,15 +9810,15 @@ unlock:
  * Return value: nextcheck or FAIL if no items for the specified queue        *
  *                                                                            *
  ******************************************************************************/
-static int	dc_config_get_queue_nextcheck(zbx_binary_heap_t *queue)
+static int	dc_config_get_queue_nextcheck(zbx_dc_item_queue_t *queue)
 {
-	int				nextcheck;
+	int				nextcheck, wheel_nextcheck;
 	const zbx_binary_heap_elem_t	*min;
 	const ZBX_DC_ITEM		*dc_item;
 
-	if (FAIL == zbx_binary_heap_empty(queue))
+	if (FAIL == zbx_binary_heap_empty(&queue->heap))
 	{
-		min = zbx_binary_heap_find_min(queue);
+		min = zbx_binary_heap_find_min(&queue->heap);
 		dc_item = (const ZBX_DC_ITEM *)min->data;
 
 		nextcheck = dc_item->nextcheck;
@@ -9359,6 +9826,12 @@ static int	dc_config_get_queue_nextcheck(zbx_binary_heap_t *queue)
 	else
 		nextcheck = FAIL;
 
+	if (FAIL != (wheel_nextcheck = dc_item_queue_wheel_nextcheck(queue)) &&
+			(FAIL == nextcheck || wheel_nextcheck < nextcheck))
+	{
+		nextcheck = wheel_nextcheck;
+	}
+
 	return nextcheck;
 }
 
@@ -9374,7 +9847,7 @@ static int	dc_config_get_queue_nextcheck(zbx_binary_heap_t *queue)
 int	DCconfig_get_poller_nextcheck(unsigned char poller_type)
 {
 	int			nextcheck;
-	zbx_binary_heap_t	*queue;
+	zbx_dc_item_queue_t	*queue;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() poller_type:%d", __func__, (int)poller_type);
 
@@ -9455,7 +9928,7 @@ static void	dc_requeue_item_at(ZBX_DC_ITEM *dc_item, ZBX_DC_HOST *dc_host, int n
 int	DCconfig_get_poller_items(unsigned char poller_type, DC_ITEM **items)
 {
 	int			now, num = 0, max_items;
-	zbx_binary_heap_t	*queue;
+	zbx_dc_item_queue_t	*queue;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() poller_type:%d", __func__, (int)poller_type);
 
@@ -9477,7 +9950,9 @@ int	DCconfig_get_poller_items(unsigned char poller_type, DC_ITEM **items)
 
 	WRLOCK_CACHE;
 
-	while (num < max_items && FAIL == zbx_binary_heap_empty(queue))
+	dc_item_queue_advance(queue, now);
+
+	while (num < max_items && FAIL == zbx_binary_heap_empty(&queue->heap))
 	{
 		int				disable_until;
 		const zbx_binary_heap_elem_t	*min;
@@ -9486,7 +9961,7 @@ int	DCconfig_get_poller_items(unsigned char poller_type, DC_ITEM **items)
 		ZBX_DC_ITEM			*dc_item;
 		static const ZBX_DC_ITEM	*dc_item_prev = NULL;
 
-		min = zbx_binary_heap_find_min(queue);
+		min = zbx_binary_heap_find_min(&queue->heap);
 		dc_item = (ZBX_DC_ITEM *)min->data;
 
 		if (dc_item->nextcheck > now)
@@ -9506,7 +9981,7 @@ int	DCconfig_get_poller_items(unsigned char poller_type, DC_ITEM **items)
 			}
 		}
 
-		zbx_binary_heap_remove_min(queue);
+		zbx_binary_heap_remove_min(&queue->heap);
 		dc_item->location = ZBX_LOC_NOWHERE;
 
 		if (NULL == (dc_host = (ZBX_DC_HOST *)zbx_hashset_search(&config->hosts, &dc_item->hostid)))
@@ -9606,7 +10081,7 @@ int	DCconfig_get_poller_items(unsigned char poller_type, DC_ITEM **items)
 int	DCconfig_get_ipmi_poller_items(int now, DC_ITEM *items, int items_num, int *nextcheck)
 {
 	int			num = 0;
-	zbx_binary_heap_t	*queue;
+	zbx_dc_item_queue_t	*queue;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -9614,7 +10089,9 @@ int	DCconfig_get_ipmi_poller_items(int now, DC_ITEM *items, int items_num, int *
 
 	WRLOCK_CACHE;
 
-	while (num < items_num && FAIL == zbx_binary_heap_empty(queue))
+	dc_item_queue_advance(queue, now);
+
+	while (num < items_num && FAIL == zbx_binary_heap_empty(&queue->heap))
 	{
 		int				disable_until;
 		const zbx_binary_heap_elem_t	*min;
@@ -9622,13 +10099,13 @@ int	DCconfig_get_ipmi_poller_items(int now, DC_ITEM *items, int items_num, int *
 		ZBX_DC_INTERFACE		*dc_interface;
 		ZBX_DC_ITEM			*dc_item;
 
-		min = zbx_binary_heap_find_min(queue);
+		min = zbx_binary_heap_find_min(&queue->heap);
 		dc_item = (ZBX_DC_ITEM *)min->data;
 
 		if (dc_item->nextcheck > now)
 			break;
 
-		zbx_binary_heap_remove_min(queue);
+		zbx_binary_heap_remove_min(&queue->heap);
 		dc_item->location = ZBX_LOC_NOWHERE;
 
 		if (NULL == (dc_host = (ZBX_DC_HOST *)zbx_hashset_search(&config->hosts, &dc_item->hostid)))
@@ -14062,7 +14539,155 @@ int	zbx_dc_maintenance_has_tags(void)
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get configuration cache shared memory statistics                  *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_get_mem_stats(zbx_mem_stats_t *stats)
+{
+	RDLOCK_CACHE;
+	zbx_mem_get_stats(config_mem, stats);
+	UNLOCK_CACHE;
+}
+
+typedef struct
+{
+	const char	*name;
+	size_t		offset;
+	size_t		entry_size;
+}
+zbx_dc_hashset_def_t;
+
+#define ZBX_DC_HASHSET_DEF(field, type)	{#field, offsetof(ZBX_DC_CONFIG, field), sizeof(type)}
+
+static const zbx_dc_hashset_def_t	dc_hashset_defs[] = {
+	ZBX_DC_HASHSET_DEF(items, ZBX_DC_ITEM),
+	ZBX_DC_HASHSET_DEF(items_hk, ZBX_DC_ITEM_HK),
+	ZBX_DC_HASHSET_DEF(template_items, ZBX_DC_TEMPLATE_ITEM),
+	ZBX_DC_HASHSET_DEF(prototype_items, ZBX_DC_PROTOTYPE_ITEM),
+	ZBX_DC_HASHSET_DEF(numitems, ZBX_DC_NUMITEM),
+	ZBX_DC_HASHSET_DEF(snmpitems, ZBX_DC_SNMPITEM),
+	ZBX_DC_HASHSET_DEF(ipmiitems, ZBX_DC_IPMIITEM),
+	ZBX_DC_HASHSET_DEF(trapitems, ZBX_DC_TRAPITEM),
+	ZBX_DC_HASHSET_DEF(dependentitems, ZBX_DC_DEPENDENTITEM),
+	ZBX_DC_HASHSET_DEF(logitems, ZBX_DC_LOGITEM),
+	ZBX_DC_HASHSET_DEF(dbitems, ZBX_DC_DBITEM),
+	ZBX_DC_HASHSET_DEF(sshitems, ZBX_DC_SSHITEM),
+	ZBX_DC_HASHSET_DEF(telnetitems, ZBX_DC_TELNETITEM),
+	ZBX_DC_HASHSET_DEF(simpleitems, ZBX_DC_SIMPLEITEM),
+	ZBX_DC_HASHSET_DEF(jmxitems, ZBX_DC_JMXITEM),
+	ZBX_DC_HASHSET_DEF(calcitems, ZBX_DC_CALCITEM),
+	ZBX_DC_HASHSET_DEF(masteritems, ZBX_DC_MASTERITEM),
+	ZBX_DC_HASHSET_DEF(preprocitems, ZBX_DC_PREPROCITEM),
+	ZBX_DC_HASHSET_DEF(httpitems, ZBX_DC_HTTPITEM),
+	ZBX_DC_HASHSET_DEF(scriptitems, ZBX_DC_SCRIPTITEM),
+	ZBX_DC_HASHSET_DEF(functions, ZBX_DC_FUNCTION),
+	ZBX_DC_HASHSET_DEF(triggers, ZBX_DC_TRIGGER),
+	ZBX_DC_HASHSET_DEF(trigdeps, ZBX_DC_TRIGGER_DEPLIST),
+	ZBX_DC_HASHSET_DEF(hosts, ZBX_DC_HOST),
+	ZBX_DC_HASHSET_DEF(hosts_h, ZBX_DC_HOST_H),
+	ZBX_DC_HASHSET_DEF(hosts_p, ZBX_DC_HOST_H),
+	ZBX_DC_HASHSET_DEF(proxies, ZBX_DC_PROXY),
+	ZBX_DC_HASHSET_DEF(host_inventories, ZBX_DC_HOST_INVENTORY),
+	ZBX_DC_HASHSET_DEF(host_inventories_auto, ZBX_DC_HOST_INVENTORY),
+	ZBX_DC_HASHSET_DEF(ipmihosts, ZBX_DC_IPMIHOST),
+	ZBX_DC_HASHSET_DEF(htmpls, ZBX_DC_HTMPL),
+	ZBX_DC_HASHSET_DEF(gmacros, ZBX_DC_GMACRO),
+	ZBX_DC_HASHSET_DEF(hmacros, ZBX_DC_HMACRO),
+	ZBX_DC_HASHSET_DEF(interfaces, ZBX_DC_INTERFACE),
+	ZBX_DC_HASHSET_DEF(interfaces_snmp, ZBX_DC_SNMPINTERFACE),
+	ZBX_DC_HASHSET_DEF(interfaces_ht, ZBX_DC_INTERFACE_HT),
+	ZBX_DC_HASHSET_DEF(regexps, ZBX_DC_REGEXP),
+	ZBX_DC_HASHSET_DEF(expressions, ZBX_DC_EXPRESSION),
+	ZBX_DC_HASHSET_DEF(actions, zbx_dc_action_t),
+	ZBX_DC_HASHSET_DEF(action_conditions, zbx_dc_action_condition_t),
+	ZBX_DC_HASHSET_DEF(trigger_tags, zbx_dc_trigger_tag_t),
+	ZBX_DC_HASHSET_DEF(item_tags, zbx_dc_item_tag_t),
+	ZBX_DC_HASHSET_DEF(host_tags, zbx_dc_host_tag_t),
+	ZBX_DC_HASHSET_DEF(correlations, zbx_dc_correlation_t),
+	ZBX_DC_HASHSET_DEF(corr_operations, zbx_dc_corr_operation_t),
+	ZBX_DC_HASHSET_DEF(hostgroups, zbx_dc_hostgroup_t),
+	ZBX_DC_HASHSET_DEF(preprocops, zbx_dc_preproc_op_t),
+	ZBX_DC_HASHSET_DEF(maintenances, zbx_dc_maintenance_t),
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	ZBX_DC_HASHSET_DEF(psks, ZBX_DC_PSK),
+#endif
+};
+
+#undef ZBX_DC_HASHSET_DEF
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get memory footprint statistics of configuration cache hashsets   *
+ *                                                                            *
+ * Parameters: hashsets - [OUT] the hashset statistics                        *
+ *                              (zbx_dc_hashset_stats_t)                      *
+ *                                                                            *
+ * Comments: The size includes the slot array and the fixed size part of      *
+ *           entries. Strings, vectors and other memory referenced by entries *
+ *           are not included.                                                *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_get_hashset_stats(zbx_vector_ptr_t *hashsets)
+{
+	size_t	i;
+
+	zbx_vector_ptr_reserve(hashsets, ARRSIZE(dc_hashset_defs));
+
+	RDLOCK_CACHE;
+
+	for (i = 0; i < ARRSIZE(dc_hashset_defs); i++)
+	{
+		const zbx_hashset_t	*hs = (const zbx_hashset_t *)((const char *)config + dc_hashset_defs[i].offset);
+		zbx_dc_hashset_stats_t	*hs_stats;
+
+		hs_stats = (zbx_dc_hashset_stats_t *)zbx_malloc(NULL, sizeof(zbx_dc_hashset_stats_t));
+		hs_stats->name = dc_hashset_defs[i].name;
+		zbx_hashset_get_stats(hs, &hs_stats->stats);
+		hs_stats->size = zbx_mem_required_chunk_size(sizeof(zbx_hashset_slot_t) * (size_t)hs->num_slots) +
+				(zbx_uint64_t)hs->num_data *
+				zbx_mem_required_chunk_size(ZBX_HASHSET_ENTRY_OFFSET + dc_hashset_defs[i].entry_size);
+
+		zbx_vector_ptr_append(hashsets, hs_stats);
+	}
+
+	UNLOCK_CACHE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get configuration cache string pool statistics                    *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_get_strpool_stats(zbx_dc_strpool_stats_t *stats)
+{
+	zbx_hashset_iter_t		iter;
+	const zbx_strpool_header_t	*header;
+
+	stats->refs_num = 0;
+	stats->len_total = 0;
+
+	RDLOCK_CACHE;
+
+	zbx_hashset_get_stats(&config->strpool, &stats->stats);
+	stats->size = zbx_mem_required_chunk_size(sizeof(zbx_hashset_slot_t) * (size_t)config->strpool.num_slots);
+
+	zbx_hashset_iter_reset(&config->strpool, &iter);
+
+	while (NULL != (header = (const zbx_strpool_header_t *)zbx_hashset_iter_next(&iter)))
+	{
+		stats->refs_num += header->refcount;
+		stats->len_total += header->len;
+		stats->size += zbx_mem_required_chunk_size(ZBX_HASHSET_ENTRY_OFFSET + ZBX_STRPOOL_HEADER_SIZE +
+				header->len + 1);
+	}
+
+	UNLOCK_CACHE;
+}
+
 #ifdef HAVE_TESTS
 #	include "../../../tests/libs/zbxdbcache/dc_item_poller_type_update_test.c"
 #	include "../../../tests/libs/zbxdbcache/dc_function_calculate_nextcheck_test.c"
+#	include "../../../tests/libs/zbxdbcache/dc_item_queue_test.c"
 #endif
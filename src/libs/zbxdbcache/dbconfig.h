@@ -86,7 +86,7 @@ typedef struct
 }
 ZBX_DC_FUNCTION;
 
-typedef struct
+typedef struct zbx_dc_item
 {
 	zbx_uint64_t		itemid;
 	zbx_uint64_t		hostid;
@@ -98,6 +98,11 @@ typedef struct
 	const char		*error;
 	const char		*delay;
 	ZBX_DC_TRIGGER		**triggers;
+
+	/* poller queue timer wheel slot list links, valid while item is in timer wheel */
+	struct zbx_dc_item	*queue_next;
+	struct zbx_dc_item	**queue_pprev;
+
 	int			nextcheck;
 	int			mtime;
 	int			data_expected_from;
@@ -790,6 +795,23 @@ typedef struct
 }
 zbx_dc_timer_trigger_t;
 
+/* the number of one second timer wheel slots, must be multiple of 64 */
+#define ZBX_DC_QUEUE_WHEEL_SIZE	4096
+
+/* Poller queue. Items scheduled within the timer wheel window are kept in per second slot lists, */
+/* so requeuing them does not reorder the heap. Overdue items and items scheduled after the       */
+/* window are kept in binary heap. Wheel slots are moved to the heap when their time comes, so    */
+/* the heap orders due items for pollers.                                                         */
+typedef struct
+{
+	zbx_binary_heap_t	heap;
+	ZBX_DC_ITEM		**wheel;
+	zbx_uint64_t		*wheel_used;	/* bitmap of non-empty wheel slots */
+	int			wheel_start;	/* the time of the first slot in wheel window */
+	int			wheel_num;	/* the number of items in wheel */
+}
+zbx_dc_item_queue_t;
+
 typedef struct
 {
 	/* timestamp of the last host availability diff sent to sever, used only by proxies */
@@ -877,7 +899,7 @@ typedef struct
 							/* by PSK identity */
 #endif
 	zbx_hashset_t		data_sessions;
-	zbx_binary_heap_t	queues[ZBX_POLLER_TYPE_COUNT];
+	zbx_dc_item_queue_t	queues[ZBX_POLLER_TYPE_COUNT];
 	zbx_binary_heap_t	pqueue;
 	zbx_binary_heap_t	trigger_queue;
 	ZBX_DC_CONFIG_TABLE	*config;
@@ -912,8 +934,33 @@ void	DCdump_configuration(void);
 void	*DCfind_id(zbx_hashset_t *hashset, zbx_uint64_t id, size_t size, int *found);
 
 /* string pool */
+
+/* string pool record header, followed by the zero terminated string */
+typedef struct
+{
+	zbx_uint32_t	refcount;
+	zbx_uint32_t	len;
+}
+zbx_strpool_header_t;
+
+#define ZBX_STRPOOL_HEADER_SIZE	sizeof(zbx_strpool_header_t)
+#define ZBX_STRPOOL_STRLEN(str)	(((const zbx_strpool_header_t *)((str) - ZBX_STRPOOL_HEADER_SIZE))->len)
+
+typedef struct
+{
+	const char	**curr;
+	const char	*value;
+}
+zbx_strpool_field_t;
+
+zbx_hash_t	zbx_strpool_hash_func(const void *data);
+int	zbx_strpool_compare_func(const void *d1, const void *d2);
+char	*zbx_strpool_intern_ext(zbx_hashset_t *strpool, const char *str, size_t len);
+void	zbx_strpool_release_ext(zbx_hashset_t *strpool, const char *str);
+
 void	zbx_strpool_release(const char *str);
 int	DCstrpool_replace(int found, const char **curr, const char *new_str);
+int	DCstrpool_replace_fields(int found, const zbx_strpool_field_t *fields, int fields_num);
 
 /* host groups */
 void	dc_get_nested_hostgroupids(zbx_uint64_t groupid, zbx_vector_uint64_t *nested_groupids);
@@ -19,63 +19,197 @@
 
 #include "dbsync.h"
 
+#include <poll.h>
+
 #include "log.h"
 #include "dbcache.h"
 #include "zbxserialize.h"
 #include "base64.h"
 #include "zbxeval.h"
+#include "threads.h"
+
+/* the maximum number of changelog identifiers skipped by the last read, if exceeded some */
+/* of the skipped identifiers are not tracked anymore and the full comparison is done     */
+#define ZBX_DBSYNC_CHANGELOG_GAPS_MAX	1000
+
+/* period of full comparison of incrementally synchronized tables and changelog cleanup */
+#define ZBX_DBSYNC_RECONCILE_PERIOD	SEC_PER_HOUR
+
+/* fall back to full comparison if more than 1/4 of cached objects were changed */
+#define ZBX_DBSYNC_CHANGELOG_MAX_RATIO	4
+
+/* the size of data sent by configuration prefetch workers in one write */
+#define ZBX_DBSYNC_PREFETCH_BUFFER_SIZE	(64 * ZBX_KIBIBYTE)
+
+/* the marker sent by configuration prefetch worker after the last row of changeset */
+#define ZBX_DBSYNC_PREFETCH_END		'\2'
+
+/* the prefetched changeset states */
+#define ZBX_DBSYNC_PREFETCH_RECEIVING	0
+#define ZBX_DBSYNC_PREFETCH_RECEIVED	1
+#define ZBX_DBSYNC_PREFETCH_READY	2
+#define ZBX_DBSYNC_PREFETCH_FAILED	3
+
+/* the configuration cache snapshot file format */
+#define ZBX_DBSYNC_SNAPSHOT_MAGIC	"ZBXCACHE"
+#define ZBX_DBSYNC_SNAPSHOT_VERSION	3
+
+#define ZBX_DBSYNC_ITEM_COLUMNS_NUM	50
+
+/* item_rtdata columns of items changeset, they are refreshed from database when snapshot is loaded */
+#define ZBX_DBSYNC_ITEM_RTDATA_STATE		12
+#define ZBX_DBSYNC_ITEM_RTDATA_LASTLOGSIZE	20
+#define ZBX_DBSYNC_ITEM_RTDATA_MTIME		21
+#define ZBX_DBSYNC_ITEM_RTDATA_ERROR		27
+
+extern unsigned char	program_type;
+extern char		*CONFIG_CACHE_SNAPSHOT_FILE;
+
+/* rows loaded in advance by a configuration prefetch worker */
+struct zbx_dbsync_prefetch
+{
+	/* the received data - zbx_dbsync_prefetch_header_t followed by rows  */
+	/* encoded by dbsync_row_encode()                                      */
+	char	*data;
+	size_t	data_alloc;
+	size_t	data_offset;
+
+	/* the position of the next row in data */
+	size_t	data_pos;
+
+	/* the current row, pointing to the values in data */
+	char	**row;
+
+	/* the changeset state, see ZBX_DBSYNC_PREFETCH_* defines */
+	int	state;
 
+	/* the pipe read end, -1 when all data was received or the data is not sent by worker */
+	int	fd;
+
+	/* the index of worker sending the data, -1 for data loaded from snapshot */
+	int	worker;
+};
+
+/* the configuration prefetch workers and their changesets */
 typedef struct
 {
-	zbx_hashset_t	strpool;
-	ZBX_DC_CONFIG	*cache;
+	zbx_dbsync_t	**syncs;
+	int		syncs_num;
+
+	pid_t		*pids;
+	int		workers_num;
+
+	/* the number of changesets with received data that was not retrieved yet, limited */
+	/* by the number of workers to bound the memory used by prefetched data            */
+	int		held_num;
 }
-zbx_dbsync_env_t;
+zbx_dbsync_prefetch_env_t;
 
-static zbx_dbsync_env_t	dbsync_env;
+static zbx_dbsync_prefetch_env_t	prefetch_env;
 
-/* string pool support */
+/* the changeset properties set by the compare function in prefetch worker, the worker */
+/* is a fork of configuration syncer so the function addresses are the same            */
+typedef struct
+{
+	int				columns_num;
+	zbx_dbsync_preproc_row_func_t	preproc_row_func;
+}
+zbx_dbsync_prefetch_header_t;
+
+/* the configuration cache snapshot file header, the file is read only by the same server build */
+typedef struct
+{
+	char		magic[sizeof(ZBX_DBSYNC_SNAPSHOT_MAGIC) - 1];
+	zbx_uint32_t	version;
+
+	/* hash of the server version and item select query */
+	zbx_uint32_t	build_hash;
 
-#define REFCOUNT_FIELD_SIZE	sizeof(zbx_uint32_t)
+	/* the number of sections, one per changeset */
+	int		sections_num;
 
-static zbx_hash_t	dbsync_strpool_hash_func(const void *data)
+	/* the time when the snapshot was taken */
+	int		clock;
+
+	/* the changelog record from which the changes made after the rows were selected are read */
+	zbx_uint64_t	changelogid;
+}
+zbx_dbsync_snapshot_header_t;
+
+/* the configuration cache snapshot section header, followed by rows encoded by dbsync_row_encode() */
+typedef struct
 {
-	return ZBX_DEFAULT_STRING_HASH_FUNC((char *)data + REFCOUNT_FIELD_SIZE);
+	int		columns_num;
+
+	/* the row pre-processing function index in dbsync_snapshot_preproc_funcs */
+	int		preproc_func;
+
+	/* the size of encoded rows */
+	zbx_uint64_t	size;
 }
+zbx_dbsync_snapshot_section_t;
 
-static int	dbsync_strpool_compare_func(const void *d1, const void *d2)
+/* the configuration cache snapshot being written */
+typedef struct
 {
-	return strcmp((char *)d1 + REFCOUNT_FIELD_SIZE, (char *)d2 + REFCOUNT_FIELD_SIZE);
+	FILE	*file;
+	char	*tmp_path;
+	char	*buf;
+	size_t	buf_alloc;
+	int	ret;
 }
+zbx_dbsync_snapshot_t;
 
-static char	*dbsync_strdup(const char *str)
+typedef struct
 {
-	void	*ptr;
+	zbx_uint64_t	itemid;
+	char		*state;
+	char		*lastlogsize;
+	char		*mtime;
+	char		*error;
+}
+zbx_dbsync_item_rtdata_t;
 
-	ptr = zbx_hashset_search(&dbsync_env.strpool, str - REFCOUNT_FIELD_SIZE);
+typedef struct
+{
+	zbx_hashset_t	strpool;
+	ZBX_DC_CONFIG	*cache;
 
-	if (NULL == ptr)
-	{
-		ptr = zbx_hashset_insert_ext(&dbsync_env.strpool, str - REFCOUNT_FIELD_SIZE,
-				REFCOUNT_FIELD_SIZE + strlen(str) + 1, REFCOUNT_FIELD_SIZE);
+	/* the last changelog record read */
+	zbx_uint64_t			changelogid;
 
-		*(zbx_uint32_t *)ptr = 0;
-	}
+	/* The changelog identifiers lower than the last read that were not read yet, they can   */
+	/* be written by transactions committed later (first - identifier, second - the time it  */
+	/* was skipped). The identifiers of rolled back transactions expire after reconcile      */
+	/* period.                                                                                */
+	zbx_vector_uint64_pair_t	changelog_gaps;
 
-	(*(zbx_uint32_t *)ptr)++;
+	/* the time of the last full item synchronization */
+	int				reconcile_ts;
 
-	return (char *)ptr + REFCOUNT_FIELD_SIZE;
+	/* the process writing configuration cache snapshot, 0 if none */
+	pid_t				snapshot_pid;
+
+	/* 1 if the configuration cache snapshot must be written during the next synchronization */
+	unsigned char			snapshot_due;
+
+	unsigned char			initialized;
+}
+zbx_dbsync_env_t;
+
+static zbx_dbsync_env_t	dbsync_env;
+
+/* string pool support */
+
+static char	*dbsync_strdup(const char *str)
+{
+	return zbx_strpool_intern_ext(&dbsync_env.strpool, str, strlen(str));
 }
 
 static void	dbsync_strfree(char *str)
 {
 	if (NULL != str)
-	{
-		void	*ptr = str - REFCOUNT_FIELD_SIZE;
-
-		if (0 == --(*(zbx_uint32_t *)ptr))
-			zbx_hashset_remove_direct(&dbsync_env.strpool, ptr);
-	}
+		zbx_strpool_release_ext(&dbsync_env.strpool, str);
 }
 
 /* macro value validators */
@@ -250,10 +384,45 @@ static char	**dbsync_preproc_row(zbx_dbsync_t *sync, char **row)
 	return sync->row;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets identifier of the last changelog record                      *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	dbsync_get_last_changelogid(void)
+{
+	DB_RESULT	result;
+	DB_ROW		row;
+	zbx_uint64_t	changelogid = 0;
+
+	if (NULL == (result = DBselect("select max(changelogid) from changelog")))
+		return 0;
+
+	if (NULL != (row = DBfetch(result)) && SUCCEED != DBis_null(row[0]))
+		ZBX_STR2UINT64(changelogid, row[0]);
+
+	DBfree_result(result);
+
+	return changelogid;
+}
+
 void	zbx_dbsync_init_env(ZBX_DC_CONFIG *cache)
 {
 	dbsync_env.cache = cache;
-	zbx_hashset_create(&dbsync_env.strpool, 100, dbsync_strpool_hash_func, dbsync_strpool_compare_func);
+
+	if (0 == dbsync_env.initialized)
+	{
+		dbsync_env.reconcile_ts = (int)time(NULL);
+		zbx_vector_uint64_pair_create(&dbsync_env.changelog_gaps);
+
+		/* changes are tracked from the last changelog record existing before items are loaded */
+		if (0 != (program_type & ZBX_PROGRAM_TYPE_SERVER))
+			dbsync_env.changelogid = dbsync_get_last_changelogid();
+
+		dbsync_env.initialized = 1;
+	}
+
+	zbx_hashset_create(&dbsync_env.strpool, 100, zbx_strpool_hash_func, zbx_strpool_compare_func);
 }
 
 void	zbx_dbsync_free_env(void)
@@ -286,6 +455,49 @@ void	zbx_dbsync_init(zbx_dbsync_t *sync, unsigned char mode)
 	}
 	else
 		sync->dbresult = NULL;
+
+	sync->prefetch = NULL;
+}
+
+static zbx_dbsync_prefetch_t	*dbsync_prefetch_create(int fd, int worker)
+{
+	zbx_dbsync_prefetch_t	*prefetch;
+
+	prefetch = (zbx_dbsync_prefetch_t *)zbx_malloc(NULL, sizeof(zbx_dbsync_prefetch_t));
+	memset(prefetch, 0, sizeof(zbx_dbsync_prefetch_t));
+	prefetch->state = (-1 == fd ? ZBX_DBSYNC_PREFETCH_READY : ZBX_DBSYNC_PREFETCH_RECEIVING);
+	prefetch->fd = fd;
+	prefetch->worker = worker;
+
+	return prefetch;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees prefetched data after it was retrieved or dropped           *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_prefetch_release(zbx_dbsync_prefetch_t *prefetch)
+{
+	/* data sent by worker is held since its first byte was received */
+	if (-1 != prefetch->worker && 0 != prefetch->data_alloc && 0 < prefetch_env.held_num)
+		prefetch_env.held_num--;
+
+	zbx_free(prefetch->data);
+	prefetch->data_alloc = 0;
+	prefetch->data_offset = 0;
+	prefetch->data_pos = 0;
+}
+
+static void	dbsync_prefetch_free(zbx_dbsync_prefetch_t *prefetch)
+{
+	dbsync_prefetch_release(prefetch);
+
+	if (-1 != prefetch->fd)
+		close(prefetch->fd);
+
+	zbx_free(prefetch->row);
+	zbx_free(prefetch);
 }
 
 /******************************************************************************
@@ -328,6 +540,119 @@ void	zbx_dbsync_clear(zbx_dbsync_t *sync)
 		DBfree_result(sync->dbresult);
 		sync->dbresult = NULL;
 	}
+
+	if (NULL != sync->prefetch)
+	{
+		dbsync_prefetch_free(sync->prefetch);
+		sync->prefetch = NULL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends row to prefetch or snapshot data                          *
+ *                                                                            *
+ * Comments: Each column is encoded as '\0' for NULL or '\1' followed by the  *
+ *           zero terminated string value.                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_row_encode(char **data, size_t *data_alloc, size_t *data_offset, char **row, int columns_num)
+{
+	int	i;
+	size_t	size;
+
+	for (i = 0; i < columns_num; i++)
+	{
+		/* the marker byte and the value with terminating zero */
+		size = 1 + (NULL == row[i] ? 0 : strlen(row[i]) + 1);
+
+		/* zbx_chrcpy_alloc() does not append zero bytes, so the data is copied directly */
+		if (*data_alloc < *data_offset + size)
+		{
+			*data_alloc = MAX(*data_alloc * 2, *data_offset + size);
+			*data = (char *)zbx_realloc(*data, *data_alloc);
+		}
+
+		if (NULL == row[i])
+		{
+			(*data)[(*data_offset)++] = '\0';
+			continue;
+		}
+
+		(*data)[(*data_offset)++] = '\1';
+		memcpy(*data + *data_offset, row[i], size - 1);
+		*data_offset += size - 1;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: decodes row from prefetch or snapshot data                        *
+ *                                                                            *
+ * Parameters: data        - [IN] the encoded data                            *
+ *             data_size   - [IN] the encoded data size                       *
+ *             data_pos    - [IN/OUT] the position of the row in data         *
+ *             row         - [OUT] the row, pointing to the values in data    *
+ *             columns_num - [IN] the number of columns                       *
+ *                                                                            *
+ * Return value: SUCCEED - the row was decoded                                *
+ *               FAIL    - the data is truncated                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_row_decode(char *data, size_t data_size, size_t *data_pos, char **row, int columns_num)
+{
+	int	i;
+	char	*end;
+
+	for (i = 0; i < columns_num; i++)
+	{
+		if (*data_pos >= data_size)
+			return FAIL;
+
+		if ('\0' == data[(*data_pos)++])
+		{
+			row[i] = NULL;
+			continue;
+		}
+
+		if (NULL == (end = (char *)memchr(data + *data_pos, '\0', data_size - *data_pos)))
+			return FAIL;
+
+		row[i] = data + *data_pos;
+		*data_pos = (size_t)(end - data) + 1;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets the next prefetched row                                      *
+ *                                                                            *
+ * Parameters: sync - [IN] the changeset                                      *
+ *                                                                            *
+ * Return value: the row or NULL if there are no more rows                    *
+ *                                                                            *
+ ******************************************************************************/
+static char	**dbsync_prefetch_next(zbx_dbsync_t *sync)
+{
+	zbx_dbsync_prefetch_t	*prefetch = sync->prefetch;
+
+	if (prefetch->data_pos == prefetch->data_offset)
+	{
+		/* free the changeset data as soon as it is retrieved */
+		dbsync_prefetch_release(prefetch);
+		return NULL;
+	}
+
+	if (SUCCEED != dbsync_row_decode(prefetch->data, prefetch->data_offset, &prefetch->data_pos, prefetch->row,
+			sync->columns_num))
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		return NULL;
+	}
+
+	return prefetch->row;
 }
 
 /******************************************************************************
@@ -365,7 +690,12 @@ int	zbx_dbsync_next(zbx_dbsync_t *sync, zbx_uint64_t *rowid, char ***row, unsign
 	{
 		char	**dbrow;
 
-		if (NULL == (dbrow = DBfetch(sync->dbresult)))
+		if (NULL != sync->prefetch)
+			dbrow = dbsync_prefetch_next(sync);
+		else
+			dbrow = DBfetch(sync->dbresult);
+
+		if (NULL == dbrow)
 		{
 			*row = NULL;
 			return FAIL;
@@ -384,644 +714,607 @@ int	zbx_dbsync_next(zbx_dbsync_t *sync, zbx_uint64_t *rowid, char ***row, unsign
 
 /******************************************************************************
  *                                                                            *
- * Purpose: encode serialized expression to be returned as db field           *
- *                                                                            *
- * Parameter: sync - [OUT] the changeset                                      *
- *                                                                            *
- * Return value: SUCCEED - the changeset was successfully calculated          *
- *               FAIL    - otherwise                                          *
+ * Purpose: writes data to pipe                                               *
  *                                                                            *
  ******************************************************************************/
-static char	*encode_expression(const zbx_eval_context_t *ctx)
+static int	dbsync_prefetch_write(int fd, const char *data, size_t size)
 {
-	unsigned char	*data;
-	size_t		len;
-	char		*str = NULL;
+	ssize_t	n;
 
-	len = zbx_eval_serialize(ctx, NULL, &data);
-	str_base64_encode_dyn((const char *)data, &str, len);
-	zbx_free(data);
+	while (0 != size)
+	{
+		if (-1 == (n = write(fd, data, size)))
+		{
+			if (EINTR == errno)
+				continue;
 
-	return str;
+			zabbix_log(LOG_LEVEL_WARNING, "cannot send prefetched configuration data: %s",
+					zbx_strerror(errno));
+			return FAIL;
+		}
+
+		data += n;
+		size -= (size_t)n;
+	}
+
+	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compare serialized expression                                     *
+ * Purpose: selects changeset rows and sends them to pipe (prefetch worker)   *
  *                                                                            *
- * Parameter: col   - [IN] the base64 encoded expression                      *
- *            data2 - [IN] the serialized expression in cache                 *
+ * Parameters: sync         - [IN] the changeset                              *
+ *             compare_func - [IN] the changeset compare function             *
+ *             fd           - [IN] the pipe write end                         *
  *                                                                            *
- * Return value: SUCCEED - the expressions are identical                      *
+ * Return value: SUCCEED - the rows were sent successfully                    *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_serialized_expression(const char *col, const unsigned char *data2)
+static int	dbsync_prefetch_send(zbx_dbsync_t *sync, zbx_dbsync_compare_func_t compare_func, int fd)
 {
-	zbx_uint32_t	offset1, len1, offset2, len2;
-	unsigned char	*data1;
-	int		col_len, data1_len, ret = FAIL;
-
-	if (NULL == data2)
-	{
-		if (NULL == col || '\0' == *col)
-			return SUCCEED;
-		return FAIL;
-	}
+	zbx_dbsync_prefetch_header_t	header;
+	DB_ROW				dbrow;
+	char				*buf;
+	size_t				buf_alloc = ZBX_DBSYNC_PREFETCH_BUFFER_SIZE, buf_offset = 0;
+	int				ret = FAIL;
 
-	if (NULL == col || '\0' == *col)
+	if (SUCCEED != compare_func(sync))
 		return FAIL;
 
-	col_len = strlen(col);
-	data1 = zbx_malloc(NULL, col_len);
+	memset(&header, 0, sizeof(header));
+	header.columns_num = sync->columns_num;
+	header.preproc_row_func = sync->preproc_row_func;
 
-	str_base64_decode(col, (char *)data1, col_len, &data1_len);
+	buf = (char *)zbx_malloc(NULL, buf_alloc);
+	memcpy(buf, &header, sizeof(header));
+	buf_offset = sizeof(header);
 
-	offset1 = zbx_deserialize_uint31_compact((const unsigned char *)data1, &len1);
-	offset2 = zbx_deserialize_uint31_compact((const unsigned char *)data2, &len2);
+	while (NULL != (dbrow = DBfetch(sync->dbresult)))
+	{
+		dbsync_row_encode(&buf, &buf_alloc, &buf_offset, dbrow, sync->columns_num);
 
-	if (offset1 != offset2 || len1 != len2)
-		goto out;
+		if (ZBX_DBSYNC_PREFETCH_BUFFER_SIZE <= buf_offset)
+		{
+			if (SUCCEED != dbsync_prefetch_write(fd, buf, buf_offset))
+				goto out;
 
-	if (0 != memcmp(data1 + offset1, data2 + offset2, len1))
-		goto out;
+			buf_offset = 0;
+		}
+	}
 
-	ret = SUCCEED;
+	zbx_chrcpy_alloc(&buf, &buf_alloc, &buf_offset, ZBX_DBSYNC_PREFETCH_END);
+	ret = dbsync_prefetch_write(fd, buf, buf_offset);
 out:
-	zbx_free(data1);
+	zbx_free(buf);
 
 	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares config table with cached configuration data              *
+ * Purpose: selects the assigned changesets and sends their rows to the       *
+ *          configuration syncer (prefetch worker process)                    *
  *                                                                            *
- * Parameter: sync - [OUT] the changeset                                      *
+ * Parameters: syncs         - [IN] the changesets                            *
+ *             compare_funcs - [IN] the changeset compare functions           *
+ *             fds           - [IN] the pipe read and write ends of each      *
+ *                                  changeset                                 *
+ *             syncs_num     - [IN] the number of changesets                  *
+ *             worker        - [IN] the worker index                          *
+ *             workers_num   - [IN] the number of workers                     *
  *                                                                            *
- * Return value: SUCCEED - the changeset was successfully calculated          *
- *               FAIL    - otherwise                                          *
+ * Comments: This function never returns.                                     *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_config(zbx_dbsync_t *sync)
+static void	dbsync_prefetch_worker(zbx_dbsync_t **syncs, zbx_dbsync_compare_func_t *compare_funcs, int (*fds)[2],
+		int syncs_num, int worker, int workers_num)
 {
-	DB_RESULT	result;
-
-#define SELECTED_CONFIG_FIELD_COUNT	33	/* number of columns in the following DBselect() */
+	int	i, ret = SUCCEED;
 
-	if (NULL == (result = DBselect("select discovery_groupid,snmptrap_logging,"
-				"severity_name_0,severity_name_1,severity_name_2,"
-				"severity_name_3,severity_name_4,severity_name_5,"
-				"hk_events_mode,hk_events_trigger,hk_events_internal,"
-				"hk_events_discovery,hk_events_autoreg,hk_services_mode,"
-				"hk_services,hk_audit_mode,hk_audit,hk_sessions_mode,hk_sessions,"
-				"hk_history_mode,hk_history_global,hk_history,hk_trends_mode,"
-				"hk_trends_global,hk_trends,default_inventory_mode,db_extension,autoreg_tls_accept,"
-				"compression_status,compress_older,instanceid,default_timezone,hk_events_service,"
-				"auditlog_enabled"
-			" from config"
-			" order by configid")))	/* if you change number of columns in DBselect(), */
-						/* adjust SELECTED_CONFIG_FIELD_COUNT */
+	for (i = 0; i < syncs_num; i++)
 	{
-		return FAIL;
+		close(fds[i][0]);
+
+		if (worker != i % workers_num)
+			close(fds[i][1]);
 	}
 
-	dbsync_prepare(sync, SELECTED_CONFIG_FIELD_COUNT, NULL);
+	/* exit without running the atexit handlers inherited from configuration syncer */
+	if (ZBX_DB_OK != DBconnect(ZBX_DB_CONNECT_ONCE))
+		_exit(EXIT_FAILURE);
 
-	if (ZBX_DBSYNC_INIT == sync->mode)
+	for (i = worker; i < syncs_num; i += workers_num)
 	{
-		sync->dbresult = result;
-		return SUCCEED;
-	}
+		if (SUCCEED == ret)
+			ret = dbsync_prefetch_send(syncs[i], compare_funcs[i], fds[i][1]);
 
-	DBfree_result(result);
+		close(fds[i][1]);
+	}
 
-	/* global configuration will be always synchronized directly with database */
-	THIS_SHOULD_NEVER_HAPPEN;
+	DBclose();
 
-	return FAIL;
-#undef SELECTED_CONFIG_FIELD_COUNT
+	_exit(SUCCEED == ret ? EXIT_SUCCESS : EXIT_FAILURE);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares 'config_autoreg_tls' table with cached configuration     *
- *          data                                                              *
+ * Purpose: reads prefetched data from pipe                                   *
  *                                                                            *
- * Parameter: sync - [OUT] the changeset                                      *
- *                                                                            *
- * Return value: SUCCEED - the changeset was successfully calculated          *
- *               FAIL    - otherwise                                          *
- *                                                                            *
- * Comments:                                                                  *
- *     On success this function produces a changeset with 0 or 1 record       *
- *     because 'config_autoreg_tls' table can have no more than 1 record.     *
- *     If in future you want to support multiple autoregistration PSKs and/or *
- *     select more columns in DBselect() then do not forget to sync changes   *
- *     with DCsync_autoreg_config() !!!                                       *
+ * Return value: the number of bytes read, 0 at the end of data or -1 on      *
+ *               error                                                        *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_autoreg_psk(zbx_dbsync_t *sync)
+static ssize_t	dbsync_prefetch_read(zbx_dbsync_prefetch_t *prefetch)
 {
-	DB_RESULT	result;
-	DB_ROW		dbrow;
-	int		num_records = 0;
+	ssize_t	n;
 
-#define CONFIG_AUTOREG_TLS_FIELD_COUNT	2	/* number of columns in the following DBselect() */
-
-	if (NULL == (result = DBselect("select tls_psk_identity,tls_psk"
-			" from config_autoreg_tls"
-			" order by autoreg_tlsid")))	/* if you change number of columns in DBselect(), */
-							/* adjust CONFIG_AUTOREG_TLS_FIELD_COUNT */
+	if (prefetch->data_alloc - prefetch->data_offset < ZBX_DBSYNC_PREFETCH_BUFFER_SIZE)
 	{
-		return FAIL;
-	}
+		if (0 == prefetch->data_alloc)
+			prefetch_env.held_num++;
 
-	dbsync_prepare(sync, CONFIG_AUTOREG_TLS_FIELD_COUNT, NULL);
-
-	if (ZBX_DBSYNC_INIT == sync->mode)
-	{
-		sync->dbresult = result;
-		return SUCCEED;
+		prefetch->data_alloc = MAX(prefetch->data_alloc * 2, ZBX_DBSYNC_PREFETCH_BUFFER_SIZE);
+		prefetch->data = (char *)zbx_realloc(prefetch->data, prefetch->data_alloc);
 	}
 
-	/* 0 or 1 records are expected */
+	while (-1 == (n = read(prefetch->fd, prefetch->data + prefetch->data_offset,
+			prefetch->data_alloc - prefetch->data_offset)) && EINTR == errno)
+		;
 
-	if (NULL != (dbrow = DBfetch(result)))
-	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
+	if (0 < n)
+		prefetch->data_offset += (size_t)n;
 
-		if ('\0' == dbsync_env.cache->autoreg_psk_identity[0])	/* no autoregistration PSK in cache */
-		{
-			tag = ZBX_DBSYNC_ROW_ADD;
-		}
-		else if (FAIL == dbsync_compare_str(dbrow[0], dbsync_env.cache->autoreg_psk_identity) ||
-				FAIL == dbsync_compare_str(dbrow[1], dbsync_env.cache->autoreg_psk))
-		{
-			tag = ZBX_DBSYNC_ROW_UPDATE;
-		}
+	return n;
+}
 
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, 0, tag, dbrow);	/* fictitious rowid 0 is used, there is only 1 record */
+/******************************************************************************
+ *                                                                            *
+ * Purpose: closes pipe of prefetched changeset and checks if all its data    *
+ *          was received                                                      *
+ *                                                                            *
+ * Parameters: prefetch - [IN/OUT] the prefetched changeset                   *
+ *             ret      - [IN] SUCCEED - the end of data was reached          *
+ *                             FAIL    - the data could not be read           *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_prefetch_close(zbx_dbsync_prefetch_t *prefetch, int ret)
+{
+	close(prefetch->fd);
+	prefetch->fd = -1;
 
-		num_records = 1;
+	/* worker sends the end marker only after all rows were selected and sent successfully */
+	if (SUCCEED == ret && sizeof(zbx_dbsync_prefetch_header_t) < prefetch->data_offset &&
+			ZBX_DBSYNC_PREFETCH_END == prefetch->data[prefetch->data_offset - 1])
+	{
+		prefetch->data_offset--;
+		prefetch->state = ZBX_DBSYNC_PREFETCH_RECEIVED;
+		return;
 	}
-	else if ('\0' != dbsync_env.cache->autoreg_psk_identity[0])
-			dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_REMOVE, NULL);
-
-	if (1 == num_records && NULL != DBfetch(result))
-		zabbix_log(LOG_LEVEL_ERR, "table 'config_autoreg_tls' has multiple records");
 
-	DBfree_result(result);
-
-	return SUCCEED;
-#undef CONFIG_AUTOREG_TLS_FIELD_COUNT
+	prefetch->state = ZBX_DBSYNC_PREFETCH_FAILED;
+	dbsync_prefetch_release(prefetch);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares hosts table row with cached configuration data           *
+ * Purpose: receives prefetched data until all rows of the specified          *
+ *          changeset are received                                            *
  *                                                                            *
- * Parameter: host  - [IN] the cached host                                    *
- *            dbrow - [IN] the database row                                   *
+ * Parameters: sync - [IN/OUT] the changeset                                  *
  *                                                                            *
- * Return value: SUCCEED - the row matches configuration data                 *
- *               FAIL    - otherwise                                          *
+ * Comments: Data of other changesets is received at the same time to keep    *
+ *           workers running, but only while the number of changesets held    *
+ *           in memory does not exceed the number of workers. Changesets sent *
+ *           by the same worker before the required one are always received,  *
+ *           otherwise the worker would be blocked by the full pipe.          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_host(ZBX_DC_HOST *host, const DB_ROW dbrow)
+static void	dbsync_prefetch_receive(zbx_dbsync_t *sync)
 {
-	signed char	ipmi_authtype;
-	unsigned char	ipmi_privilege;
-	ZBX_DC_IPMIHOST	*ipmihost;
-	ZBX_DC_PROXY	*proxy;
+	struct pollfd		*pollfds;
+	zbx_dbsync_prefetch_t	**prefetches;
+	int			i, fds_num, held_num, target = 0;
 
-	if (FAIL == dbsync_compare_uint64(dbrow[1], host->proxy_hostid))
-	{
-		host->update_items = 1;
-		return FAIL;
-	}
+	pollfds = (struct pollfd *)zbx_malloc(NULL, sizeof(struct pollfd) * (size_t)prefetch_env.syncs_num);
+	prefetches = (zbx_dbsync_prefetch_t **)zbx_malloc(NULL, sizeof(zbx_dbsync_prefetch_t *) *
+			(size_t)prefetch_env.syncs_num);
 
-	if (FAIL == dbsync_compare_uchar(dbrow[10], host->status))
+	for (i = 0; i < prefetch_env.syncs_num; i++)
 	{
-		host->update_items = 1;
-		return FAIL;
+		if (prefetch_env.syncs[i] == sync)
+			target = i;
 	}
 
-	host->update_items = 0;
-
-	if (FAIL == dbsync_compare_str(dbrow[2], host->host))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_str(dbrow[11], host->name))
-		return FAIL;
-
-#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
-	if (FAIL == dbsync_compare_str(dbrow[15], host->tls_issuer))
-		return FAIL;
+	while (-1 != sync->prefetch->fd)
+	{
+		held_num = prefetch_env.held_num;
 
-	if (FAIL == dbsync_compare_str(dbrow[16], host->tls_subject))
-		return FAIL;
+		for (i = 0, fds_num = 0; i < prefetch_env.syncs_num; i++)
+		{
+			zbx_dbsync_prefetch_t	*prefetch = prefetch_env.syncs[i]->prefetch;
 
-	if ('\0' == *dbrow[17] || '\0' == *dbrow[18])
-	{
-		if (NULL != host->tls_dc_psk)
-			return FAIL;
-	}
-	else
-	{
-		if (NULL == host->tls_dc_psk)
-			return FAIL;
+			if (NULL == prefetch || -1 == prefetch->fd)
+				continue;
 
-		if (FAIL == dbsync_compare_str(dbrow[17], host->tls_dc_psk->tls_psk_identity))
-			return FAIL;
+			if (i != target && 0 == prefetch->data_alloc &&
+					(prefetch->worker != sync->prefetch->worker || i > target))
+			{
+				if (held_num >= prefetch_env.workers_num)
+					continue;
 
-		if (FAIL == dbsync_compare_str(dbrow[18], host->tls_dc_psk->tls_psk))
-			return FAIL;
-	}
+				held_num++;
+			}
 
-#endif
-	if (FAIL == dbsync_compare_uchar(dbrow[13], host->tls_connect))
-		return FAIL;
+			pollfds[fds_num].fd = prefetch->fd;
+			pollfds[fds_num].events = POLLIN;
+			prefetches[fds_num++] = prefetch;
+		}
 
-	if (FAIL == dbsync_compare_uchar(dbrow[14], host->tls_accept))
-		return FAIL;
+		if (-1 == poll(pollfds, (nfds_t)fds_num, -1))
+		{
+			if (EINTR == errno)
+				continue;
 
-	/* IPMI hosts */
+			zabbix_log(LOG_LEVEL_WARNING, "cannot wait for prefetched configuration data: %s",
+					zbx_strerror(errno));
 
-	ipmi_authtype = (signed char)atoi(dbrow[3]);
-	ipmi_privilege = (unsigned char)atoi(dbrow[4]);
+			for (i = 0; i < fds_num; i++)
+				dbsync_prefetch_close(prefetches[i], FAIL);
 
-	if (ZBX_IPMI_DEFAULT_AUTHTYPE != ipmi_authtype || ZBX_IPMI_DEFAULT_PRIVILEGE != ipmi_privilege ||
-			'\0' != *dbrow[5] || '\0' != *dbrow[6])	/* useipmi */
-	{
-		if (NULL == (ipmihost = (ZBX_DC_IPMIHOST *)zbx_hashset_search(&dbsync_env.cache->ipmihosts,
-				&host->hostid)))
-		{
-			return FAIL;
+			break;
 		}
 
-		if (ipmihost->ipmi_authtype != ipmi_authtype)
-			return FAIL;
-
-		if (ipmihost->ipmi_privilege != ipmi_privilege)
-			return FAIL;
+		for (i = 0; i < fds_num; i++)
+		{
+			ssize_t	n;
 
-		if (FAIL == dbsync_compare_str(dbrow[5], ipmihost->ipmi_username))
-			return FAIL;
+			if (0 == pollfds[i].revents)
+				continue;
 
-		if (FAIL == dbsync_compare_str(dbrow[6], ipmihost->ipmi_password))
-			return FAIL;
-	}
-	else if (NULL != zbx_hashset_search(&dbsync_env.cache->ipmihosts, &host->hostid))
-		return FAIL;
+			if (0 < (n = dbsync_prefetch_read(prefetches[i])))
+				continue;
 
-	/* proxies */
-	if (NULL != (proxy = (ZBX_DC_PROXY *)zbx_hashset_search(&dbsync_env.cache->proxies, &host->hostid)))
-	{
-		if (FAIL == dbsync_compare_str(dbrow[15 + ZBX_HOST_TLS_OFFSET], proxy->proxy_address))
-			return FAIL;
+			if (-1 == n)
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "cannot read prefetched configuration data: %s",
+						zbx_strerror(errno));
+			}
 
-		if (FAIL == dbsync_compare_uchar(dbrow[16 + ZBX_HOST_TLS_OFFSET], proxy->auto_compress))
-			return FAIL;
+			dbsync_prefetch_close(prefetches[i], 0 == n ? SUCCEED : FAIL);
+		}
 	}
 
-	return SUCCEED;
+	zbx_free(prefetches);
+	zbx_free(pollfds);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares hosts table with cached configuration data               *
- *          and populates the changeset                                       *
+ * Purpose: starts loading changesets in parallel for the initial             *
+ *          synchronization                                                   *
  *                                                                            *
- * Parameter: sync - [OUT] the changeset                                      *
+ * Parameters: syncs         - [IN/OUT] the changesets, initialized in        *
+ *                                      ZBX_DBSYNC_INIT mode                  *
+ *             compare_funcs - [IN] the changeset compare functions           *
+ *             syncs_num     - [IN] the number of changesets                  *
+ *             workers_num   - [IN] the number of worker processes            *
  *                                                                            *
- * Return value: SUCCEED - the changeset was successfully calculated          *
- *               FAIL    - otherwise                                          *
+ * Comments: The changesets are distributed between worker processes, each    *
+ *           having its own database connection. Workers send the selected    *
+ *           rows through pipes and the rows are received by                  *
+ *           zbx_dbsync_compare() when the changeset is needed.               *
+ *           The database connection of the calling process is closed while   *
+ *           workers are started.                                             *
+ *           If worker fails its changesets are loaded by the compare         *
+ *           functions as usual.                                              *
+ *                                                                            *
+ * Return value: SUCCEED - the changesets are being prefetched or left for    *
+ *                         loading by the compare functions                   *
+ *               FAIL    - the database connection was not re-established     *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_hosts(zbx_dbsync_t *sync)
+static int	dbsync_prefetch(zbx_dbsync_t **syncs, zbx_dbsync_compare_func_t *compare_funcs, int syncs_num,
+		int workers_num)
 {
-	DB_ROW			dbrow;
-	DB_RESULT		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	ZBX_DC_HOST		*host;
+	int	i, open_num = 0, ret = SUCCEED, (*fds)[2];
 
-#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
-	if (NULL == (result = DBselect(
-			"select hostid,proxy_hostid,host,ipmi_authtype,ipmi_privilege,ipmi_username,"
-				"ipmi_password,maintenance_status,maintenance_type,maintenance_from,"
-				"status,name,lastaccess,tls_connect,tls_accept,tls_issuer,tls_subject,"
-				"tls_psk_identity,tls_psk,proxy_address,auto_compress,maintenanceid"
-			" from hosts"
-			" where status in (%d,%d,%d,%d)"
-				" and flags<>%d",
-			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED,
-			HOST_STATUS_PROXY_ACTIVE, HOST_STATUS_PROXY_PASSIVE,
-			ZBX_FLAG_DISCOVERY_PROTOTYPE)))
-	{
-		return FAIL;
-	}
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() syncs:%d workers:%d", __func__, syncs_num, workers_num);
 
-	dbsync_prepare(sync, 22, NULL);
-#else
-	if (NULL == (result = DBselect(
-			"select hostid,proxy_hostid,host,ipmi_authtype,ipmi_privilege,ipmi_username,"
-				"ipmi_password,maintenance_status,maintenance_type,maintenance_from,"
-				"status,name,lastaccess,tls_connect,tls_accept,"
-				"proxy_address,auto_compress,maintenanceid"
-			" from hosts"
-			" where status in (%d,%d,%d,%d)"
-				" and flags<>%d",
-			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED,
-			HOST_STATUS_PROXY_ACTIVE, HOST_STATUS_PROXY_PASSIVE,
-			ZBX_FLAG_DISCOVERY_PROTOTYPE)))
-	{
-		return FAIL;
-	}
+	if (workers_num > syncs_num)
+		workers_num = syncs_num;
 
-	dbsync_prepare(sync, 18, NULL);
-#endif
+	fds = (int (*)[2])zbx_malloc(NULL, sizeof(int[2]) * (size_t)syncs_num);
 
-	if (ZBX_DBSYNC_INIT == sync->mode)
+	for (; open_num < syncs_num; open_num++)
 	{
-		sync->dbresult = result;
-		return SUCCEED;
+		if (-1 == pipe(fds[open_num]))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot create pipe: %s", zbx_strerror(errno));
+			zabbix_log(LOG_LEVEL_WARNING, "cannot load configuration in parallel, falling back to"
+					" sequential loading");
+
+			for (i = 0; i < open_num; i++)
+			{
+				close(fds[i][0]);
+				close(fds[i][1]);
+			}
+
+			goto out;
+		}
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->hosts.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	prefetch_env.syncs = (zbx_dbsync_t **)zbx_malloc(NULL, sizeof(zbx_dbsync_t *) * (size_t)syncs_num);
+	memcpy(prefetch_env.syncs, syncs, sizeof(zbx_dbsync_t *) * (size_t)syncs_num);
+	prefetch_env.syncs_num = syncs_num;
+	prefetch_env.pids = (pid_t *)zbx_malloc(NULL, sizeof(pid_t) * (size_t)workers_num);
+	prefetch_env.workers_num = workers_num;
+	prefetch_env.held_num = 0;
 
-	while (NULL != (dbrow = DBfetch(result)))
-	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
+	for (i = 0; i < syncs_num; i++)
+		syncs[i]->prefetch = dbsync_prefetch_create(fds[i][0], i % workers_num);
 
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
+	/* workers must not share the database connection */
+	DBclose();
 
-		if (NULL == (host = (ZBX_DC_HOST *)zbx_hashset_search(&dbsync_env.cache->hosts, &rowid)))
-			tag = ZBX_DBSYNC_ROW_ADD;
-		else if (FAIL == dbsync_compare_host(host, dbrow))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
+	for (i = 0; i < workers_num; i++)
+	{
+		/* plain fork, configuration syncer is not the main process */
+		prefetch_env.pids[i] = zbx_fork();
 
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
+		if (0 == prefetch_env.pids[i])
+			dbsync_prefetch_worker(syncs, compare_funcs, fds, syncs_num, i, workers_num);
+
+		if (-1 == prefetch_env.pids[i])
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot start configuration prefetch worker: %s",
+					zbx_strerror(errno));
+		}
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->hosts, &iter);
-	while (NULL != (host = (ZBX_DC_HOST *)zbx_hashset_iter_next(&iter)))
+	/* the changesets of failed workers are received as empty and loaded sequentially */
+	for (i = 0; i < syncs_num; i++)
+		close(fds[i][1]);
+
+	if (ZBX_DB_OK != DBconnect(ZBX_DB_CONNECT_NORMAL))
 	{
-		if (NULL == zbx_hashset_search(&ids, &host->hostid))
-			dbsync_add_row(sync, host->hostid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		zabbix_log(LOG_LEVEL_WARNING, "cannot reconnect to the database after starting configuration"
+				" prefetch workers");
+		ret = FAIL;
 	}
+out:
+	zbx_free(fds);
 
-	zbx_hashset_destroy(&ids);
-	DBfree_result(result);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
-	return SUCCEED;
+	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares host inventory table row with cached configuration data  *
+ * Purpose: starts loading changesets in parallel for the initial             *
+ *          synchronization, skipping the changesets already loaded from      *
+ *          snapshot                                                          *
  *                                                                            *
- * Parameter: hi    - [IN] the cached host inventory data                     *
- *            dbrow - [IN] the database row                                   *
+ * Parameters: syncs         - [IN/OUT] the changesets, initialized in        *
+ *                                      ZBX_DBSYNC_INIT mode                  *
+ *             compare_funcs - [IN] the changeset compare functions           *
+ *             syncs_num     - [IN] the number of changesets                  *
+ *             workers_num   - [IN] the number of worker processes            *
  *                                                                            *
- * Return value: SUCCEED - the row matches configuration data                 *
- *               FAIL    - otherwise                                          *
+ * Return value: SUCCEED - the changesets are being prefetched or left for    *
+ *                         loading by the compare functions                   *
+ *               FAIL    - the database connection was lost                   *
+ *                                                                            *
+ * Comments: The changesets must be listed in the order they are compared by  *
+ *           zbx_dbsync_compare(). zbx_dbsync_prefetch_finish() must be       *
+ *           called after the changesets were compared.                       *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_host_inventory(const ZBX_DC_HOST_INVENTORY *hi, const DB_ROW dbrow)
+int	zbx_dbsync_prefetch(zbx_dbsync_t **syncs, zbx_dbsync_compare_func_t *compare_funcs, int syncs_num,
+		int workers_num)
 {
-	int	i;
+	zbx_dbsync_t			**load_syncs;
+	zbx_dbsync_compare_func_t	*load_funcs;
+	int				i, load_num = 0, ret = SUCCEED;
 
-	if (SUCCEED != dbsync_compare_uchar(dbrow[1], hi->inventory_mode))
-		return FAIL;
+	load_syncs = (zbx_dbsync_t **)zbx_malloc(NULL, sizeof(zbx_dbsync_t *) * (size_t)syncs_num);
+	load_funcs = (zbx_dbsync_compare_func_t *)zbx_malloc(NULL, sizeof(zbx_dbsync_compare_func_t) *
+			(size_t)syncs_num);
 
-	for (i = 0; i < HOST_INVENTORY_FIELD_COUNT; i++)
+	for (i = 0; i < syncs_num; i++)
 	{
-		if (FAIL == dbsync_compare_str(dbrow[i + 2], hi->values[i]))
-			return FAIL;
+		if (NULL != syncs[i]->prefetch)
+			continue;
+
+		load_syncs[load_num] = syncs[i];
+		load_funcs[load_num++] = compare_funcs[i];
 	}
 
-	return SUCCEED;
+	if (0 != load_num)
+		ret = dbsync_prefetch(load_syncs, load_funcs, load_num, workers_num);
+
+	zbx_free(load_funcs);
+	zbx_free(load_syncs);
+
+	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares host_inventory table with cached configuration data      *
+ * Purpose: stops receiving prefetched changesets and waits for prefetch      *
+ *          workers to exit                                                   *
  *                                                                            *
- * Parameter: sync - [OUT] the changeset                                      *
- *                                                                            *
- * Return value: SUCCEED - the changeset was successfully calculated          *
- *               FAIL    - otherwise                                          *
+ * Comments: The changesets not received yet are loaded by the compare        *
+ *           functions if compared later.                                     *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_host_inventory(zbx_dbsync_t *sync)
+void	zbx_dbsync_prefetch_finish(void)
 {
-	DB_ROW			dbrow;
-	DB_RESULT		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	ZBX_DC_HOST_INVENTORY	*hi;
-	const char		*sql;
-
-	sql = "select hostid,inventory_mode,type,type_full,name,alias,os,os_full,os_short,serialno_a,"
-			"serialno_b,tag,asset_tag,macaddress_a,macaddress_b,hardware,hardware_full,software,"
-			"software_full,software_app_a,software_app_b,software_app_c,software_app_d,"
-			"software_app_e,contact,location,location_lat,location_lon,notes,chassis,model,"
-			"hw_arch,vendor,contract_number,installer_name,deployment_status,url_a,url_b,"
-			"url_c,host_networks,host_netmask,host_router,oob_ip,oob_netmask,oob_router,"
-			"date_hw_purchase,date_hw_install,date_hw_expiry,date_hw_decomm,site_address_a,"
-			"site_address_b,site_address_c,site_city,site_state,site_country,site_zip,site_rack,"
-			"site_notes,poc_1_name,poc_1_email,poc_1_phone_a,poc_1_phone_b,poc_1_cell,"
-			"poc_1_screen,poc_1_notes,poc_2_name,poc_2_email,poc_2_phone_a,poc_2_phone_b,"
-			"poc_2_cell,poc_2_screen,poc_2_notes"
-			" from host_inventory";
+	int	i, status;
 
-	if (NULL == (result = DBselect("%s", sql)))
-		return FAIL;
+	if (NULL == prefetch_env.syncs)
+		return;
 
-	dbsync_prepare(sync, 72, NULL);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	if (ZBX_DBSYNC_INIT == sync->mode)
+	for (i = 0; i < prefetch_env.syncs_num; i++)
 	{
-		sync->dbresult = result;
-		return SUCCEED;
-	}
+		zbx_dbsync_prefetch_t	*prefetch = prefetch_env.syncs[i]->prefetch;
 
-	zbx_hashset_create(&ids, dbsync_env.cache->host_inventories.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		if (NULL != prefetch && -1 != prefetch->fd)
+			dbsync_prefetch_close(prefetch, FAIL);
+	}
 
-	while (NULL != (dbrow = DBfetch(result)))
+	/* workers still sending data exit on the closed pipes */
+	for (i = 0; i < prefetch_env.workers_num; i++)
 	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
-
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
-
-		if (NULL == (hi = (ZBX_DC_HOST_INVENTORY *)zbx_hashset_search(&dbsync_env.cache->host_inventories,
-				&rowid)))
-		{
-			tag = ZBX_DBSYNC_ROW_ADD;
-		}
-		else if (FAIL == dbsync_compare_host_inventory(hi, dbrow))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
+		pid_t	pid;
 
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
+		if (-1 == prefetch_env.pids[i])
+			continue;
 
-	}
+		while (-1 == (pid = waitpid(prefetch_env.pids[i], &status, 0)) && EINTR == errno)
+			;
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->host_inventories, &iter);
-	while (NULL != (hi = (ZBX_DC_HOST_INVENTORY *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL == zbx_hashset_search(&ids, &hi->hostid))
-			dbsync_add_row(sync, hi->hostid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (-1 == pid || !WIFEXITED(status) || EXIT_SUCCESS != WEXITSTATUS(status))
+			zabbix_log(LOG_LEVEL_DEBUG, "configuration prefetch worker #%d did not complete", i + 1);
 	}
 
-	zbx_hashset_destroy(&ids);
-	DBfree_result(result);
+	zbx_free(prefetch_env.pids);
+	zbx_free(prefetch_env.syncs);
+	memset(&prefetch_env, 0, sizeof(prefetch_env));
 
-	return SUCCEED;
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares hosts_templates table with cached configuration data     *
+ * Purpose: calculates changeset unless it was already prefetched             *
  *                                                                            *
- * Parameter: sync - [OUT] the changeset                                      *
+ * Parameters: sync         - [IN/OUT] the changeset                          *
+ *             compare_func - [IN] the changeset compare function             *
  *                                                                            *
  * Return value: SUCCEED - the changeset was successfully calculated          *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: Prefetched changeset is received from worker first. If worker    *
+ *           failed to send it, the changeset is loaded by compare function.  *
+ *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_host_templates(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare(zbx_dbsync_t *sync, zbx_dbsync_compare_func_t compare_func)
 {
-	DB_ROW			dbrow;
-	DB_RESULT		result;
-	zbx_hashset_iter_t	iter;
-	ZBX_DC_HTMPL		*htmpl;
-	zbx_hashset_t		htmpls;
-	int			i;
-	zbx_uint64_pair_t	ht_local, *ht;
-	char			hostid_s[MAX_ID_LEN + 1], templateid_s[MAX_ID_LEN + 1];
-	char			*del_row[2] = {hostid_s, templateid_s};
+	zbx_dbsync_prefetch_t		*prefetch = sync->prefetch;
+	zbx_dbsync_prefetch_header_t	header;
 
-	if (NULL == (result = DBselect(
-			"select hostid,templateid"
-			" from hosts_templates"
-			" order by hostid")))
-	{
-		return FAIL;
-	}
+	if (NULL == prefetch)
+		return compare_func(sync);
 
-	dbsync_prepare(sync, 2, NULL);
+	if (ZBX_DBSYNC_PREFETCH_RECEIVING == prefetch->state)
+		dbsync_prefetch_receive(sync);
 
-	if (ZBX_DBSYNC_INIT == sync->mode)
+	if (ZBX_DBSYNC_PREFETCH_FAILED == prefetch->state)
 	{
-		sync->dbresult = result;
-		return SUCCEED;
-	}
+		zabbix_log(LOG_LEVEL_WARNING, "cannot load configuration table in parallel, falling back to"
+				" sequential loading");
 
-	zbx_hashset_create(&htmpls, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
-
-	/* index all host->template links */
-	zbx_hashset_iter_reset(&dbsync_env.cache->htmpls, &iter);
-	while (NULL != (htmpl = (ZBX_DC_HTMPL *)zbx_hashset_iter_next(&iter)))
-	{
-		ht_local.first = htmpl->hostid;
+		dbsync_prefetch_free(prefetch);
+		sync->prefetch = NULL;
 
-		for (i = 0; i < htmpl->templateids.values_num; i++)
-		{
-			ht_local.second = htmpl->templateids.values[i];
-			zbx_hashset_insert(&htmpls, &ht_local, sizeof(ht_local));
-		}
+		return compare_func(sync);
 	}
 
-	/* add new rows, remove existing rows from index */
-	while (NULL != (dbrow = DBfetch(result)))
+	if (ZBX_DBSYNC_PREFETCH_RECEIVED == prefetch->state)
 	{
-		ZBX_STR2UINT64(ht_local.first, dbrow[0]);
-		ZBX_STR2UINT64(ht_local.second, dbrow[1]);
+		memcpy(&header, prefetch->data, sizeof(header));
+		dbsync_prepare(sync, header.columns_num, header.preproc_row_func);
 
-		if (NULL == (ht = (zbx_uint64_pair_t *)zbx_hashset_search(&htmpls, &ht_local)))
-			dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_ADD, dbrow);
-		else
-			zbx_hashset_remove_direct(&htmpls, ht);
-	}
+		prefetch->data_pos = sizeof(header);
+		prefetch->row = (char **)zbx_malloc(NULL, sizeof(char *) * (size_t)header.columns_num);
+		prefetch->state = ZBX_DBSYNC_PREFETCH_READY;
 
-	/* add removed rows */
-	zbx_hashset_iter_reset(&htmpls, &iter);
-	while (NULL != (ht = (zbx_uint64_pair_t *)zbx_hashset_iter_next(&iter)))
-	{
-		zbx_snprintf(hostid_s, sizeof(hostid_s), ZBX_FS_UI64, ht->first);
-		zbx_snprintf(templateid_s, sizeof(templateid_s), ZBX_FS_UI64, ht->second);
-		dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_REMOVE, del_row);
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() prefetched size:" ZBX_FS_SIZE_T " held:%d", __func__,
+				(zbx_fs_size_t)prefetch->data_offset, prefetch_env.held_num);
 	}
 
-	DBfree_result(result);
-	zbx_hashset_destroy(&htmpls);
-
 	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares global macro table row with cached configuration data    *
+ * Purpose: encode serialized expression to be returned as db field           *
  *                                                                            *
- * Parameter: gmacro - [IN] the cached global macro data                      *
- *            dbrow    - [IN] the database row                                *
+ * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
- * Return value: SUCCEED - the row matches configuration data                 *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_global_macro(const ZBX_DC_GMACRO *gmacro, const DB_ROW dbrow)
+static char	*encode_expression(const zbx_eval_context_t *ctx)
 {
-	char	*macro = NULL, *context = NULL;
-	int	ret = FAIL;
+	unsigned char	*data;
+	size_t		len;
+	char		*str = NULL;
 
-	if (FAIL == dbsync_compare_uchar(dbrow[3], gmacro->type))
-		return FAIL;
+	len = zbx_eval_serialize(ctx, NULL, &data);
+	str_base64_encode_dyn((const char *)data, &str, len);
+	zbx_free(data);
 
-	if (FAIL == dbsync_compare_str(dbrow[2], gmacro->value))
+	return str;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compare serialized expression                                     *
+ *                                                                            *
+ * Parameter: col   - [IN] the base64 encoded expression                      *
+ *            data2 - [IN] the serialized expression in cache                 *
+ *                                                                            *
+ * Return value: SUCCEED - the expressions are identical                      *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_compare_serialized_expression(const char *col, const unsigned char *data2)
+{
+	zbx_uint32_t	offset1, len1, offset2, len2;
+	unsigned char	*data1;
+	int		col_len, data1_len, ret = FAIL;
+
+	if (NULL == data2)
+	{
+		if (NULL == col || '\0' == *col)
+			return SUCCEED;
 		return FAIL;
+	}
 
-	if (SUCCEED != zbx_user_macro_parse_dyn(dbrow[1], &macro, &context, NULL, NULL))
+	if (NULL == col || '\0' == *col)
 		return FAIL;
 
-	if (0 != strcmp(gmacro->macro, macro))
-		goto out;
+	col_len = strlen(col);
+	data1 = zbx_malloc(NULL, col_len);
 
-	if (NULL == context)
-	{
-		if (NULL != gmacro->context)
-			goto out;
+	str_base64_decode(col, (char *)data1, col_len, &data1_len);
 
-		ret = SUCCEED;
+	offset1 = zbx_deserialize_uint31_compact((const unsigned char *)data1, &len1);
+	offset2 = zbx_deserialize_uint31_compact((const unsigned char *)data2, &len2);
+
+	if (offset1 != offset2 || len1 != len2)
 		goto out;
-	}
 
-	if (NULL == gmacro->context)
+	if (0 != memcmp(data1 + offset1, data2 + offset2, len1))
 		goto out;
 
-	if (0 == strcmp(gmacro->context, context))
-		ret = SUCCEED;
+	ret = SUCCEED;
 out:
-	zbx_free(macro);
-	zbx_free(context);
+	zbx_free(data1);
 
 	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares global macros table with cached configuration data       *
+ * Purpose: compares config table with cached configuration data              *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -1029,23 +1322,30 @@ out:
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_global_macros(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_config(zbx_dbsync_t *sync)
 {
-	DB_ROW			dbrow;
-	DB_RESULT		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	ZBX_DC_GMACRO		*macro;
+	DB_RESULT	result;
 
-	if (NULL == (result = DBselect(
-			"select globalmacroid,macro,value,type"
-			" from globalmacro")))
+#define SELECTED_CONFIG_FIELD_COUNT	33	/* number of columns in the following DBselect() */
+
+	if (NULL == (result = DBselect("select discovery_groupid,snmptrap_logging,"
+				"severity_name_0,severity_name_1,severity_name_2,"
+				"severity_name_3,severity_name_4,severity_name_5,"
+				"hk_events_mode,hk_events_trigger,hk_events_internal,"
+				"hk_events_discovery,hk_events_autoreg,hk_services_mode,"
+				"hk_services,hk_audit_mode,hk_audit,hk_sessions_mode,hk_sessions,"
+				"hk_history_mode,hk_history_global,hk_history,hk_trends_mode,"
+				"hk_trends_global,hk_trends,default_inventory_mode,db_extension,autoreg_tls_accept,"
+				"compression_status,compress_older,instanceid,default_timezone,hk_events_service,"
+				"auditlog_enabled"
+			" from config"
+			" order by configid")))	/* if you change number of columns in DBselect(), */
+						/* adjust SELECTED_CONFIG_FIELD_COUNT */
 	{
 		return FAIL;
 	}
 
-	dbsync_prepare(sync, 4, NULL);
+	dbsync_prepare(sync, SELECTED_CONFIG_FIELD_COUNT, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -1053,119 +1353,50 @@ int	zbx_dbsync_compare_global_macros(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->gmacros.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-
-	while (NULL != (dbrow = DBfetch(result)))
-	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
-
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
-
-		if (NULL == (macro = (ZBX_DC_GMACRO *)zbx_hashset_search(&dbsync_env.cache->gmacros, &rowid)))
-			tag = ZBX_DBSYNC_ROW_ADD;
-		else if (FAIL == dbsync_compare_global_macro(macro, dbrow))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
-
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
-	}
-
-	zbx_hashset_iter_reset(&dbsync_env.cache->gmacros, &iter);
-	while (NULL != (macro = (ZBX_DC_GMACRO *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL == zbx_hashset_search(&ids, &macro->globalmacroid))
-			dbsync_add_row(sync, macro->globalmacroid, ZBX_DBSYNC_ROW_REMOVE, NULL);
-	}
-
-	zbx_hashset_destroy(&ids);
 	DBfree_result(result);
 
-	return SUCCEED;
+	/* global configuration will be always synchronized directly with database */
+	THIS_SHOULD_NEVER_HAPPEN;
+
+	return FAIL;
+#undef SELECTED_CONFIG_FIELD_COUNT
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares host macro table row with cached configuration data      *
+ * Purpose: compares 'config_autoreg_tls' table with cached configuration     *
+ *          data                                                              *
  *                                                                            *
- * Parameter: hmacro - [IN] the cached host macro data                        *
- *            dbrow  - [IN] the database row                                  *
- *                                                                            *
- * Return value: SUCCEED - the row matches configuration data                 *
- *               FAIL    - otherwise                                          *
- *                                                                            *
- ******************************************************************************/
-static int	dbsync_compare_host_macro(const ZBX_DC_HMACRO *hmacro, const DB_ROW dbrow)
-{
-	char	*macro = NULL, *context = NULL;
-	int	ret = FAIL;
-
-	if (FAIL == dbsync_compare_uchar(dbrow[4], hmacro->type))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_str(dbrow[3], hmacro->value))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_uint64(dbrow[1], hmacro->hostid))
-		return FAIL;
-
-	if (SUCCEED != zbx_user_macro_parse_dyn(dbrow[2], &macro, &context, NULL, NULL))
-		return FAIL;
-
-	if (0 != strcmp(hmacro->macro, macro))
-		goto out;
-
-	if (NULL == context)
-	{
-		if (NULL != hmacro->context)
-			goto out;
-
-		ret = SUCCEED;
-		goto out;
-	}
-
-	if (NULL == hmacro->context)
-		goto out;
-
-	if (0 == strcmp(hmacro->context, context))
-		ret = SUCCEED;
-out:
-	zbx_free(macro);
-	zbx_free(context);
-
-	return ret;
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: compares global macros table with cached configuration data       *
- *                                                                            *
- * Parameter: sync - [OUT] the changeset                                      *
+ * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
  * Return value: SUCCEED - the changeset was successfully calculated          *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments:                                                                  *
+ *     On success this function produces a changeset with 0 or 1 record       *
+ *     because 'config_autoreg_tls' table can have no more than 1 record.     *
+ *     If in future you want to support multiple autoregistration PSKs and/or *
+ *     select more columns in DBselect() then do not forget to sync changes   *
+ *     with DCsync_autoreg_config() !!!                                       *
+ *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_host_macros(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_autoreg_psk(zbx_dbsync_t *sync)
 {
-	DB_ROW			dbrow;
-	DB_RESULT		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	ZBX_DC_HMACRO		*macro;
+	DB_RESULT	result;
+	DB_ROW		dbrow;
+	int		num_records = 0;
 
-	if (NULL == (result = DBselect(
-			"select m.hostmacroid,m.hostid,m.macro,m.value,m.type"
-			" from hostmacro m"
-			" inner join hosts h on m.hostid=h.hostid"
-			" where h.flags<>%d", ZBX_FLAG_DISCOVERY_PROTOTYPE)))
+#define CONFIG_AUTOREG_TLS_FIELD_COUNT	2	/* number of columns in the following DBselect() */
+
+	if (NULL == (result = DBselect("select tls_psk_identity,tls_psk"
+			" from config_autoreg_tls"
+			" order by autoreg_tlsid")))	/* if you change number of columns in DBselect(), */
+							/* adjust CONFIG_AUTOREG_TLS_FIELD_COUNT */
 	{
 		return FAIL;
 	}
 
-	dbsync_prepare(sync, 5, NULL);
+	dbsync_prepare(sync, CONFIG_AUTOREG_TLS_FIELD_COUNT, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -1173,143 +1404,154 @@ int	zbx_dbsync_compare_host_macros(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->hmacros.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	/* 0 or 1 records are expected */
 
-	while (NULL != (dbrow = DBfetch(result)))
+	if (NULL != (dbrow = DBfetch(result)))
 	{
 		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
 
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
-
-		if (NULL == (macro = (ZBX_DC_HMACRO *)zbx_hashset_search(&dbsync_env.cache->hmacros, &rowid)))
+		if ('\0' == dbsync_env.cache->autoreg_psk_identity[0])	/* no autoregistration PSK in cache */
+		{
 			tag = ZBX_DBSYNC_ROW_ADD;
-		else if (FAIL == dbsync_compare_host_macro(macro, dbrow))
+		}
+		else if (FAIL == dbsync_compare_str(dbrow[0], dbsync_env.cache->autoreg_psk_identity) ||
+				FAIL == dbsync_compare_str(dbrow[1], dbsync_env.cache->autoreg_psk))
+		{
 			tag = ZBX_DBSYNC_ROW_UPDATE;
+		}
 
 		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
-	}
+			dbsync_add_row(sync, 0, tag, dbrow);	/* fictitious rowid 0 is used, there is only 1 record */
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->hmacros, &iter);
-	while (NULL != (macro = (ZBX_DC_HMACRO *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL == zbx_hashset_search(&ids, &macro->hostmacroid))
-			dbsync_add_row(sync, macro->hostmacroid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		num_records = 1;
 	}
+	else if ('\0' != dbsync_env.cache->autoreg_psk_identity[0])
+			dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_REMOVE, NULL);
+
+	if (1 == num_records && NULL != DBfetch(result))
+		zabbix_log(LOG_LEVEL_ERR, "table 'config_autoreg_tls' has multiple records");
 
-	zbx_hashset_destroy(&ids);
 	DBfree_result(result);
 
 	return SUCCEED;
+#undef CONFIG_AUTOREG_TLS_FIELD_COUNT
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares interface table row with cached configuration data       *
+ * Purpose: compares hosts table row with cached configuration data           *
  *                                                                            *
- * Parameter: interface - [IN] the cached interface data                      *
- *            dbrow     - [IN] the database row                               *
+ * Parameter: host  - [IN] the cached host                                    *
+ *            dbrow - [IN] the database row                                   *
  *                                                                            *
  * Return value: SUCCEED - the row matches configuration data                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
- * Comments: User macros used in ip, dns fields will always make compare to   *
- *           fail.                                                            *
- *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_interface(const ZBX_DC_INTERFACE *interface, const DB_ROW dbrow)
+static int	dbsync_compare_host(ZBX_DC_HOST *host, const DB_ROW dbrow)
 {
-	ZBX_DC_SNMPINTERFACE *snmp;
+	signed char	ipmi_authtype;
+	unsigned char	ipmi_privilege;
+	ZBX_DC_IPMIHOST	*ipmihost;
+	ZBX_DC_PROXY	*proxy;
 
-	if (FAIL == dbsync_compare_uint64(dbrow[1], interface->hostid))
+	if (FAIL == dbsync_compare_uint64(dbrow[1], host->proxy_hostid))
+	{
+		host->update_items = 1;
 		return FAIL;
+	}
 
-	if (FAIL == dbsync_compare_uchar(dbrow[2], interface->type))
+	if (FAIL == dbsync_compare_uchar(dbrow[10], host->status))
+	{
+		host->update_items = 1;
 		return FAIL;
+	}
 
-	if (FAIL == dbsync_compare_uchar(dbrow[3], interface->main))
-		return FAIL;
+	host->update_items = 0;
 
-	if (FAIL == dbsync_compare_uchar(dbrow[4], interface->useip))
+	if (FAIL == dbsync_compare_str(dbrow[2], host->host))
 		return FAIL;
 
-	if (NULL != strstr(dbrow[5], "{$"))
+	if (FAIL == dbsync_compare_str(dbrow[11], host->name))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_str(dbrow[5], interface->ip))
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	if (FAIL == dbsync_compare_str(dbrow[15], host->tls_issuer))
 		return FAIL;
 
-	if (NULL != strstr(dbrow[6], "{$"))
+	if (FAIL == dbsync_compare_str(dbrow[16], host->tls_subject))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_str(dbrow[6], interface->dns))
-		return FAIL;
+	if ('\0' == *dbrow[17] || '\0' == *dbrow[18])
+	{
+		if (NULL != host->tls_dc_psk)
+			return FAIL;
+	}
+	else
+	{
+		if (NULL == host->tls_dc_psk)
+			return FAIL;
 
-	if (FAIL == dbsync_compare_str(dbrow[7], interface->port))
-		return FAIL;
+		if (FAIL == dbsync_compare_str(dbrow[17], host->tls_dc_psk->tls_psk_identity))
+			return FAIL;
 
-	if (FAIL == dbsync_compare_uchar(dbrow[8], interface->available))
-		return FAIL;
+		if (FAIL == dbsync_compare_str(dbrow[18], host->tls_dc_psk->tls_psk))
+			return FAIL;
+	}
 
-	if (FAIL == dbsync_compare_int(dbrow[9], interface->disable_until))
+#endif
+	if (FAIL == dbsync_compare_uchar(dbrow[13], host->tls_connect))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_str(dbrow[10], interface->error))
+	if (FAIL == dbsync_compare_uchar(dbrow[14], host->tls_accept))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_int(dbrow[11], interface->errors_from))
-		return FAIL;
-	/* reset_availability, items_num and availability_ts are excluded from the comparison */
+	/* IPMI hosts */
 
-	snmp = (ZBX_DC_SNMPINTERFACE *)zbx_hashset_search(&dbsync_env.cache->interfaces_snmp,
-			&interface->interfaceid);
+	ipmi_authtype = (signed char)atoi(dbrow[3]);
+	ipmi_privilege = (unsigned char)atoi(dbrow[4]);
 
-	if (INTERFACE_TYPE_SNMP == interface->type)
+	if (ZBX_IPMI_DEFAULT_AUTHTYPE != ipmi_authtype || ZBX_IPMI_DEFAULT_PRIVILEGE != ipmi_privilege ||
+			'\0' != *dbrow[5] || '\0' != *dbrow[6])	/* useipmi */
 	{
-		if (NULL == snmp || SUCCEED == DBis_null(dbrow[12]))	/* should never happen */
-			return FAIL;
-
-		if (FAIL == dbsync_compare_uchar(dbrow[12], snmp->version))
-			return FAIL;
-
-		if (FAIL == dbsync_compare_uchar(dbrow[13], snmp->bulk))
-			return FAIL;
-
-		if (FAIL == dbsync_compare_str(dbrow[14], snmp->community))
-			return FAIL;
-
-		if (FAIL == dbsync_compare_str(dbrow[15], snmp->securityname))
+		if (NULL == (ipmihost = (ZBX_DC_IPMIHOST *)zbx_hashset_search(&dbsync_env.cache->ipmihosts,
+				&host->hostid)))
+		{
 			return FAIL;
+		}
 
-		if (FAIL == dbsync_compare_uchar(dbrow[16], snmp->securitylevel))
+		if (ipmihost->ipmi_authtype != ipmi_authtype)
 			return FAIL;
 
-		if (FAIL == dbsync_compare_str(dbrow[17], snmp->authpassphrase))
+		if (ipmihost->ipmi_privilege != ipmi_privilege)
 			return FAIL;
 
-		if (FAIL == dbsync_compare_str(dbrow[18], snmp->privpassphrase))
+		if (FAIL == dbsync_compare_str(dbrow[5], ipmihost->ipmi_username))
 			return FAIL;
 
-		if (FAIL == dbsync_compare_uchar(dbrow[19], snmp->authprotocol))
+		if (FAIL == dbsync_compare_str(dbrow[6], ipmihost->ipmi_password))
 			return FAIL;
+	}
+	else if (NULL != zbx_hashset_search(&dbsync_env.cache->ipmihosts, &host->hostid))
+		return FAIL;
 
-		if (FAIL == dbsync_compare_uchar(dbrow[20], snmp->privprotocol))
+	/* proxies */
+	if (NULL != (proxy = (ZBX_DC_PROXY *)zbx_hashset_search(&dbsync_env.cache->proxies, &host->hostid)))
+	{
+		if (FAIL == dbsync_compare_str(dbrow[15 + ZBX_HOST_TLS_OFFSET], proxy->proxy_address))
 			return FAIL;
 
-		if (FAIL == dbsync_compare_str(dbrow[21], snmp->contextname))
+		if (FAIL == dbsync_compare_uchar(dbrow[16 + ZBX_HOST_TLS_OFFSET], proxy->auto_compress))
 			return FAIL;
 	}
-	else if (NULL != snmp)
-		return FAIL;
 
 	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares interfaces table with cached configuration data          *
+ * Purpose: compares hosts table with cached configuration data               *
+ *          and populates the changeset                                       *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -1317,35 +1559,58 @@ static int	dbsync_compare_interface(const ZBX_DC_INTERFACE *interface, const DB_
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_interfaces(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_hosts(zbx_dbsync_t *sync)
 {
 	DB_ROW			dbrow;
 	DB_RESULT		result;
 	zbx_hashset_t		ids;
 	zbx_hashset_iter_t	iter;
 	zbx_uint64_t		rowid;
-	ZBX_DC_INTERFACE	*interface;
+	ZBX_DC_HOST		*host;
 
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
 	if (NULL == (result = DBselect(
-			"select i.interfaceid,i.hostid,i.type,i.main,i.useip,i.ip,i.dns,i.port,"
-			"i.available,i.disable_until,i.error,i.errors_from,"
-			"s.version,s.bulk,s.community,s.securityname,s.securitylevel,s.authpassphrase,s.privpassphrase,"
-			"s.authprotocol,s.privprotocol,s.contextname"
-			" from interface i"
-			" left join interface_snmp s on i.interfaceid=s.interfaceid")))
+			"select hostid,proxy_hostid,host,ipmi_authtype,ipmi_privilege,ipmi_username,"
+				"ipmi_password,maintenance_status,maintenance_type,maintenance_from,"
+				"status,name,lastaccess,tls_connect,tls_accept,tls_issuer,tls_subject,"
+				"tls_psk_identity,tls_psk,proxy_address,auto_compress,maintenanceid"
+			" from hosts"
+			" where status in (%d,%d,%d,%d)"
+				" and flags<>%d",
+			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED,
+			HOST_STATUS_PROXY_ACTIVE, HOST_STATUS_PROXY_PASSIVE,
+			ZBX_FLAG_DISCOVERY_PROTOTYPE)))
 	{
 		return FAIL;
 	}
 
 	dbsync_prepare(sync, 22, NULL);
-
-	if (ZBX_DBSYNC_INIT == sync->mode)
-	{
-		sync->dbresult = result;
-		return SUCCEED;
-	}
-
-	zbx_hashset_create(&ids, dbsync_env.cache->interfaces.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+#else
+	if (NULL == (result = DBselect(
+			"select hostid,proxy_hostid,host,ipmi_authtype,ipmi_privilege,ipmi_username,"
+				"ipmi_password,maintenance_status,maintenance_type,maintenance_from,"
+				"status,name,lastaccess,tls_connect,tls_accept,"
+				"proxy_address,auto_compress,maintenanceid"
+			" from hosts"
+			" where status in (%d,%d,%d,%d)"
+				" and flags<>%d",
+			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED,
+			HOST_STATUS_PROXY_ACTIVE, HOST_STATUS_PROXY_PASSIVE,
+			ZBX_FLAG_DISCOVERY_PROTOTYPE)))
+	{
+		return FAIL;
+	}
+
+	dbsync_prepare(sync, 18, NULL);
+#endif
+
+	if (ZBX_DBSYNC_INIT == sync->mode)
+	{
+		sync->dbresult = result;
+		return SUCCEED;
+	}
+
+	zbx_hashset_create(&ids, dbsync_env.cache->hosts.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	while (NULL != (dbrow = DBfetch(result)))
@@ -1355,20 +1620,20 @@ int	zbx_dbsync_compare_interfaces(zbx_dbsync_t *sync)
 		ZBX_STR2UINT64(rowid, dbrow[0]);
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		if (NULL == (interface = (ZBX_DC_INTERFACE *)zbx_hashset_search(&dbsync_env.cache->interfaces, &rowid)))
+		if (NULL == (host = (ZBX_DC_HOST *)zbx_hashset_search(&dbsync_env.cache->hosts, &rowid)))
 			tag = ZBX_DBSYNC_ROW_ADD;
-		else if (FAIL == dbsync_compare_interface(interface, dbrow))
+		else if (FAIL == dbsync_compare_host(host, dbrow))
 			tag = ZBX_DBSYNC_ROW_UPDATE;
 
 		if (ZBX_DBSYNC_ROW_NONE != tag)
 			dbsync_add_row(sync, rowid, tag, dbrow);
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->interfaces, &iter);
-	while (NULL != (interface = (ZBX_DC_INTERFACE *)zbx_hashset_iter_next(&iter)))
+	zbx_hashset_iter_reset(&dbsync_env.cache->hosts, &iter);
+	while (NULL != (host = (ZBX_DC_HOST *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &interface->interfaceid))
-			dbsync_add_row(sync, interface->interfaceid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL == zbx_hashset_search(&ids, &host->hostid))
+			dbsync_add_row(sync, host->hostid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	zbx_hashset_destroy(&ids);
@@ -1379,376 +1644,1696 @@ int	zbx_dbsync_compare_interfaces(zbx_dbsync_t *sync)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares items table row with cached configuration data           *
+ * Purpose: compares host inventory table row with cached configuration data  *
  *                                                                            *
- * Parameter: item  - [IN] the cached item                                    *
+ * Parameter: hi    - [IN] the cached host inventory data                     *
  *            dbrow - [IN] the database row                                   *
  *                                                                            *
  * Return value: SUCCEED - the row matches configuration data                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_item(const ZBX_DC_ITEM *item, const DB_ROW dbrow)
+static int	dbsync_compare_host_inventory(const ZBX_DC_HOST_INVENTORY *hi, const DB_ROW dbrow)
 {
-	ZBX_DC_NUMITEM		*numitem;
-	ZBX_DC_SNMPITEM		*snmpitem;
-	ZBX_DC_IPMIITEM		*ipmiitem;
-	ZBX_DC_TRAPITEM		*trapitem;
-	ZBX_DC_LOGITEM		*logitem;
-	ZBX_DC_DBITEM		*dbitem;
-	ZBX_DC_SSHITEM		*sshitem;
-	ZBX_DC_TELNETITEM	*telnetitem;
-	ZBX_DC_SIMPLEITEM	*simpleitem;
-	ZBX_DC_JMXITEM		*jmxitem;
-	ZBX_DC_CALCITEM		*calcitem;
-	ZBX_DC_DEPENDENTITEM	*depitem;
-	ZBX_DC_HOST		*host;
-	ZBX_DC_HTTPITEM		*httpitem;
-	ZBX_DC_SCRIPTITEM	*scriptitem;
-	unsigned char		value_type, type;
-	int			history_sec, trends_sec;
-
-	if (FAIL == dbsync_compare_uint64(dbrow[1], item->hostid))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_uint64(dbrow[48], item->templateid))
-		return FAIL;
+	int	i;
 
-	if (NULL == (host = (ZBX_DC_HOST *)zbx_hashset_search(&dbsync_env.cache->hosts, &item->hostid)))
+	if (SUCCEED != dbsync_compare_uchar(dbrow[1], hi->inventory_mode))
 		return FAIL;
 
-	if (0 != host->update_items)
-		return FAIL;
+	for (i = 0; i < HOST_INVENTORY_FIELD_COUNT; i++)
+	{
+		if (FAIL == dbsync_compare_str(dbrow[i + 2], hi->values[i]))
+			return FAIL;
+	}
 
-	if (FAIL == dbsync_compare_uchar(dbrow[2], item->status))
-		return FAIL;
+	return SUCCEED;
+}
 
-	ZBX_STR2UCHAR(type, dbrow[3]);
-	if (item->type != type)
-		return FAIL;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares host_inventory table with cached configuration data      *
+ *                                                                            *
+ * Parameter: sync - [OUT] the changeset                                      *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dbsync_compare_host_inventory(zbx_dbsync_t *sync)
+{
+	DB_ROW			dbrow;
+	DB_RESULT		result;
+	zbx_hashset_t		ids;
+	zbx_hashset_iter_t	iter;
+	zbx_uint64_t		rowid;
+	ZBX_DC_HOST_INVENTORY	*hi;
+	const char		*sql;
 
-	if (FAIL == dbsync_compare_uchar(dbrow[18], item->flags))
-		return FAIL;
+	sql = "select hostid,inventory_mode,type,type_full,name,alias,os,os_full,os_short,serialno_a,"
+			"serialno_b,tag,asset_tag,macaddress_a,macaddress_b,hardware,hardware_full,software,"
+			"software_full,software_app_a,software_app_b,software_app_c,software_app_d,"
+			"software_app_e,contact,location,location_lat,location_lon,notes,chassis,model,"
+			"hw_arch,vendor,contract_number,installer_name,deployment_status,url_a,url_b,"
+			"url_c,host_networks,host_netmask,host_router,oob_ip,oob_netmask,oob_router,"
+			"date_hw_purchase,date_hw_install,date_hw_expiry,date_hw_decomm,site_address_a,"
+			"site_address_b,site_address_c,site_city,site_state,site_country,site_zip,site_rack,"
+			"site_notes,poc_1_name,poc_1_email,poc_1_phone_a,poc_1_phone_b,poc_1_cell,"
+			"poc_1_screen,poc_1_notes,poc_2_name,poc_2_email,poc_2_phone_a,poc_2_phone_b,"
+			"poc_2_cell,poc_2_screen,poc_2_notes"
+			" from host_inventory";
 
-	if (FAIL == dbsync_compare_uint64(dbrow[19], item->interfaceid))
+	if (NULL == (result = DBselect("%s", sql)))
 		return FAIL;
 
-	if (SUCCEED != is_time_suffix(dbrow[22], &history_sec, ZBX_LENGTH_UNLIMITED))
-		history_sec = ZBX_HK_PERIOD_MAX;
-
-	if (0 != history_sec && ZBX_HK_OPTION_ENABLED == dbsync_env.cache->config->hk.history_global)
-		history_sec = dbsync_env.cache->config->hk.history;
+	dbsync_prepare(sync, 72, NULL);
 
-	if (item->history != (0 != history_sec))
-		return FAIL;
+	if (ZBX_DBSYNC_INIT == sync->mode)
+	{
+		sync->dbresult = result;
+		return SUCCEED;
+	}
 
-	if (history_sec != item->history_sec)
-		return FAIL;
+	zbx_hashset_create(&ids, dbsync_env.cache->host_inventories.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
-	if (FAIL == dbsync_compare_uchar(dbrow[24], item->inventory_link))
-		return FAIL;
+	while (NULL != (dbrow = DBfetch(result)))
+	{
+		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
 
-	if (FAIL == dbsync_compare_uint64(dbrow[25], item->valuemapid))
-		return FAIL;
+		ZBX_STR2UINT64(rowid, dbrow[0]);
+		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-	ZBX_STR2UCHAR(value_type, dbrow[4]);
-	if (item->value_type != value_type)
-		return FAIL;
+		if (NULL == (hi = (ZBX_DC_HOST_INVENTORY *)zbx_hashset_search(&dbsync_env.cache->host_inventories,
+				&rowid)))
+		{
+			tag = ZBX_DBSYNC_ROW_ADD;
+		}
+		else if (FAIL == dbsync_compare_host_inventory(hi, dbrow))
+			tag = ZBX_DBSYNC_ROW_UPDATE;
 
-	if (FAIL == dbsync_compare_str(dbrow[5], item->key))
-		return FAIL;
+		if (ZBX_DBSYNC_ROW_NONE != tag)
+			dbsync_add_row(sync, rowid, tag, dbrow);
 
-	if (FAIL == dbsync_compare_str(dbrow[8], item->delay))
-		return FAIL;
+	}
 
-	numitem = (ZBX_DC_NUMITEM *)zbx_hashset_search(&dbsync_env.cache->numitems, &item->itemid);
-	if (ITEM_VALUE_TYPE_FLOAT == value_type || ITEM_VALUE_TYPE_UINT64 == value_type)
+	zbx_hashset_iter_reset(&dbsync_env.cache->host_inventories, &iter);
+	while (NULL != (hi = (ZBX_DC_HOST_INVENTORY *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == numitem)
-			return FAIL;
-
-		if (SUCCEED != is_time_suffix(dbrow[23], &trends_sec, ZBX_LENGTH_UNLIMITED))
-			trends_sec = ZBX_HK_PERIOD_MAX;
+		if (NULL == zbx_hashset_search(&ids, &hi->hostid))
+			dbsync_add_row(sync, hi->hostid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+	}
 
-		if (0 != trends_sec && ZBX_HK_OPTION_ENABLED == dbsync_env.cache->config->hk.trends_global)
-			trends_sec = dbsync_env.cache->config->hk.trends;
+	zbx_hashset_destroy(&ids);
+	DBfree_result(result);
 
-		if (numitem->trends != (0 != trends_sec))
-			return FAIL;
+	return SUCCEED;
+}
 
-		if (numitem->trends_sec != trends_sec)
-			return FAIL;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares hosts_templates table with cached configuration data     *
+ *                                                                            *
+ * Parameter: sync - [OUT] the changeset                                      *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dbsync_compare_host_templates(zbx_dbsync_t *sync)
+{
+	DB_ROW			dbrow;
+	DB_RESULT		result;
+	zbx_hashset_iter_t	iter;
+	ZBX_DC_HTMPL		*htmpl;
+	zbx_hashset_t		htmpls;
+	int			i;
+	zbx_uint64_pair_t	ht_local, *ht;
+	char			hostid_s[MAX_ID_LEN + 1], templateid_s[MAX_ID_LEN + 1];
+	char			*del_row[2] = {hostid_s, templateid_s};
 
-		if (FAIL == dbsync_compare_str(dbrow[26], numitem->units))
-			return FAIL;
-	}
-	else if (NULL != numitem)
+	if (NULL == (result = DBselect(
+			"select hostid,templateid"
+			" from hosts_templates"
+			" order by hostid")))
+	{
 		return FAIL;
+	}
 
-	snmpitem = (ZBX_DC_SNMPITEM *)zbx_hashset_search(&dbsync_env.cache->snmpitems, &item->itemid);
-	if (ITEM_TYPE_SNMP == type)
-	{
-		if (NULL == snmpitem)
-			return FAIL;
+	dbsync_prepare(sync, 2, NULL);
 
-		if (FAIL == dbsync_compare_str(dbrow[6], snmpitem->snmp_oid))
-			return FAIL;
+	if (ZBX_DBSYNC_INIT == sync->mode)
+	{
+		sync->dbresult = result;
+		return SUCCEED;
 	}
-	else if (NULL != snmpitem)
-		return FAIL;
 
-	ipmiitem = (ZBX_DC_IPMIITEM *)zbx_hashset_search(&dbsync_env.cache->ipmiitems, &item->itemid);
-	if (ITEM_TYPE_IPMI == item->type)
+	zbx_hashset_create(&htmpls, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
+
+	/* index all host->template links */
+	zbx_hashset_iter_reset(&dbsync_env.cache->htmpls, &iter);
+	while (NULL != (htmpl = (ZBX_DC_HTMPL *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == ipmiitem)
-			return FAIL;
+		ht_local.first = htmpl->hostid;
 
-		if (FAIL == dbsync_compare_str(dbrow[7], ipmiitem->ipmi_sensor))
-			return FAIL;
+		for (i = 0; i < htmpl->templateids.values_num; i++)
+		{
+			ht_local.second = htmpl->templateids.values[i];
+			zbx_hashset_insert(&htmpls, &ht_local, sizeof(ht_local));
+		}
 	}
-	else if (NULL != ipmiitem)
-		return FAIL;
 
-	trapitem = (ZBX_DC_TRAPITEM *)zbx_hashset_search(&dbsync_env.cache->trapitems, &item->itemid);
-	if (ITEM_TYPE_TRAPPER == item->type && '\0' != *dbrow[9])
+	/* add new rows, remove existing rows from index */
+	while (NULL != (dbrow = DBfetch(result)))
 	{
-		zbx_trim_str_list(dbrow[9], ',');
+		ZBX_STR2UINT64(ht_local.first, dbrow[0]);
+		ZBX_STR2UINT64(ht_local.second, dbrow[1]);
+
+		if (NULL == (ht = (zbx_uint64_pair_t *)zbx_hashset_search(&htmpls, &ht_local)))
+			dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_ADD, dbrow);
+		else
+			zbx_hashset_remove_direct(&htmpls, ht);
+	}
+
+	/* add removed rows */
+	zbx_hashset_iter_reset(&htmpls, &iter);
+	while (NULL != (ht = (zbx_uint64_pair_t *)zbx_hashset_iter_next(&iter)))
+	{
+		zbx_snprintf(hostid_s, sizeof(hostid_s), ZBX_FS_UI64, ht->first);
+		zbx_snprintf(templateid_s, sizeof(templateid_s), ZBX_FS_UI64, ht->second);
+		dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_REMOVE, del_row);
+	}
+
+	DBfree_result(result);
+	zbx_hashset_destroy(&htmpls);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares global macro table row with cached configuration data    *
+ *                                                                            *
+ * Parameter: gmacro - [IN] the cached global macro data                      *
+ *            dbrow    - [IN] the database row                                *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches configuration data                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_compare_global_macro(const ZBX_DC_GMACRO *gmacro, const DB_ROW dbrow)
+{
+	char	*macro = NULL, *context = NULL;
+	int	ret = FAIL;
+
+	if (FAIL == dbsync_compare_uchar(dbrow[3], gmacro->type))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_str(dbrow[2], gmacro->value))
+		return FAIL;
+
+	if (SUCCEED != zbx_user_macro_parse_dyn(dbrow[1], &macro, &context, NULL, NULL))
+		return FAIL;
+
+	if (0 != strcmp(gmacro->macro, macro))
+		goto out;
+
+	if (NULL == context)
+	{
+		if (NULL != gmacro->context)
+			goto out;
+
+		ret = SUCCEED;
+		goto out;
+	}
+
+	if (NULL == gmacro->context)
+		goto out;
+
+	if (0 == strcmp(gmacro->context, context))
+		ret = SUCCEED;
+out:
+	zbx_free(macro);
+	zbx_free(context);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares global macros table with cached configuration data       *
+ *                                                                            *
+ * Parameter: sync - [OUT] the changeset                                      *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dbsync_compare_global_macros(zbx_dbsync_t *sync)
+{
+	DB_ROW			dbrow;
+	DB_RESULT		result;
+	zbx_hashset_t		ids;
+	zbx_hashset_iter_t	iter;
+	zbx_uint64_t		rowid;
+	ZBX_DC_GMACRO		*macro;
+
+	if (NULL == (result = DBselect(
+			"select globalmacroid,macro,value,type"
+			" from globalmacro")))
+	{
+		return FAIL;
+	}
+
+	dbsync_prepare(sync, 4, NULL);
+
+	if (ZBX_DBSYNC_INIT == sync->mode)
+	{
+		sync->dbresult = result;
+		return SUCCEED;
+	}
+
+	zbx_hashset_create(&ids, dbsync_env.cache->gmacros.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	while (NULL != (dbrow = DBfetch(result)))
+	{
+		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
+
+		ZBX_STR2UINT64(rowid, dbrow[0]);
+		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
+
+		if (NULL == (macro = (ZBX_DC_GMACRO *)zbx_hashset_search(&dbsync_env.cache->gmacros, &rowid)))
+			tag = ZBX_DBSYNC_ROW_ADD;
+		else if (FAIL == dbsync_compare_global_macro(macro, dbrow))
+			tag = ZBX_DBSYNC_ROW_UPDATE;
+
+		if (ZBX_DBSYNC_ROW_NONE != tag)
+			dbsync_add_row(sync, rowid, tag, dbrow);
+	}
+
+	zbx_hashset_iter_reset(&dbsync_env.cache->gmacros, &iter);
+	while (NULL != (macro = (ZBX_DC_GMACRO *)zbx_hashset_iter_next(&iter)))
+	{
+		if (NULL == zbx_hashset_search(&ids, &macro->globalmacroid))
+			dbsync_add_row(sync, macro->globalmacroid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+	}
+
+	zbx_hashset_destroy(&ids);
+	DBfree_result(result);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares host macro table row with cached configuration data      *
+ *                                                                            *
+ * Parameter: hmacro - [IN] the cached host macro data                        *
+ *            dbrow  - [IN] the database row                                  *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches configuration data                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_compare_host_macro(const ZBX_DC_HMACRO *hmacro, const DB_ROW dbrow)
+{
+	char	*macro = NULL, *context = NULL;
+	int	ret = FAIL;
+
+	if (FAIL == dbsync_compare_uchar(dbrow[4], hmacro->type))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_str(dbrow[3], hmacro->value))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_uint64(dbrow[1], hmacro->hostid))
+		return FAIL;
+
+	if (SUCCEED != zbx_user_macro_parse_dyn(dbrow[2], &macro, &context, NULL, NULL))
+		return FAIL;
+
+	if (0 != strcmp(hmacro->macro, macro))
+		goto out;
+
+	if (NULL == context)
+	{
+		if (NULL != hmacro->context)
+			goto out;
+
+		ret = SUCCEED;
+		goto out;
+	}
+
+	if (NULL == hmacro->context)
+		goto out;
+
+	if (0 == strcmp(hmacro->context, context))
+		ret = SUCCEED;
+out:
+	zbx_free(macro);
+	zbx_free(context);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares global macros table with cached configuration data       *
+ *                                                                            *
+ * Parameter: sync - [OUT] the changeset                                      *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dbsync_compare_host_macros(zbx_dbsync_t *sync)
+{
+	DB_ROW			dbrow;
+	DB_RESULT		result;
+	zbx_hashset_t		ids;
+	zbx_hashset_iter_t	iter;
+	zbx_uint64_t		rowid;
+	ZBX_DC_HMACRO		*macro;
+
+	if (NULL == (result = DBselect(
+			"select m.hostmacroid,m.hostid,m.macro,m.value,m.type"
+			" from hostmacro m"
+			" inner join hosts h on m.hostid=h.hostid"
+			" where h.flags<>%d", ZBX_FLAG_DISCOVERY_PROTOTYPE)))
+	{
+		return FAIL;
+	}
+
+	dbsync_prepare(sync, 5, NULL);
+
+	if (ZBX_DBSYNC_INIT == sync->mode)
+	{
+		sync->dbresult = result;
+		return SUCCEED;
+	}
+
+	zbx_hashset_create(&ids, dbsync_env.cache->hmacros.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	while (NULL != (dbrow = DBfetch(result)))
+	{
+		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
+
+		ZBX_STR2UINT64(rowid, dbrow[0]);
+		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
+
+		if (NULL == (macro = (ZBX_DC_HMACRO *)zbx_hashset_search(&dbsync_env.cache->hmacros, &rowid)))
+			tag = ZBX_DBSYNC_ROW_ADD;
+		else if (FAIL == dbsync_compare_host_macro(macro, dbrow))
+			tag = ZBX_DBSYNC_ROW_UPDATE;
+
+		if (ZBX_DBSYNC_ROW_NONE != tag)
+			dbsync_add_row(sync, rowid, tag, dbrow);
+	}
+
+	zbx_hashset_iter_reset(&dbsync_env.cache->hmacros, &iter);
+	while (NULL != (macro = (ZBX_DC_HMACRO *)zbx_hashset_iter_next(&iter)))
+	{
+		if (NULL == zbx_hashset_search(&ids, &macro->hostmacroid))
+			dbsync_add_row(sync, macro->hostmacroid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+	}
+
+	zbx_hashset_destroy(&ids);
+	DBfree_result(result);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares interface table row with cached configuration data       *
+ *                                                                            *
+ * Parameter: interface - [IN] the cached interface data                      *
+ *            dbrow     - [IN] the database row                               *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches configuration data                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: User macros used in ip, dns fields will always make compare to   *
+ *           fail.                                                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_compare_interface(const ZBX_DC_INTERFACE *interface, const DB_ROW dbrow)
+{
+	ZBX_DC_SNMPINTERFACE *snmp;
+
+	if (FAIL == dbsync_compare_uint64(dbrow[1], interface->hostid))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_uchar(dbrow[2], interface->type))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_uchar(dbrow[3], interface->main))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_uchar(dbrow[4], interface->useip))
+		return FAIL;
+
+	if (NULL != strstr(dbrow[5], "{$"))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_str(dbrow[5], interface->ip))
+		return FAIL;
+
+	if (NULL != strstr(dbrow[6], "{$"))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_str(dbrow[6], interface->dns))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_str(dbrow[7], interface->port))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_uchar(dbrow[8], interface->available))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_int(dbrow[9], interface->disable_until))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_str(dbrow[10], interface->error))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_int(dbrow[11], interface->errors_from))
+		return FAIL;
+	/* reset_availability, items_num and availability_ts are excluded from the comparison */
+
+	snmp = (ZBX_DC_SNMPINTERFACE *)zbx_hashset_search(&dbsync_env.cache->interfaces_snmp,
+			&interface->interfaceid);
+
+	if (INTERFACE_TYPE_SNMP == interface->type)
+	{
+		if (NULL == snmp || SUCCEED == DBis_null(dbrow[12]))	/* should never happen */
+			return FAIL;
+
+		if (FAIL == dbsync_compare_uchar(dbrow[12], snmp->version))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_uchar(dbrow[13], snmp->bulk))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[14], snmp->community))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[15], snmp->securityname))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_uchar(dbrow[16], snmp->securitylevel))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[17], snmp->authpassphrase))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[18], snmp->privpassphrase))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_uchar(dbrow[19], snmp->authprotocol))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_uchar(dbrow[20], snmp->privprotocol))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[21], snmp->contextname))
+			return FAIL;
+	}
+	else if (NULL != snmp)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares interfaces table with cached configuration data          *
+ *                                                                            *
+ * Parameter: sync - [OUT] the changeset                                      *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dbsync_compare_interfaces(zbx_dbsync_t *sync)
+{
+	DB_ROW			dbrow;
+	DB_RESULT		result;
+	zbx_hashset_t		ids;
+	zbx_hashset_iter_t	iter;
+	zbx_uint64_t		rowid;
+	ZBX_DC_INTERFACE	*interface;
+
+	if (NULL == (result = DBselect(
+			"select i.interfaceid,i.hostid,i.type,i.main,i.useip,i.ip,i.dns,i.port,"
+			"i.available,i.disable_until,i.error,i.errors_from,"
+			"s.version,s.bulk,s.community,s.securityname,s.securitylevel,s.authpassphrase,s.privpassphrase,"
+			"s.authprotocol,s.privprotocol,s.contextname"
+			" from interface i"
+			" left join interface_snmp s on i.interfaceid=s.interfaceid")))
+	{
+		return FAIL;
+	}
+
+	dbsync_prepare(sync, 22, NULL);
+
+	if (ZBX_DBSYNC_INIT == sync->mode)
+	{
+		sync->dbresult = result;
+		return SUCCEED;
+	}
+
+	zbx_hashset_create(&ids, dbsync_env.cache->interfaces.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	while (NULL != (dbrow = DBfetch(result)))
+	{
+		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
+
+		ZBX_STR2UINT64(rowid, dbrow[0]);
+		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
+
+		if (NULL == (interface = (ZBX_DC_INTERFACE *)zbx_hashset_search(&dbsync_env.cache->interfaces, &rowid)))
+			tag = ZBX_DBSYNC_ROW_ADD;
+		else if (FAIL == dbsync_compare_interface(interface, dbrow))
+			tag = ZBX_DBSYNC_ROW_UPDATE;
+
+		if (ZBX_DBSYNC_ROW_NONE != tag)
+			dbsync_add_row(sync, rowid, tag, dbrow);
+	}
+
+	zbx_hashset_iter_reset(&dbsync_env.cache->interfaces, &iter);
+	while (NULL != (interface = (ZBX_DC_INTERFACE *)zbx_hashset_iter_next(&iter)))
+	{
+		if (NULL == zbx_hashset_search(&ids, &interface->interfaceid))
+			dbsync_add_row(sync, interface->interfaceid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+	}
+
+	zbx_hashset_destroy(&ids);
+	DBfree_result(result);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares items table row with cached configuration data           *
+ *                                                                            *
+ * Parameter: item  - [IN] the cached item                                    *
+ *            dbrow - [IN] the database row                                   *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches configuration data                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_compare_item(const ZBX_DC_ITEM *item, const DB_ROW dbrow)
+{
+	ZBX_DC_NUMITEM		*numitem;
+	ZBX_DC_SNMPITEM		*snmpitem;
+	ZBX_DC_IPMIITEM		*ipmiitem;
+	ZBX_DC_TRAPITEM		*trapitem;
+	ZBX_DC_LOGITEM		*logitem;
+	ZBX_DC_DBITEM		*dbitem;
+	ZBX_DC_SSHITEM		*sshitem;
+	ZBX_DC_TELNETITEM	*telnetitem;
+	ZBX_DC_SIMPLEITEM	*simpleitem;
+	ZBX_DC_JMXITEM		*jmxitem;
+	ZBX_DC_CALCITEM		*calcitem;
+	ZBX_DC_DEPENDENTITEM	*depitem;
+	ZBX_DC_HOST		*host;
+	ZBX_DC_HTTPITEM		*httpitem;
+	ZBX_DC_SCRIPTITEM	*scriptitem;
+	unsigned char		value_type, type;
+	int			history_sec, trends_sec;
+
+	if (FAIL == dbsync_compare_uint64(dbrow[1], item->hostid))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_uint64(dbrow[48], item->templateid))
+		return FAIL;
+
+	if (NULL == (host = (ZBX_DC_HOST *)zbx_hashset_search(&dbsync_env.cache->hosts, &item->hostid)))
+		return FAIL;
+
+	if (0 != host->update_items)
+		return FAIL;
+
+	if (FAIL == dbsync_compare_uchar(dbrow[2], item->status))
+		return FAIL;
+
+	ZBX_STR2UCHAR(type, dbrow[3]);
+	if (item->type != type)
+		return FAIL;
+
+	if (FAIL == dbsync_compare_uchar(dbrow[18], item->flags))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_uint64(dbrow[19], item->interfaceid))
+		return FAIL;
+
+	if (SUCCEED != is_time_suffix(dbrow[22], &history_sec, ZBX_LENGTH_UNLIMITED))
+		history_sec = ZBX_HK_PERIOD_MAX;
+
+	if (0 != history_sec && ZBX_HK_OPTION_ENABLED == dbsync_env.cache->config->hk.history_global)
+		history_sec = dbsync_env.cache->config->hk.history;
+
+	if (item->history != (0 != history_sec))
+		return FAIL;
+
+	if (history_sec != item->history_sec)
+		return FAIL;
+
+	if (FAIL == dbsync_compare_uchar(dbrow[24], item->inventory_link))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_uint64(dbrow[25], item->valuemapid))
+		return FAIL;
+
+	ZBX_STR2UCHAR(value_type, dbrow[4]);
+	if (item->value_type != value_type)
+		return FAIL;
+
+	if (FAIL == dbsync_compare_str(dbrow[5], item->key))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_str(dbrow[8], item->delay))
+		return FAIL;
+
+	numitem = (ZBX_DC_NUMITEM *)zbx_hashset_search(&dbsync_env.cache->numitems, &item->itemid);
+	if (ITEM_VALUE_TYPE_FLOAT == value_type || ITEM_VALUE_TYPE_UINT64 == value_type)
+	{
+		if (NULL == numitem)
+			return FAIL;
+
+		if (SUCCEED != is_time_suffix(dbrow[23], &trends_sec, ZBX_LENGTH_UNLIMITED))
+			trends_sec = ZBX_HK_PERIOD_MAX;
+
+		if (0 != trends_sec && ZBX_HK_OPTION_ENABLED == dbsync_env.cache->config->hk.trends_global)
+			trends_sec = dbsync_env.cache->config->hk.trends;
+
+		if (numitem->trends != (0 != trends_sec))
+			return FAIL;
+
+		if (numitem->trends_sec != trends_sec)
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[26], numitem->units))
+			return FAIL;
+	}
+	else if (NULL != numitem)
+		return FAIL;
+
+	snmpitem = (ZBX_DC_SNMPITEM *)zbx_hashset_search(&dbsync_env.cache->snmpitems, &item->itemid);
+	if (ITEM_TYPE_SNMP == type)
+	{
+		if (NULL == snmpitem)
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[6], snmpitem->snmp_oid))
+			return FAIL;
+	}
+	else if (NULL != snmpitem)
+		return FAIL;
+
+	ipmiitem = (ZBX_DC_IPMIITEM *)zbx_hashset_search(&dbsync_env.cache->ipmiitems, &item->itemid);
+	if (ITEM_TYPE_IPMI == item->type)
+	{
+		if (NULL == ipmiitem)
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[7], ipmiitem->ipmi_sensor))
+			return FAIL;
+	}
+	else if (NULL != ipmiitem)
+		return FAIL;
+
+	trapitem = (ZBX_DC_TRAPITEM *)zbx_hashset_search(&dbsync_env.cache->trapitems, &item->itemid);
+	if (ITEM_TYPE_TRAPPER == item->type && '\0' != *dbrow[9])
+	{
+		zbx_trim_str_list(dbrow[9], ',');
 
 		if (NULL == trapitem)
 			return FAIL;
 
-		if (FAIL == dbsync_compare_str(dbrow[9], trapitem->trapper_hosts))
-			return FAIL;
+		if (FAIL == dbsync_compare_str(dbrow[9], trapitem->trapper_hosts))
+			return FAIL;
+	}
+	else if (NULL != trapitem)
+		return FAIL;
+
+	logitem = (ZBX_DC_LOGITEM *)zbx_hashset_search(&dbsync_env.cache->logitems, &item->itemid);
+	if (ITEM_VALUE_TYPE_LOG == item->value_type && '\0' != *dbrow[10])
+	{
+		if (NULL == logitem)
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[10], logitem->logtimefmt))
+			return FAIL;
+	}
+	else if (NULL != logitem)
+		return FAIL;
+
+	dbitem = (ZBX_DC_DBITEM *)zbx_hashset_search(&dbsync_env.cache->dbitems, &item->itemid);
+	if (ITEM_TYPE_DB_MONITOR == item->type && '\0' != *dbrow[11])
+	{
+		if (NULL == dbitem)
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[11], dbitem->params))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[14], dbitem->username))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[15], dbitem->password))
+			return FAIL;
+	}
+	else if (NULL != dbitem)
+		return FAIL;
+
+	sshitem = (ZBX_DC_SSHITEM *)zbx_hashset_search(&dbsync_env.cache->sshitems, &item->itemid);
+	if (ITEM_TYPE_SSH == item->type)
+	{
+		if (NULL == sshitem)
+			return FAIL;
+
+		if (FAIL == dbsync_compare_uchar(dbrow[13], sshitem->authtype))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[14], sshitem->username))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[15], sshitem->password))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[16], sshitem->publickey))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[17], sshitem->privatekey))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[13], sshitem->params))
+			return FAIL;
+	}
+	else if (NULL != sshitem)
+		return FAIL;
+
+	telnetitem = (ZBX_DC_TELNETITEM *)zbx_hashset_search(&dbsync_env.cache->telnetitems, &item->itemid);
+	if (ITEM_TYPE_TELNET == item->type)
+	{
+		if (NULL == telnetitem)
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[14], telnetitem->username))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[15], telnetitem->password))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[11], telnetitem->params))
+			return FAIL;
+	}
+	else if (NULL != telnetitem)
+		return FAIL;
+
+	scriptitem = (ZBX_DC_SCRIPTITEM *)zbx_hashset_search(&dbsync_env.cache->scriptitems, &item->itemid);
+	if (ITEM_TYPE_SCRIPT == item->type)
+	{
+		if (NULL == scriptitem)
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[14], scriptitem->timeout))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[11], scriptitem->script))
+			return FAIL;
+	}
+	else if (NULL != scriptitem)
+		return FAIL;
+
+	simpleitem = (ZBX_DC_SIMPLEITEM *)zbx_hashset_search(&dbsync_env.cache->simpleitems, &item->itemid);
+	if (ITEM_TYPE_SIMPLE == item->type)
+	{
+		if (NULL == simpleitem)
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[14], simpleitem->username))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[15], simpleitem->password))
+			return FAIL;
+	}
+	else if (NULL != simpleitem)
+		return FAIL;
+
+	jmxitem = (ZBX_DC_JMXITEM *)zbx_hashset_search(&dbsync_env.cache->jmxitems, &item->itemid);
+	if (ITEM_TYPE_JMX == item->type)
+	{
+		if (NULL == jmxitem)
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[14], jmxitem->username))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[15], jmxitem->password))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[28], jmxitem->jmx_endpoint))
+			return FAIL;
+	}
+	else if (NULL != jmxitem)
+		return FAIL;
+
+	calcitem = (ZBX_DC_CALCITEM *)zbx_hashset_search(&dbsync_env.cache->calcitems, &item->itemid);
+	if (ITEM_TYPE_CALCULATED == item->type)
+	{
+		if (NULL == calcitem)
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[11], calcitem->params))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_serialized_expression(dbrow[49], calcitem->formula_bin))
+			return FAIL;
+	}
+	else if (NULL != calcitem)
+		return FAIL;
+
+	depitem = (ZBX_DC_DEPENDENTITEM *)zbx_hashset_search(&dbsync_env.cache->dependentitems, &item->itemid);
+	if (ITEM_TYPE_DEPENDENT == item->type)
+	{
+		if (NULL == depitem)
+			return FAIL;
+
+		if (FAIL == dbsync_compare_uint64(dbrow[29], depitem->master_itemid))
+			return FAIL;
+	}
+	else if (NULL != depitem)
+		return FAIL;
+
+	httpitem = (ZBX_DC_HTTPITEM *)zbx_hashset_search(&dbsync_env.cache->httpitems, &item->itemid);
+	if (ITEM_TYPE_HTTPAGENT == item->type)
+	{
+		zbx_trim_str_list(dbrow[9], ',');
+
+		if (NULL == httpitem)
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[30], httpitem->timeout))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[31], httpitem->url))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[32], httpitem->query_fields))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[33], httpitem->posts))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[34], httpitem->status_codes))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_uchar(dbrow[35], httpitem->follow_redirects))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_uchar(dbrow[36], httpitem->post_type))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[37], httpitem->http_proxy))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[38], httpitem->headers))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_uchar(dbrow[39], httpitem->retrieve_mode))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_uchar(dbrow[40], httpitem->request_method))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_uchar(dbrow[41], httpitem->output_format))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[42], httpitem->ssl_cert_file))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[43], httpitem->ssl_key_file))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[44], httpitem->ssl_key_password))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_uchar(dbrow[45], httpitem->verify_peer))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_uchar(dbrow[46], httpitem->verify_host))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_uchar(dbrow[13], httpitem->authtype))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[14], httpitem->username))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[15], httpitem->password))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_uchar(dbrow[47], httpitem->allow_traps))
+			return FAIL;
+
+		if (FAIL == dbsync_compare_str(dbrow[10], httpitem->trapper_hosts))
+			return FAIL;
+	}
+	else if (NULL != httpitem)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: applies necessary preprocessing before row is compared/used       *
+ *                                                                            *
+ * Parameter: row - [IN] the row to preprocess                                *
+ *                                                                            *
+ * Return value: the preprocessed row                                         *
+ *                                                                            *
+ * Comments: The row preprocessing can be used to expand user macros in       *
+ *           some columns.                                                    *
+ *                                                                            *
+ ******************************************************************************/
+static char	**dbsync_item_preproc_row(char **row)
+{
+#define ZBX_DBSYNC_ITEM_COLUMN_DELAY	0x01
+#define ZBX_DBSYNC_ITEM_COLUMN_HISTORY	0x02
+#define ZBX_DBSYNC_ITEM_COLUMN_TRENDS	0x04
+#define ZBX_DBSYNC_ITEM_COLUMN_CALCITEM	0x08
+
+	zbx_uint64_t	hostid;
+	unsigned char	flags = 0, type;
+
+	/* return the original row if user macros are not used in target columns */
+
+	ZBX_STR2UCHAR(type, row[3]);
+
+	if (SUCCEED == dbsync_check_row_macros(row, 8))
+		flags |= ZBX_DBSYNC_ITEM_COLUMN_DELAY;
+
+	if (SUCCEED == dbsync_check_row_macros(row, 23))
+		flags |= ZBX_DBSYNC_ITEM_COLUMN_HISTORY;
+
+	if (SUCCEED == dbsync_check_row_macros(row, 24))
+		flags |= ZBX_DBSYNC_ITEM_COLUMN_TRENDS;
+
+	if (ITEM_TYPE_CALCULATED == type)
+		flags |= ZBX_DBSYNC_ITEM_COLUMN_CALCITEM;
+
+	if (0 == flags)
+		return row;
+
+	/* get associated host identifier */
+	ZBX_STR2UINT64(hostid, row[1]);
+
+	/* expand user macros */
+
+	if (0 != (flags & ZBX_DBSYNC_ITEM_COLUMN_DELAY))
+		row[8] = dc_expand_user_macros(row[8], &hostid, 1);
+
+	if (0 != (flags & ZBX_DBSYNC_ITEM_COLUMN_HISTORY))
+		row[22] = dc_expand_user_macros(row[22], &hostid, 1);
+
+	if (0 != (flags & ZBX_DBSYNC_ITEM_COLUMN_TRENDS))
+		row[23] = dc_expand_user_macros(row[23], &hostid, 1);
+
+	if (ITEM_TYPE_CALCULATED == type)
+	{
+		zbx_eval_context_t	ctx;
+		char			*error = NULL;
+
+		if (FAIL == zbx_eval_parse_expression(&ctx, row[11], ZBX_EVAL_PARSE_CALC_EXPRESSION, &error))
+		{
+			zbx_eval_set_exception(&ctx, zbx_dsprintf(NULL, "Cannot parse formula: %s", error));
+			zbx_free(error);
+		}
+		else
+		{
+			if (SUCCEED != zbx_eval_expand_user_macros(&ctx, &hostid, 1, dc_expand_user_macros_len, &error))
+			{
+				zbx_eval_clear(&ctx);
+				zbx_eval_set_exception(&ctx, zbx_dsprintf(NULL, "Cannot evaluate formula: %s", error));
+				zbx_free(error);
+			}
+		}
+
+		row[49] = encode_expression(&ctx);
+		zbx_eval_clear(&ctx);
+	}
+
+	return row;
+
+#undef ZBX_DBSYNC_ITEM_COLUMN_DELAY
+#undef ZBX_DBSYNC_ITEM_COLUMN_HISTORY
+#undef ZBX_DBSYNC_ITEM_COLUMN_TRENDS
+}
+
+static int	dbsync_changelog_gap_compare(const void *d1, const void *d2)
+{
+	const zbx_uint64_pair_t	*p1 = (const zbx_uint64_pair_t *)d1;
+	const zbx_uint64_pair_t	*p2 = (const zbx_uint64_pair_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(p1->first, p2->first);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets identifiers of items changed since the last synchronization  *
+ *          from changelog                                                    *
+ *                                                                            *
+ * Parameters: itemids     - [OUT] the changed item identifiers               *
+ *             changelogid - [IN/OUT] the last changelog record read          *
+ *             gaps        - [IN/OUT] the changelog identifiers lower than    *
+ *                                    the last read that were not read yet    *
+ *             now         - [IN] the current time                            *
+ *                                                                            *
+ * Return value: SUCCEED - the items can be synchronized incrementally        *
+ *               FAIL    - the full item comparison must be done              *
+ *                                                                            *
+ * Comments: Changelog is read by record identifier rather than by time,      *
+ *           because identifiers are assigned in the order of inserts while   *
+ *           the records become visible in the order of commits. Identifiers  *
+ *           skipped by the read are kept and read again until they appear or *
+ *           expire.                                                          *
+ *           Removed objects cannot be tracked reliably, because database     *
+ *           triggers are not fired for rows removed by cascade foreign keys, *
+ *           so removal of hosts or items forces the full comparison.         *
+ *           The last read record and gaps are updated also when the full     *
+ *           comparison must be done, so that it is not repeated.             *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_get_changed_itemids(zbx_vector_uint64_t *itemids, zbx_uint64_t *changelogid,
+		zbx_vector_uint64_pair_t *gaps, int now)
+{
+	DB_RESULT		result;
+	DB_ROW			row;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	zbx_uint64_t		objectid;
+	zbx_uint64_pair_t	gap;
+	zbx_vector_uint64_t	gapids;
+	int			i, object, ret = SUCCEED;
+
+	/* skipped identifiers of rolled back transactions are never written */
+	for (i = 0; i < gaps->values_num; i++)
+	{
+		if (ZBX_DBSYNC_RECONCILE_PERIOD <= now - (int)gaps->values[i].second)
+			zbx_vector_uint64_pair_remove(gaps, i--);
+	}
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+			"select changelogid,object,objectid,operation"
+			" from changelog"
+			" where changelogid>" ZBX_FS_UI64, *changelogid);
+
+	if (0 != gaps->values_num)
+	{
+		zbx_vector_uint64_create(&gapids);
+
+		for (i = 0; i < gaps->values_num; i++)
+			zbx_vector_uint64_append(&gapids, gaps->values[i].first);
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " or");
+		DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "changelogid", gapids.values,
+				gapids.values_num);
+
+		zbx_vector_uint64_destroy(&gapids);
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " order by changelogid");
+
+	result = DBselect("%s", sql);
+	zbx_free(sql);
+
+	if (NULL == result)
+		return FAIL;
+
+	while (NULL != (row = DBfetch(result)))
+	{
+		ZBX_STR2UINT64(gap.first, row[0]);
+
+		if (gap.first <= *changelogid)
+		{
+			/* the record of transaction committed after the records with higher identifiers were read */
+			if (FAIL != (i = zbx_vector_uint64_pair_bsearch(gaps, gap, dbsync_changelog_gap_compare)))
+				zbx_vector_uint64_pair_remove(gaps, i);
+		}
+		else if (ZBX_DBSYNC_CHANGELOG_GAPS_MAX < gap.first - *changelogid - 1)
+		{
+			/* too many records are not visible yet, the changes are applied by the full comparison */
+			*changelogid = gap.first;
+			ret = FAIL;
+		}
+		else
+		{
+			zbx_uint64_t	id = gap.first;
+
+			gap.second = (zbx_uint64_t)now;
+
+			for (gap.first = *changelogid + 1; gap.first < id; gap.first++)
+				zbx_vector_uint64_pair_append(gaps, gap);
+
+			*changelogid = id;
+		}
+
+		object = atoi(row[1]);
+
+		if (ZBX_DBSYNC_ROW_REMOVE == atoi(row[3]))
+		{
+			if (ZBX_DBSYNC_OBJ_ITEM == object || ZBX_DBSYNC_OBJ_HOST == object)
+				ret = FAIL;
+
+			continue;
+		}
+
+		if (ZBX_DBSYNC_OBJ_ITEM != object)
+			continue;
+
+		ZBX_STR2UINT64(objectid, row[2]);
+		zbx_vector_uint64_append(itemids, objectid);
 	}
-	else if (NULL != trapitem)
+	DBfree_result(result);
+
+	/* gaps are kept in ascending order, the oldest ones are dropped */
+	if (ZBX_DBSYNC_CHANGELOG_GAPS_MAX < gaps->values_num)
+	{
+		memmove(gaps->values, gaps->values + gaps->values_num - ZBX_DBSYNC_CHANGELOG_GAPS_MAX,
+				sizeof(zbx_uint64_pair_t) * ZBX_DBSYNC_CHANGELOG_GAPS_MAX);
+		gaps->values_num = ZBX_DBSYNC_CHANGELOG_GAPS_MAX;
+		ret = FAIL;
+	}
+
+	if (SUCCEED != ret)
 		return FAIL;
 
-	logitem = (ZBX_DC_LOGITEM *)zbx_hashset_search(&dbsync_env.cache->logitems, &item->itemid);
-	if (ITEM_VALUE_TYPE_LOG == item->value_type && '\0' != *dbrow[10])
+	zbx_vector_uint64_sort(itemids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(itemids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	if (itemids->values_num > dbsync_env.cache->items.num_data / ZBX_DBSYNC_CHANGELOG_MAX_RATIO)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends the item select query without item filter                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_items_sql(char **sql, size_t *sql_alloc, size_t *sql_offset)
+{
+	zbx_snprintf_alloc(sql, sql_alloc, sql_offset,
+			"select i.itemid,i.hostid,i.status,i.type,i.value_type,i.key_,i.snmp_oid,i.ipmi_sensor,i.delay,"
+				"i.trapper_hosts,i.logtimefmt,i.params,ir.state,i.authtype,i.username,i.password,"
+				"i.publickey,i.privatekey,i.flags,i.interfaceid,ir.lastlogsize,ir.mtime,"
+				"i.history,i.trends,i.inventory_link,i.valuemapid,i.units,ir.error,i.jmx_endpoint,"
+				"i.master_itemid,i.timeout,i.url,i.query_fields,i.posts,i.status_codes,"
+				"i.follow_redirects,i.post_type,i.http_proxy,i.headers,i.retrieve_mode,"
+				"i.request_method,i.output_format,i.ssl_cert_file,i.ssl_key_file,i.ssl_key_password,"
+				"i.verify_peer,i.verify_host,i.allow_traps,i.templateid,null"
+			" from items i"
+			" inner join hosts h on i.hostid=h.hostid"
+			" join item_rtdata ir on i.itemid=ir.itemid"
+			" where h.status in (%d,%d) and i.flags<>%d",
+			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED, ZBX_FLAG_DISCOVERY_PROTOTYPE);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares items table with cached configuration data               *
+ *                                                                            *
+ * Parameter: sync - [OUT] the changeset                                      *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: On server items changed since the last synchronization are read  *
+ *           from changelog and only those items are compared. The full       *
+ *           comparison is done periodically and when changelog cannot be     *
+ *           used.                                                            *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dbsync_compare_items(zbx_dbsync_t *sync)
+{
+	DB_ROW			dbrow;
+	DB_RESULT		result;
+	zbx_hashset_t		ids;
+	zbx_hashset_iter_t	iter;
+	zbx_uint64_t		rowid;
+	ZBX_DC_ITEM		*item;
+	char			**row, *sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	int				now, i, reconcile = 0, changelog = 0, ret = FAIL;
+	zbx_vector_uint64_t		itemids;
+	zbx_vector_uint64_pair_t	gaps;
+	zbx_uint64_t			changelogid;
+
+	now = (int)time(NULL);
+
+	zbx_vector_uint64_create(&itemids);
+	zbx_vector_uint64_pair_create(&gaps);
+
+	/* the changelog position is updated only if synchronization succeeds */
+	changelogid = dbsync_env.changelogid;
+
+	/* full load in ZBX_DBSYNC_INIT mode, changelog is tracked from the record set by zbx_dbsync_init_env() */
+	if (ZBX_DBSYNC_UPDATE == sync->mode)
 	{
-		if (NULL == logitem)
-			return FAIL;
+		/* changelog is read also before the full comparison to track the changes from the current position */
+		if (0 != (program_type & ZBX_PROGRAM_TYPE_SERVER))
+		{
+			zbx_vector_uint64_pair_append_array(&gaps, dbsync_env.changelog_gaps.values,
+					dbsync_env.changelog_gaps.values_num);
 
-		if (FAIL == dbsync_compare_str(dbrow[10], logitem->logtimefmt))
-			return FAIL;
+			if (SUCCEED == dbsync_get_changed_itemids(&itemids, &changelogid, &gaps, now))
+				changelog = 1;
+			else
+				zbx_vector_uint64_clear(&itemids);
+		}
+
+		if (ZBX_DBSYNC_RECONCILE_PERIOD <= now - dbsync_env.reconcile_ts)
+		{
+#ifndef HAVE_SQLITE3
+			/* changelog is filled by database triggers on proxies too, so it must be cleaned up everywhere */
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "delete from changelog where clock<%d",
+					now - ZBX_DBSYNC_RECONCILE_PERIOD);
+
+			/* the last read record is kept for configuration cache snapshot validation on server */
+			if (0 != (program_type & ZBX_PROGRAM_TYPE_SERVER))
+			{
+				zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and changelogid<" ZBX_FS_UI64,
+						changelogid);
+			}
+
+			if (ZBX_DB_OK > DBexecute("%s", sql))
+				goto out;
+
+			sql_offset = 0;
+#endif
+			zbx_vector_uint64_clear(&itemids);
+			reconcile = 1;
+		}
+		else if (0 != changelog && 0 == itemids.values_num)
+		{
+			dbsync_prepare(sync, ZBX_DBSYNC_ITEM_COLUMNS_NUM, dbsync_item_preproc_row);
+			ret = SUCCEED;
+			goto out;
+		}
 	}
-	else if (NULL != logitem)
-		return FAIL;
 
-	dbitem = (ZBX_DC_DBITEM *)zbx_hashset_search(&dbsync_env.cache->dbitems, &item->itemid);
-	if (ITEM_TYPE_DB_MONITOR == item->type && '\0' != *dbrow[11])
+	dbsync_items_sql(&sql, &sql_alloc, &sql_offset);
+
+	if (0 != itemids.values_num)
 	{
-		if (NULL == dbitem)
-			return FAIL;
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and");
+		DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "i.itemid", itemids.values, itemids.values_num);
+	}
 
-		if (FAIL == dbsync_compare_str(dbrow[11], dbitem->params))
-			return FAIL;
+	if (NULL == (result = DBselect("%s", sql)))
+		goto out;
 
-		if (FAIL == dbsync_compare_str(dbrow[14], dbitem->username))
-			return FAIL;
+	dbsync_prepare(sync, ZBX_DBSYNC_ITEM_COLUMNS_NUM, dbsync_item_preproc_row);
 
-		if (FAIL == dbsync_compare_str(dbrow[15], dbitem->password))
-			return FAIL;
+	if (ZBX_DBSYNC_INIT == sync->mode)
+	{
+		sync->dbresult = result;
+		ret = SUCCEED;
+		goto out;
 	}
-	else if (NULL != dbitem)
+
+	zbx_hashset_create(&ids, 0 == itemids.values_num ? dbsync_env.cache->items.num_data : itemids.values_num,
+			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	while (NULL != (dbrow = DBfetch(result)))
+	{
+		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
+
+		ZBX_STR2UINT64(rowid, dbrow[0]);
+		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
+
+		row = dbsync_preproc_row(sync, dbrow);
+
+		if (NULL == (item = (ZBX_DC_ITEM *)zbx_hashset_search(&dbsync_env.cache->items, &rowid)))
+			tag = ZBX_DBSYNC_ROW_ADD;
+		else if (FAIL == dbsync_compare_item(item, row))
+			tag = ZBX_DBSYNC_ROW_UPDATE;
+
+		if (ZBX_DBSYNC_ROW_NONE != tag)
+			dbsync_add_row(sync, rowid, tag, row);
+	}
+
+	if (0 == itemids.values_num)
+	{
+		zbx_hashset_iter_reset(&dbsync_env.cache->items, &iter);
+		while (NULL != (item = (ZBX_DC_ITEM *)zbx_hashset_iter_next(&iter)))
+		{
+			if (NULL == zbx_hashset_search(&ids, &item->itemid))
+				dbsync_add_row(sync, item->itemid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		}
+	}
+	else
+	{
+		/* changed items not matching the selection criteria anymore */
+		for (i = 0; i < itemids.values_num; i++)
+		{
+			if (NULL == zbx_hashset_search(&ids, &itemids.values[i]) &&
+					NULL != zbx_hashset_search(&dbsync_env.cache->items, &itemids.values[i]))
+			{
+				dbsync_add_row(sync, itemids.values[i], ZBX_DBSYNC_ROW_REMOVE, NULL);
+			}
+		}
+	}
+
+	zbx_hashset_destroy(&ids);
+	DBfree_result(result);
+
+	ret = SUCCEED;
+out:
+	if (SUCCEED == ret && ZBX_DBSYNC_UPDATE == sync->mode)
+	{
+		dbsync_env.changelogid = changelogid;
+		zbx_vector_uint64_pair_clear(&dbsync_env.changelog_gaps);
+		zbx_vector_uint64_pair_append_array(&dbsync_env.changelog_gaps, gaps.values, gaps.values_num);
+
+		if (0 != reconcile)
+		{
+			dbsync_env.reconcile_ts = now;
+
+			/* old changelog records were removed, the snapshot must be taken again */
+			dbsync_env.snapshot_due = 1;
+		}
+	}
+
+	zbx_free(sql);
+	zbx_vector_uint64_pair_destroy(&gaps);
+	zbx_vector_uint64_destroy(&itemids);
+
+	return ret;
+}
+
+static int	dbsync_compare_item_discovery(const ZBX_DC_ITEM_DISCOVERY *item_discovery, const DB_ROW dbrow)
+{
+	return dbsync_compare_uint64(dbrow[1], item_discovery->parent_itemid);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares mapping between items, prototypes and rules with         *
+ *          configuration cache                                               *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dbsync_compare_item_discovery(zbx_dbsync_t *sync)
+{
+	DB_ROW			dbrow;
+	DB_RESULT		result;
+	zbx_hashset_t		ids;
+	zbx_hashset_iter_t	iter;
+	zbx_uint64_t		rowid;
+	ZBX_DC_ITEM_DISCOVERY	*item_discovery;
+	char			**row;
+
+	if (NULL == (result = DBselect("select itemid,parent_itemid from item_discovery")))
 		return FAIL;
 
-	sshitem = (ZBX_DC_SSHITEM *)zbx_hashset_search(&dbsync_env.cache->sshitems, &item->itemid);
-	if (ITEM_TYPE_SSH == item->type)
+	dbsync_prepare(sync, 2, NULL);
+
+	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == sshitem)
-			return FAIL;
+		sync->dbresult = result;
+		return SUCCEED;
+	}
 
-		if (FAIL == dbsync_compare_uchar(dbrow[13], sshitem->authtype))
-			return FAIL;
+	zbx_hashset_create(&ids, (size_t)dbsync_env.cache->item_discovery.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
-		if (FAIL == dbsync_compare_str(dbrow[14], sshitem->username))
-			return FAIL;
+	while (NULL != (dbrow = DBfetch(result)))
+	{
+		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
 
-		if (FAIL == dbsync_compare_str(dbrow[15], sshitem->password))
-			return FAIL;
+		ZBX_STR2UINT64(rowid, dbrow[0]);
+		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		if (FAIL == dbsync_compare_str(dbrow[16], sshitem->publickey))
-			return FAIL;
+		row = dbsync_preproc_row(sync, dbrow);
 
-		if (FAIL == dbsync_compare_str(dbrow[17], sshitem->privatekey))
-			return FAIL;
+		if (NULL == (item_discovery = (ZBX_DC_ITEM_DISCOVERY *)zbx_hashset_search(
+				&dbsync_env.cache->item_discovery, &rowid)))
+		{
+			tag = ZBX_DBSYNC_ROW_ADD;
+		}
+		else if (FAIL == dbsync_compare_item_discovery(item_discovery, row))
+			tag = ZBX_DBSYNC_ROW_UPDATE;
 
-		if (FAIL == dbsync_compare_str(dbrow[13], sshitem->params))
-			return FAIL;
+		if (ZBX_DBSYNC_ROW_NONE != tag)
+			dbsync_add_row(sync, rowid, tag, row);
 	}
-	else if (NULL != sshitem)
+
+	zbx_hashset_iter_reset(&dbsync_env.cache->item_discovery, &iter);
+	while (NULL != (item_discovery = (ZBX_DC_ITEM_DISCOVERY *)zbx_hashset_iter_next(&iter)))
+	{
+		if (NULL == zbx_hashset_search(&ids, &item_discovery->itemid))
+			dbsync_add_row(sync, item_discovery->itemid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+	}
+
+	zbx_hashset_destroy(&ids);
+	DBfree_result(result);
+
+	return SUCCEED;
+}
+
+static int	dbsync_compare_template_item(const ZBX_DC_TEMPLATE_ITEM *item, const DB_ROW dbrow)
+{
+	if (FAIL == dbsync_compare_uint64(dbrow[1], item->hostid))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_uint64(dbrow[2], item->templateid))
 		return FAIL;
 
-	telnetitem = (ZBX_DC_TELNETITEM *)zbx_hashset_search(&dbsync_env.cache->telnetitems, &item->itemid);
-	if (ITEM_TYPE_TELNET == item->type)
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares items that belong to templates with configuration cache  *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dbsync_compare_template_items(zbx_dbsync_t *sync)
+{
+	DB_ROW			dbrow;
+	DB_RESULT		result;
+	zbx_hashset_t		ids;
+	zbx_hashset_iter_t	iter;
+	zbx_uint64_t		rowid;
+	ZBX_DC_TEMPLATE_ITEM	*item;
+	char			**row;
+
+	if (NULL == (result = DBselect(
+			"select i.itemid,i.hostid,i.templateid from items i inner join hosts h on i.hostid=h.hostid"
+			" where h.status=%d", HOST_STATUS_TEMPLATE)))
 	{
-		if (NULL == telnetitem)
-			return FAIL;
-
-		if (FAIL == dbsync_compare_str(dbrow[14], telnetitem->username))
-			return FAIL;
+		return FAIL;
+	}
 
-		if (FAIL == dbsync_compare_str(dbrow[15], telnetitem->password))
-			return FAIL;
+	dbsync_prepare(sync, 3, NULL);
 
-		if (FAIL == dbsync_compare_str(dbrow[11], telnetitem->params))
-			return FAIL;
+	if (ZBX_DBSYNC_INIT == sync->mode)
+	{
+		sync->dbresult = result;
+		return SUCCEED;
 	}
-	else if (NULL != telnetitem)
-		return FAIL;
 
-	scriptitem = (ZBX_DC_SCRIPTITEM *)zbx_hashset_search(&dbsync_env.cache->scriptitems, &item->itemid);
-	if (ITEM_TYPE_SCRIPT == item->type)
-	{
-		if (NULL == scriptitem)
-			return FAIL;
+	zbx_hashset_create(&ids, dbsync_env.cache->template_items.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
-		if (FAIL == dbsync_compare_str(dbrow[14], scriptitem->timeout))
-			return FAIL;
+	while (NULL != (dbrow = DBfetch(result)))
+	{
+		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
 
-		if (FAIL == dbsync_compare_str(dbrow[11], scriptitem->script))
-			return FAIL;
-	}
-	else if (NULL != scriptitem)
-		return FAIL;
+		ZBX_STR2UINT64(rowid, dbrow[0]);
+		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-	simpleitem = (ZBX_DC_SIMPLEITEM *)zbx_hashset_search(&dbsync_env.cache->simpleitems, &item->itemid);
-	if (ITEM_TYPE_SIMPLE == item->type)
-	{
-		if (NULL == simpleitem)
-			return FAIL;
+		row = dbsync_preproc_row(sync, dbrow);
 
-		if (FAIL == dbsync_compare_str(dbrow[14], simpleitem->username))
-			return FAIL;
+		if (NULL == (item = (ZBX_DC_TEMPLATE_ITEM *)zbx_hashset_search(&dbsync_env.cache->template_items,
+				&rowid)))
+		{
+			tag = ZBX_DBSYNC_ROW_ADD;
+		}
+		else if (FAIL == dbsync_compare_template_item(item, row))
+			tag = ZBX_DBSYNC_ROW_UPDATE;
 
-		if (FAIL == dbsync_compare_str(dbrow[15], simpleitem->password))
-			return FAIL;
+		if (ZBX_DBSYNC_ROW_NONE != tag)
+			dbsync_add_row(sync, rowid, tag, row);
 	}
-	else if (NULL != simpleitem)
-		return FAIL;
 
-	jmxitem = (ZBX_DC_JMXITEM *)zbx_hashset_search(&dbsync_env.cache->jmxitems, &item->itemid);
-	if (ITEM_TYPE_JMX == item->type)
+	zbx_hashset_iter_reset(&dbsync_env.cache->template_items, &iter);
+	while (NULL != (item = (ZBX_DC_TEMPLATE_ITEM *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == jmxitem)
-			return FAIL;
+		if (NULL == zbx_hashset_search(&ids, &item->itemid))
+			dbsync_add_row(sync, item->itemid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+	}
 
-		if (FAIL == dbsync_compare_str(dbrow[14], jmxitem->username))
-			return FAIL;
+	zbx_hashset_destroy(&ids);
+	DBfree_result(result);
 
-		if (FAIL == dbsync_compare_str(dbrow[15], jmxitem->password))
-			return FAIL;
+	return SUCCEED;
+}
 
-		if (FAIL == dbsync_compare_str(dbrow[28], jmxitem->jmx_endpoint))
-			return FAIL;
-	}
-	else if (NULL != jmxitem)
+static int	dbsync_compare_prototype_item(const ZBX_DC_PROTOTYPE_ITEM *item, const DB_ROW dbrow)
+{
+	if (FAIL == dbsync_compare_uint64(dbrow[1], item->hostid))
 		return FAIL;
 
-	calcitem = (ZBX_DC_CALCITEM *)zbx_hashset_search(&dbsync_env.cache->calcitems, &item->itemid);
-	if (ITEM_TYPE_CALCULATED == item->type)
-	{
-		if (NULL == calcitem)
-			return FAIL;
+	if (FAIL == dbsync_compare_uint64(dbrow[2], item->templateid))
+		return FAIL;
 
-		if (FAIL == dbsync_compare_str(dbrow[11], calcitem->params))
-			return FAIL;
+	return SUCCEED;
+}
 
-		if (FAIL == dbsync_compare_serialized_expression(dbrow[49], calcitem->formula_bin))
-			return FAIL;
-	}
-	else if (NULL != calcitem)
-		return FAIL;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares lld item prototypes with configuration cache             *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dbsync_compare_prototype_items(zbx_dbsync_t *sync)
+{
+	DB_ROW			dbrow;
+	DB_RESULT		result;
+	zbx_hashset_t		ids;
+	zbx_hashset_iter_t	iter;
+	zbx_uint64_t		rowid;
+	ZBX_DC_PROTOTYPE_ITEM	*item;
+	char			**row;
 
-	depitem = (ZBX_DC_DEPENDENTITEM *)zbx_hashset_search(&dbsync_env.cache->dependentitems, &item->itemid);
-	if (ITEM_TYPE_DEPENDENT == item->type)
+	if (NULL == (result = DBselect(
+			"select i.itemid,i.hostid,i.templateid from items i where i.flags=%d",
+				ZBX_FLAG_DISCOVERY_PROTOTYPE)))
 	{
-		if (NULL == depitem)
-			return FAIL;
-
-		if (FAIL == dbsync_compare_uint64(dbrow[29], depitem->master_itemid))
-			return FAIL;
-	}
-	else if (NULL != depitem)
 		return FAIL;
+	}
 
-	httpitem = (ZBX_DC_HTTPITEM *)zbx_hashset_search(&dbsync_env.cache->httpitems, &item->itemid);
-	if (ITEM_TYPE_HTTPAGENT == item->type)
+	dbsync_prepare(sync, 3, NULL);
+
+	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		zbx_trim_str_list(dbrow[9], ',');
+		sync->dbresult = result;
+		return SUCCEED;
+	}
 
-		if (NULL == httpitem)
-			return FAIL;
+	zbx_hashset_create(&ids, dbsync_env.cache->prototype_items.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
-		if (FAIL == dbsync_compare_str(dbrow[30], httpitem->timeout))
-			return FAIL;
+	while (NULL != (dbrow = DBfetch(result)))
+	{
+		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
 
-		if (FAIL == dbsync_compare_str(dbrow[31], httpitem->url))
-			return FAIL;
+		ZBX_STR2UINT64(rowid, dbrow[0]);
+		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		if (FAIL == dbsync_compare_str(dbrow[32], httpitem->query_fields))
-			return FAIL;
+		row = dbsync_preproc_row(sync, dbrow);
 
-		if (FAIL == dbsync_compare_str(dbrow[33], httpitem->posts))
-			return FAIL;
+		if (NULL == (item = (ZBX_DC_PROTOTYPE_ITEM *)zbx_hashset_search(&dbsync_env.cache->prototype_items,
+				&rowid)))
+		{
+			tag = ZBX_DBSYNC_ROW_ADD;
+		}
+		else if (FAIL == dbsync_compare_prototype_item(item, row))
+			tag = ZBX_DBSYNC_ROW_UPDATE;
 
-		if (FAIL == dbsync_compare_str(dbrow[34], httpitem->status_codes))
-			return FAIL;
+		if (ZBX_DBSYNC_ROW_NONE != tag)
+			dbsync_add_row(sync, rowid, tag, row);
+	}
 
-		if (FAIL == dbsync_compare_uchar(dbrow[35], httpitem->follow_redirects))
-			return FAIL;
+	zbx_hashset_iter_reset(&dbsync_env.cache->prototype_items, &iter);
+	while (NULL != (item = (ZBX_DC_PROTOTYPE_ITEM *)zbx_hashset_iter_next(&iter)))
+	{
+		if (NULL == zbx_hashset_search(&ids, &item->itemid))
+			dbsync_add_row(sync, item->itemid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+	}
 
-		if (FAIL == dbsync_compare_uchar(dbrow[36], httpitem->post_type))
-			return FAIL;
+	zbx_hashset_destroy(&ids);
+	DBfree_result(result);
 
-		if (FAIL == dbsync_compare_str(dbrow[37], httpitem->http_proxy))
-			return FAIL;
+	return SUCCEED;
+}
 
-		if (FAIL == dbsync_compare_str(dbrow[38], httpitem->headers))
-			return FAIL;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares triggers table row with cached configuration data        *
+ *                                                                            *
+ * Parameter: trigger - [IN] the cached trigger                               *
+ *            dbrow   - [IN] the database row                                 *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches configuration data                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_compare_trigger(const ZBX_DC_TRIGGER *trigger, const DB_ROW dbrow)
+{
+	if (ZBX_FLAG_DISCOVERY_PROTOTYPE == atoi(dbrow[19]))
+		return dbsync_compare_uchar(dbrow[19], trigger->flags);
 
-		if (FAIL == dbsync_compare_uchar(dbrow[39], httpitem->retrieve_mode))
-			return FAIL;
+	if (FAIL == dbsync_compare_str(dbrow[1], trigger->description))
+		return FAIL;
 
-		if (FAIL == dbsync_compare_uchar(dbrow[40], httpitem->request_method))
-			return FAIL;
+	if (FAIL == dbsync_compare_str(dbrow[2], trigger->expression))
+		return FAIL;
 
-		if (FAIL == dbsync_compare_uchar(dbrow[41], httpitem->output_format))
-			return FAIL;
+	if (FAIL == dbsync_compare_uchar(dbrow[4], trigger->priority))
+		return FAIL;
 
-		if (FAIL == dbsync_compare_str(dbrow[42], httpitem->ssl_cert_file))
-			return FAIL;
+	if (FAIL == dbsync_compare_uchar(dbrow[5], trigger->type))
+		return FAIL;
 
-		if (FAIL == dbsync_compare_str(dbrow[43], httpitem->ssl_key_file))
-			return FAIL;
+	if (FAIL == dbsync_compare_uchar(dbrow[9], trigger->status))
+		return FAIL;
 
-		if (FAIL == dbsync_compare_str(dbrow[44], httpitem->ssl_key_password))
-			return FAIL;
+	if (FAIL == dbsync_compare_uchar(dbrow[10], trigger->recovery_mode))
+		return FAIL;
 
-		if (FAIL == dbsync_compare_uchar(dbrow[45], httpitem->verify_peer))
-			return FAIL;
+	if (FAIL == dbsync_compare_str(dbrow[11], trigger->recovery_expression))
+		return FAIL;
 
-		if (FAIL == dbsync_compare_uchar(dbrow[46], httpitem->verify_host))
-			return FAIL;
+	if (FAIL == dbsync_compare_uchar(dbrow[12], trigger->correlation_mode))
+		return FAIL;
 
-		if (FAIL == dbsync_compare_uchar(dbrow[13], httpitem->authtype))
-			return FAIL;
+	if (FAIL == dbsync_compare_str(dbrow[13], trigger->correlation_tag))
+		return FAIL;
 
-		if (FAIL == dbsync_compare_str(dbrow[14], httpitem->username))
-			return FAIL;
+	if (FAIL == dbsync_compare_str(dbrow[14], trigger->opdata))
+		return FAIL;
 
-		if (FAIL == dbsync_compare_str(dbrow[15], httpitem->password))
-			return FAIL;
+	if (FAIL == dbsync_compare_str(dbrow[15], trigger->event_name))
+		return FAIL;
 
-		if (FAIL == dbsync_compare_uchar(dbrow[47], httpitem->allow_traps))
-			return FAIL;
+	if (FAIL == dbsync_compare_serialized_expression(dbrow[16], trigger->expression_bin))
+		return FAIL;
 
-		if (FAIL == dbsync_compare_str(dbrow[10], httpitem->trapper_hosts))
-			return FAIL;
-	}
-	else if (NULL != httpitem)
+	if (TRIGGER_RECOVERY_MODE_RECOVERY_EXPRESSION == atoi(dbrow[10]) &&
+			FAIL == dbsync_compare_serialized_expression(dbrow[17], trigger->recovery_expression_bin))
+	{
 		return FAIL;
+	}
 
 	return SUCCEED;
 }
@@ -1763,189 +3348,137 @@ static int	dbsync_compare_item(const ZBX_DC_ITEM *item, const DB_ROW dbrow)
  *                                                                            *
  * Comments: The row preprocessing can be used to expand user macros in       *
  *           some columns.                                                    *
+ *           During preprocessing trigger expression/recovery expression are  *
+ *           parsed, serialized and stored as base64 strings into 16,17       *
+ *           columns.                                                         *
  *                                                                            *
  ******************************************************************************/
-static char	**dbsync_item_preproc_row(char **row)
+static char	**dbsync_trigger_preproc_row(char **row)
 {
-#define ZBX_DBSYNC_ITEM_COLUMN_DELAY	0x01
-#define ZBX_DBSYNC_ITEM_COLUMN_HISTORY	0x02
-#define ZBX_DBSYNC_ITEM_COLUMN_TRENDS	0x04
-#define ZBX_DBSYNC_ITEM_COLUMN_CALCITEM	0x08
-
-	zbx_uint64_t	hostid;
-	unsigned char	flags = 0, type;
-
-	/* return the original row if user macros are not used in target columns */
-
-	ZBX_STR2UCHAR(type, row[3]);
-
-	if (SUCCEED == dbsync_check_row_macros(row, 8))
-		flags |= ZBX_DBSYNC_ITEM_COLUMN_DELAY;
-
-	if (SUCCEED == dbsync_check_row_macros(row, 23))
-		flags |= ZBX_DBSYNC_ITEM_COLUMN_HISTORY;
-
-	if (SUCCEED == dbsync_check_row_macros(row, 24))
-		flags |= ZBX_DBSYNC_ITEM_COLUMN_TRENDS;
+	zbx_vector_uint64_t	hostids, functionids;
+	zbx_eval_context_t	ctx, ctx_r;
+	char			*error = NULL;
+	unsigned char		mode, timer = ZBX_TRIGGER_TIMER_DEFAULT, flags;
 
-	if (ITEM_TYPE_CALCULATED == type)
-		flags |= ZBX_DBSYNC_ITEM_COLUMN_CALCITEM;
+	ZBX_STR2UCHAR(flags, row[19]);
 
-	if (0 == flags)
+	if (ZBX_FLAG_DISCOVERY_PROTOTYPE == flags)
 		return row;
 
-	/* get associated host identifier */
-	ZBX_STR2UINT64(hostid, row[1]);
-
-	/* expand user macros */
+	zbx_vector_uint64_create(&hostids);
+	zbx_vector_uint64_create(&functionids);
 
-	if (0 != (flags & ZBX_DBSYNC_ITEM_COLUMN_DELAY))
-		row[8] = dc_expand_user_macros(row[8], &hostid, 1);
+	if (FAIL == zbx_eval_parse_expression(&ctx, row[2], ZBX_EVAL_TRIGGER_EXPRESSION, &error))
+	{
+		zbx_eval_set_exception(&ctx, zbx_dsprintf(NULL, "cannot parse trigger expression: %s", error));
+		zbx_free(error);
+	}
+	else
+	{
+		zbx_eval_get_functionids(&ctx, &functionids);
 
-	if (0 != (flags & ZBX_DBSYNC_ITEM_COLUMN_HISTORY))
-		row[22] = dc_expand_user_macros(row[22], &hostid, 1);
+		if (SUCCEED == zbx_eval_check_timer_functions(&ctx))
+			timer |= ZBX_TRIGGER_TIMER_EXPRESSION;
+	}
 
-	if (0 != (flags & ZBX_DBSYNC_ITEM_COLUMN_TRENDS))
-		row[23] = dc_expand_user_macros(row[23], &hostid, 1);
+	ZBX_STR2UCHAR(mode, row[10]);
 
-	if (ITEM_TYPE_CALCULATED == type)
+	if (TRIGGER_RECOVERY_MODE_RECOVERY_EXPRESSION == mode)
 	{
-		zbx_eval_context_t	ctx;
-		char			*error = NULL;
-
-		if (FAIL == zbx_eval_parse_expression(&ctx, row[11], ZBX_EVAL_PARSE_CALC_EXPRESSION, &error))
+		if (FAIL == zbx_eval_parse_expression(&ctx_r, row[11], ZBX_EVAL_TRIGGER_EXPRESSION, &error))
 		{
-			zbx_eval_set_exception(&ctx, zbx_dsprintf(NULL, "Cannot parse formula: %s", error));
+			zbx_eval_set_exception(&ctx_r, zbx_dsprintf(NULL, "cannot parse trigger recovery"
+					" expression: %s", error));
 			zbx_free(error);
 		}
 		else
 		{
-			if (SUCCEED != zbx_eval_expand_user_macros(&ctx, &hostid, 1, dc_expand_user_macros_len, &error))
-			{
-				zbx_eval_clear(&ctx);
-				zbx_eval_set_exception(&ctx, zbx_dsprintf(NULL, "Cannot evaluate formula: %s", error));
-				zbx_free(error);
-			}
-		}
+			zbx_eval_get_functionids(&ctx_r, &functionids);
 
-		row[49] = encode_expression(&ctx);
-		zbx_eval_clear(&ctx);
+			if (SUCCEED == zbx_eval_check_timer_functions(&ctx_r))
+				timer |= ZBX_TRIGGER_TIMER_RECOVERY_EXPRESSION;
+		}
 	}
 
-	return row;
-
-#undef ZBX_DBSYNC_ITEM_COLUMN_DELAY
-#undef ZBX_DBSYNC_ITEM_COLUMN_HISTORY
-#undef ZBX_DBSYNC_ITEM_COLUMN_TRENDS
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: compares items table with cached configuration data               *
- *                                                                            *
- * Return value: SUCCEED - the changeset was successfully calculated          *
- *               FAIL    - otherwise                                          *
- *                                                                            *
- ******************************************************************************/
-int	zbx_dbsync_compare_items(zbx_dbsync_t *sync)
-{
-	DB_ROW			dbrow;
-	DB_RESULT		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	ZBX_DC_ITEM		*item;
-	char			**row;
-
-	if (NULL == (result = DBselect(
-			"select i.itemid,i.hostid,i.status,i.type,i.value_type,i.key_,i.snmp_oid,i.ipmi_sensor,i.delay,"
-				"i.trapper_hosts,i.logtimefmt,i.params,ir.state,i.authtype,i.username,i.password,"
-				"i.publickey,i.privatekey,i.flags,i.interfaceid,ir.lastlogsize,ir.mtime,"
-				"i.history,i.trends,i.inventory_link,i.valuemapid,i.units,ir.error,i.jmx_endpoint,"
-				"i.master_itemid,i.timeout,i.url,i.query_fields,i.posts,i.status_codes,"
-				"i.follow_redirects,i.post_type,i.http_proxy,i.headers,i.retrieve_mode,"
-				"i.request_method,i.output_format,i.ssl_cert_file,i.ssl_key_file,i.ssl_key_password,"
-				"i.verify_peer,i.verify_host,i.allow_traps,i.templateid,null"
-			" from items i"
-			" inner join hosts h on i.hostid=h.hostid"
-			" join item_rtdata ir on i.itemid=ir.itemid"
-			" where h.status in (%d,%d) and i.flags<>%d",
-			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED, ZBX_FLAG_DISCOVERY_PROTOTYPE)))
-
-	{
-		return FAIL;
-	}
+	zbx_vector_uint64_sort(&functionids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&functionids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
-	dbsync_prepare(sync, 50, dbsync_item_preproc_row);
+	dc_get_hostids_by_functionids(functionids.values, functionids.values_num, &hostids);
 
-	if (ZBX_DBSYNC_INIT == sync->mode)
+	if (NULL != ctx.expression)
 	{
-		sync->dbresult = result;
-		return SUCCEED;
+		if (SUCCEED != zbx_eval_expand_user_macros(&ctx, hostids.values, hostids.values_num,
+				dc_expand_user_macros_len, &error))
+		{
+			zbx_eval_clear(&ctx);
+			zbx_eval_set_exception(&ctx, zbx_dsprintf(NULL, "cannot evaluate expression: %s", error));
+			zbx_free(error);
+		}
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->items.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-
-	while (NULL != (dbrow = DBfetch(result)))
-	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
-
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
-
-		row = dbsync_preproc_row(sync, dbrow);
-
-		if (NULL == (item = (ZBX_DC_ITEM *)zbx_hashset_search(&dbsync_env.cache->items, &rowid)))
-			tag = ZBX_DBSYNC_ROW_ADD;
-		else if (FAIL == dbsync_compare_item(item, row))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
-
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, row);
-	}
+	row[16] = encode_expression(&ctx);
+	zbx_eval_clear(&ctx);
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->items, &iter);
-	while (NULL != (item = (ZBX_DC_ITEM *)zbx_hashset_iter_next(&iter)))
+	if (TRIGGER_RECOVERY_MODE_RECOVERY_EXPRESSION == mode)
 	{
-		if (NULL == zbx_hashset_search(&ids, &item->itemid))
-			dbsync_add_row(sync, item->itemid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL != ctx_r.expression)
+		{
+			if (SUCCEED != zbx_eval_expand_user_macros(&ctx_r, hostids.values, hostids.values_num,
+					dc_expand_user_macros_len, &error))
+			{
+				zbx_eval_clear(&ctx_r);
+				zbx_eval_set_exception(&ctx_r, zbx_dsprintf(NULL, "cannot evaluate recovery"
+						" expression: %s", error));
+				zbx_free(error);
+			}
+		}
+		row[17] = encode_expression(&ctx_r);
+		zbx_eval_clear(&ctx_r);
 	}
 
-	zbx_hashset_destroy(&ids);
-	DBfree_result(result);
+	row[18] = zbx_dsprintf(NULL, "%d", timer);
 
-	return SUCCEED;
-}
+	zbx_vector_uint64_destroy(&functionids);
+	zbx_vector_uint64_destroy(&hostids);
 
-static int	dbsync_compare_item_discovery(const ZBX_DC_ITEM_DISCOVERY *item_discovery, const DB_ROW dbrow)
-{
-	return dbsync_compare_uint64(dbrow[1], item_discovery->parent_itemid);
+	return row;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares mapping between items, prototypes and rules with         *
- *          configuration cache                                               *
+ * Purpose: compares triggers table with cached configuration data            *
+ *                                                                            *
+ * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
  * Return value: SUCCEED - the changeset was successfully calculated          *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comment: The 16th and 17th fields (starting with 0) are placeholders for   *
+ *          serialized expression/recovery expression.                        *
+ *          The 18th field is placeholder for trigger timer flag (set if      *
+ *          expression/recovery expression contains timer functions).         *
+ *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_item_discovery(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_triggers(zbx_dbsync_t *sync)
 {
 	DB_ROW			dbrow;
 	DB_RESULT		result;
 	zbx_hashset_t		ids;
 	zbx_hashset_iter_t	iter;
 	zbx_uint64_t		rowid;
-	ZBX_DC_ITEM_DISCOVERY	*item_discovery;
+	ZBX_DC_TRIGGER		*trigger;
 	char			**row;
 
-	if (NULL == (result = DBselect("select itemid,parent_itemid from item_discovery")))
+	if (NULL == (result = DBselect(
+			"select triggerid,description,expression,error,priority,type,value,state,lastchange,status,"
+			"recovery_mode,recovery_expression,correlation_mode,correlation_tag,opdata,event_name,null,"
+			"null,null,flags"
+			" from triggers")))
+	{
 		return FAIL;
+	}
 
-	dbsync_prepare(sync, 2, NULL);
+	dbsync_prepare(sync, 20, dbsync_trigger_preproc_row);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -1953,35 +3486,32 @@ int	zbx_dbsync_compare_item_discovery(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, (size_t)dbsync_env.cache->item_discovery.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	zbx_hashset_create(&ids, dbsync_env.cache->triggers.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	while (NULL != (dbrow = DBfetch(result)))
 	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
-
 		ZBX_STR2UINT64(rowid, dbrow[0]);
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
 		row = dbsync_preproc_row(sync, dbrow);
 
-		if (NULL == (item_discovery = (ZBX_DC_ITEM_DISCOVERY *)zbx_hashset_search(
-				&dbsync_env.cache->item_discovery, &rowid)))
+		if (NULL == (trigger = (ZBX_DC_TRIGGER *)zbx_hashset_search(&dbsync_env.cache->triggers, &rowid)))
 		{
-			tag = ZBX_DBSYNC_ROW_ADD;
+			dbsync_add_row(sync, rowid, ZBX_DBSYNC_ROW_ADD, row);
+		}
+		else
+		{
+			if (FAIL == dbsync_compare_trigger(trigger, row))
+				dbsync_add_row(sync, rowid, ZBX_DBSYNC_ROW_UPDATE, row);
 		}
-		else if (FAIL == dbsync_compare_item_discovery(item_discovery, row))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
-
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, row);
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->item_discovery, &iter);
-	while (NULL != (item_discovery = (ZBX_DC_ITEM_DISCOVERY *)zbx_hashset_iter_next(&iter)))
+	zbx_hashset_iter_reset(&dbsync_env.cache->triggers, &iter);
+	while (NULL != (trigger = (ZBX_DC_TRIGGER *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &item_discovery->itemid))
-			dbsync_add_row(sync, item_discovery->itemid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL == zbx_hashset_search(&ids, &trigger->triggerid))
+			dbsync_add_row(sync, trigger->triggerid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	zbx_hashset_destroy(&ids);
@@ -1990,43 +3520,32 @@ int	zbx_dbsync_compare_item_discovery(zbx_dbsync_t *sync)
 	return SUCCEED;
 }
 
-static int	dbsync_compare_template_item(const ZBX_DC_TEMPLATE_ITEM *item, const DB_ROW dbrow)
-{
-	if (FAIL == dbsync_compare_uint64(dbrow[1], item->hostid))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_uint64(dbrow[2], item->templateid))
-		return FAIL;
-
-	return SUCCEED;
-}
-
 /******************************************************************************
  *                                                                            *
- * Purpose: compares items that belong to templates with configuration cache  *
+ * Purpose: compares trigger_depends table with cached configuration data     *
+ *                                                                            *
+ * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
  * Return value: SUCCEED - the changeset was successfully calculated          *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_template_items(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_trigger_dependency(zbx_dbsync_t *sync)
 {
 	DB_ROW			dbrow;
 	DB_RESULT		result;
-	zbx_hashset_t		ids;
+	zbx_hashset_t		deps;
 	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	ZBX_DC_TEMPLATE_ITEM	*item;
-	char			**row;
+	ZBX_DC_TRIGGER_DEPLIST	*dep_down, *dep_up;
+	zbx_uint64_pair_t	*dep, dep_local;
+	char			down_s[MAX_ID_LEN + 1], up_s[MAX_ID_LEN + 1];
+	char			*del_row[2] = {down_s, up_s};
+	int			i;
 
-	if (NULL == (result = DBselect(
-			"select i.itemid,i.hostid,i.templateid from items i inner join hosts h on i.hostid=h.hostid"
-			" where h.status=%d", HOST_STATUS_TEMPLATE)))
-	{
+	if (NULL == (result = DBselect("select triggerid_down,triggerid_up from trigger_depends")))
 		return FAIL;
-	}
 
-	dbsync_prepare(sync, 3, NULL);
+	dbsync_prepare(sync, 2, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -2034,49 +3553,72 @@ int	zbx_dbsync_compare_template_items(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->template_items.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_create(&deps, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
 
-	while (NULL != (dbrow = DBfetch(result)))
+	/* index all host->template links */
+	zbx_hashset_iter_reset(&dbsync_env.cache->trigdeps, &iter);
+	while (NULL != (dep_down = (ZBX_DC_TRIGGER_DEPLIST *)zbx_hashset_iter_next(&iter)))
 	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
-
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
-
-		row = dbsync_preproc_row(sync, dbrow);
+		dep_local.first = dep_down->triggerid;
 
-		if (NULL == (item = (ZBX_DC_TEMPLATE_ITEM *)zbx_hashset_search(&dbsync_env.cache->template_items,
-				&rowid)))
+		for (i = 0; i < dep_down->dependencies.values_num; i++)
 		{
-			tag = ZBX_DBSYNC_ROW_ADD;
+			dep_up = (ZBX_DC_TRIGGER_DEPLIST *)dep_down->dependencies.values[i];
+			dep_local.second = dep_up->triggerid;
+			zbx_hashset_insert(&deps, &dep_local, sizeof(dep_local));
 		}
-		else if (FAIL == dbsync_compare_template_item(item, row))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
+	}
 
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, row);
+	/* add new rows, remove existing rows from index */
+	while (NULL != (dbrow = DBfetch(result)))
+	{
+		ZBX_STR2UINT64(dep_local.first, dbrow[0]);
+		ZBX_STR2UINT64(dep_local.second, dbrow[1]);
+
+		if (NULL == (dep = (zbx_uint64_pair_t *)zbx_hashset_search(&deps, &dep_local)))
+			dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_ADD, dbrow);
+		else
+			zbx_hashset_remove_direct(&deps, dep);
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->template_items, &iter);
-	while (NULL != (item = (ZBX_DC_TEMPLATE_ITEM *)zbx_hashset_iter_next(&iter)))
+	/* add removed rows */
+	zbx_hashset_iter_reset(&deps, &iter);
+	while (NULL != (dep = (zbx_uint64_pair_t *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &item->itemid))
-			dbsync_add_row(sync, item->itemid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		zbx_snprintf(down_s, sizeof(down_s), ZBX_FS_UI64, dep->first);
+		zbx_snprintf(up_s, sizeof(up_s), ZBX_FS_UI64, dep->second);
+		dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_REMOVE, del_row);
 	}
 
-	zbx_hashset_destroy(&ids);
 	DBfree_result(result);
+	zbx_hashset_destroy(&deps);
 
 	return SUCCEED;
 }
 
-static int	dbsync_compare_prototype_item(const ZBX_DC_PROTOTYPE_ITEM *item, const DB_ROW dbrow)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares functions table row with cached configuration data       *
+ *                                                                            *
+ * Parameter: function - [IN] the cached function                             *
+ *            dbrow    - [IN] the database row                                *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches configuration data                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_compare_function(const ZBX_DC_FUNCTION *function, const DB_ROW dbrow)
 {
-	if (FAIL == dbsync_compare_uint64(dbrow[1], item->hostid))
+	if (FAIL == dbsync_compare_uint64(dbrow[0], function->itemid))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_uint64(dbrow[2], item->templateid))
+	if (FAIL == dbsync_compare_uint64(dbrow[4], function->triggerid))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_str(dbrow[2], function->function))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_str(dbrow[3], function->parameter))
 		return FAIL;
 
 	return SUCCEED;
@@ -2084,30 +3626,65 @@ static int	dbsync_compare_prototype_item(const ZBX_DC_PROTOTYPE_ITEM *item, cons
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares lld item prototypes with configuration cache             *
+ * Purpose: applies necessary preprocessing before row is compared/used       *
+ *                                                                            *
+ * Parameter: row - [IN] the row to preprocess                                *
+ *                                                                            *
+ * Return value: the preprocessed row                                         *
+ *                                                                            *
+ * Comments: The row preprocessing can be used to expand user macros in       *
+ *           some columns.                                                    *
+ *                                                                            *
+ ******************************************************************************/
+static char	**dbsync_function_preproc_row(char **row)
+{
+	const char	*row3;
+
+	/* first parameter is /host/key placeholder $, don't cache it */
+	if (NULL == (row3 = strchr(row[3], ',')))
+		row3 = "";
+	else
+		row3++;
+
+	/* return the original row if user macros are not used in target columns */
+	if (SUCCEED == dbsync_check_row_macros(row, 3))
+	{
+		zbx_uint64_t	itemid;
+		/* get associated host identifier */
+		ZBX_STR2UINT64(itemid, row[0]);
+
+		row[3] = dc_expand_user_macros_in_func_params(row3, itemid);
+	}
+	else
+		row[3] = zbx_strdup(NULL, row3);
+
+	return row;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares functions table with cached configuration data           *
+ *                                                                            *
+ * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
  * Return value: SUCCEED - the changeset was successfully calculated          *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_prototype_items(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_functions(zbx_dbsync_t *sync)
 {
 	DB_ROW			dbrow;
 	DB_RESULT		result;
 	zbx_hashset_t		ids;
 	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	ZBX_DC_PROTOTYPE_ITEM	*item;
+	zbx_uint64_t		rowid, itemid;
+	ZBX_DC_FUNCTION		*function;
 	char			**row;
 
-	if (NULL == (result = DBselect(
-			"select i.itemid,i.hostid,i.templateid from items i where i.flags=%d",
-				ZBX_FLAG_DISCOVERY_PROTOTYPE)))
-	{
+	if (NULL == (result = DBselect("select itemid,functionid,name,parameter,triggerid from functions")))
 		return FAIL;
-	}
 
-	dbsync_prepare(sync, 3, NULL);
+	dbsync_prepare(sync, 5, dbsync_function_preproc_row);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -2115,35 +3692,36 @@ int	zbx_dbsync_compare_prototype_items(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->prototype_items.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	zbx_hashset_create(&ids, dbsync_env.cache->functions.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	while (NULL != (dbrow = DBfetch(result)))
 	{
 		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
 
-		ZBX_STR2UINT64(rowid, dbrow[0]);
+		ZBX_STR2UINT64(itemid, dbrow[0]);
+		if (NULL == (ZBX_DC_ITEM *)zbx_hashset_search(&config->items, &itemid))
+			continue;
+
+		ZBX_STR2UINT64(rowid, dbrow[1]);
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
 		row = dbsync_preproc_row(sync, dbrow);
 
-		if (NULL == (item = (ZBX_DC_PROTOTYPE_ITEM *)zbx_hashset_search(&dbsync_env.cache->prototype_items,
-				&rowid)))
-		{
+		if (NULL == (function = (ZBX_DC_FUNCTION *)zbx_hashset_search(&dbsync_env.cache->functions, &rowid)))
 			tag = ZBX_DBSYNC_ROW_ADD;
-		}
-		else if (FAIL == dbsync_compare_prototype_item(item, row))
+		else if (FAIL == dbsync_compare_function(function, row))
 			tag = ZBX_DBSYNC_ROW_UPDATE;
 
 		if (ZBX_DBSYNC_ROW_NONE != tag)
 			dbsync_add_row(sync, rowid, tag, row);
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->prototype_items, &iter);
-	while (NULL != (item = (ZBX_DC_PROTOTYPE_ITEM *)zbx_hashset_iter_next(&iter)))
+	zbx_hashset_iter_reset(&dbsync_env.cache->functions, &iter);
+	while (NULL != (function = (ZBX_DC_FUNCTION *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &item->itemid))
-			dbsync_add_row(sync, item->itemid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL == zbx_hashset_search(&ids, &function->functionid))
+			dbsync_add_row(sync, function->functionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	zbx_hashset_destroy(&ids);
@@ -2154,206 +3732,162 @@ int	zbx_dbsync_compare_prototype_items(zbx_dbsync_t *sync)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares triggers table row with cached configuration data        *
+ * Purpose: compares expressions table row with cached configuration data     *
  *                                                                            *
- * Parameter: trigger - [IN] the cached trigger                               *
- *            dbrow   - [IN] the database row                                 *
+ * Parameter: expression - [IN] the cached expression                         *
+ *            dbrow      - [IN] the database row                              *
  *                                                                            *
  * Return value: SUCCEED - the row matches configuration data                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_trigger(const ZBX_DC_TRIGGER *trigger, const DB_ROW dbrow)
+static int	dbsync_compare_expression(const ZBX_DC_EXPRESSION *expression, const DB_ROW dbrow)
 {
-	if (ZBX_FLAG_DISCOVERY_PROTOTYPE == atoi(dbrow[19]))
-		return dbsync_compare_uchar(dbrow[19], trigger->flags);
-
-	if (FAIL == dbsync_compare_str(dbrow[1], trigger->description))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_str(dbrow[2], trigger->expression))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_uchar(dbrow[4], trigger->priority))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_uchar(dbrow[5], trigger->type))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_uchar(dbrow[9], trigger->status))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_uchar(dbrow[10], trigger->recovery_mode))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_str(dbrow[11], trigger->recovery_expression))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_uchar(dbrow[12], trigger->correlation_mode))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_str(dbrow[13], trigger->correlation_tag))
+	if (FAIL == dbsync_compare_str(dbrow[0], expression->regexp))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_str(dbrow[14], trigger->opdata))
+	if (FAIL == dbsync_compare_str(dbrow[2], expression->expression))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_str(dbrow[15], trigger->event_name))
+	if (FAIL == dbsync_compare_uchar(dbrow[3], expression->type))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_serialized_expression(dbrow[16], trigger->expression_bin))
+	if (*dbrow[4] != expression->delimiter)
 		return FAIL;
 
-	if (TRIGGER_RECOVERY_MODE_RECOVERY_EXPRESSION == atoi(dbrow[10]) &&
-			FAIL == dbsync_compare_serialized_expression(dbrow[17], trigger->recovery_expression_bin))
-	{
+	if (FAIL == dbsync_compare_uchar(dbrow[5], expression->case_sensitive))
 		return FAIL;
-	}
 
 	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: applies necessary preprocessing before row is compared/used       *
- *                                                                            *
- * Parameter: row - [IN] the row to preprocess                                *
+ * Purpose: compares expressions, regexps tables with cached configuration    *
+ *          data                                                              *
  *                                                                            *
- * Return value: the preprocessed row                                         *
+ * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
- * Comments: The row preprocessing can be used to expand user macros in       *
- *           some columns.                                                    *
- *           During preprocessing trigger expression/recovery expression are  *
- *           parsed, serialized and stored as base64 strings into 16,17       *
- *           columns.                                                         *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static char	**dbsync_trigger_preproc_row(char **row)
+int	zbx_dbsync_compare_expressions(zbx_dbsync_t *sync)
 {
-	zbx_vector_uint64_t	hostids, functionids;
-	zbx_eval_context_t	ctx, ctx_r;
-	char			*error = NULL;
-	unsigned char		mode, timer = ZBX_TRIGGER_TIMER_DEFAULT, flags;
-
-	ZBX_STR2UCHAR(flags, row[19]);
-
-	if (ZBX_FLAG_DISCOVERY_PROTOTYPE == flags)
-		return row;
-
-	zbx_vector_uint64_create(&hostids);
-	zbx_vector_uint64_create(&functionids);
+	DB_ROW			dbrow;
+	DB_RESULT		result;
+	zbx_hashset_t		ids;
+	zbx_hashset_iter_t	iter;
+	zbx_uint64_t		rowid;
+	ZBX_DC_EXPRESSION	*expression;
 
-	if (FAIL == zbx_eval_parse_expression(&ctx, row[2], ZBX_EVAL_TRIGGER_EXPRESSION, &error))
+	if (NULL == (result = DBselect(
+			"select r.name,e.expressionid,e.expression,e.expression_type,e.exp_delimiter,e.case_sensitive"
+			" from regexps r,expressions e"
+			" where r.regexpid=e.regexpid")))
 	{
-		zbx_eval_set_exception(&ctx, zbx_dsprintf(NULL, "cannot parse trigger expression: %s", error));
-		zbx_free(error);
+		return FAIL;
 	}
-	else
-	{
-		zbx_eval_get_functionids(&ctx, &functionids);
 
-		if (SUCCEED == zbx_eval_check_timer_functions(&ctx))
-			timer |= ZBX_TRIGGER_TIMER_EXPRESSION;
+	dbsync_prepare(sync, 6, NULL);
+
+	if (ZBX_DBSYNC_INIT == sync->mode)
+	{
+		sync->dbresult = result;
+		return SUCCEED;
 	}
 
-	ZBX_STR2UCHAR(mode, row[10]);
+	zbx_hashset_create(&ids, dbsync_env.cache->expressions.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
-	if (TRIGGER_RECOVERY_MODE_RECOVERY_EXPRESSION == mode)
+	while (NULL != (dbrow = DBfetch(result)))
 	{
-		if (FAIL == zbx_eval_parse_expression(&ctx_r, row[11], ZBX_EVAL_TRIGGER_EXPRESSION, &error))
+		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
+
+		ZBX_STR2UINT64(rowid, dbrow[1]);
+		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
+
+		if (NULL == (expression = (ZBX_DC_EXPRESSION *)zbx_hashset_search(&dbsync_env.cache->expressions,
+				&rowid)))
 		{
-			zbx_eval_set_exception(&ctx_r, zbx_dsprintf(NULL, "cannot parse trigger recovery"
-					" expression: %s", error));
-			zbx_free(error);
+			tag = ZBX_DBSYNC_ROW_ADD;
 		}
-		else
-		{
-			zbx_eval_get_functionids(&ctx_r, &functionids);
+		else if (FAIL == dbsync_compare_expression(expression, dbrow))
+			tag = ZBX_DBSYNC_ROW_UPDATE;
 
-			if (SUCCEED == zbx_eval_check_timer_functions(&ctx_r))
-				timer |= ZBX_TRIGGER_TIMER_RECOVERY_EXPRESSION;
-		}
+		if (ZBX_DBSYNC_ROW_NONE != tag)
+			dbsync_add_row(sync, rowid, tag, dbrow);
 	}
 
-	zbx_vector_uint64_sort(&functionids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-	zbx_vector_uint64_uniq(&functionids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-
-	dc_get_hostids_by_functionids(functionids.values, functionids.values_num, &hostids);
-
-	if (NULL != ctx.expression)
+	zbx_hashset_iter_reset(&dbsync_env.cache->expressions, &iter);
+	while (NULL != (expression = (ZBX_DC_EXPRESSION *)zbx_hashset_iter_next(&iter)))
 	{
-		if (SUCCEED != zbx_eval_expand_user_macros(&ctx, hostids.values, hostids.values_num,
-				dc_expand_user_macros_len, &error))
-		{
-			zbx_eval_clear(&ctx);
-			zbx_eval_set_exception(&ctx, zbx_dsprintf(NULL, "cannot evaluate expression: %s", error));
-			zbx_free(error);
-		}
+		if (NULL == zbx_hashset_search(&ids, &expression->expressionid))
+			dbsync_add_row(sync, expression->expressionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
-	row[16] = encode_expression(&ctx);
-	zbx_eval_clear(&ctx);
+	zbx_hashset_destroy(&ids);
+	DBfree_result(result);
 
-	if (TRIGGER_RECOVERY_MODE_RECOVERY_EXPRESSION == mode)
-	{
-		if (NULL != ctx_r.expression)
-		{
-			if (SUCCEED != zbx_eval_expand_user_macros(&ctx_r, hostids.values, hostids.values_num,
-					dc_expand_user_macros_len, &error))
-			{
-				zbx_eval_clear(&ctx_r);
-				zbx_eval_set_exception(&ctx_r, zbx_dsprintf(NULL, "cannot evaluate recovery"
-						" expression: %s", error));
-				zbx_free(error);
-			}
-		}
-		row[17] = encode_expression(&ctx_r);
-		zbx_eval_clear(&ctx_r);
-	}
+	return SUCCEED;
+}
 
-	row[18] = zbx_dsprintf(NULL, "%d", timer);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares actions table row with cached configuration data         *
+ *                                                                            *
+ * Parameter: action - [IN] the cached action                                 *
+ *            dbrow  - [IN] the database row                                  *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches configuration data                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_compare_action(const zbx_dc_action_t *action, const DB_ROW dbrow)
+{
 
-	zbx_vector_uint64_destroy(&functionids);
-	zbx_vector_uint64_destroy(&hostids);
+	if (FAIL == dbsync_compare_uchar(dbrow[1], action->eventsource))
+		return FAIL;
 
-	return row;
+	if (FAIL == dbsync_compare_uchar(dbrow[2], action->evaltype))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_str(dbrow[3], action->formula))
+		return FAIL;
+
+	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares triggers table with cached configuration data            *
+ * Purpose: compares actions table with cached configuration data             *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
  * Return value: SUCCEED - the changeset was successfully calculated          *
  *               FAIL    - otherwise                                          *
  *                                                                            *
- * Comment: The 16th and 17th fields (starting with 0) are placeholders for   *
- *          serialized expression/recovery expression.                        *
- *          The 18th field is placeholder for trigger timer flag (set if      *
- *          expression/recovery expression contains timer functions).         *
- *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_triggers(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_actions(zbx_dbsync_t *sync)
 {
 	DB_ROW			dbrow;
 	DB_RESULT		result;
 	zbx_hashset_t		ids;
 	zbx_hashset_iter_t	iter;
 	zbx_uint64_t		rowid;
-	ZBX_DC_TRIGGER		*trigger;
-	char			**row;
+	zbx_dc_action_t		*action;
 
 	if (NULL == (result = DBselect(
-			"select triggerid,description,expression,error,priority,type,value,state,lastchange,status,"
-			"recovery_mode,recovery_expression,correlation_mode,correlation_tag,opdata,event_name,null,"
-			"null,null,flags"
-			" from triggers")))
+			"select actionid,eventsource,evaltype,formula"
+			" from actions"
+			" where eventsource<>%d"
+				" and status=%d",
+			EVENT_SOURCE_SERVICE, ACTION_STATUS_ACTIVE)))
 	{
 		return FAIL;
 	}
 
-	dbsync_prepare(sync, 20, dbsync_trigger_preproc_row);
+	dbsync_prepare(sync, 4, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -2361,32 +3895,30 @@ int	zbx_dbsync_compare_triggers(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->triggers.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	zbx_hashset_create(&ids, dbsync_env.cache->actions.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	while (NULL != (dbrow = DBfetch(result)))
 	{
+		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
+
 		ZBX_STR2UINT64(rowid, dbrow[0]);
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		row = dbsync_preproc_row(sync, dbrow);
+		if (NULL == (action = (zbx_dc_action_t *)zbx_hashset_search(&dbsync_env.cache->actions, &rowid)))
+			tag = ZBX_DBSYNC_ROW_ADD;
+		else if (FAIL == dbsync_compare_action(action, dbrow))
+			tag = ZBX_DBSYNC_ROW_UPDATE;
 
-		if (NULL == (trigger = (ZBX_DC_TRIGGER *)zbx_hashset_search(&dbsync_env.cache->triggers, &rowid)))
-		{
-			dbsync_add_row(sync, rowid, ZBX_DBSYNC_ROW_ADD, row);
-		}
-		else
-		{
-			if (FAIL == dbsync_compare_trigger(trigger, row))
-				dbsync_add_row(sync, rowid, ZBX_DBSYNC_ROW_UPDATE, row);
-		}
+		if (ZBX_DBSYNC_ROW_NONE != tag)
+			dbsync_add_row(sync, rowid, tag, dbrow);
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->triggers, &iter);
-	while (NULL != (trigger = (ZBX_DC_TRIGGER *)zbx_hashset_iter_next(&iter)))
+	zbx_hashset_iter_reset(&dbsync_env.cache->actions, &iter);
+	while (NULL != (action = (zbx_dc_action_t *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &trigger->triggerid))
-			dbsync_add_row(sync, trigger->triggerid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL == zbx_hashset_search(&ids, &action->actionid))
+			dbsync_add_row(sync, action->actionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	zbx_hashset_destroy(&ids);
@@ -2397,7 +3929,37 @@ int	zbx_dbsync_compare_triggers(zbx_dbsync_t *sync)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares trigger_depends table with cached configuration data     *
+ * Purpose: compares action operation class and flushes update row if         *
+ *          necessary                                                         *
+ *                                                                            *
+ * Parameter: sync     - [OUT] the changeset                                  *
+ *            actionid - [IN] the action identifier                           *
+ *            opflags  - [IN] the action operation class flags                *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_compare_action_op(zbx_dbsync_t *sync, zbx_uint64_t actionid, unsigned char opflags)
+{
+	zbx_dc_action_t	*action;
+
+	if (0 == actionid)
+		return;
+
+	if (NULL == (action = (zbx_dc_action_t *)zbx_hashset_search(&dbsync_env.cache->actions, &actionid)) ||
+			opflags != action->opflags)
+	{
+		char	actionid_s[MAX_ID_LEN], opflags_s[MAX_ID_LEN];
+		char	*row[] = {actionid_s, opflags_s};
+
+		zbx_snprintf(actionid_s, sizeof(actionid_s), ZBX_FS_UI64, actionid);
+		zbx_snprintf(opflags_s, sizeof(opflags_s), "%d", opflags);
+
+		dbsync_add_row(sync, actionid, ZBX_DBSYNC_ROW_UPDATE, (DB_ROW)row);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares actions by operation class                               *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -2405,95 +3967,86 @@ int	zbx_dbsync_compare_triggers(zbx_dbsync_t *sync)
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_trigger_dependency(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_action_ops(zbx_dbsync_t *sync)
 {
 	DB_ROW			dbrow;
 	DB_RESULT		result;
-	zbx_hashset_t		deps;
-	zbx_hashset_iter_t	iter;
-	ZBX_DC_TRIGGER_DEPLIST	*dep_down, *dep_up;
-	zbx_uint64_pair_t	*dep, dep_local;
-	char			down_s[MAX_ID_LEN + 1], up_s[MAX_ID_LEN + 1];
-	char			*del_row[2] = {down_s, up_s};
-	int			i;
-
-	if (NULL == (result = DBselect("select triggerid_down,triggerid_up from trigger_depends")))
-		return FAIL;
-
-	dbsync_prepare(sync, 2, NULL);
+	zbx_uint64_t		rowid, actionid = 0;
+	unsigned char		opflags = ZBX_ACTION_OPCLASS_NONE;
 
-	if (ZBX_DBSYNC_INIT == sync->mode)
+	if (NULL == (result = DBselect(
+			"select a.actionid,o.recovery"
+			" from actions a"
+			" left join operations o"
+				" on a.actionid=o.actionid"
+			" where a.status=%d"
+			" group by a.actionid,o.recovery"
+			" order by a.actionid",
+			ACTION_STATUS_ACTIVE)))
 	{
-		sync->dbresult = result;
-		return SUCCEED;
+		return FAIL;
 	}
 
-	zbx_hashset_create(&deps, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
+	dbsync_prepare(sync, 2, NULL);
 
-	/* index all host->template links */
-	zbx_hashset_iter_reset(&dbsync_env.cache->trigdeps, &iter);
-	while (NULL != (dep_down = (ZBX_DC_TRIGGER_DEPLIST *)zbx_hashset_iter_next(&iter)))
+	while (NULL != (dbrow = DBfetch(result)))
 	{
-		dep_local.first = dep_down->triggerid;
+		ZBX_STR2UINT64(rowid, dbrow[0]);
 
-		for (i = 0; i < dep_down->dependencies.values_num; i++)
+		if (actionid != rowid)
 		{
-			dep_up = (ZBX_DC_TRIGGER_DEPLIST *)dep_down->dependencies.values[i];
-			dep_local.second = dep_up->triggerid;
-			zbx_hashset_insert(&deps, &dep_local, sizeof(dep_local));
+			dbsync_compare_action_op(sync, actionid, opflags);
+			actionid = rowid;
+			opflags = ZBX_ACTION_OPCLASS_NONE;
 		}
-	}
 
-	/* add new rows, remove existing rows from index */
-	while (NULL != (dbrow = DBfetch(result)))
-	{
-		ZBX_STR2UINT64(dep_local.first, dbrow[0]);
-		ZBX_STR2UINT64(dep_local.second, dbrow[1]);
+		if (SUCCEED == DBis_null(dbrow[1]))
+			continue;
 
-		if (NULL == (dep = (zbx_uint64_pair_t *)zbx_hashset_search(&deps, &dep_local)))
-			dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_ADD, dbrow);
-		else
-			zbx_hashset_remove_direct(&deps, dep);
+		switch (atoi(dbrow[1]))
+		{
+			case 0:
+				opflags |= ZBX_ACTION_OPCLASS_NORMAL;
+				break;
+			case 1:
+				opflags |= ZBX_ACTION_OPCLASS_RECOVERY;
+				break;
+			case 2:
+				opflags |= ZBX_ACTION_OPCLASS_ACKNOWLEDGE;
+				break;
+		}
 	}
 
-	/* add removed rows */
-	zbx_hashset_iter_reset(&deps, &iter);
-	while (NULL != (dep = (zbx_uint64_pair_t *)zbx_hashset_iter_next(&iter)))
-	{
-		zbx_snprintf(down_s, sizeof(down_s), ZBX_FS_UI64, dep->first);
-		zbx_snprintf(up_s, sizeof(up_s), ZBX_FS_UI64, dep->second);
-		dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_REMOVE, del_row);
-	}
+	dbsync_compare_action_op(sync, actionid, opflags);
 
 	DBfree_result(result);
-	zbx_hashset_destroy(&deps);
 
 	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares functions table row with cached configuration data       *
+ * Purpose: compares conditions table row with cached configuration data      *
  *                                                                            *
- * Parameter: function - [IN] the cached function                             *
- *            dbrow    - [IN] the database row                                *
+ * Parameter: condition - [IN] the cached action condition                    *
+ *            dbrow     - [IN] the database row                               *
  *                                                                            *
  * Return value: SUCCEED - the row matches configuration data                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_function(const ZBX_DC_FUNCTION *function, const DB_ROW dbrow)
+static int	dbsync_compare_action_condition(const zbx_dc_action_condition_t *condition, const DB_ROW dbrow)
 {
-	if (FAIL == dbsync_compare_uint64(dbrow[0], function->itemid))
+	if (FAIL == dbsync_compare_uchar(dbrow[2], condition->conditiontype))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_uint64(dbrow[4], function->triggerid))
+	if (FAIL == dbsync_compare_uchar(dbrow[3], condition->op))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_str(dbrow[2], function->function))
+	if (FAIL == dbsync_compare_str(dbrow[4], condition->value))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_str(dbrow[3], function->parameter))
+	if (FAIL == dbsync_compare_str(dbrow[5], condition->value2))
 		return FAIL;
 
 	return SUCCEED;
@@ -2501,44 +4054,7 @@ static int	dbsync_compare_function(const ZBX_DC_FUNCTION *function, const DB_ROW
 
 /******************************************************************************
  *                                                                            *
- * Purpose: applies necessary preprocessing before row is compared/used       *
- *                                                                            *
- * Parameter: row - [IN] the row to preprocess                                *
- *                                                                            *
- * Return value: the preprocessed row                                         *
- *                                                                            *
- * Comments: The row preprocessing can be used to expand user macros in       *
- *           some columns.                                                    *
- *                                                                            *
- ******************************************************************************/
-static char	**dbsync_function_preproc_row(char **row)
-{
-	const char	*row3;
-
-	/* first parameter is /host/key placeholder $, don't cache it */
-	if (NULL == (row3 = strchr(row[3], ',')))
-		row3 = "";
-	else
-		row3++;
-
-	/* return the original row if user macros are not used in target columns */
-	if (SUCCEED == dbsync_check_row_macros(row, 3))
-	{
-		zbx_uint64_t	itemid;
-		/* get associated host identifier */
-		ZBX_STR2UINT64(itemid, row[0]);
-
-		row[3] = dc_expand_user_macros_in_func_params(row3, itemid);
-	}
-	else
-		row[3] = zbx_strdup(NULL, row3);
-
-	return row;
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: compares functions table with cached configuration data           *
+ * Purpose: compares conditions table with cached configuration data          *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -2546,20 +4062,26 @@ static char	**dbsync_function_preproc_row(char **row)
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_functions(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_action_conditions(zbx_dbsync_t *sync)
 {
-	DB_ROW			dbrow;
-	DB_RESULT		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid, itemid;
-	ZBX_DC_FUNCTION		*function;
-	char			**row;
+	DB_ROW				dbrow;
+	DB_RESULT			result;
+	zbx_hashset_t			ids;
+	zbx_hashset_iter_t		iter;
+	zbx_uint64_t			rowid;
+	zbx_dc_action_condition_t	*condition;
 
-	if (NULL == (result = DBselect("select itemid,functionid,name,parameter,triggerid from functions")))
+	if (NULL == (result = DBselect(
+			"select c.conditionid,c.actionid,c.conditiontype,c.operator,c.value,c.value2"
+			" from conditions c,actions a"
+			" where c.actionid=a.actionid"
+				" and a.status=%d",
+			ACTION_STATUS_ACTIVE)))
+	{
 		return FAIL;
+	}
 
-	dbsync_prepare(sync, 5, dbsync_function_preproc_row);
+	dbsync_prepare(sync, 6, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -2567,36 +4089,33 @@ int	zbx_dbsync_compare_functions(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->functions.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	zbx_hashset_create(&ids, dbsync_env.cache->action_conditions.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	while (NULL != (dbrow = DBfetch(result)))
 	{
 		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
 
-		ZBX_STR2UINT64(itemid, dbrow[0]);
-		if (NULL == (ZBX_DC_ITEM *)zbx_hashset_search(&config->items, &itemid))
-			continue;
-
-		ZBX_STR2UINT64(rowid, dbrow[1]);
+		ZBX_STR2UINT64(rowid, dbrow[0]);
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		row = dbsync_preproc_row(sync, dbrow);
-
-		if (NULL == (function = (ZBX_DC_FUNCTION *)zbx_hashset_search(&dbsync_env.cache->functions, &rowid)))
+		if (NULL == (condition = (zbx_dc_action_condition_t *)zbx_hashset_search(
+				&dbsync_env.cache->action_conditions, &rowid)))
+		{
 			tag = ZBX_DBSYNC_ROW_ADD;
-		else if (FAIL == dbsync_compare_function(function, row))
+		}
+		else if (FAIL == dbsync_compare_action_condition(condition, dbrow))
 			tag = ZBX_DBSYNC_ROW_UPDATE;
 
 		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, row);
+			dbsync_add_row(sync, rowid, tag, dbrow);
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->functions, &iter);
-	while (NULL != (function = (ZBX_DC_FUNCTION *)zbx_hashset_iter_next(&iter)))
+	zbx_hashset_iter_reset(&dbsync_env.cache->action_conditions, &iter);
+	while (NULL != (condition = (zbx_dc_action_condition_t *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &function->functionid))
-			dbsync_add_row(sync, function->functionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL == zbx_hashset_search(&ids, &condition->conditionid))
+			dbsync_add_row(sync, condition->conditionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	zbx_hashset_destroy(&ids);
@@ -2607,30 +4126,24 @@ int	zbx_dbsync_compare_functions(zbx_dbsync_t *sync)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares expressions table row with cached configuration data     *
+ * Purpose: compares trigger tags table row with cached configuration data    *
  *                                                                            *
- * Parameter: expression - [IN] the cached expression                         *
- *            dbrow      - [IN] the database row                              *
+ * Parameter: tag   - [IN] the cached trigger tag                             *
+ *            dbrow - [IN] the database row                                   *
  *                                                                            *
  * Return value: SUCCEED - the row matches configuration data                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_expression(const ZBX_DC_EXPRESSION *expression, const DB_ROW dbrow)
+static int	dbsync_compare_trigger_tag(const zbx_dc_trigger_tag_t *tag, const DB_ROW dbrow)
 {
-	if (FAIL == dbsync_compare_str(dbrow[0], expression->regexp))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_str(dbrow[2], expression->expression))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_uchar(dbrow[3], expression->type))
+	if (FAIL == dbsync_compare_uint64(dbrow[1], tag->triggerid))
 		return FAIL;
 
-	if (*dbrow[4] != expression->delimiter)
+	if (FAIL == dbsync_compare_str(dbrow[2], tag->tag))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_uchar(dbrow[5], expression->case_sensitive))
+	if (FAIL == dbsync_compare_str(dbrow[3], tag->value))
 		return FAIL;
 
 	return SUCCEED;
@@ -2638,8 +4151,7 @@ static int	dbsync_compare_expression(const ZBX_DC_EXPRESSION *expression, const
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares expressions, regexps tables with cached configuration    *
- *          data                                                              *
+ * Purpose: compares trigger tags table with cached configuration data        *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -2647,24 +4159,19 @@ static int	dbsync_compare_expression(const ZBX_DC_EXPRESSION *expression, const
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_expressions(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_trigger_tags(zbx_dbsync_t *sync)
 {
 	DB_ROW			dbrow;
 	DB_RESULT		result;
 	zbx_hashset_t		ids;
 	zbx_hashset_iter_t	iter;
 	zbx_uint64_t		rowid;
-	ZBX_DC_EXPRESSION	*expression;
+	zbx_dc_trigger_tag_t	*trigger_tag;
 
-	if (NULL == (result = DBselect(
-			"select r.name,e.expressionid,e.expression,e.expression_type,e.exp_delimiter,e.case_sensitive"
-			" from regexps r,expressions e"
-			" where r.regexpid=e.regexpid")))
-	{
+	if (NULL == (result = DBselect("select triggertagid,triggerid,tag,value from trigger_tag")))
 		return FAIL;
-	}
 
-	dbsync_prepare(sync, 6, NULL);
+	dbsync_prepare(sync, 4, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -2672,33 +4179,33 @@ int	zbx_dbsync_compare_expressions(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->expressions.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	zbx_hashset_create(&ids, dbsync_env.cache->trigger_tags.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	while (NULL != (dbrow = DBfetch(result)))
 	{
 		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
 
-		ZBX_STR2UINT64(rowid, dbrow[1]);
+		ZBX_STR2UINT64(rowid, dbrow[0]);
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		if (NULL == (expression = (ZBX_DC_EXPRESSION *)zbx_hashset_search(&dbsync_env.cache->expressions,
+		if (NULL == (trigger_tag = (zbx_dc_trigger_tag_t *)zbx_hashset_search(&dbsync_env.cache->trigger_tags,
 				&rowid)))
 		{
 			tag = ZBX_DBSYNC_ROW_ADD;
 		}
-		else if (FAIL == dbsync_compare_expression(expression, dbrow))
+		else if (FAIL == dbsync_compare_trigger_tag(trigger_tag, dbrow))
 			tag = ZBX_DBSYNC_ROW_UPDATE;
 
 		if (ZBX_DBSYNC_ROW_NONE != tag)
 			dbsync_add_row(sync, rowid, tag, dbrow);
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->expressions, &iter);
-	while (NULL != (expression = (ZBX_DC_EXPRESSION *)zbx_hashset_iter_next(&iter)))
+	zbx_hashset_iter_reset(&dbsync_env.cache->trigger_tags, &iter);
+	while (NULL != (trigger_tag = (zbx_dc_trigger_tag_t *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &expression->expressionid))
-			dbsync_add_row(sync, expression->expressionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL == zbx_hashset_search(&ids, &trigger_tag->triggertagid))
+			dbsync_add_row(sync, trigger_tag->triggertagid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	zbx_hashset_destroy(&ids);
@@ -2709,25 +4216,24 @@ int	zbx_dbsync_compare_expressions(zbx_dbsync_t *sync)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares actions table row with cached configuration data         *
+ * Purpose: compares item tags table row with cached configuration data       *
  *                                                                            *
- * Parameter: action - [IN] the cached action                                 *
- *            dbrow  - [IN] the database row                                  *
+ * Parameter: tag   - [IN] the cached item tag                                *
+ *            dbrow - [IN] the database row                                   *
  *                                                                            *
  * Return value: SUCCEED - the row matches configuration data                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_action(const zbx_dc_action_t *action, const DB_ROW dbrow)
+static int	dbsync_compare_item_tag(const zbx_dc_item_tag_t *tag, const DB_ROW dbrow)
 {
-
-	if (FAIL == dbsync_compare_uchar(dbrow[1], action->eventsource))
+	if (FAIL == dbsync_compare_uint64(dbrow[1], tag->itemid))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_uchar(dbrow[2], action->evaltype))
+	if (FAIL == dbsync_compare_str(dbrow[2], tag->tag))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_str(dbrow[3], action->formula))
+	if (FAIL == dbsync_compare_str(dbrow[3], tag->value))
 		return FAIL;
 
 	return SUCCEED;
@@ -2735,7 +4241,7 @@ static int	dbsync_compare_action(const zbx_dc_action_t *action, const DB_ROW dbr
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares actions table with cached configuration data             *
+ * Purpose: compares item tags table with cached configuration data           *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -2743,24 +4249,17 @@ static int	dbsync_compare_action(const zbx_dc_action_t *action, const DB_ROW dbr
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_actions(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_item_tags(zbx_dbsync_t *sync)
 {
 	DB_ROW			dbrow;
 	DB_RESULT		result;
 	zbx_hashset_t		ids;
 	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	zbx_dc_action_t		*action;
+	zbx_uint64_t		rowid, itemid;
+	zbx_dc_item_tag_t	*item_tag;
 
-	if (NULL == (result = DBselect(
-			"select actionid,eventsource,evaltype,formula"
-			" from actions"
-			" where eventsource<>%d"
-				" and status=%d",
-			EVENT_SOURCE_SERVICE, ACTION_STATUS_ACTIVE)))
-	{
+	if (NULL == (result = DBselect("select itemtagid,itemid,tag,value from item_tag")))
 		return FAIL;
-	}
 
 	dbsync_prepare(sync, 4, NULL);
 
@@ -2770,71 +4269,73 @@ int	zbx_dbsync_compare_actions(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->actions.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	zbx_hashset_create(&ids, dbsync_env.cache->item_tags.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	while (NULL != (dbrow = DBfetch(result)))
 	{
 		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
 
+		ZBX_STR2UINT64(itemid, dbrow[1]);
+		if (NULL == zbx_hashset_search(&dbsync_env.cache->items, &itemid))
+			continue;
+
 		ZBX_STR2UINT64(rowid, dbrow[0]);
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		if (NULL == (action = (zbx_dc_action_t *)zbx_hashset_search(&dbsync_env.cache->actions, &rowid)))
+		if (NULL == (item_tag = (zbx_dc_item_tag_t *)zbx_hashset_search(&dbsync_env.cache->item_tags,
+				&rowid)))
+		{
 			tag = ZBX_DBSYNC_ROW_ADD;
-		else if (FAIL == dbsync_compare_action(action, dbrow))
+		}
+		else if (FAIL == dbsync_compare_item_tag(item_tag, dbrow))
 			tag = ZBX_DBSYNC_ROW_UPDATE;
 
 		if (ZBX_DBSYNC_ROW_NONE != tag)
 			dbsync_add_row(sync, rowid, tag, dbrow);
 	}
+	DBfree_result(result);
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->actions, &iter);
-	while (NULL != (action = (zbx_dc_action_t *)zbx_hashset_iter_next(&iter)))
+	zbx_hashset_iter_reset(&dbsync_env.cache->item_tags, &iter);
+	while (NULL != (item_tag = (zbx_dc_item_tag_t *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &action->actionid))
-			dbsync_add_row(sync, action->actionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL == zbx_hashset_search(&ids, &item_tag->itemtagid))
+			dbsync_add_row(sync, item_tag->itemtagid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	zbx_hashset_destroy(&ids);
-	DBfree_result(result);
 
 	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares action operation class and flushes update row if         *
- *          necessary                                                         *
+ * Purpose: compares host tags table row with cached configuration data       *
  *                                                                            *
- * Parameter: sync     - [OUT] the changeset                                  *
- *            actionid - [IN] the action identifier                           *
- *            opflags  - [IN] the action operation class flags                *
+ * Parameter: tag   - [IN] the cached host tag                                *
+ *            dbrow - [IN] the database row                                   *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches configuration data                 *
+ *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static void	dbsync_compare_action_op(zbx_dbsync_t *sync, zbx_uint64_t actionid, unsigned char opflags)
+static int	dbsync_compare_host_tag(const zbx_dc_host_tag_t *tag, const DB_ROW dbrow)
 {
-	zbx_dc_action_t	*action;
-
-	if (0 == actionid)
-		return;
-
-	if (NULL == (action = (zbx_dc_action_t *)zbx_hashset_search(&dbsync_env.cache->actions, &actionid)) ||
-			opflags != action->opflags)
-	{
-		char	actionid_s[MAX_ID_LEN], opflags_s[MAX_ID_LEN];
-		char	*row[] = {actionid_s, opflags_s};
+	if (FAIL == dbsync_compare_uint64(dbrow[1], tag->hostid))
+		return FAIL;
 
-		zbx_snprintf(actionid_s, sizeof(actionid_s), ZBX_FS_UI64, actionid);
-		zbx_snprintf(opflags_s, sizeof(opflags_s), "%d", opflags);
+	if (FAIL == dbsync_compare_str(dbrow[2], tag->tag))
+		return FAIL;
 
-		dbsync_add_row(sync, actionid, ZBX_DBSYNC_ROW_UPDATE, (DB_ROW)row);
-	}
+	if (FAIL == dbsync_compare_str(dbrow[3], tag->value))
+		return FAIL;
+
+	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares actions by operation class                               *
+ * Purpose: compares host tags table with cached configuration data           *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -2842,58 +4343,60 @@ static void	dbsync_compare_action_op(zbx_dbsync_t *sync, zbx_uint64_t actionid,
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_action_ops(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_host_tags(zbx_dbsync_t *sync)
 {
 	DB_ROW			dbrow;
 	DB_RESULT		result;
-	zbx_uint64_t		rowid, actionid = 0;
-	unsigned char		opflags = ZBX_ACTION_OPCLASS_NONE;
+	zbx_hashset_t		ids;
+	zbx_hashset_iter_t	iter;
+	zbx_uint64_t		rowid;
+	zbx_dc_host_tag_t	*host_tag;
 
 	if (NULL == (result = DBselect(
-			"select a.actionid,o.recovery"
-			" from actions a"
-			" left join operations o"
-				" on a.actionid=o.actionid"
-			" where a.status=%d"
-			" group by a.actionid,o.recovery"
-			" order by a.actionid",
-			ACTION_STATUS_ACTIVE)))
+			"select * from host_tag")))
 	{
+		printf("db query failed!\n");
 		return FAIL;
 	}
 
-	dbsync_prepare(sync, 2, NULL);
+	dbsync_prepare(sync, 4, NULL);
+
+	if (ZBX_DBSYNC_INIT == sync->mode)
+	{
+		sync->dbresult = result;
+		return SUCCEED;
+	}
+
+	zbx_hashset_create(&ids, dbsync_env.cache->host_tags.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	while (NULL != (dbrow = DBfetch(result)))
 	{
+		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
+
 		ZBX_STR2UINT64(rowid, dbrow[0]);
+		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		if (actionid != rowid)
+		if (NULL == (host_tag = (zbx_dc_host_tag_t *)zbx_hashset_search(&dbsync_env.cache->host_tags,
+				&rowid)))
 		{
-			dbsync_compare_action_op(sync, actionid, opflags);
-			actionid = rowid;
-			opflags = ZBX_ACTION_OPCLASS_NONE;
+			tag = ZBX_DBSYNC_ROW_ADD;
 		}
+		else if (FAIL == dbsync_compare_host_tag(host_tag, dbrow))
+			tag = ZBX_DBSYNC_ROW_UPDATE;
 
-		if (SUCCEED == DBis_null(dbrow[1]))
-			continue;
-
-		switch (atoi(dbrow[1]))
-		{
-			case 0:
-				opflags |= ZBX_ACTION_OPCLASS_NORMAL;
-				break;
-			case 1:
-				opflags |= ZBX_ACTION_OPCLASS_RECOVERY;
-				break;
-			case 2:
-				opflags |= ZBX_ACTION_OPCLASS_ACKNOWLEDGE;
-				break;
-		}
+		if (ZBX_DBSYNC_ROW_NONE != tag)
+			dbsync_add_row(sync, rowid, tag, dbrow);
 	}
 
-	dbsync_compare_action_op(sync, actionid, opflags);
+	zbx_hashset_iter_reset(&dbsync_env.cache->host_tags, &iter);
+	while (NULL != (host_tag = (zbx_dc_host_tag_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (NULL == zbx_hashset_search(&ids, &host_tag->hosttagid))
+			dbsync_add_row(sync, host_tag->hosttagid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+	}
 
+	zbx_hashset_destroy(&ids);
 	DBfree_result(result);
 
 	return SUCCEED;
@@ -2901,27 +4404,24 @@ int	zbx_dbsync_compare_action_ops(zbx_dbsync_t *sync)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares conditions table row with cached configuration data      *
+ * Purpose: compares correlation table row with cached configuration data     *
  *                                                                            *
- * Parameter: condition - [IN] the cached action condition                    *
- *            dbrow     - [IN] the database row                               *
+ * Parameter: correlation - [IN] the cached correlation rule                  *
+ *            dbrow       - [IN] the database row                             *
  *                                                                            *
  * Return value: SUCCEED - the row matches configuration data                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_action_condition(const zbx_dc_action_condition_t *condition, const DB_ROW dbrow)
+static int	dbsync_compare_correlation(const zbx_dc_correlation_t *correlation, const DB_ROW dbrow)
 {
-	if (FAIL == dbsync_compare_uchar(dbrow[2], condition->conditiontype))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_uchar(dbrow[3], condition->op))
+	if (FAIL == dbsync_compare_str(dbrow[1], correlation->name))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_str(dbrow[4], condition->value))
+	if (FAIL == dbsync_compare_uchar(dbrow[2], correlation->evaltype))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_str(dbrow[5], condition->value2))
+	if (FAIL == dbsync_compare_str(dbrow[3], correlation->formula))
 		return FAIL;
 
 	return SUCCEED;
@@ -2929,7 +4429,7 @@ static int	dbsync_compare_action_condition(const zbx_dc_action_condition_t *cond
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares conditions table with cached configuration data          *
+ * Purpose: compares correlation table with cached configuration data         *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -2937,26 +4437,25 @@ static int	dbsync_compare_action_condition(const zbx_dc_action_condition_t *cond
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_action_conditions(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_correlations(zbx_dbsync_t *sync)
 {
-	DB_ROW				dbrow;
-	DB_RESULT			result;
-	zbx_hashset_t			ids;
-	zbx_hashset_iter_t		iter;
-	zbx_uint64_t			rowid;
-	zbx_dc_action_condition_t	*condition;
+	DB_ROW			dbrow;
+	DB_RESULT		result;
+	zbx_hashset_t		ids;
+	zbx_hashset_iter_t	iter;
+	zbx_uint64_t		rowid;
+	zbx_dc_correlation_t	*correlation;
 
 	if (NULL == (result = DBselect(
-			"select c.conditionid,c.actionid,c.conditiontype,c.operator,c.value,c.value2"
-			" from conditions c,actions a"
-			" where c.actionid=a.actionid"
-				" and a.status=%d",
-			ACTION_STATUS_ACTIVE)))
+			"select correlationid,name,evaltype,formula"
+			" from correlation"
+			" where status=%d",
+			ZBX_CORRELATION_ENABLED)))
 	{
 		return FAIL;
 	}
 
-	dbsync_prepare(sync, 6, NULL);
+	dbsync_prepare(sync, 4, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -2964,7 +4463,7 @@ int	zbx_dbsync_compare_action_conditions(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->action_conditions.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	zbx_hashset_create(&ids, dbsync_env.cache->correlations.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	while (NULL != (dbrow = DBfetch(result)))
@@ -2974,23 +4473,23 @@ int	zbx_dbsync_compare_action_conditions(zbx_dbsync_t *sync)
 		ZBX_STR2UINT64(rowid, dbrow[0]);
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		if (NULL == (condition = (zbx_dc_action_condition_t *)zbx_hashset_search(
-				&dbsync_env.cache->action_conditions, &rowid)))
+		if (NULL == (correlation = (zbx_dc_correlation_t *)zbx_hashset_search(&dbsync_env.cache->correlations,
+				&rowid)))
 		{
 			tag = ZBX_DBSYNC_ROW_ADD;
 		}
-		else if (FAIL == dbsync_compare_action_condition(condition, dbrow))
+		else if (FAIL == dbsync_compare_correlation(correlation, dbrow))
 			tag = ZBX_DBSYNC_ROW_UPDATE;
 
 		if (ZBX_DBSYNC_ROW_NONE != tag)
 			dbsync_add_row(sync, rowid, tag, dbrow);
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->action_conditions, &iter);
-	while (NULL != (condition = (zbx_dc_action_condition_t *)zbx_hashset_iter_next(&iter)))
+	zbx_hashset_iter_reset(&dbsync_env.cache->correlations, &iter);
+	while (NULL != (correlation = (zbx_dc_correlation_t *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &condition->conditionid))
-			dbsync_add_row(sync, condition->conditionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL == zbx_hashset_search(&ids, &correlation->correlationid))
+			dbsync_add_row(sync, correlation->correlationid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	zbx_hashset_destroy(&ids);
@@ -3001,32 +4500,62 @@ int	zbx_dbsync_compare_action_conditions(zbx_dbsync_t *sync)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares trigger tags table row with cached configuration data    *
+ * Purpose: compares correlation condition tables dbrow with cached             *
+ *          configuration data                                                *
  *                                                                            *
- * Parameter: tag   - [IN] the cached trigger tag                             *
- *            dbrow - [IN] the database row                                   *
+ * Parameter: corr_condition - [IN] the cached correlation condition          *
+ *            dbrow          - [IN] the database row                          *
  *                                                                            *
  * Return value: SUCCEED - the row matches configuration data                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_trigger_tag(const zbx_dc_trigger_tag_t *tag, const DB_ROW dbrow)
+static int	dbsync_compare_corr_condition(const zbx_dc_corr_condition_t *corr_condition, const DB_ROW dbrow)
 {
-	if (FAIL == dbsync_compare_uint64(dbrow[1], tag->triggerid))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_str(dbrow[2], tag->tag))
+	if (FAIL == dbsync_compare_uint64(dbrow[1], corr_condition->correlationid))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_str(dbrow[3], tag->value))
+	if (FAIL == dbsync_compare_uchar(dbrow[2], corr_condition->type))
 		return FAIL;
 
+	switch (corr_condition->type)
+	{
+		case ZBX_CORR_CONDITION_OLD_EVENT_TAG:
+			/* break; is not missing here */
+		case ZBX_CORR_CONDITION_NEW_EVENT_TAG:
+			if (FAIL == dbsync_compare_str(dbrow[3], corr_condition->data.tag.tag))
+				return FAIL;
+			break;
+		case ZBX_CORR_CONDITION_OLD_EVENT_TAG_VALUE:
+			/* break; is not missing here */
+		case ZBX_CORR_CONDITION_NEW_EVENT_TAG_VALUE:
+			if (FAIL == dbsync_compare_str(dbrow[4], corr_condition->data.tag_value.tag))
+				return FAIL;
+			if (FAIL == dbsync_compare_str(dbrow[5], corr_condition->data.tag_value.value))
+				return FAIL;
+			if (FAIL == dbsync_compare_uchar(dbrow[6], corr_condition->data.tag_value.op))
+				return FAIL;
+			break;
+		case ZBX_CORR_CONDITION_NEW_EVENT_HOSTGROUP:
+			if (FAIL == dbsync_compare_uint64(dbrow[7], corr_condition->data.group.groupid))
+				return FAIL;
+			if (FAIL == dbsync_compare_uchar(dbrow[8], corr_condition->data.group.op))
+				return FAIL;
+			break;
+		case ZBX_CORR_CONDITION_EVENT_TAG_PAIR:
+			if (FAIL == dbsync_compare_str(dbrow[9], corr_condition->data.tag_pair.oldtag))
+				return FAIL;
+			if (FAIL == dbsync_compare_str(dbrow[10], corr_condition->data.tag_pair.newtag))
+				return FAIL;
+			break;
+	}
 	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares trigger tags table with cached configuration data        *
+ * Purpose: compares correlation condition tables with cached configuration   *
+ *          data                                                              *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -3034,19 +4563,35 @@ static int	dbsync_compare_trigger_tag(const zbx_dc_trigger_tag_t *tag, const DB_
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_trigger_tags(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_corr_conditions(zbx_dbsync_t *sync)
 {
 	DB_ROW			dbrow;
 	DB_RESULT		result;
 	zbx_hashset_t		ids;
 	zbx_hashset_iter_t	iter;
 	zbx_uint64_t		rowid;
-	zbx_dc_trigger_tag_t	*trigger_tag;
+	zbx_dc_corr_condition_t	*corr_condition;
 
-	if (NULL == (result = DBselect("select triggertagid,triggerid,tag,value from trigger_tag")))
+	if (NULL == (result = DBselect(
+			"select cc.corr_conditionid,cc.correlationid,cc.type,cct.tag,cctv.tag,cctv.value,cctv.operator,"
+				" ccg.groupid,ccg.operator,cctp.oldtag,cctp.newtag"
+			" from correlation c,corr_condition cc"
+			" left join corr_condition_tag cct"
+				" on cct.corr_conditionid=cc.corr_conditionid"
+			" left join corr_condition_tagvalue cctv"
+				" on cctv.corr_conditionid=cc.corr_conditionid"
+			" left join corr_condition_group ccg"
+				" on ccg.corr_conditionid=cc.corr_conditionid"
+			" left join corr_condition_tagpair cctp"
+				" on cctp.corr_conditionid=cc.corr_conditionid"
+			" where c.correlationid=cc.correlationid"
+				" and c.status=%d",
+			ZBX_CORRELATION_ENABLED)))
+	{
 		return FAIL;
+	}
 
-	dbsync_prepare(sync, 4, NULL);
+	dbsync_prepare(sync, 11, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -3054,7 +4599,7 @@ int	zbx_dbsync_compare_trigger_tags(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->trigger_tags.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	zbx_hashset_create(&ids, dbsync_env.cache->corr_conditions.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	while (NULL != (dbrow = DBfetch(result)))
@@ -3064,23 +4609,23 @@ int	zbx_dbsync_compare_trigger_tags(zbx_dbsync_t *sync)
 		ZBX_STR2UINT64(rowid, dbrow[0]);
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		if (NULL == (trigger_tag = (zbx_dc_trigger_tag_t *)zbx_hashset_search(&dbsync_env.cache->trigger_tags,
-				&rowid)))
+		if (NULL == (corr_condition = (zbx_dc_corr_condition_t *)zbx_hashset_search(
+				&dbsync_env.cache->corr_conditions, &rowid)))
 		{
 			tag = ZBX_DBSYNC_ROW_ADD;
 		}
-		else if (FAIL == dbsync_compare_trigger_tag(trigger_tag, dbrow))
+		else if (FAIL == dbsync_compare_corr_condition(corr_condition, dbrow))
 			tag = ZBX_DBSYNC_ROW_UPDATE;
 
 		if (ZBX_DBSYNC_ROW_NONE != tag)
 			dbsync_add_row(sync, rowid, tag, dbrow);
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->trigger_tags, &iter);
-	while (NULL != (trigger_tag = (zbx_dc_trigger_tag_t *)zbx_hashset_iter_next(&iter)))
+	zbx_hashset_iter_reset(&dbsync_env.cache->corr_conditions, &iter);
+	while (NULL != (corr_condition = (zbx_dc_corr_condition_t *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &trigger_tag->triggertagid))
-			dbsync_add_row(sync, trigger_tag->triggertagid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL == zbx_hashset_search(&ids, &corr_condition->corr_conditionid))
+			dbsync_add_row(sync, corr_condition->corr_conditionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	zbx_hashset_destroy(&ids);
@@ -3091,24 +4636,22 @@ int	zbx_dbsync_compare_trigger_tags(zbx_dbsync_t *sync)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares item tags table row with cached configuration data       *
+ * Purpose: compares correlation operation tables dbrow with cached             *
+ *          configuration data                                                *
  *                                                                            *
- * Parameter: tag   - [IN] the cached item tag                                *
- *            dbrow - [IN] the database row                                   *
+ * Parameter: corr_operation - [IN] the cached correlation operation          *
+ *            dbrow          - [IN] the database row                          *
  *                                                                            *
  * Return value: SUCCEED - the row matches configuration data                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_item_tag(const zbx_dc_item_tag_t *tag, const DB_ROW dbrow)
+static int	dbsync_compare_corr_operation(const zbx_dc_corr_operation_t *corr_operation, const DB_ROW dbrow)
 {
-	if (FAIL == dbsync_compare_uint64(dbrow[1], tag->itemid))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_str(dbrow[2], tag->tag))
+	if (FAIL == dbsync_compare_uint64(dbrow[1], corr_operation->correlationid))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_str(dbrow[3], tag->value))
+	if (FAIL == dbsync_compare_uchar(dbrow[2], corr_operation->type))
 		return FAIL;
 
 	return SUCCEED;
@@ -3116,7 +4659,8 @@ static int	dbsync_compare_item_tag(const zbx_dc_item_tag_t *tag, const DB_ROW db
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares item tags table with cached configuration data           *
+ * Purpose: compares correlation operation tables with cached configuration   *
+ *          data                                                              *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -3124,19 +4668,26 @@ static int	dbsync_compare_item_tag(const zbx_dc_item_tag_t *tag, const DB_ROW db
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_item_tags(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_corr_operations(zbx_dbsync_t *sync)
 {
 	DB_ROW			dbrow;
 	DB_RESULT		result;
 	zbx_hashset_t		ids;
 	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid, itemid;
-	zbx_dc_item_tag_t	*item_tag;
+	zbx_uint64_t		rowid;
+	zbx_dc_corr_operation_t	*corr_operation;
 
-	if (NULL == (result = DBselect("select itemtagid,itemid,tag,value from item_tag")))
+	if (NULL == (result = DBselect(
+			"select co.corr_operationid,co.correlationid,co.type"
+			" from correlation c,corr_operation co"
+			" where c.correlationid=co.correlationid"
+				" and c.status=%d",
+			ZBX_CORRELATION_ENABLED)))
+	{
 		return FAIL;
+	}
 
-	dbsync_prepare(sync, 4, NULL);
+	dbsync_prepare(sync, 3, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -3144,65 +4695,55 @@ int	zbx_dbsync_compare_item_tags(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->item_tags.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	zbx_hashset_create(&ids, dbsync_env.cache->corr_operations.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	while (NULL != (dbrow = DBfetch(result)))
 	{
 		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
 
-		ZBX_STR2UINT64(itemid, dbrow[1]);
-		if (NULL == zbx_hashset_search(&dbsync_env.cache->items, &itemid))
-			continue;
-
 		ZBX_STR2UINT64(rowid, dbrow[0]);
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		if (NULL == (item_tag = (zbx_dc_item_tag_t *)zbx_hashset_search(&dbsync_env.cache->item_tags,
-				&rowid)))
+		if (NULL == (corr_operation = (zbx_dc_corr_operation_t *)zbx_hashset_search(
+				&dbsync_env.cache->corr_operations, &rowid)))
 		{
 			tag = ZBX_DBSYNC_ROW_ADD;
 		}
-		else if (FAIL == dbsync_compare_item_tag(item_tag, dbrow))
+		else if (FAIL == dbsync_compare_corr_operation(corr_operation, dbrow))
 			tag = ZBX_DBSYNC_ROW_UPDATE;
 
 		if (ZBX_DBSYNC_ROW_NONE != tag)
 			dbsync_add_row(sync, rowid, tag, dbrow);
 	}
-	DBfree_result(result);
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->item_tags, &iter);
-	while (NULL != (item_tag = (zbx_dc_item_tag_t *)zbx_hashset_iter_next(&iter)))
+	zbx_hashset_iter_reset(&dbsync_env.cache->corr_operations, &iter);
+	while (NULL != (corr_operation = (zbx_dc_corr_operation_t *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &item_tag->itemtagid))
-			dbsync_add_row(sync, item_tag->itemtagid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL == zbx_hashset_search(&ids, &corr_operation->corr_operationid))
+			dbsync_add_row(sync, corr_operation->corr_operationid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	zbx_hashset_destroy(&ids);
+	DBfree_result(result);
 
 	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares host tags table row with cached configuration data       *
+ * Purpose: compares host group table row with cached configuration data      *
  *                                                                            *
- * Parameter: tag   - [IN] the cached host tag                                *
+ * Parameter: group - [IN] the cached host group                              *
  *            dbrow - [IN] the database row                                   *
  *                                                                            *
  * Return value: SUCCEED - the row matches configuration data                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_host_tag(const zbx_dc_host_tag_t *tag, const DB_ROW dbrow)
+static int	dbsync_compare_host_group(const zbx_dc_hostgroup_t *group, const DB_ROW dbrow)
 {
-	if (FAIL == dbsync_compare_uint64(dbrow[1], tag->hostid))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_str(dbrow[2], tag->tag))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_str(dbrow[3], tag->value))
+	if (FAIL == dbsync_compare_str(dbrow[1], group->name))
 		return FAIL;
 
 	return SUCCEED;
@@ -3210,7 +4751,7 @@ static int	dbsync_compare_host_tag(const zbx_dc_host_tag_t *tag, const DB_ROW db
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares host tags table with cached configuration data           *
+ * Purpose: compares host groups table with cached configuration data         *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -3218,23 +4759,19 @@ static int	dbsync_compare_host_tag(const zbx_dc_host_tag_t *tag, const DB_ROW db
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_host_tags(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_host_groups(zbx_dbsync_t *sync)
 {
 	DB_ROW			dbrow;
 	DB_RESULT		result;
 	zbx_hashset_t		ids;
 	zbx_hashset_iter_t	iter;
 	zbx_uint64_t		rowid;
-	zbx_dc_host_tag_t	*host_tag;
+	zbx_dc_hostgroup_t	*group;
 
-	if (NULL == (result = DBselect(
-			"select * from host_tag")))
-	{
-		printf("db query failed!\n");
+	if (NULL == (result = DBselect("select groupid,name from hstgrp")))
 		return FAIL;
-	}
 
-	dbsync_prepare(sync, 4, NULL);
+	dbsync_prepare(sync, 2, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -3242,7 +4779,7 @@ int	zbx_dbsync_compare_host_tags(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->host_tags.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	zbx_hashset_create(&ids, dbsync_env.cache->hostgroups.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	while (NULL != (dbrow = DBfetch(result)))
@@ -3252,23 +4789,20 @@ int	zbx_dbsync_compare_host_tags(zbx_dbsync_t *sync)
 		ZBX_STR2UINT64(rowid, dbrow[0]);
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		if (NULL == (host_tag = (zbx_dc_host_tag_t *)zbx_hashset_search(&dbsync_env.cache->host_tags,
-				&rowid)))
-		{
+		if (NULL == (group = (zbx_dc_hostgroup_t *)zbx_hashset_search(&dbsync_env.cache->hostgroups, &rowid)))
 			tag = ZBX_DBSYNC_ROW_ADD;
-		}
-		else if (FAIL == dbsync_compare_host_tag(host_tag, dbrow))
+		else if (FAIL == dbsync_compare_host_group(group, dbrow))
 			tag = ZBX_DBSYNC_ROW_UPDATE;
 
 		if (ZBX_DBSYNC_ROW_NONE != tag)
 			dbsync_add_row(sync, rowid, tag, dbrow);
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->host_tags, &iter);
-	while (NULL != (host_tag = (zbx_dc_host_tag_t *)zbx_hashset_iter_next(&iter)))
+	zbx_hashset_iter_reset(&dbsync_env.cache->hostgroups, &iter);
+	while (NULL != (group = (zbx_dc_hostgroup_t *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &host_tag->hosttagid))
-			dbsync_add_row(sync, host_tag->hosttagid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL == zbx_hashset_search(&ids, &group->groupid))
+			dbsync_add_row(sync, group->groupid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	zbx_hashset_destroy(&ids);
@@ -3279,24 +4813,76 @@ int	zbx_dbsync_compare_host_tags(zbx_dbsync_t *sync)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares correlation table row with cached configuration data     *
+ * Purpose: applies necessary preprocessing before row is compared/used       *
  *                                                                            *
- * Parameter: correlation - [IN] the cached correlation rule                  *
- *            dbrow       - [IN] the database row                             *
+ * Parameter: row - [IN] the row to preprocess                                *
+ *                                                                            *
+ * Return value: the preprocessed row of item_preproc table                   *
+ *                                                                            *
+ * Comments: The row preprocessing can be used to expand user macros in       *
+ *           some columns.                                                    *
+ *                                                                            *
+ ******************************************************************************/
+static char	**dbsync_item_pp_preproc_row(char **row)
+{
+#define ZBX_DBSYNC_ITEM_PP_COLUMN_PARAM		0x01
+#define ZBX_DBSYNC_ITEM_PP_COLUMN_ERR_PARAM	0x02
+
+	zbx_uint64_t	hostid;
+	unsigned int	flags = 0;
+
+	if (SUCCEED == dbsync_check_row_macros(row, 3))
+		flags |= ZBX_DBSYNC_ITEM_PP_COLUMN_PARAM;
+
+	if (SUCCEED == dbsync_check_row_macros(row, 7))
+		flags |= ZBX_DBSYNC_ITEM_PP_COLUMN_ERR_PARAM;
+
+	if (0 != flags)
+	{
+		ZBX_STR2UINT64(hostid, row[5]);
+
+		if (0 != (flags & ZBX_DBSYNC_ITEM_PP_COLUMN_PARAM))
+			row[3] = dc_expand_user_macros(row[3], &hostid, 1);
+
+		if (0 != (flags & ZBX_DBSYNC_ITEM_PP_COLUMN_ERR_PARAM))
+			row[7] = dc_expand_user_macros(row[7], &hostid, 1);
+	}
+
+	return row;
+
+#undef ZBX_DBSYNC_ITEM_PP_COLUMN_PARAM
+#undef ZBX_DBSYNC_ITEM_PP_COLUMN_ERR_PARAM
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares item preproc table row with cached configuration data    *
+ *                                                                            *
+ * Parameter: preproc - [IN] the cached item preprocessing operation          *
+ *            dbrow   - [IN] the database row                                 *
  *                                                                            *
  * Return value: SUCCEED - the row matches configuration data                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_correlation(const zbx_dc_correlation_t *correlation, const DB_ROW dbrow)
+static int	dbsync_compare_item_preproc(const zbx_dc_preproc_op_t *preproc, const DB_ROW dbrow)
 {
-	if (FAIL == dbsync_compare_str(dbrow[1], correlation->name))
+	if (FAIL == dbsync_compare_uint64(dbrow[1], preproc->itemid))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_uchar(dbrow[2], correlation->evaltype))
+	if (FAIL == dbsync_compare_uchar(dbrow[2], preproc->type))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_str(dbrow[3], correlation->formula))
+	if (FAIL == dbsync_compare_str(dbrow[3], preproc->params))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_int(dbrow[4], preproc->step))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_int(dbrow[6], preproc->error_handler))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_str(dbrow[7], preproc->error_handler_params))
 		return FAIL;
 
 	return SUCCEED;
@@ -3304,7 +4890,7 @@ static int	dbsync_compare_correlation(const zbx_dc_correlation_t *correlation, c
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares correlation table with cached configuration data         *
+ * Purpose: compares item preproc tables with cached configuration data       *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -3312,25 +4898,34 @@ static int	dbsync_compare_correlation(const zbx_dc_correlation_t *correlation, c
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_correlations(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_item_preprocs(zbx_dbsync_t *sync)
 {
 	DB_ROW			dbrow;
 	DB_RESULT		result;
 	zbx_hashset_t		ids;
 	zbx_hashset_iter_t	iter;
 	zbx_uint64_t		rowid;
-	zbx_dc_correlation_t	*correlation;
+	zbx_dc_preproc_op_t	*preproc;
+	char			**row;
 
 	if (NULL == (result = DBselect(
-			"select correlationid,name,evaltype,formula"
-			" from correlation"
-			" where status=%d",
-			ZBX_CORRELATION_ENABLED)))
+			"select pp.item_preprocid,pp.itemid,pp.type,pp.params,pp.step,h.hostid,pp.error_handler,"
+				"pp.error_handler_params"
+			" from item_preproc pp,items i,hosts h"
+			" where pp.itemid=i.itemid"
+				" and i.hostid=h.hostid"
+/* RSM specifics:		" and (h.proxy_hostid is null"				*/
+/* move all preprocessing to server	" or i.type in (%d,%d,%d))"			*/
+				" and h.status in (%d,%d)"
+				" and i.flags<>%d",
+/*			ITEM_TYPE_INTERNAL, ITEM_TYPE_CALCULATED, ITEM_TYPE_DEPENDENT,	*/
+			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED,
+			ZBX_FLAG_DISCOVERY_PROTOTYPE)))
 	{
 		return FAIL;
 	}
 
-	dbsync_prepare(sync, 4, NULL);
+	dbsync_prepare(sync, 8, dbsync_item_pp_preproc_row);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -3338,7 +4933,7 @@ int	zbx_dbsync_compare_correlations(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->correlations.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	zbx_hashset_create(&ids, dbsync_env.cache->hostgroups.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	while (NULL != (dbrow = DBfetch(result)))
@@ -3348,23 +4943,26 @@ int	zbx_dbsync_compare_correlations(zbx_dbsync_t *sync)
 		ZBX_STR2UINT64(rowid, dbrow[0]);
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		if (NULL == (correlation = (zbx_dc_correlation_t *)zbx_hashset_search(&dbsync_env.cache->correlations,
+		row = dbsync_preproc_row(sync, dbrow);
+
+		if (NULL == (preproc = (zbx_dc_preproc_op_t *)zbx_hashset_search(&dbsync_env.cache->preprocops,
 				&rowid)))
 		{
 			tag = ZBX_DBSYNC_ROW_ADD;
 		}
-		else if (FAIL == dbsync_compare_correlation(correlation, dbrow))
+		else if (FAIL == dbsync_compare_item_preproc(preproc, row))
 			tag = ZBX_DBSYNC_ROW_UPDATE;
 
 		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
+			dbsync_add_row(sync, rowid, tag, row);
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->correlations, &iter);
-	while (NULL != (correlation = (zbx_dc_correlation_t *)zbx_hashset_iter_next(&iter)))
+	zbx_hashset_iter_reset(&dbsync_env.cache->preprocops, &iter);
+
+	while (NULL != (preproc = (zbx_dc_preproc_op_t *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &correlation->correlationid))
-			dbsync_add_row(sync, correlation->correlationid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL == zbx_hashset_search(&ids, &preproc->item_preprocid))
+			dbsync_add_row(sync, preproc->item_preprocid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	zbx_hashset_destroy(&ids);
@@ -3375,62 +4973,61 @@ int	zbx_dbsync_compare_correlations(zbx_dbsync_t *sync)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares correlation condition tables dbrow with cached             *
- *          configuration data                                                *
+ * Purpose: compares maintenance table row with cached configuration data     *
  *                                                                            *
- * Parameter: corr_condition - [IN] the cached correlation condition          *
- *            dbrow          - [IN] the database row                          *
+ * Parameter: maintenance - [IN] the cached maintenance data                  *
+ *            dbrow       - [IN] the database row                             *
  *                                                                            *
  * Return value: SUCCEED - the row matches configuration data                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_corr_condition(const zbx_dc_corr_condition_t *corr_condition, const DB_ROW dbrow)
+static int	dbsync_compare_maintenance(const zbx_dc_maintenance_t *maintenance, const DB_ROW dbrow)
 {
-	if (FAIL == dbsync_compare_uint64(dbrow[1], corr_condition->correlationid))
+	if (FAIL == dbsync_compare_uchar(dbrow[1], maintenance->type))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_uchar(dbrow[2], corr_condition->type))
+	if (FAIL == dbsync_compare_int(dbrow[2], maintenance->active_since))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_int(dbrow[3], maintenance->active_until))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_uchar(dbrow[4], maintenance->tags_evaltype))
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares item script params table row with cached configuration   *
+ *          data                                                              *
+ *                                                                            *
+ * Parameter: script - [IN] the cached item script                            *
+ *            dbrow  - [IN] the database row                                  *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches configuration data                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_compare_itemscript_param(const zbx_dc_scriptitem_param_t *scriptitem_param, const DB_ROW dbrow)
+{
+	if (FAIL == dbsync_compare_uint64(dbrow[1], scriptitem_param->itemid))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_str(dbrow[2], scriptitem_param->name))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_str(dbrow[3], scriptitem_param->value))
 		return FAIL;
 
-	switch (corr_condition->type)
-	{
-		case ZBX_CORR_CONDITION_OLD_EVENT_TAG:
-			/* break; is not missing here */
-		case ZBX_CORR_CONDITION_NEW_EVENT_TAG:
-			if (FAIL == dbsync_compare_str(dbrow[3], corr_condition->data.tag.tag))
-				return FAIL;
-			break;
-		case ZBX_CORR_CONDITION_OLD_EVENT_TAG_VALUE:
-			/* break; is not missing here */
-		case ZBX_CORR_CONDITION_NEW_EVENT_TAG_VALUE:
-			if (FAIL == dbsync_compare_str(dbrow[4], corr_condition->data.tag_value.tag))
-				return FAIL;
-			if (FAIL == dbsync_compare_str(dbrow[5], corr_condition->data.tag_value.value))
-				return FAIL;
-			if (FAIL == dbsync_compare_uchar(dbrow[6], corr_condition->data.tag_value.op))
-				return FAIL;
-			break;
-		case ZBX_CORR_CONDITION_NEW_EVENT_HOSTGROUP:
-			if (FAIL == dbsync_compare_uint64(dbrow[7], corr_condition->data.group.groupid))
-				return FAIL;
-			if (FAIL == dbsync_compare_uchar(dbrow[8], corr_condition->data.group.op))
-				return FAIL;
-			break;
-		case ZBX_CORR_CONDITION_EVENT_TAG_PAIR:
-			if (FAIL == dbsync_compare_str(dbrow[9], corr_condition->data.tag_pair.oldtag))
-				return FAIL;
-			if (FAIL == dbsync_compare_str(dbrow[10], corr_condition->data.tag_pair.newtag))
-				return FAIL;
-			break;
-	}
 	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares correlation condition tables with cached configuration   *
- *          data                                                              *
+ * Purpose: compares item_parameter table with cached configuration data      *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -3438,35 +5035,31 @@ static int	dbsync_compare_corr_condition(const zbx_dc_corr_condition_t *corr_con
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_corr_conditions(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_item_script_param(zbx_dbsync_t *sync)
 {
-	DB_ROW			dbrow;
-	DB_RESULT		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	zbx_dc_corr_condition_t	*corr_condition;
+	DB_ROW				dbrow;
+	DB_RESULT			result;
+	zbx_hashset_t			ids;
+	zbx_hashset_iter_t		iter;
+	zbx_uint64_t			rowid;
+	zbx_dc_scriptitem_param_t	*itemscript_params;
+	char				**row;
 
 	if (NULL == (result = DBselect(
-			"select cc.corr_conditionid,cc.correlationid,cc.type,cct.tag,cctv.tag,cctv.value,cctv.operator,"
-				" ccg.groupid,ccg.operator,cctp.oldtag,cctp.newtag"
-			" from correlation c,corr_condition cc"
-			" left join corr_condition_tag cct"
-				" on cct.corr_conditionid=cc.corr_conditionid"
-			" left join corr_condition_tagvalue cctv"
-				" on cctv.corr_conditionid=cc.corr_conditionid"
-			" left join corr_condition_group ccg"
-				" on ccg.corr_conditionid=cc.corr_conditionid"
-			" left join corr_condition_tagpair cctp"
-				" on cctp.corr_conditionid=cc.corr_conditionid"
-			" where c.correlationid=cc.correlationid"
-				" and c.status=%d",
-			ZBX_CORRELATION_ENABLED)))
+			"select p.item_parameterid,p.itemid,p.name,p.value,i.hostid"
+			" from item_parameter p,items i,hosts h"
+			" where p.itemid=i.itemid"
+				" and i.hostid=h.hostid"
+				" and h.status in (%d,%d)"
+				" and i.flags<>%d"
+			" order by p.itemid",
+			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED,
+			ZBX_FLAG_DISCOVERY_PROTOTYPE)))
 	{
 		return FAIL;
 	}
 
-	dbsync_prepare(sync, 11, NULL);
+	dbsync_prepare(sync, 5, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -3474,7 +5067,7 @@ int	zbx_dbsync_compare_corr_conditions(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->corr_conditions.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	zbx_hashset_create(&ids, dbsync_env.cache->itemscript_params.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	while (NULL != (dbrow = DBfetch(result)))
@@ -3484,23 +5077,28 @@ int	zbx_dbsync_compare_corr_conditions(zbx_dbsync_t *sync)
 		ZBX_STR2UINT64(rowid, dbrow[0]);
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		if (NULL == (corr_condition = (zbx_dc_corr_condition_t *)zbx_hashset_search(
-				&dbsync_env.cache->corr_conditions, &rowid)))
+		row = dbsync_preproc_row(sync, dbrow);
+
+		if (NULL == (itemscript_params = (zbx_dc_scriptitem_param_t *)
+				zbx_hashset_search(&dbsync_env.cache->itemscript_params, &rowid)))
 		{
 			tag = ZBX_DBSYNC_ROW_ADD;
 		}
-		else if (FAIL == dbsync_compare_corr_condition(corr_condition, dbrow))
+		else if (FAIL == dbsync_compare_itemscript_param(itemscript_params, row))
+		{
 			tag = ZBX_DBSYNC_ROW_UPDATE;
+		}
 
 		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
+			dbsync_add_row(sync, rowid, tag, row);
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->corr_conditions, &iter);
-	while (NULL != (corr_condition = (zbx_dc_corr_condition_t *)zbx_hashset_iter_next(&iter)))
+	zbx_hashset_iter_reset(&dbsync_env.cache->itemscript_params, &iter);
+
+	while (NULL != (itemscript_params = (zbx_dc_scriptitem_param_t *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &corr_condition->corr_conditionid))
-			dbsync_add_row(sync, corr_condition->corr_conditionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL == zbx_hashset_search(&ids, &itemscript_params->item_script_paramid))
+			dbsync_add_row(sync, itemscript_params->item_script_paramid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	zbx_hashset_destroy(&ids);
@@ -3511,31 +5109,7 @@ int	zbx_dbsync_compare_corr_conditions(zbx_dbsync_t *sync)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares correlation operation tables dbrow with cached             *
- *          configuration data                                                *
- *                                                                            *
- * Parameter: corr_operation - [IN] the cached correlation operation          *
- *            dbrow          - [IN] the database row                          *
- *                                                                            *
- * Return value: SUCCEED - the row matches configuration data                 *
- *               FAIL    - otherwise                                          *
- *                                                                            *
- ******************************************************************************/
-static int	dbsync_compare_corr_operation(const zbx_dc_corr_operation_t *corr_operation, const DB_ROW dbrow)
-{
-	if (FAIL == dbsync_compare_uint64(dbrow[1], corr_operation->correlationid))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_uchar(dbrow[2], corr_operation->type))
-		return FAIL;
-
-	return SUCCEED;
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: compares correlation operation tables with cached configuration   *
- *          data                                                              *
+ * Purpose: compares maintenances table with cached configuration data        *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -3543,26 +5117,22 @@ static int	dbsync_compare_corr_operation(const zbx_dc_corr_operation_t *corr_ope
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_corr_operations(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_maintenances(zbx_dbsync_t *sync)
 {
 	DB_ROW			dbrow;
 	DB_RESULT		result;
 	zbx_hashset_t		ids;
 	zbx_hashset_iter_t	iter;
 	zbx_uint64_t		rowid;
-	zbx_dc_corr_operation_t	*corr_operation;
+	zbx_dc_maintenance_t	*maintenance;
 
-	if (NULL == (result = DBselect(
-			"select co.corr_operationid,co.correlationid,co.type"
-			" from correlation c,corr_operation co"
-			" where c.correlationid=co.correlationid"
-				" and c.status=%d",
-			ZBX_CORRELATION_ENABLED)))
+	if (NULL == (result = DBselect("select maintenanceid,maintenance_type,active_since,active_till,tags_evaltype"
+						" from maintenances")))
 	{
 		return FAIL;
 	}
 
-	dbsync_prepare(sync, 3, NULL);
+	dbsync_prepare(sync, 5, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -3570,7 +5140,7 @@ int	zbx_dbsync_compare_corr_operations(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->corr_operations.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	zbx_hashset_create(&ids, dbsync_env.cache->maintenances.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	while (NULL != (dbrow = DBfetch(result)))
@@ -3580,23 +5150,22 @@ int	zbx_dbsync_compare_corr_operations(zbx_dbsync_t *sync)
 		ZBX_STR2UINT64(rowid, dbrow[0]);
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		if (NULL == (corr_operation = (zbx_dc_corr_operation_t *)zbx_hashset_search(
-				&dbsync_env.cache->corr_operations, &rowid)))
-		{
+		maintenance = (zbx_dc_maintenance_t *)zbx_hashset_search(&dbsync_env.cache->maintenances, &rowid);
+
+		if (NULL == maintenance)
 			tag = ZBX_DBSYNC_ROW_ADD;
-		}
-		else if (FAIL == dbsync_compare_corr_operation(corr_operation, dbrow))
+		else if (FAIL == dbsync_compare_maintenance(maintenance, dbrow))
 			tag = ZBX_DBSYNC_ROW_UPDATE;
 
 		if (ZBX_DBSYNC_ROW_NONE != tag)
 			dbsync_add_row(sync, rowid, tag, dbrow);
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->corr_operations, &iter);
-	while (NULL != (corr_operation = (zbx_dc_corr_operation_t *)zbx_hashset_iter_next(&iter)))
+	zbx_hashset_iter_reset(&dbsync_env.cache->maintenances, &iter);
+	while (NULL != (maintenance = (zbx_dc_maintenance_t *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &corr_operation->corr_operationid))
-			dbsync_add_row(sync, corr_operation->corr_operationid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL == zbx_hashset_search(&ids, &maintenance->maintenanceid))
+			dbsync_add_row(sync, maintenance->maintenanceid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	zbx_hashset_destroy(&ids);
@@ -3607,18 +5176,24 @@ int	zbx_dbsync_compare_corr_operations(zbx_dbsync_t *sync)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares host group table row with cached configuration data      *
+ * Purpose: compares maintenance_tag table row with cached configuration data *
  *                                                                            *
- * Parameter: group - [IN] the cached host group                              *
- *            dbrow - [IN] the database row                                   *
+ * Parameter: maintenance_tag - [IN] the cached maintenance tag               *
+ *            dbrow           - [IN] the database row                         *
  *                                                                            *
  * Return value: SUCCEED - the row matches configuration data                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_host_group(const zbx_dc_hostgroup_t *group, const DB_ROW dbrow)
+static int	dbsync_compare_maintenance_tag(const zbx_dc_maintenance_tag_t *maintenance_tag, const DB_ROW dbrow)
 {
-	if (FAIL == dbsync_compare_str(dbrow[1], group->name))
+	if (FAIL == dbsync_compare_int(dbrow[2], maintenance_tag->op))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_str(dbrow[3], maintenance_tag->tag))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_str(dbrow[4], maintenance_tag->value))
 		return FAIL;
 
 	return SUCCEED;
@@ -3626,7 +5201,7 @@ static int	dbsync_compare_host_group(const zbx_dc_hostgroup_t *group, const DB_R
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares host groups table with cached configuration data         *
+ * Purpose: compares maintenances table with cached configuration data        *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -3634,19 +5209,22 @@ static int	dbsync_compare_host_group(const zbx_dc_hostgroup_t *group, const DB_R
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_host_groups(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_maintenance_tags(zbx_dbsync_t *sync)
 {
-	DB_ROW			dbrow;
-	DB_RESULT		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	zbx_dc_hostgroup_t	*group;
+	DB_ROW				dbrow;
+	DB_RESULT			result;
+	zbx_hashset_t			ids;
+	zbx_hashset_iter_t		iter;
+	zbx_uint64_t			rowid;
+	zbx_dc_maintenance_tag_t	*maintenance_tag;
 
-	if (NULL == (result = DBselect("select groupid,name from hstgrp")))
+	if (NULL == (result = DBselect("select maintenancetagid,maintenanceid,operator,tag,value"
+						" from maintenance_tag")))
+	{
 		return FAIL;
+	}
 
-	dbsync_prepare(sync, 2, NULL);
+	dbsync_prepare(sync, 5, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -3654,7 +5232,7 @@ int	zbx_dbsync_compare_host_groups(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->hostgroups.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	zbx_hashset_create(&ids, dbsync_env.cache->maintenance_tags.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	while (NULL != (dbrow = DBfetch(result)))
@@ -3664,20 +5242,23 @@ int	zbx_dbsync_compare_host_groups(zbx_dbsync_t *sync)
 		ZBX_STR2UINT64(rowid, dbrow[0]);
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		if (NULL == (group = (zbx_dc_hostgroup_t *)zbx_hashset_search(&dbsync_env.cache->hostgroups, &rowid)))
+		maintenance_tag = (zbx_dc_maintenance_tag_t *)zbx_hashset_search(&dbsync_env.cache->maintenance_tags,
+				&rowid);
+
+		if (NULL == maintenance_tag)
 			tag = ZBX_DBSYNC_ROW_ADD;
-		else if (FAIL == dbsync_compare_host_group(group, dbrow))
+		else if (FAIL == dbsync_compare_maintenance_tag(maintenance_tag, dbrow))
 			tag = ZBX_DBSYNC_ROW_UPDATE;
 
 		if (ZBX_DBSYNC_ROW_NONE != tag)
 			dbsync_add_row(sync, rowid, tag, dbrow);
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->hostgroups, &iter);
-	while (NULL != (group = (zbx_dc_hostgroup_t *)zbx_hashset_iter_next(&iter)))
+	zbx_hashset_iter_reset(&dbsync_env.cache->maintenance_tags, &iter);
+	while (NULL != (maintenance_tag = (zbx_dc_maintenance_tag_t *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &group->groupid))
-			dbsync_add_row(sync, group->groupid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL == zbx_hashset_search(&ids, &maintenance_tag->maintenancetagid))
+			dbsync_add_row(sync, maintenance_tag->maintenancetagid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	zbx_hashset_destroy(&ids);
@@ -3688,76 +5269,40 @@ int	zbx_dbsync_compare_host_groups(zbx_dbsync_t *sync)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: applies necessary preprocessing before row is compared/used       *
- *                                                                            *
- * Parameter: row - [IN] the row to preprocess                                *
- *                                                                            *
- * Return value: the preprocessed row of item_preproc table                   *
- *                                                                            *
- * Comments: The row preprocessing can be used to expand user macros in       *
- *           some columns.                                                    *
- *                                                                            *
- ******************************************************************************/
-static char	**dbsync_item_pp_preproc_row(char **row)
-{
-#define ZBX_DBSYNC_ITEM_PP_COLUMN_PARAM		0x01
-#define ZBX_DBSYNC_ITEM_PP_COLUMN_ERR_PARAM	0x02
-
-	zbx_uint64_t	hostid;
-	unsigned int	flags = 0;
-
-	if (SUCCEED == dbsync_check_row_macros(row, 3))
-		flags |= ZBX_DBSYNC_ITEM_PP_COLUMN_PARAM;
-
-	if (SUCCEED == dbsync_check_row_macros(row, 7))
-		flags |= ZBX_DBSYNC_ITEM_PP_COLUMN_ERR_PARAM;
-
-	if (0 != flags)
-	{
-		ZBX_STR2UINT64(hostid, row[5]);
-
-		if (0 != (flags & ZBX_DBSYNC_ITEM_PP_COLUMN_PARAM))
-			row[3] = dc_expand_user_macros(row[3], &hostid, 1);
-
-		if (0 != (flags & ZBX_DBSYNC_ITEM_PP_COLUMN_ERR_PARAM))
-			row[7] = dc_expand_user_macros(row[7], &hostid, 1);
-	}
-
-	return row;
-
-#undef ZBX_DBSYNC_ITEM_PP_COLUMN_PARAM
-#undef ZBX_DBSYNC_ITEM_PP_COLUMN_ERR_PARAM
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: compares item preproc table row with cached configuration data    *
+ * Purpose: compares maintenance_period table row with cached configuration   *
+ *          dat                                                               *
  *                                                                            *
- * Parameter: preproc - [IN] the cached item preprocessing operation          *
- *            dbrow   - [IN] the database row                                 *
+ * Parameter: period - [IN] the cached maintenance period                     *
+ *            dbrow  - [IN] the database row                                  *
  *                                                                            *
  * Return value: SUCCEED - the row matches configuration data                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_item_preproc(const zbx_dc_preproc_op_t *preproc, const DB_ROW dbrow)
+static int	dbsync_compare_maintenance_period(const zbx_dc_maintenance_period_t *period, const DB_ROW dbrow)
 {
-	if (FAIL == dbsync_compare_uint64(dbrow[1], preproc->itemid))
+	if (FAIL == dbsync_compare_uchar(dbrow[1], period->type))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_uchar(dbrow[2], preproc->type))
+	if (FAIL == dbsync_compare_int(dbrow[2], period->every))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_str(dbrow[3], preproc->params))
+	if (FAIL == dbsync_compare_int(dbrow[3], period->month))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_int(dbrow[4], preproc->step))
+	if (FAIL == dbsync_compare_int(dbrow[4], period->dayofweek))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_int(dbrow[6], preproc->error_handler))
+	if (FAIL == dbsync_compare_int(dbrow[5], period->day))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_str(dbrow[7], preproc->error_handler_params))
+	if (FAIL == dbsync_compare_int(dbrow[6], period->start_time))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_int(dbrow[7], period->period))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_int(dbrow[8], period->start_date))
 		return FAIL;
 
 	return SUCCEED;
@@ -3765,7 +5310,7 @@ static int	dbsync_compare_item_preproc(const zbx_dc_preproc_op_t *preproc, const
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares item preproc tables with cached configuration data       *
+ * Purpose: compares timeperiods table with cached configuration data         *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -3773,34 +5318,24 @@ static int	dbsync_compare_item_preproc(const zbx_dc_preproc_op_t *preproc, const
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_item_preprocs(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_maintenance_periods(zbx_dbsync_t *sync)
 {
-	DB_ROW			dbrow;
-	DB_RESULT		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	zbx_dc_preproc_op_t	*preproc;
-	char			**row;
+	DB_ROW				dbrow;
+	DB_RESULT			result;
+	zbx_hashset_t			ids;
+	zbx_hashset_iter_t		iter;
+	zbx_uint64_t			rowid;
+	zbx_dc_maintenance_period_t	*period;
 
-	if (NULL == (result = DBselect(
-			"select pp.item_preprocid,pp.itemid,pp.type,pp.params,pp.step,h.hostid,pp.error_handler,"
-				"pp.error_handler_params"
-			" from item_preproc pp,items i,hosts h"
-			" where pp.itemid=i.itemid"
-				" and i.hostid=h.hostid"
-/* RSM specifics:		" and (h.proxy_hostid is null"				*/
-/* move all preprocessing to server	" or i.type in (%d,%d,%d))"			*/
-				" and h.status in (%d,%d)"
-				" and i.flags<>%d",
-/*			ITEM_TYPE_INTERNAL, ITEM_TYPE_CALCULATED, ITEM_TYPE_DEPENDENT,	*/
-			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED,
-			ZBX_FLAG_DISCOVERY_PROTOTYPE)))
+	if (NULL == (result = DBselect("select t.timeperiodid,t.timeperiod_type,t.every,t.month,t.dayofweek,t.day,"
+						"t.start_time,t.period,t.start_date,m.maintenanceid"
+					" from maintenances_windows m,timeperiods t"
+					" where t.timeperiodid=m.timeperiodid")))
 	{
 		return FAIL;
 	}
 
-	dbsync_prepare(sync, 8, dbsync_item_pp_preproc_row);
+	dbsync_prepare(sync, 10, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -3808,7 +5343,7 @@ int	zbx_dbsync_compare_item_preprocs(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->hostgroups.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	zbx_hashset_create(&ids, dbsync_env.cache->maintenance_periods.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	while (NULL != (dbrow = DBfetch(result)))
@@ -3818,26 +5353,23 @@ int	zbx_dbsync_compare_item_preprocs(zbx_dbsync_t *sync)
 		ZBX_STR2UINT64(rowid, dbrow[0]);
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		row = dbsync_preproc_row(sync, dbrow);
+		period = (zbx_dc_maintenance_period_t *)zbx_hashset_search(&dbsync_env.cache->maintenance_periods,
+				&rowid);
 
-		if (NULL == (preproc = (zbx_dc_preproc_op_t *)zbx_hashset_search(&dbsync_env.cache->preprocops,
-				&rowid)))
-		{
+		if (NULL == period)
 			tag = ZBX_DBSYNC_ROW_ADD;
-		}
-		else if (FAIL == dbsync_compare_item_preproc(preproc, row))
+		else if (FAIL == dbsync_compare_maintenance_period(period, dbrow))
 			tag = ZBX_DBSYNC_ROW_UPDATE;
 
 		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, row);
+			dbsync_add_row(sync, rowid, tag, dbrow);
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->preprocops, &iter);
-
-	while (NULL != (preproc = (zbx_dc_preproc_op_t *)zbx_hashset_iter_next(&iter)))
+	zbx_hashset_iter_reset(&dbsync_env.cache->maintenance_periods, &iter);
+	while (NULL != (period = (zbx_dc_maintenance_period_t *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &preproc->item_preprocid))
-			dbsync_add_row(sync, preproc->item_preprocid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL == zbx_hashset_search(&ids, &period->timeperiodid))
+			dbsync_add_row(sync, period->timeperiodid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	zbx_hashset_destroy(&ids);
@@ -3848,61 +5380,82 @@ int	zbx_dbsync_compare_item_preprocs(zbx_dbsync_t *sync)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares maintenance table row with cached configuration data     *
+ * Purpose: compares maintenances_groups table with cached configuration data *
  *                                                                            *
- * Parameter: maintenance - [IN] the cached maintenance data                  *
- *            dbrow       - [IN] the database row                             *
+ * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
- * Return value: SUCCEED - the row matches configuration data                 *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_maintenance(const zbx_dc_maintenance_t *maintenance, const DB_ROW dbrow)
+int	zbx_dbsync_compare_maintenance_groups(zbx_dbsync_t *sync)
 {
-	if (FAIL == dbsync_compare_uchar(dbrow[1], maintenance->type))
-		return FAIL;
+	DB_ROW			dbrow;
+	DB_RESULT		result;
+	zbx_hashset_iter_t	iter;
+	zbx_dc_maintenance_t	*maintenance;
+	zbx_hashset_t		mgroups;
+	int			i;
+	zbx_uint64_pair_t	mg_local, *mg;
+	char			maintenanceid_s[MAX_ID_LEN + 1], groupid_s[MAX_ID_LEN + 1];
+	char			*del_row[2] = {maintenanceid_s, groupid_s};
 
-	if (FAIL == dbsync_compare_int(dbrow[2], maintenance->active_since))
+	if (NULL == (result = DBselect("select maintenanceid,groupid from maintenances_groups order by maintenanceid")))
 		return FAIL;
 
-	if (FAIL == dbsync_compare_int(dbrow[3], maintenance->active_until))
-		return FAIL;
+	dbsync_prepare(sync, 2, NULL);
 
-	if (FAIL == dbsync_compare_uchar(dbrow[4], maintenance->tags_evaltype))
-		return FAIL;
+	if (ZBX_DBSYNC_INIT == sync->mode)
+	{
+		sync->dbresult = result;
+		return SUCCEED;
+	}
 
-	return SUCCEED;
-}
+	zbx_hashset_create(&mgroups, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
 
-/******************************************************************************
- *                                                                            *
- * Purpose: compares item script params table row with cached configuration   *
- *          data                                                              *
- *                                                                            *
- * Parameter: script - [IN] the cached item script                            *
- *            dbrow  - [IN] the database row                                  *
- *                                                                            *
- * Return value: SUCCEED - the row matches configuration data                 *
- *               FAIL    - otherwise                                          *
- *                                                                            *
- ******************************************************************************/
-static int	dbsync_compare_itemscript_param(const zbx_dc_scriptitem_param_t *scriptitem_param, const DB_ROW dbrow)
-{
-	if (FAIL == dbsync_compare_uint64(dbrow[1], scriptitem_param->itemid))
-		return FAIL;
+	/* index all maintenance->group links */
+	zbx_hashset_iter_reset(&dbsync_env.cache->maintenances, &iter);
+	while (NULL != (maintenance = (zbx_dc_maintenance_t *)zbx_hashset_iter_next(&iter)))
+	{
+		mg_local.first = maintenance->maintenanceid;
 
-	if (FAIL == dbsync_compare_str(dbrow[2], scriptitem_param->name))
-		return FAIL;
+		for (i = 0; i < maintenance->groupids.values_num; i++)
+		{
+			mg_local.second = maintenance->groupids.values[i];
+			zbx_hashset_insert(&mgroups, &mg_local, sizeof(mg_local));
+		}
+	}
 
-	if (FAIL == dbsync_compare_str(dbrow[3], scriptitem_param->value))
-		return FAIL;
+	/* add new rows, remove existing rows from index */
+	while (NULL != (dbrow = DBfetch(result)))
+	{
+		ZBX_STR2UINT64(mg_local.first, dbrow[0]);
+		ZBX_STR2UINT64(mg_local.second, dbrow[1]);
+
+		if (NULL == (mg = (zbx_uint64_pair_t *)zbx_hashset_search(&mgroups, &mg_local)))
+			dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_ADD, dbrow);
+		else
+			zbx_hashset_remove_direct(&mgroups, mg);
+	}
+
+	/* add removed rows */
+	zbx_hashset_iter_reset(&mgroups, &iter);
+	while (NULL != (mg = (zbx_uint64_pair_t *)zbx_hashset_iter_next(&iter)))
+	{
+		zbx_snprintf(maintenanceid_s, sizeof(maintenanceid_s), ZBX_FS_UI64, mg->first);
+		zbx_snprintf(groupid_s, sizeof(groupid_s), ZBX_FS_UI64, mg->second);
+		dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_REMOVE, del_row);
+	}
+
+	DBfree_result(result);
+	zbx_hashset_destroy(&mgroups);
 
 	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares item_parameter table with cached configuration data      *
+ * Purpose: compares maintenances_hosts table with cached configuration data  *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -3910,31 +5463,22 @@ static int	dbsync_compare_itemscript_param(const zbx_dc_scriptitem_param_t *scri
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_item_script_param(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_maintenance_hosts(zbx_dbsync_t *sync)
 {
-	DB_ROW				dbrow;
-	DB_RESULT			result;
-	zbx_hashset_t			ids;
-	zbx_hashset_iter_t		iter;
-	zbx_uint64_t			rowid;
-	zbx_dc_scriptitem_param_t	*itemscript_params;
-	char				**row;
+	DB_ROW			dbrow;
+	DB_RESULT		result;
+	zbx_hashset_iter_t	iter;
+	zbx_dc_maintenance_t	*maintenance;
+	zbx_hashset_t		mhosts;
+	int			i;
+	zbx_uint64_pair_t	mh_local, *mh;
+	char			maintenanceid_s[MAX_ID_LEN + 1], hostid_s[MAX_ID_LEN + 1];
+	char			*del_row[2] = {maintenanceid_s, hostid_s};
 
-	if (NULL == (result = DBselect(
-			"select p.item_parameterid,p.itemid,p.name,p.value,i.hostid"
-			" from item_parameter p,items i,hosts h"
-			" where p.itemid=i.itemid"
-				" and i.hostid=h.hostid"
-				" and h.status in (%d,%d)"
-				" and i.flags<>%d"
-			" order by p.itemid",
-			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED,
-			ZBX_FLAG_DISCOVERY_PROTOTYPE)))
-	{
+	if (NULL == (result = DBselect("select maintenanceid,hostid from maintenances_hosts order by maintenanceid")))
 		return FAIL;
-	}
 
-	dbsync_prepare(sync, 5, NULL);
+	dbsync_prepare(sync, 2, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -3942,49 +5486,51 @@ int	zbx_dbsync_compare_item_script_param(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->itemscript_params.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_create(&mhosts, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
 
-	while (NULL != (dbrow = DBfetch(result)))
+	/* index all maintenance->host links */
+	zbx_hashset_iter_reset(&dbsync_env.cache->maintenances, &iter);
+	while (NULL != (maintenance = (zbx_dc_maintenance_t *)zbx_hashset_iter_next(&iter)))
 	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
-
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
-
-		row = dbsync_preproc_row(sync, dbrow);
+		mh_local.first = maintenance->maintenanceid;
 
-		if (NULL == (itemscript_params = (zbx_dc_scriptitem_param_t *)
-				zbx_hashset_search(&dbsync_env.cache->itemscript_params, &rowid)))
-		{
-			tag = ZBX_DBSYNC_ROW_ADD;
-		}
-		else if (FAIL == dbsync_compare_itemscript_param(itemscript_params, row))
+		for (i = 0; i < maintenance->hostids.values_num; i++)
 		{
-			tag = ZBX_DBSYNC_ROW_UPDATE;
+			mh_local.second = maintenance->hostids.values[i];
+			zbx_hashset_insert(&mhosts, &mh_local, sizeof(mh_local));
 		}
-
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, row);
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->itemscript_params, &iter);
+	/* add new rows, remove existing rows from index */
+	while (NULL != (dbrow = DBfetch(result)))
+	{
+		ZBX_STR2UINT64(mh_local.first, dbrow[0]);
+		ZBX_STR2UINT64(mh_local.second, dbrow[1]);
 
-	while (NULL != (itemscript_params = (zbx_dc_scriptitem_param_t *)zbx_hashset_iter_next(&iter)))
+		if (NULL == (mh = (zbx_uint64_pair_t *)zbx_hashset_search(&mhosts, &mh_local)))
+			dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_ADD, dbrow);
+		else
+			zbx_hashset_remove_direct(&mhosts, mh);
+	}
+
+	/* add removed rows */
+	zbx_hashset_iter_reset(&mhosts, &iter);
+	while (NULL != (mh = (zbx_uint64_pair_t *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &itemscript_params->item_script_paramid))
-			dbsync_add_row(sync, itemscript_params->item_script_paramid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		zbx_snprintf(maintenanceid_s, sizeof(maintenanceid_s), ZBX_FS_UI64, mh->first);
+		zbx_snprintf(hostid_s, sizeof(hostid_s), ZBX_FS_UI64, mh->second);
+		dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_REMOVE, del_row);
 	}
 
-	zbx_hashset_destroy(&ids);
 	DBfree_result(result);
+	zbx_hashset_destroy(&mhosts);
 
 	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares maintenances table with cached configuration data        *
+ * Purpose: compares hosts_groups table with cached configuration data        *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -3992,22 +5538,31 @@ int	zbx_dbsync_compare_item_script_param(zbx_dbsync_t *sync)
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_maintenances(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_host_group_hosts(zbx_dbsync_t *sync)
 {
 	DB_ROW			dbrow;
 	DB_RESULT		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	zbx_dc_maintenance_t	*maintenance;
+	zbx_hashset_iter_t	iter, iter_hosts;
+	zbx_dc_hostgroup_t	*group;
+	zbx_hashset_t		groups;
+	zbx_uint64_t		*phostid;
+	zbx_uint64_pair_t	gh_local, *gh;
+	char			groupid_s[MAX_ID_LEN + 1], hostid_s[MAX_ID_LEN + 1];
+	char			*del_row[2] = {groupid_s, hostid_s};
 
-	if (NULL == (result = DBselect("select maintenanceid,maintenance_type,active_since,active_till,tags_evaltype"
-						" from maintenances")))
+	if (NULL == (result = DBselect(
+			"select hg.groupid,hg.hostid"
+			" from hosts_groups hg,hosts h"
+			" where hg.hostid=h.hostid"
+			" and h.status in (%d,%d)"
+			" and h.flags<>%d"
+			" order by hg.groupid",
+			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED, ZBX_FLAG_DISCOVERY_PROTOTYPE)))
 	{
 		return FAIL;
 	}
 
-	dbsync_prepare(sync, 5, NULL);
+	dbsync_prepare(sync, 2, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -4015,475 +5570,776 @@ int	zbx_dbsync_compare_maintenances(zbx_dbsync_t *sync)
 		return SUCCEED;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->maintenances.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_create(&groups, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
 
-	while (NULL != (dbrow = DBfetch(result)))
+	/* index all group->host links */
+	zbx_hashset_iter_reset(&dbsync_env.cache->hostgroups, &iter);
+	while (NULL != (group = (zbx_dc_hostgroup_t *)zbx_hashset_iter_next(&iter)))
 	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
-
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
+		gh_local.first = group->groupid;
 
-		maintenance = (zbx_dc_maintenance_t *)zbx_hashset_search(&dbsync_env.cache->maintenances, &rowid);
+		zbx_hashset_iter_reset(&group->hostids, &iter_hosts);
+		while (NULL != (phostid = (zbx_uint64_t *)zbx_hashset_iter_next(&iter_hosts)))
+		{
+			gh_local.second = *phostid;
+			zbx_hashset_insert(&groups, &gh_local, sizeof(gh_local));
+		}
+	}
 
-		if (NULL == maintenance)
-			tag = ZBX_DBSYNC_ROW_ADD;
-		else if (FAIL == dbsync_compare_maintenance(maintenance, dbrow))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
+	/* add new rows, remove existing rows from index */
+	while (NULL != (dbrow = DBfetch(result)))
+	{
+		ZBX_STR2UINT64(gh_local.first, dbrow[0]);
+		ZBX_STR2UINT64(gh_local.second, dbrow[1]);
 
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
+		if (NULL == (gh = (zbx_uint64_pair_t *)zbx_hashset_search(&groups, &gh_local)))
+			dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_ADD, dbrow);
+		else
+			zbx_hashset_remove_direct(&groups, gh);
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->maintenances, &iter);
-	while (NULL != (maintenance = (zbx_dc_maintenance_t *)zbx_hashset_iter_next(&iter)))
+	/* add removed rows */
+	zbx_hashset_iter_reset(&groups, &iter);
+	while (NULL != (gh = (zbx_uint64_pair_t *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &maintenance->maintenanceid))
-			dbsync_add_row(sync, maintenance->maintenanceid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		zbx_snprintf(groupid_s, sizeof(groupid_s), ZBX_FS_UI64, gh->first);
+		zbx_snprintf(hostid_s, sizeof(hostid_s), ZBX_FS_UI64, gh->second);
+		dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_REMOVE, del_row);
 	}
 
-	zbx_hashset_destroy(&ids);
 	DBfree_result(result);
+	zbx_hashset_destroy(&groups);
 
 	return SUCCEED;
 }
 
+/* the row pre-processing functions of snapshot sections, the snapshot stores function */
+/* index because function addresses change between server runs                        */
+static zbx_dbsync_preproc_row_func_t	dbsync_snapshot_preproc_funcs[] = {NULL, dbsync_item_preproc_row,
+		dbsync_trigger_preproc_row, dbsync_function_preproc_row, dbsync_item_pp_preproc_row};
+
 /******************************************************************************
  *                                                                            *
- * Purpose: compares maintenance_tag table row with cached configuration data *
+ * Purpose: calculates hash identifying the server build writing snapshot     *
  *                                                                            *
- * Parameter: maintenance_tag - [IN] the cached maintenance tag               *
- *            dbrow           - [IN] the database row                         *
+ ******************************************************************************/
+static zbx_uint32_t	dbsync_snapshot_build_hash(void)
+{
+	char		*sql = NULL;
+	size_t		sql_alloc = 0, sql_offset = 0;
+	zbx_uint32_t	hash;
+
+	/* the item query changes with database schema also between development builds of the same version */
+	dbsync_items_sql(&sql, &sql_alloc, &sql_offset);
+	hash = ZBX_DEFAULT_STRING_HASH_ALGO(sql, sql_offset,
+			zbx_default_string_hash_func(ZABBIX_VERSION " " ZABBIX_REVISION));
+	zbx_free(sql);
+
+	return hash;
+}
+
+/******************************************************************************
  *                                                                            *
- * Return value: SUCCEED - the row matches configuration data                 *
+ * Purpose: starts writing configuration cache snapshot into temporary file   *
+ *                                                                            *
+ * Parameters: snapshot - [OUT] the snapshot                                  *
+ *             header   - [IN] the snapshot file header                       *
+ *                                                                            *
+ * Return value: SUCCEED - the file was created                               *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_maintenance_tag(const zbx_dc_maintenance_tag_t *maintenance_tag, const DB_ROW dbrow)
+static int	dbsync_snapshot_open(zbx_dbsync_snapshot_t *snapshot, const zbx_dbsync_snapshot_header_t *header)
 {
-	if (FAIL == dbsync_compare_int(dbrow[2], maintenance_tag->op))
+	int	fd;
+
+	snapshot->tmp_path = zbx_dsprintf(NULL, "%s.tmp", CONFIG_CACHE_SNAPSHOT_FILE);
+
+	/* the snapshot contains item and macro credentials, it must be readable only by server */
+	if (0 != unlink(snapshot->tmp_path) && ENOENT != errno)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot remove configuration cache snapshot file \"%s\": %s",
+				snapshot->tmp_path, zbx_strerror(errno));
+		zbx_free(snapshot->tmp_path);
 		return FAIL;
+	}
 
-	if (FAIL == dbsync_compare_str(dbrow[3], maintenance_tag->tag))
+	if (-1 == (fd = open(snapshot->tmp_path, O_WRONLY | O_CREAT | O_EXCL, 0600)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot create configuration cache snapshot file \"%s\": %s",
+				snapshot->tmp_path, zbx_strerror(errno));
+		zbx_free(snapshot->tmp_path);
 		return FAIL;
+	}
 
-	if (FAIL == dbsync_compare_str(dbrow[4], maintenance_tag->value))
+	if (NULL == (snapshot->file = fdopen(fd, "w")))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot open configuration cache snapshot file \"%s\": %s",
+				snapshot->tmp_path, zbx_strerror(errno));
+		close(fd);
+		unlink(snapshot->tmp_path);
+		zbx_free(snapshot->tmp_path);
 		return FAIL;
+	}
+
+	snapshot->ret = (1 == fwrite(header, sizeof(zbx_dbsync_snapshot_header_t), 1, snapshot->file) ? SUCCEED :
+			FAIL);
 
 	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares maintenances table with cached configuration data        *
+ * Purpose: selects changeset rows and writes them into snapshot section      *
  *                                                                            *
- * Parameter: sync - [OUT] the changeset                                      *
+ * Parameters: snapshot     - [IN/OUT] the snapshot                           *
+ *             compare_func - [IN] the changeset compare function             *
  *                                                                            *
- * Return value: SUCCEED - the changeset was successfully calculated          *
+ * Return value: SUCCEED - the rows were selected                             *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: Write errors are stored in snapshot and reported when it is      *
+ *           closed.                                                          *
+ *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_maintenance_tags(zbx_dbsync_t *sync)
+static int	dbsync_snapshot_write_section(zbx_dbsync_snapshot_t *snapshot, zbx_dbsync_compare_func_t compare_func)
 {
+	zbx_dbsync_t			sync;
+	zbx_dbsync_snapshot_section_t	section;
 	DB_ROW				dbrow;
-	DB_RESULT			result;
-	zbx_hashset_t			ids;
-	zbx_hashset_iter_t		iter;
-	zbx_uint64_t			rowid;
-	zbx_dc_maintenance_tag_t	*maintenance_tag;
+	off_t				pos, end;
+	size_t				buf_offset;
+	int				i, ret = FAIL;
 
-	if (NULL == (result = DBselect("select maintenancetagid,maintenanceid,operator,tag,value"
-						" from maintenance_tag")))
+	zbx_dbsync_init(&sync, ZBX_DBSYNC_INIT);
+
+	if (SUCCEED != compare_func(&sync))
+		goto out;
+
+	for (i = 0; i < (int)ARRSIZE(dbsync_snapshot_preproc_funcs); i++)
 	{
-		return FAIL;
+		if (sync.preproc_row_func == dbsync_snapshot_preproc_funcs[i])
+			break;
 	}
 
-	dbsync_prepare(sync, 5, NULL);
-
-	if (ZBX_DBSYNC_INIT == sync->mode)
+	if ((int)ARRSIZE(dbsync_snapshot_preproc_funcs) == i)
 	{
-		sync->dbresult = result;
-		return SUCCEED;
+		THIS_SHOULD_NEVER_HAPPEN;
+		goto out;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->maintenance_tags.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	memset(&section, 0, sizeof(section));
+	section.columns_num = sync.columns_num;
+	section.preproc_func = i;
 
-	while (NULL != (dbrow = DBfetch(result)))
+	ret = SUCCEED;
+
+	if (-1 == (pos = ftello(snapshot->file)) || 1 != fwrite(&section, sizeof(section), 1, snapshot->file))
 	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
+		snapshot->ret = FAIL;
+		goto out;
+	}
 
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
+	while (NULL != (dbrow = DBfetch(sync.dbresult)))
+	{
+		buf_offset = 0;
+		dbsync_row_encode(&snapshot->buf, &snapshot->buf_alloc, &buf_offset, dbrow, sync.columns_num);
 
-		maintenance_tag = (zbx_dc_maintenance_tag_t *)zbx_hashset_search(&dbsync_env.cache->maintenance_tags,
-				&rowid);
+		if (1 != fwrite(snapshot->buf, buf_offset, 1, snapshot->file))
+		{
+			snapshot->ret = FAIL;
+			goto out;
+		}
 
-		if (NULL == maintenance_tag)
-			tag = ZBX_DBSYNC_ROW_ADD;
-		else if (FAIL == dbsync_compare_maintenance_tag(maintenance_tag, dbrow))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
+		section.size += buf_offset;
+	}
 
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
+	/* the section size is known only after all rows are written */
+	if (-1 == (end = ftello(snapshot->file)) || 0 != fseeko(snapshot->file, pos, SEEK_SET) ||
+			1 != fwrite(&section, sizeof(section), 1, snapshot->file) ||
+			0 != fseeko(snapshot->file, end, SEEK_SET))
+	{
+		snapshot->ret = FAIL;
 	}
+out:
+	zbx_dbsync_clear(&sync);
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->maintenance_tags, &iter);
-	while (NULL != (maintenance_tag = (zbx_dc_maintenance_tag_t *)zbx_hashset_iter_next(&iter)))
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finishes writing configuration cache snapshot                     *
+ *                                                                            *
+ * Parameters: snapshot - [IN] the snapshot                                   *
+ *             ret      - [IN] SUCCEED - all rows were selected               *
+ *                             FAIL    - row selection failed                 *
+ *                                                                            *
+ * Return value: SUCCEED - the snapshot file was replaced                     *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The temporary file replaces the snapshot file only if all        *
+ *           sections were written successfully.                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_snapshot_close(zbx_dbsync_snapshot_t *snapshot, int ret)
+{
+	if (0 != fclose(snapshot->file) || SUCCEED != snapshot->ret)
 	{
-		if (NULL == zbx_hashset_search(&ids, &maintenance_tag->maintenancetagid))
-			dbsync_add_row(sync, maintenance_tag->maintenancetagid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		zabbix_log(LOG_LEVEL_WARNING, "cannot write configuration cache snapshot file \"%s\": %s",
+				snapshot->tmp_path, zbx_strerror(errno));
+		ret = FAIL;
 	}
 
-	zbx_hashset_destroy(&ids);
-	DBfree_result(result);
+	if (SUCCEED == ret && 0 != rename(snapshot->tmp_path, CONFIG_CACHE_SNAPSHOT_FILE))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot rename configuration cache snapshot file \"%s\": %s",
+				snapshot->tmp_path, zbx_strerror(errno));
+		ret = FAIL;
+	}
 
-	return SUCCEED;
+	if (SUCCEED != ret)
+		unlink(snapshot->tmp_path);
+
+	snapshot->file = NULL;
+	zbx_free(snapshot->tmp_path);
+	zbx_free(snapshot->buf);
+
+	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares maintenance_period table row with cached configuration   *
- *          dat                                                               *
+ * Purpose: selects changesets with own database connection and writes them   *
+ *          into snapshot file (snapshot writer process)                      *
  *                                                                            *
- * Parameter: period - [IN] the cached maintenance period                     *
- *            dbrow  - [IN] the database row                                  *
+ * Parameters: compare_funcs - [IN] the changeset compare functions           *
+ *             funcs_num     - [IN] the number of changesets                  *
+ *             header        - [IN] the snapshot file header                  *
  *                                                                            *
- * Return value: SUCCEED - the row matches configuration data                 *
- *               FAIL    - otherwise                                          *
+ * Comments: This function never returns.                                     *
  *                                                                            *
  ******************************************************************************/
-static int	dbsync_compare_maintenance_period(const zbx_dc_maintenance_period_t *period, const DB_ROW dbrow)
+static void	dbsync_snapshot_writer(zbx_dbsync_compare_func_t *compare_funcs, int funcs_num,
+		const zbx_dbsync_snapshot_header_t *header)
 {
-	if (FAIL == dbsync_compare_uchar(dbrow[1], period->type))
-		return FAIL;
+	zbx_dbsync_snapshot_t	snapshot;
+	int			i, ret = FAIL;
 
-	if (FAIL == dbsync_compare_int(dbrow[2], period->every))
-		return FAIL;
+	/* exit without running the atexit handlers inherited from configuration syncer */
+	if (ZBX_DB_OK != DBconnect(ZBX_DB_CONNECT_ONCE))
+		_exit(EXIT_FAILURE);
 
-	if (FAIL == dbsync_compare_int(dbrow[3], period->month))
-		return FAIL;
+	memset(&snapshot, 0, sizeof(snapshot));
 
-	if (FAIL == dbsync_compare_int(dbrow[4], period->dayofweek))
-		return FAIL;
+	if (SUCCEED == dbsync_snapshot_open(&snapshot, header))
+	{
+		for (i = 0, ret = SUCCEED; i < funcs_num && SUCCEED == ret && SUCCEED == snapshot.ret; i++)
+			ret = dbsync_snapshot_write_section(&snapshot, compare_funcs[i]);
 
-	if (FAIL == dbsync_compare_int(dbrow[5], period->day))
-		return FAIL;
+		ret = dbsync_snapshot_close(&snapshot, ret);
+	}
 
-	if (FAIL == dbsync_compare_int(dbrow[6], period->start_time))
-		return FAIL;
+	DBclose();
 
-	if (FAIL == dbsync_compare_int(dbrow[7], period->period))
-		return FAIL;
+	_exit(SUCCEED == ret ? EXIT_SUCCESS : EXIT_FAILURE);
+}
 
-	if (FAIL == dbsync_compare_int(dbrow[8], period->start_date))
-		return FAIL;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts writing configuration cache snapshot if it is due          *
+ *                                                                            *
+ * Parameters: compare_funcs - [IN] the compare functions of changesets       *
+ *                                  loaded from snapshot                      *
+ *             funcs_num     - [IN] the number of changesets                  *
+ *                                                                            *
+ * Comments: The snapshot is written by a forked process with its own         *
+ *           database connection, so that synchronization is not delayed.     *
+ *           The snapshot is taken after the server starts without snapshot   *
+ *           and after every reconciliation, which removes old changelog      *
+ *           records. The changes made after the recorded changelog position  *
+ *           are applied by the first synchronization after snapshot is       *
+ *           loaded.                                                          *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dbsync_write_snapshot(zbx_dbsync_compare_func_t *compare_funcs, int funcs_num)
+{
+	zbx_dbsync_snapshot_header_t	header;
+	pid_t				pid;
+	int				status;
 
-	return SUCCEED;
+	if (0 != dbsync_env.snapshot_pid)
+	{
+		while (-1 == (pid = waitpid(dbsync_env.snapshot_pid, &status, WNOHANG)) && EINTR == errno)
+			;
+
+		/* the previous snapshot is still being written */
+		if (0 == pid)
+			return;
+
+		if (-1 == pid || !WIFEXITED(status) || EXIT_SUCCESS != WEXITSTATUS(status))
+			zabbix_log(LOG_LEVEL_WARNING, "cannot write configuration cache snapshot");
+		else
+			zabbix_log(LOG_LEVEL_DEBUG, "configuration cache snapshot was written");
+
+		dbsync_env.snapshot_pid = 0;
+	}
+
+	if (0 == dbsync_env.snapshot_due || NULL == CONFIG_CACHE_SNAPSHOT_FILE ||
+			0 == (program_type & ZBX_PROGRAM_TYPE_SERVER))
+	{
+		return;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, ZBX_DBSYNC_SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = ZBX_DBSYNC_SNAPSHOT_VERSION;
+	header.build_hash = dbsync_snapshot_build_hash();
+	header.sections_num = funcs_num;
+	header.clock = (int)time(NULL);
+
+	/* the changes skipped before the rows are selected are read again after loading the snapshot */
+	if (0 != dbsync_env.changelog_gaps.values_num)
+		header.changelogid = dbsync_env.changelog_gaps.values[0].first - 1;
+	else
+		header.changelogid = dbsync_env.changelogid;
+
+	/* writer must not share the database connection */
+	DBclose();
+
+	/* plain fork, configuration syncer is not the main process */
+	if (0 == (pid = zbx_fork()))
+		dbsync_snapshot_writer(compare_funcs, funcs_num, &header);
+
+	if (-1 == pid)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot start configuration cache snapshot writer: %s",
+				zbx_strerror(errno));
+	}
+	else
+	{
+		dbsync_env.snapshot_pid = pid;
+		dbsync_env.snapshot_due = 0;
+	}
+
+	DBconnect(ZBX_DB_CONNECT_NORMAL);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares timeperiods table with cached configuration data         *
+ * Purpose: opens configuration cache snapshot file for reading               *
  *                                                                            *
- * Parameter: sync - [OUT] the changeset                                      *
+ * Parameters: fd    - [OUT] the file descriptor                              *
+ *             size  - [OUT] the file size                                    *
+ *             error - [OUT] the error message                                *
  *                                                                            *
- * Return value: SUCCEED - the changeset was successfully calculated          *
+ * Return value: SUCCEED - the file was opened                                *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_maintenance_periods(zbx_dbsync_t *sync)
+static int	dbsync_snapshot_open_read(int *fd, zbx_uint64_t *size, char **error)
 {
-	DB_ROW				dbrow;
-	DB_RESULT			result;
-	zbx_hashset_t			ids;
-	zbx_hashset_iter_t		iter;
-	zbx_uint64_t			rowid;
-	zbx_dc_maintenance_period_t	*period;
+	zbx_stat_t	st;
 
-	if (NULL == (result = DBselect("select t.timeperiodid,t.timeperiod_type,t.every,t.month,t.dayofweek,t.day,"
-						"t.start_time,t.period,t.start_date,m.maintenanceid"
-					" from maintenances_windows m,timeperiods t"
-					" where t.timeperiodid=m.timeperiodid")))
+	if (-1 == (*fd = open(CONFIG_CACHE_SNAPSHOT_FILE, O_RDONLY)))
 	{
+		*error = zbx_dsprintf(NULL, "cannot open file: %s", zbx_strerror(errno));
 		return FAIL;
 	}
 
-	dbsync_prepare(sync, 10, NULL);
+	if (0 != zbx_fstat(*fd, &st))
+	{
+		*error = zbx_dsprintf(NULL, "cannot obtain file information: %s", zbx_strerror(errno));
+		goto fail;
+	}
 
-	if (ZBX_DBSYNC_INIT == sync->mode)
+	if (st.st_uid != geteuid() || 0 != (st.st_mode & (S_IRWXG | S_IRWXO)))
 	{
-		sync->dbresult = result;
-		return SUCCEED;
+		*error = zbx_strdup(NULL, "file must be owned by the server user and not accessible by others");
+		goto fail;
 	}
 
-	zbx_hashset_create(&ids, dbsync_env.cache->maintenance_periods.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	*size = (zbx_uint64_t)st.st_size;
 
-	while (NULL != (dbrow = DBfetch(result)))
-	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
+	return SUCCEED;
+fail:
+	close(*fd);
+	*fd = -1;
 
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
+	return FAIL;
+}
 
-		period = (zbx_dc_maintenance_period_t *)zbx_hashset_search(&dbsync_env.cache->maintenance_periods,
-				&rowid);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads the specified number of bytes from snapshot file            *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_snapshot_read(int fd, void *data, size_t size, char **error)
+{
+	size_t	offset = 0;
+	ssize_t	n;
 
-		if (NULL == period)
-			tag = ZBX_DBSYNC_ROW_ADD;
-		else if (FAIL == dbsync_compare_maintenance_period(period, dbrow))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
+	while (offset < size)
+	{
+		if (-1 == (n = read(fd, (char *)data + offset, size - offset)))
+		{
+			if (EINTR == errno)
+				continue;
 
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
-	}
+			*error = zbx_dsprintf(NULL, "cannot read file: %s", zbx_strerror(errno));
+			return FAIL;
+		}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->maintenance_periods, &iter);
-	while (NULL != (period = (zbx_dc_maintenance_period_t *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL == zbx_hashset_search(&ids, &period->timeperiodid))
-			dbsync_add_row(sync, period->timeperiodid, ZBX_DBSYNC_ROW_REMOVE, NULL);
-	}
+		if (0 == n)
+		{
+			*error = zbx_strdup(NULL, "unexpected end of file");
+			return FAIL;
+		}
 
-	zbx_hashset_destroy(&ids);
-	DBfree_result(result);
+		offset += (size_t)n;
+	}
 
 	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares maintenances_groups table with cached configuration data *
+ * Purpose: checks if changelog still has all records written after the       *
+ *          snapshot was taken                                                *
  *                                                                            *
- * Parameter: sync - [OUT] the changeset                                      *
+ * Parameters: changelogid - [IN] the changelog position of snapshot          *
  *                                                                            *
- * Return value: SUCCEED - the changeset was successfully calculated          *
+ * Return value: SUCCEED - the changes made after snapshot can be read from   *
+ *                         changelog                                          *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: Old records are removed by time during reconciliation and the    *
+ *           last read record is always kept. So if a record not newer than   *
+ *           the snapshot position still exists, no newer records were        *
+ *           removed, no matter how long the server was stopped.              *
+ *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_maintenance_groups(zbx_dbsync_t *sync)
+static int	dbsync_snapshot_check_changelog(zbx_uint64_t changelogid)
 {
-	DB_ROW			dbrow;
-	DB_RESULT		result;
-	zbx_hashset_iter_t	iter;
-	zbx_dc_maintenance_t	*maintenance;
-	zbx_hashset_t		mgroups;
-	int			i;
-	zbx_uint64_pair_t	mg_local, *mg;
-	char			maintenanceid_s[MAX_ID_LEN + 1], groupid_s[MAX_ID_LEN + 1];
-	char			*del_row[2] = {maintenanceid_s, groupid_s};
+	DB_RESULT	result;
+	DB_ROW		row;
+	zbx_uint64_t	first_changelogid;
+	int		ret = FAIL;
 
-	if (NULL == (result = DBselect("select maintenanceid,groupid from maintenances_groups order by maintenanceid")))
+	if (NULL == (result = DBselect("select min(changelogid) from changelog")))
 		return FAIL;
 
-	dbsync_prepare(sync, 2, NULL);
-
-	if (ZBX_DBSYNC_INIT == sync->mode)
+	if (NULL != (row = DBfetch(result)))
 	{
-		sync->dbresult = result;
-		return SUCCEED;
+		if (SUCCEED == DBis_null(row[0]))
+		{
+			/* nothing was changed since snapshot was taken on empty changelog */
+			ret = SUCCEED;
+		}
+		else
+		{
+			ZBX_STR2UINT64(first_changelogid, row[0]);
+
+			if (first_changelogid <= changelogid)
+				ret = SUCCEED;
+		}
 	}
+	DBfree_result(result);
 
-	zbx_hashset_create(&mgroups, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
+	return ret;
+}
 
-	/* index all maintenance->group links */
-	zbx_hashset_iter_reset(&dbsync_env.cache->maintenances, &iter);
-	while (NULL != (maintenance = (zbx_dc_maintenance_t *)zbx_hashset_iter_next(&iter)))
-	{
-		mg_local.first = maintenance->maintenanceid;
+static void	dbsync_item_rtdata_clean(void *data)
+{
+	zbx_dbsync_item_rtdata_t	*rtdata = (zbx_dbsync_item_rtdata_t *)data;
 
-		for (i = 0; i < maintenance->groupids.values_num; i++)
-		{
-			mg_local.second = maintenance->groupids.values[i];
-			zbx_hashset_insert(&mgroups, &mg_local, sizeof(mg_local));
-		}
-	}
+	zbx_free(rtdata->state);
+	zbx_free(rtdata->lastlogsize);
+	zbx_free(rtdata->mtime);
+	zbx_free(rtdata->error);
+}
 
-	/* add new rows, remove existing rows from index */
-	while (NULL != (dbrow = DBfetch(result)))
-	{
-		ZBX_STR2UINT64(mg_local.first, dbrow[0]);
-		ZBX_STR2UINT64(mg_local.second, dbrow[1]);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads item runtime data from database                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_item_rtdata_load(zbx_hashset_t *rtdata)
+{
+	DB_RESULT			result;
+	DB_ROW				dbrow;
+	zbx_dbsync_item_rtdata_t	rtdata_local;
 
-		if (NULL == (mg = (zbx_uint64_pair_t *)zbx_hashset_search(&mgroups, &mg_local)))
-			dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_ADD, dbrow);
-		else
-			zbx_hashset_remove_direct(&mgroups, mg);
-	}
+	if (NULL == (result = DBselect("select itemid,state,lastlogsize,mtime,error from item_rtdata")))
+		return FAIL;
 
-	/* add removed rows */
-	zbx_hashset_iter_reset(&mgroups, &iter);
-	while (NULL != (mg = (zbx_uint64_pair_t *)zbx_hashset_iter_next(&iter)))
+	while (NULL != (dbrow = DBfetch(result)))
 	{
-		zbx_snprintf(maintenanceid_s, sizeof(maintenanceid_s), ZBX_FS_UI64, mg->first);
-		zbx_snprintf(groupid_s, sizeof(groupid_s), ZBX_FS_UI64, mg->second);
-		dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_REMOVE, del_row);
+		ZBX_STR2UINT64(rtdata_local.itemid, dbrow[0]);
+		rtdata_local.state = zbx_strdup(NULL, dbrow[1]);
+		rtdata_local.lastlogsize = zbx_strdup(NULL, dbrow[2]);
+		rtdata_local.mtime = zbx_strdup(NULL, dbrow[3]);
+		rtdata_local.error = zbx_strdup(NULL, dbrow[4]);
+		zbx_hashset_insert(rtdata, &rtdata_local, sizeof(rtdata_local));
 	}
-
 	DBfree_result(result);
-	zbx_hashset_destroy(&mgroups);
 
 	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares maintenances_hosts table with cached configuration data  *
+ * Purpose: checks snapshot section rows, replacing item runtime data with    *
+ *          the values read from database for items section                   *
  *                                                                            *
- * Parameter: sync - [OUT] the changeset                                      *
+ * Parameters: data        - [IN/OUT] the encoded rows                        *
+ *             size        - [IN/OUT] the encoded rows size                   *
+ *             columns_num - [IN] the number of columns                       *
+ *             rtdata      - [IN] the item runtime data, NULL for sections    *
+ *                                other than items                            *
  *                                                                            *
- * Return value: SUCCEED - the changeset was successfully calculated          *
- *               FAIL    - otherwise                                          *
+ * Return value: SUCCEED - the rows are valid                                 *
+ *               FAIL    - the data is truncated or corrupted                 *
+ *                                                                            *
+ * Comments: Items without runtime data were removed after snapshot was taken *
+ *           and are skipped.                                                 *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_maintenance_hosts(zbx_dbsync_t *sync)
+static int	dbsync_snapshot_check_rows(char **data, size_t *size, int columns_num, zbx_hashset_t *rtdata)
 {
-	DB_ROW			dbrow;
-	DB_RESULT		result;
-	zbx_hashset_iter_t	iter;
-	zbx_dc_maintenance_t	*maintenance;
-	zbx_hashset_t		mhosts;
-	int			i;
-	zbx_uint64_pair_t	mh_local, *mh;
-	char			maintenanceid_s[MAX_ID_LEN + 1], hostid_s[MAX_ID_LEN + 1];
-	char			*del_row[2] = {maintenanceid_s, hostid_s};
-
-	if (NULL == (result = DBselect("select maintenanceid,hostid from maintenances_hosts order by maintenanceid")))
-		return FAIL;
+	char				**row, *items = NULL;
+	size_t				pos = 0, items_alloc = 0, items_offset = 0;
+	zbx_uint64_t			itemid;
+	zbx_dbsync_item_rtdata_t	*item_rtdata;
+	int				ret = SUCCEED;
 
-	dbsync_prepare(sync, 2, NULL);
+	row = (char **)zbx_malloc(NULL, sizeof(char *) * (size_t)columns_num);
 
-	if (ZBX_DBSYNC_INIT == sync->mode)
+	while (pos < *size)
 	{
-		sync->dbresult = result;
-		return SUCCEED;
-	}
-
-	zbx_hashset_create(&mhosts, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
+		if (SUCCEED != dbsync_row_decode(*data, *size, &pos, row, columns_num))
+		{
+			ret = FAIL;
+			break;
+		}
 
-	/* index all maintenance->host links */
-	zbx_hashset_iter_reset(&dbsync_env.cache->maintenances, &iter);
-	while (NULL != (maintenance = (zbx_dc_maintenance_t *)zbx_hashset_iter_next(&iter)))
-	{
-		mh_local.first = maintenance->maintenanceid;
+		if (NULL == rtdata)
+			continue;
 
-		for (i = 0; i < maintenance->hostids.values_num; i++)
+		if (NULL == row[0])
 		{
-			mh_local.second = maintenance->hostids.values[i];
-			zbx_hashset_insert(&mhosts, &mh_local, sizeof(mh_local));
+			ret = FAIL;
+			break;
 		}
-	}
 
-	/* add new rows, remove existing rows from index */
-	while (NULL != (dbrow = DBfetch(result)))
-	{
-		ZBX_STR2UINT64(mh_local.first, dbrow[0]);
-		ZBX_STR2UINT64(mh_local.second, dbrow[1]);
+		ZBX_STR2UINT64(itemid, row[0]);
 
-		if (NULL == (mh = (zbx_uint64_pair_t *)zbx_hashset_search(&mhosts, &mh_local)))
-			dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_ADD, dbrow);
-		else
-			zbx_hashset_remove_direct(&mhosts, mh);
+		if (NULL == (item_rtdata = (zbx_dbsync_item_rtdata_t *)zbx_hashset_search(rtdata, &itemid)))
+			continue;
+
+		row[ZBX_DBSYNC_ITEM_RTDATA_STATE] = item_rtdata->state;
+		row[ZBX_DBSYNC_ITEM_RTDATA_LASTLOGSIZE] = item_rtdata->lastlogsize;
+		row[ZBX_DBSYNC_ITEM_RTDATA_MTIME] = item_rtdata->mtime;
+		row[ZBX_DBSYNC_ITEM_RTDATA_ERROR] = item_rtdata->error;
+
+		dbsync_row_encode(&items, &items_alloc, &items_offset, row, columns_num);
 	}
 
-	/* add removed rows */
-	zbx_hashset_iter_reset(&mhosts, &iter);
-	while (NULL != (mh = (zbx_uint64_pair_t *)zbx_hashset_iter_next(&iter)))
+	zbx_free(row);
+
+	if (NULL != rtdata)
 	{
-		zbx_snprintf(maintenanceid_s, sizeof(maintenanceid_s), ZBX_FS_UI64, mh->first);
-		zbx_snprintf(hostid_s, sizeof(hostid_s), ZBX_FS_UI64, mh->second);
-		dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_REMOVE, del_row);
+		if (SUCCEED == ret)
+		{
+			zbx_free(*data);
+			*data = items;
+			*size = items_offset;
+		}
+		else
+			zbx_free(items);
 	}
 
-	DBfree_result(result);
-	zbx_hashset_destroy(&mhosts);
-
-	return SUCCEED;
+	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares hosts_groups table with cached configuration data        *
+ * Purpose: loads changesets for the initial synchronization from             *
+ *          configuration cache snapshot file                                 *
  *                                                                            *
- * Parameter: sync - [OUT] the changeset                                      *
+ * Parameters: syncs     - [IN/OUT] the changesets, initialized in            *
+ *                                  ZBX_DBSYNC_INIT mode                      *
+ *             syncs_num - [IN] the number of changesets                      *
  *                                                                            *
- * Return value: SUCCEED - the changeset was successfully calculated          *
- *               FAIL    - otherwise                                          *
+ * Return value: SUCCEED - the changesets were loaded from snapshot           *
+ *               FAIL    - the snapshot is disabled, missing or outdated      *
+ *                                                                            *
+ * Comments: The changesets must be listed in the same order as the compare   *
+ *           functions passed to zbx_dbsync_write_snapshot().                 *
+ *           The snapshot is usable while changelog has all records written   *
+ *           since the snapshot was taken. The item changes are applied by    *
+ *           the next incremental synchronization and the other tables are    *
+ *           fully compared by it. The item runtime data is written by server *
+ *           without changelog registration, so it is read from database.     *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_host_group_hosts(zbx_dbsync_t *sync)
+int	zbx_dbsync_load_snapshot(zbx_dbsync_t **syncs, int syncs_num)
 {
-	DB_ROW			dbrow;
-	DB_RESULT		result;
-	zbx_hashset_iter_t	iter, iter_hosts;
-	zbx_dc_hostgroup_t	*group;
-	zbx_hashset_t		groups;
-	zbx_uint64_t		*phostid;
-	zbx_uint64_pair_t	gh_local, *gh;
-	char			groupid_s[MAX_ID_LEN + 1], hostid_s[MAX_ID_LEN + 1];
-	char			*del_row[2] = {groupid_s, hostid_s};
+	zbx_dbsync_snapshot_header_t	header;
+	zbx_dbsync_snapshot_section_t	*sections;
+	char				**data, *error = NULL;
+	size_t				*sizes;
+	zbx_uint64_t			file_size, offset;
+	zbx_hashset_t			rtdata;
+	int				fd, i, loaded_num = 0, ret = FAIL;
 
-	if (NULL == (result = DBselect(
-			"select hg.groupid,hg.hostid"
-			" from hosts_groups hg,hosts h"
-			" where hg.hostid=h.hostid"
-			" and h.status in (%d,%d)"
-			" and h.flags<>%d"
-			" order by hg.groupid",
-			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED, ZBX_FLAG_DISCOVERY_PROTOTYPE)))
-	{
+	if (NULL == CONFIG_CACHE_SNAPSHOT_FILE || 0 == (program_type & ZBX_PROGRAM_TYPE_SERVER))
 		return FAIL;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	sections = (zbx_dbsync_snapshot_section_t *)zbx_malloc(NULL, sizeof(zbx_dbsync_snapshot_section_t) *
+			(size_t)syncs_num);
+	data = (char **)zbx_calloc(NULL, (size_t)syncs_num, sizeof(char *));
+	sizes = (size_t *)zbx_calloc(NULL, (size_t)syncs_num, sizeof(size_t));
+
+	zbx_hashset_create_ext(&rtdata, 1000, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC,
+			dbsync_item_rtdata_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+
+	if (SUCCEED != dbsync_snapshot_open_read(&fd, &file_size, &error))
+		goto out;
+
+	if (sizeof(header) > file_size || SUCCEED != dbsync_snapshot_read(fd, &header, sizeof(header), &error))
+	{
+		if (NULL == error)
+			error = zbx_strdup(NULL, "invalid file size");
+		goto out;
 	}
 
-	dbsync_prepare(sync, 2, NULL);
+	if (0 != memcmp(header.magic, ZBX_DBSYNC_SNAPSHOT_MAGIC, sizeof(header.magic)) ||
+			ZBX_DBSYNC_SNAPSHOT_VERSION != header.version ||
+			dbsync_snapshot_build_hash() != header.build_hash || syncs_num != header.sections_num)
+	{
+		error = zbx_strdup(NULL, "incompatible snapshot format");
+		goto out;
+	}
 
-	if (ZBX_DBSYNC_INIT == sync->mode)
+	if (SUCCEED != dbsync_snapshot_check_changelog(header.changelogid))
 	{
-		sync->dbresult = result;
-		return SUCCEED;
+		error = zbx_strdup(NULL, "changelog records written after snapshot was taken were removed");
+		goto out;
 	}
 
-	zbx_hashset_create(&groups, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
+	if (SUCCEED != dbsync_item_rtdata_load(&rtdata))
+	{
+		error = zbx_strdup(NULL, "cannot select item runtime data");
+		goto out;
+	}
 
-	/* index all group->host links */
-	zbx_hashset_iter_reset(&dbsync_env.cache->hostgroups, &iter);
-	while (NULL != (group = (zbx_dc_hostgroup_t *)zbx_hashset_iter_next(&iter)))
+	for (offset = sizeof(header); loaded_num < syncs_num; loaded_num++)
 	{
-		gh_local.first = group->groupid;
+		zbx_dbsync_snapshot_section_t	*section = &sections[loaded_num];
+		zbx_hashset_t			*section_rtdata = NULL;
 
-		zbx_hashset_iter_reset(&group->hostids, &iter_hosts);
-		while (NULL != (phostid = (zbx_uint64_t *)zbx_hashset_iter_next(&iter_hosts)))
+		if (sizeof(*section) > file_size - offset ||
+				SUCCEED != dbsync_snapshot_read(fd, section, sizeof(*section), &error))
 		{
-			gh_local.second = *phostid;
-			zbx_hashset_insert(&groups, &gh_local, sizeof(gh_local));
+			break;
+		}
+
+		offset += sizeof(*section);
+
+		if (0 >= section->columns_num || 0 > section->preproc_func ||
+				(int)ARRSIZE(dbsync_snapshot_preproc_funcs) <= section->preproc_func ||
+				section->size > file_size - offset)
+		{
+			break;
+		}
+
+		if (dbsync_item_preproc_row == dbsync_snapshot_preproc_funcs[section->preproc_func])
+		{
+			if (ZBX_DBSYNC_ITEM_COLUMNS_NUM != section->columns_num)
+				break;
+
+			section_rtdata = &rtdata;
+		}
+
+		sizes[loaded_num] = (size_t)section->size;
+
+		if (0 != sizes[loaded_num])
+		{
+			data[loaded_num] = (char *)zbx_malloc(NULL, sizes[loaded_num]);
+
+			if (SUCCEED != dbsync_snapshot_read(fd, data[loaded_num], sizes[loaded_num], &error))
+				break;
+		}
+
+		offset += section->size;
+
+		if (SUCCEED != dbsync_snapshot_check_rows(&data[loaded_num], &sizes[loaded_num],
+				section->columns_num, section_rtdata))
+		{
+			break;
 		}
 	}
 
-	/* add new rows, remove existing rows from index */
-	while (NULL != (dbrow = DBfetch(result)))
+	if (loaded_num != syncs_num || offset != file_size)
 	{
-		ZBX_STR2UINT64(gh_local.first, dbrow[0]);
-		ZBX_STR2UINT64(gh_local.second, dbrow[1]);
+		if (NULL == error)
+			error = zbx_strdup(NULL, "invalid snapshot data");
+		goto out;
+	}
 
-		if (NULL == (gh = (zbx_uint64_pair_t *)zbx_hashset_search(&groups, &gh_local)))
-			dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_ADD, dbrow);
-		else
-			zbx_hashset_remove_direct(&groups, gh);
+	for (i = 0; i < syncs_num; i++)
+	{
+		zbx_dbsync_prefetch_t	*prefetch;
+
+		prefetch = dbsync_prefetch_create(-1, -1);
+		prefetch->data = data[i];
+		prefetch->data_alloc = prefetch->data_offset = sizes[i];
+		prefetch->row = (char **)zbx_malloc(NULL, sizeof(char *) * (size_t)sections[i].columns_num);
+		data[i] = NULL;
+
+		syncs[i]->prefetch = prefetch;
+		dbsync_prepare(syncs[i], sections[i].columns_num,
+				dbsync_snapshot_preproc_funcs[sections[i].preproc_func]);
 	}
 
-	/* add removed rows */
-	zbx_hashset_iter_reset(&groups, &iter);
-	while (NULL != (gh = (zbx_uint64_pair_t *)zbx_hashset_iter_next(&iter)))
+	/* apply item changes made since snapshot was taken during the next synchronization */
+	dbsync_env.changelogid = header.changelogid;
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "loaded %d configuration tables from configuration cache snapshot taken %d"
+			" seconds ago", syncs_num, (int)time(NULL) - header.clock);
+
+	ret = SUCCEED;
+out:
+	if (SUCCEED != ret)
 	{
-		zbx_snprintf(groupid_s, sizeof(groupid_s), ZBX_FS_UI64, gh->first);
-		zbx_snprintf(hostid_s, sizeof(hostid_s), ZBX_FS_UI64, gh->second);
-		dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_REMOVE, del_row);
+		zabbix_log(LOG_LEVEL_WARNING, "cannot load configuration cache snapshot \"%s\": %s",
+				CONFIG_CACHE_SNAPSHOT_FILE, error);
+
+		/* write new snapshot after the initial synchronization */
+		dbsync_env.snapshot_due = 1;
 	}
 
-	DBfree_result(result);
-	zbx_hashset_destroy(&groups);
+	if (-1 != fd)
+		close(fd);
 
-	return SUCCEED;
+	for (i = 0; i < syncs_num; i++)
+		zbx_free(data[i]);
+
+	zbx_hashset_destroy(&rtdata);
+	zbx_free(sizes);
+	zbx_free(data);
+	zbx_free(sections);
+	zbx_free(error);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
 }
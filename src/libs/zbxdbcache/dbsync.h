@@ -40,6 +40,10 @@
 #define ZBX_DBSYNC_UPDATE_HOST_GROUPS		__UINT64_C(0x0020)
 #define ZBX_DBSYNC_UPDATE_MAINTENANCE_GROUPS	__UINT64_C(0x0040)
 
+/* changelog object types, must match the values used by changelog database triggers */
+#define ZBX_DBSYNC_OBJ_HOST	1
+#define ZBX_DBSYNC_OBJ_ITEM	3
+
 #if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
 #	define ZBX_HOST_TLS_OFFSET	4
 #else
@@ -62,6 +66,8 @@
  ******************************************************************************/
 typedef char **(*zbx_dbsync_preproc_row_func_t)(char **row);
 
+typedef struct zbx_dbsync_prefetch zbx_dbsync_prefetch_t;
+
 typedef struct
 {
 	/* a row tag, describing the changes (see ZBX_DBSYNC_ROW_* defines) */
@@ -92,6 +98,10 @@ struct zbx_dbsync
 	/* the database result set for ZBX_DBSYNC_ALL mode */
 	DB_RESULT			dbresult;
 
+	/* the rows loaded by zbx_dbsync_prefetch() or from snapshot for ZBX_DBSYNC_INIT mode, */
+	/* NULL if not prefetched                                                             */
+	zbx_dbsync_prefetch_t		*prefetch;
+
 	/* the row preprocessing function */
 	zbx_dbsync_preproc_row_func_t	preproc_row_func;
 
@@ -114,6 +124,15 @@ void	zbx_dbsync_init(zbx_dbsync_t *sync, unsigned char mode);
 void	zbx_dbsync_clear(zbx_dbsync_t *sync);
 int	zbx_dbsync_next(zbx_dbsync_t *sync, zbx_uint64_t *rowid, char ***row, unsigned char *tag);
 
+typedef int	(*zbx_dbsync_compare_func_t)(zbx_dbsync_t *sync);
+
+int	zbx_dbsync_prefetch(zbx_dbsync_t **syncs, zbx_dbsync_compare_func_t *compare_funcs, int syncs_num,
+		int workers_num);
+void	zbx_dbsync_prefetch_finish(void);
+int	zbx_dbsync_compare(zbx_dbsync_t *sync, zbx_dbsync_compare_func_t compare_func);
+int	zbx_dbsync_load_snapshot(zbx_dbsync_t **syncs, int syncs_num);
+void	zbx_dbsync_write_snapshot(zbx_dbsync_compare_func_t *compare_funcs, int funcs_num);
+
 int	zbx_dbsync_compare_config(zbx_dbsync_t *sync);
 int	zbx_dbsync_compare_autoreg_psk(zbx_dbsync_t *sync);
 int	zbx_dbsync_compare_hosts(zbx_dbsync_t *sync);
@@ -72,6 +72,9 @@ static int	vc_state = ZBX_VC_DISABLED;
 /* the value cache size */
 extern zbx_uint64_t	CONFIG_VALUE_CACHE_SIZE;
 
+/* the value cache snapshot file */
+extern char		*CONFIG_VALUE_CACHE_SNAPSHOT_FILE;
+
 ZBX_MEM_FUNC_IMPL(__vc, vc_mem)
 
 #define VC_STRPOOL_INIT_SIZE	(1000)
@@ -86,6 +89,38 @@ ZBX_MEM_FUNC_IMPL(__vc, vc_mem)
 
 #define ZBX_VC_ITEM_EXPIRE_PERIOD	SEC_PER_DAY
 
+#define ZBX_VC_SNAPSHOT_MAGIC		"ZBXVALUE"
+#define ZBX_VC_SNAPSHOT_VERSION		1
+
+/* the value cache snapshot file header, the file is read only by the same server binary */
+typedef struct
+{
+	char		magic[sizeof(ZBX_VC_SNAPSHOT_MAGIC) - 1];
+	zbx_uint32_t	version;
+
+	/* the number of items in snapshot */
+	int		items_num;
+
+	/* the time when the snapshot was taken */
+	int		clock;
+}
+zbx_vc_snapshot_header_t;
+
+/* the value cache snapshot item, followed by the item values in ascending order */
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	unsigned char	value_type;
+	unsigned char	status;
+	unsigned char	range_sync_hour;
+	int		last_accessed;
+	int		active_range;
+	int		daily_range;
+	int		db_cached_from;
+	int		values_num;
+}
+zbx_vc_snapshot_item_t;
+
 /* the data chunk used to store data fragment */
 typedef struct zbx_vc_chunk
 {
@@ -169,6 +204,11 @@ typedef struct
 	/* The hour of hourly_num                                     */
 	int		hour;
 
+	/* The time when the value cache snapshot the item was loaded */
+	/* from was taken. Set until the item values are checked      */
+	/* against database when the item is accessed first time.     */
+	int		restored_from;
+
 	/* The number of cache hits for this item.                    */
 	/* Used to evaluate if the item must be dropped from cache    */
 	/* in low memory situation.                                   */
@@ -934,6 +974,125 @@ static void	vc_history_record_vector_append(zbx_vector_history_record_t *vector,
 	zbx_vector_history_record_append_ptr(vector, &record);
 }
 
+/* range aggregate state, see ZBX_VC_AGGREGATE_* defines for functions */
+typedef struct
+{
+	int		func;
+	int		value_type;
+	int		values_num;
+	history_value_t	value;
+}
+zbx_vc_aggregate_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: aggregates a range of history records                             *
+ *                                                                            *
+ * Parameters: records - [IN] the history records                             *
+ *             first   - [IN] the index of the first record in range          *
+ *             last    - [IN] the index of the last record in range           *
+ *             data    - [IN/OUT] the aggregate state                         *
+ *                                                                            *
+ * Comments: This is zbx_vc_foreach_value() callback. Records are processed   *
+ *           from the last to the first one - the same order as               *
+ *           zbx_vc_get_values() returns values, so the results match the     *
+ *           ones calculated from the returned values.                        *
+ *           The loops are kept simple for compiler to optimize them.         *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_aggregate_records(const zbx_history_record_t *records, int first, int last, void *data)
+{
+	zbx_vc_aggregate_t	*agg = (zbx_vc_aggregate_t *)data;
+	int			i, n;
+
+	switch (agg->func)
+	{
+		case ZBX_VC_AGGREGATE_SUM:
+			if (ITEM_VALUE_TYPE_FLOAT == agg->value_type)
+			{
+				for (i = last; i >= first; i--)
+					agg->value.dbl += records[i].value.dbl;
+			}
+			else
+			{
+				for (i = last; i >= first; i--)
+					agg->value.ui64 += records[i].value.ui64;
+			}
+			break;
+		case ZBX_VC_AGGREGATE_AVG:
+			if (ITEM_VALUE_TYPE_FLOAT == agg->value_type)
+			{
+				/* running average to avoid overflow, see evaluate_AVG() */
+				for (i = last, n = agg->values_num + 1; i >= first; i--, n++)
+					agg->value.dbl += records[i].value.dbl / n - agg->value.dbl / n;
+			}
+			else
+			{
+				/* sum is divided by the number of values in vc_aggregate_finish() */
+				for (i = last; i >= first; i--)
+					agg->value.dbl += (double)records[i].value.ui64;
+			}
+			break;
+		case ZBX_VC_AGGREGATE_MIN:
+			if (0 == agg->values_num)
+				agg->value = records[last].value;
+
+			if (ITEM_VALUE_TYPE_FLOAT == agg->value_type)
+			{
+				for (i = last; i >= first; i--)
+				{
+					if (records[i].value.dbl < agg->value.dbl)
+						agg->value.dbl = records[i].value.dbl;
+				}
+			}
+			else
+			{
+				for (i = last; i >= first; i--)
+				{
+					if (records[i].value.ui64 < agg->value.ui64)
+						agg->value.ui64 = records[i].value.ui64;
+				}
+			}
+			break;
+		case ZBX_VC_AGGREGATE_MAX:
+			if (0 == agg->values_num)
+				agg->value = records[last].value;
+
+			if (ITEM_VALUE_TYPE_FLOAT == agg->value_type)
+			{
+				for (i = last; i >= first; i--)
+				{
+					if (records[i].value.dbl > agg->value.dbl)
+						agg->value.dbl = records[i].value.dbl;
+				}
+			}
+			else
+			{
+				for (i = last; i >= first; i--)
+				{
+					if (records[i].value.ui64 > agg->value.ui64)
+						agg->value.ui64 = records[i].value.ui64;
+				}
+			}
+			break;
+	}
+
+	agg->values_num += last - first + 1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finishes range aggregate calculation                              *
+ *                                                                            *
+ * Parameters: agg - [IN/OUT] the aggregate state                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_aggregate_finish(zbx_vc_aggregate_t *agg)
+{
+	if (ZBX_VC_AGGREGATE_AVG == agg->func && ITEM_VALUE_TYPE_UINT64 == agg->value_type && 0 != agg->values_num)
+		agg->value.dbl /= agg->values_num;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: allocate cache memory to store item's resources                   *
@@ -2299,173 +2458,1008 @@ out:
 
 /******************************************************************************
  *                                                                            *
- * Purpose: frees resources allocated for item history data                   *
+ * Purpose: finds the first value in chunk with timestamp greater than the    *
+ *          specified timestamp                                               *
  *                                                                            *
- * Parameters: item    - [IN] the item                                        *
+ * Parameters: chunk - [IN] the chunk                                         *
+ *             index - [IN] the index of the last value to check              *
+ *             ts    - [IN] the target timestamp                              *
  *                                                                            *
- * Return value: the size of freed memory (bytes)                             *
+ * Return value: The index of the first value in chunk with timestamp greater *
+ *               than the specified timestamp or index + 1 if there are no    *
+ *               such values.                                                 *
  *                                                                            *
  ******************************************************************************/
-static size_t	vch_item_free_cache(zbx_vc_item_t *item)
+static int	vch_chunk_find_first_value_after(const zbx_vc_chunk_t *chunk, int index, const zbx_timespec_t *ts)
 {
-	size_t	freed = 0;
-
-	zbx_vc_chunk_t	*chunk = item->tail;
+	int	start = chunk->first_value, end = index + 1, middle;
 
-	while (NULL != chunk)
+	while (start < end)
 	{
-		zbx_vc_chunk_t	*next = chunk->next;
+		middle = start + (end - start) / 2;
 
-		freed += vch_item_free_chunk(item, chunk);
-		chunk = next;
+		if (0 < zbx_timespec_compare(&chunk->slots[middle].timestamp, ts))
+			end = middle;
+		else
+			start = middle + 1;
 	}
-	item->values_total = 0;
-	item->head = NULL;
-	item->tail = NULL;
 
-	return freed;
+	return start;
 }
 
-/******************************************************************************************************************
- *                                                                                                                *
- * Public API                                                                                                     *
- *                                                                                                                *
- ******************************************************************************************************************/
-
 /******************************************************************************
  *                                                                            *
- * Purpose: initializes value cache                                           *
+ * Purpose: passes item history data in cache to the callback function        *
+ *                                                                            *
+ * Parameters: item    - [IN] the item                                        *
+ *             seconds - [IN] the time period                                 *
+ *             ts      - [IN] the requested period end timestamp              *
+ *             func    - [IN] the callback function                           *
+ *             data    - [IN] the callback data                               *
+ *                                                                            *
+ * Return value: the number of values passed to the callback function         *
+ *                                                                            *
+ * Comments: This function walks the same values as                           *
+ *           vch_item_get_values_by_time(), but passes cache chunk slot       *
+ *           ranges to the callback instead of copying values to a vector.    *
  *                                                                            *
  ******************************************************************************/
-int	zbx_vc_init(char **error)
+static int	vch_item_foreach_by_time(const zbx_vc_item_t *item, int seconds, const zbx_timespec_t *ts,
+		zbx_vc_foreach_func_t func, void *data)
 {
-	zbx_uint64_t	size_reserved;
-	int		ret = FAIL;
+	int		index, first, now, values_num = 0;
+	zbx_timespec_t	start = {ts->sec - seconds, ts->ns};
+	zbx_vc_chunk_t	*chunk;
 
-	if (0 == CONFIG_VALUE_CACHE_SIZE)
-		return SUCCEED;
+	if (0 != item->active_range || ZBX_ITEM_STATUS_CACHED_ALL != item->status)
+	{
+		now = time(NULL);
+		/* add another second to include nanosecond shifts */
+		vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, seconds + now - ts->sec + 1, now);
+	}
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
+		return 0;
 
-	if (SUCCEED != (ret = zbx_rwlock_create(&vc_lock, ZBX_RWLOCK_VALUECACHE, error)))
-		goto out;
+	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
+	{
+		if (index >= chunk->first_value)
+		{
+			if (0 < zbx_timespec_compare(&chunk->slots[chunk->first_value].timestamp, &start))
+				first = chunk->first_value;
+			else
+				first = vch_chunk_find_first_value_after(chunk, index, &start);
 
-	size_reserved = zbx_mem_required_size(1, "value cache size", "ValueCacheSize");
+			if (first <= index)
+			{
+				func(chunk->slots, first, index, data);
+				values_num += index - first + 1;
+			}
+		}
 
-	if (SUCCEED != zbx_mem_create(&vc_mem, CONFIG_VALUE_CACHE_SIZE, "value cache size", "ValueCacheSize", 1, error))
-		goto out;
+		if (NULL == (chunk = chunk->prev))
+			break;
 
-	CONFIG_VALUE_CACHE_SIZE -= size_reserved;
+		index = chunk->last_value;
+	}
 
-	vc_cache = (zbx_vc_cache_t *)__vc_mem_malloc_func(vc_cache, sizeof(zbx_vc_cache_t));
+	return values_num;
+}
 
-	if (NULL == vc_cache)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: passes item history data in cache to the callback function        *
+ *                                                                            *
+ * Parameters: item    - [IN] the item                                        *
+ *             seconds - [IN] the time period                                 *
+ *             count   - [IN] the number of history values                    *
+ *             ts      - [IN] the target timestamp                            *
+ *             func    - [IN] the callback function                           *
+ *             data    - [IN] the callback data                               *
+ *                                                                            *
+ * Return value: the number of values passed to the callback function         *
+ *                                                                            *
+ * Comments: This function walks the same values as                           *
+ *           vch_item_get_values_by_time_and_count().                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_foreach_by_time_and_count(zbx_vc_item_t *item, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_foreach_func_t func, void *data)
+{
+	int		index, first, now, range_timestamp = 0, values_num = 0;
+	zbx_vc_chunk_t	*chunk;
+	zbx_timespec_t	start;
+
+	/* set start timestamp of the requested time period */
+	if (0 != seconds)
 	{
-		*error = zbx_strdup(*error, "cannot allocate value cache header");
-		goto out;
+		start.sec = ts->sec - seconds;
+		start.ns = ts->ns;
 	}
-	memset(vc_cache, 0, sizeof(zbx_vc_cache_t));
-
-	zbx_hashset_create_ext(&vc_cache->items, VC_ITEMS_INIT_SIZE,
-			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-			__vc_mem_malloc_func, __vc_mem_realloc_func, __vc_mem_free_func);
-
-	if (NULL == vc_cache->items.slots)
+	else
 	{
-		*error = zbx_strdup(*error, "cannot allocate value cache data storage");
-		goto out;
+		start.sec = 0;
+		start.ns = 0;
 	}
 
-	zbx_hashset_create_ext(&vc_cache->strpool, VC_STRPOOL_INIT_SIZE,
-			vc_strpool_hash_func, vc_strpool_compare_func, NULL,
-			__vc_mem_malloc_func, __vc_mem_realloc_func, __vc_mem_free_func);
+	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
+		goto out;
 
-	if (NULL == vc_cache->strpool.slots)
+	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
 	{
-		*error = zbx_strdup(*error, "cannot allocate string pool for value cache data storage");
-		goto out;
-	}
+		if (index >= chunk->first_value)
+		{
+			if (0 < zbx_timespec_compare(&chunk->slots[chunk->first_value].timestamp, &start))
+				first = chunk->first_value;
+			else
+				first = vch_chunk_find_first_value_after(chunk, index, &start);
 
-	/* the free space request should be 5% of cache size, but no more than 128KB */
-	vc_cache->min_free_request = (CONFIG_VALUE_CACHE_SIZE / 100) * 5;
-	if (vc_cache->min_free_request > 128 * ZBX_KIBIBYTE)
-		vc_cache->min_free_request = 128 * ZBX_KIBIBYTE;
+			if (first < index - (count - values_num) + 1)
+				first = index - (count - values_num) + 1;
 
-	zbx_vector_vc_itemupdate_create(&vc_itemupdates);
-	zbx_vector_vc_itemupdate_reserve(&vc_itemupdates, 256);
+			if (first <= index)
+			{
+				func(chunk->slots, first, index, data);
+				values_num += index - first + 1;
+				range_timestamp = chunk->slots[first].timestamp.sec - 1;
 
-	ret = SUCCEED;
+				if (values_num == count)
+					goto out;
+			}
+		}
+
+		if (NULL == (chunk = chunk->prev))
+			break;
+
+		index = chunk->last_value;
+	}
 out:
-	zbx_vc_disable();
+	if (count > values_num)
+	{
+		if (0 == seconds)
+			return values_num;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+		/* not enough data in the requested period, set the range equal to the period plus */
+		/* one second to include nanosecond shifts                                         */
+		range_timestamp = ts->sec - seconds;
+	}
 
-	return ret;
+	/* otherwise the range is set to the oldest value timestamp */
+	now = time(NULL);
+	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, now - range_timestamp, now);
+
+	return values_num;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: destroys value cache                                              *
+ * Purpose: passes item values for the specified range to the callback        *
+ *          function                                                          *
+ *                                                                            *
+ * Parameters: item       - [IN] the item                                     *
+ *             seconds    - [IN] the time period                              *
+ *             count      - [IN] the number of history values                 *
+ *             ts         - [IN] the target timestamp                         *
+ *             func       - [IN] the callback function                        *
+ *             data       - [IN] the callback data                            *
+ *             values_num - [OUT] the number of values passed to callback     *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was processed successfully  *
+ *                FAIL    - the item history data was not cached              *
+ *                                                                            *
+ * Comments: The value range is defined the same way as in                    *
+ *           vch_item_get_values().                                           *
  *                                                                            *
  ******************************************************************************/
-void	zbx_vc_destroy(void)
+static int	vch_item_foreach(zbx_vc_item_t *item, int seconds, int count, const zbx_timespec_t *ts,
+		zbx_vc_foreach_func_t func, void *data, int *values_num)
 {
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+	int	ret, records_read, range_start;
 
-	if (NULL != vc_cache)
+	if (0 == count)
 	{
-		zbx_vector_vc_itemupdate_destroy(&vc_itemupdates);
+		if (0 > (range_start = ts->sec - seconds))
+			range_start = 0;
 
-		zbx_hashset_destroy(&vc_cache->items);
-		zbx_hashset_destroy(&vc_cache->strpool);
+		if (FAIL == (ret = vch_item_cache_values_by_time(&item, range_start)))
+			return FAIL;
 
-		__vc_mem_free_func(vc_cache);
-		vc_cache = NULL;
+		records_read = ret;
+		*values_num = vch_item_foreach_by_time(item, seconds, ts, func, data);
+	}
+	else
+	{
+		range_start = (0 == seconds ? 0 : ts->sec - seconds);
 
-		zbx_mem_destroy(vc_mem);
-		vc_mem = NULL;
-		zbx_rwlock_destroy(&vc_lock);
+		if (FAIL == (ret = vch_item_cache_values_by_time_and_count(&item, range_start, count, ts)))
+			return FAIL;
+
+		records_read = ret;
+		*values_num = vch_item_foreach_by_time_and_count(item, seconds, count, ts, func, data);
 	}
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+	if (records_read > *values_num)
+		records_read = *values_num;
+
+	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_STATS, *values_num - records_read, records_read);
+
+	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: resets value cache                                                *
+ * Purpose: counts cached item values within the specified time interval      *
  *                                                                            *
- * Comments: All items and their historical data are removed,                 *
- *           cache working mode, statistics reset.                            *
+ * Parameters: item        - [IN] the item                                    *
+ *             range_start - [IN] the interval start time                     *
+ *             range_end   - [IN] the interval end time                       *
+ *                                                                            *
+ * Return value: the number of values in interval [range_start, range_end]    *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_count_values(const zbx_vc_item_t *item, int range_start, int range_end)
+{
+	const zbx_vc_chunk_t	*chunk;
+	int			i, values_num = 0;
+
+	for (chunk = item->head; NULL != chunk; chunk = chunk->prev)
+	{
+		for (i = chunk->last_value; i >= chunk->first_value; i--)
+		{
+			if (chunk->slots[i].timestamp.sec < range_start)
+				return values_num;
+
+			if (chunk->slots[i].timestamp.sec <= range_end)
+				values_num++;
+		}
+	}
+
+	return values_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if item loaded from value cache snapshot has all values    *
+ *          written to database since the snapshot was taken                  *
+ *                                                                            *
+ * Parameters: item - [IN/OUT] the item, updated after cache was relocked     *
+ *                                                                            *
+ * Return value:  SUCCEED - the item values are up to date                    *
+ *                FAIL    - the item was removed from cache or an error       *
+ *                          occurred                                          *
+ *                                                                            *
+ * Comments: Cached values cannot be newer than database, so the item is      *
+ *           stale if database has more values since the snapshot was taken.  *
+ *           This can happen if another HA node was active meanwhile.         *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_check_restored(zbx_vc_item_t **item)
+{
+	int		ret, now, restored_from, values_num;
+	zbx_uint64_t	itemid;
+	unsigned char	value_type;
+
+	itemid = (*item)->itemid;
+	value_type = (*item)->value_type;
+	restored_from = (*item)->restored_from;
+	now = (int)time(NULL);
+
+	UNLOCK_CACHE;
+
+	/* history backend excludes interval start point, while cached values are counted from it */
+	ret = zbx_history_count_values(itemid, value_type, restored_from - 1, now, &values_num);
+
+	WRLOCK_CACHE;
+
+	if (SUCCEED != ret)
+		return FAIL;
+
+	if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+		return FAIL;
+
+	if (restored_from != (*item)->restored_from)
+		return SUCCEED;
+
+	if (values_num != vch_item_count_values(*item, restored_from, now))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "discarding stale value cache snapshot data of item " ZBX_FS_UI64,
+				itemid);
+		vc_remove_item(*item);
+		*item = NULL;
+
+		return FAIL;
+	}
+
+	(*item)->restored_from = 0;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees resources allocated for item history data                   *
+ *                                                                            *
+ * Parameters: item    - [IN] the item                                        *
+ *                                                                            *
+ * Return value: the size of freed memory (bytes)                             *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vch_item_free_cache(zbx_vc_item_t *item)
+{
+	size_t	freed = 0;
+
+	zbx_vc_chunk_t	*chunk = item->tail;
+
+	while (NULL != chunk)
+	{
+		zbx_vc_chunk_t	*next = chunk->next;
+
+		freed += vch_item_free_chunk(item, chunk);
+		chunk = next;
+	}
+	item->values_total = 0;
+	item->head = NULL;
+	item->tail = NULL;
+
+	return freed;
+}
+
+/******************************************************************************************************************
+ *                                                                                                                *
+ * Public API                                                                                                     *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes value cache                                           *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_init(char **error)
+{
+	zbx_uint64_t	size_reserved;
+	int		ret = FAIL;
+
+	if (0 == CONFIG_VALUE_CACHE_SIZE)
+		return SUCCEED;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (SUCCEED != (ret = zbx_rwlock_create(&vc_lock, ZBX_RWLOCK_VALUECACHE, error)))
+		goto out;
+
+	size_reserved = zbx_mem_required_size(1, "value cache size", "ValueCacheSize");
+
+	if (SUCCEED != zbx_mem_create(&vc_mem, CONFIG_VALUE_CACHE_SIZE, "value cache size", "ValueCacheSize", 1, error))
+		goto out;
+
+	CONFIG_VALUE_CACHE_SIZE -= size_reserved;
+
+	vc_cache = (zbx_vc_cache_t *)__vc_mem_malloc_func(vc_cache, sizeof(zbx_vc_cache_t));
+
+	if (NULL == vc_cache)
+	{
+		*error = zbx_strdup(*error, "cannot allocate value cache header");
+		goto out;
+	}
+	memset(vc_cache, 0, sizeof(zbx_vc_cache_t));
+
+	zbx_hashset_create_ext(&vc_cache->items, VC_ITEMS_INIT_SIZE,
+			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
+			__vc_mem_malloc_func, __vc_mem_realloc_func, __vc_mem_free_func);
+
+	if (NULL == vc_cache->items.slots)
+	{
+		*error = zbx_strdup(*error, "cannot allocate value cache data storage");
+		goto out;
+	}
+
+	zbx_hashset_create_ext(&vc_cache->strpool, VC_STRPOOL_INIT_SIZE,
+			vc_strpool_hash_func, vc_strpool_compare_func, NULL,
+			__vc_mem_malloc_func, __vc_mem_realloc_func, __vc_mem_free_func);
+
+	if (NULL == vc_cache->strpool.slots)
+	{
+		*error = zbx_strdup(*error, "cannot allocate string pool for value cache data storage");
+		goto out;
+	}
+
+	/* the free space request should be 5% of cache size, but no more than 128KB */
+	vc_cache->min_free_request = (CONFIG_VALUE_CACHE_SIZE / 100) * 5;
+	if (vc_cache->min_free_request > 128 * ZBX_KIBIBYTE)
+		vc_cache->min_free_request = 128 * ZBX_KIBIBYTE;
+
+	zbx_vector_vc_itemupdate_create(&vc_itemupdates);
+	zbx_vector_vc_itemupdate_reserve(&vc_itemupdates, 256);
+
+	ret = SUCCEED;
+out:
+	zbx_vc_disable();
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: destroys value cache                                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_destroy(void)
+{
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (NULL != vc_cache)
+	{
+		zbx_vector_vc_itemupdate_destroy(&vc_itemupdates);
+
+		zbx_hashset_destroy(&vc_cache->items);
+		zbx_hashset_destroy(&vc_cache->strpool);
+
+		__vc_mem_free_func(vc_cache);
+		vc_cache = NULL;
+
+		zbx_mem_destroy(vc_mem);
+		vc_mem = NULL;
+		zbx_rwlock_destroy(&vc_lock);
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resets value cache                                                *
+ *                                                                            *
+ * Comments: All items and their historical data are removed,                 *
+ *           cache working mode, statistics reset.                            *
  *                                                                            *
  ******************************************************************************/
 void	zbx_vc_reset(void)
 {
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	if (NULL != vc_cache)
+	if (NULL != vc_cache)
+	{
+		zbx_vc_item_t		*item;
+		zbx_hashset_iter_t	iter;
+
+		WRLOCK_CACHE;
+
+		zbx_hashset_iter_reset(&vc_cache->items, &iter);
+		while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+		{
+			vch_item_free_cache(item);
+			zbx_hashset_iter_remove(&iter);
+		}
+
+		vc_cache->hits = 0;
+		vc_cache->misses = 0;
+		vc_cache->min_free_request = 0;
+		vc_cache->mode = ZBX_VC_MODE_NORMAL;
+		vc_cache->mode_time = 0;
+		vc_cache->last_warning_time = 0;
+
+		UNLOCK_CACHE;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes cached item value into value cache snapshot file           *
+ *                                                                            *
+ * Parameters: file       - [IN] the snapshot file                            *
+ *             value_type - [IN] the item value type                          *
+ *             record     - [IN] the value to write                           *
+ *                                                                            *
+ * Return value: SUCCEED - the value was written                              *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_snapshot_write_value(FILE *file, unsigned char value_type, const zbx_history_record_t *record)
+{
+	const zbx_log_value_t	*log;
+	int			log_fields[3];
+	unsigned char		has_source;
+
+	if (1 != fwrite(&record->timestamp, sizeof(record->timestamp), 1, file))
+		return FAIL;
+
+	switch (value_type)
+	{
+		case ITEM_VALUE_TYPE_FLOAT:
+			return 1 == fwrite(&record->value.dbl, sizeof(record->value.dbl), 1, file) ? SUCCEED : FAIL;
+		case ITEM_VALUE_TYPE_UINT64:
+			return 1 == fwrite(&record->value.ui64, sizeof(record->value.ui64), 1, file) ? SUCCEED : FAIL;
+		case ITEM_VALUE_TYPE_STR:
+		case ITEM_VALUE_TYPE_TEXT:
+			return 1 == fwrite(record->value.str, strlen(record->value.str) + 1, 1, file) ? SUCCEED : FAIL;
+		case ITEM_VALUE_TYPE_LOG:
+			log = record->value.log;
+			log_fields[0] = log->timestamp;
+			log_fields[1] = log->logeventid;
+			log_fields[2] = log->severity;
+			has_source = (NULL != log->source);
+
+			if (1 != fwrite(log_fields, sizeof(log_fields), 1, file) ||
+					1 != fwrite(&has_source, sizeof(has_source), 1, file))
+			{
+				return FAIL;
+			}
+
+			if (0 != has_source && 1 != fwrite(log->source, strlen(log->source) + 1, 1, file))
+				return FAIL;
+
+			return 1 == fwrite(log->value, strlen(log->value) + 1, 1, file) ? SUCCEED : FAIL;
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes cached item into value cache snapshot file                 *
+ *                                                                            *
+ * Parameters: file - [IN] the snapshot file                                  *
+ *             item - [IN] the item to write                                  *
+ *                                                                            *
+ * Return value: SUCCEED - the item was written                               *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_snapshot_write_item(FILE *file, const zbx_vc_item_t *item)
+{
+	zbx_vc_snapshot_item_t	snapshot_item;
+	const zbx_vc_chunk_t	*chunk;
+	int			i;
+
+	memset(&snapshot_item, 0, sizeof(snapshot_item));
+	snapshot_item.itemid = item->itemid;
+	snapshot_item.value_type = item->value_type;
+	snapshot_item.status = item->status;
+	snapshot_item.range_sync_hour = item->range_sync_hour;
+	snapshot_item.last_accessed = item->last_accessed;
+	snapshot_item.active_range = item->active_range;
+	snapshot_item.daily_range = item->daily_range;
+	snapshot_item.db_cached_from = item->db_cached_from;
+
+	for (chunk = item->tail; NULL != chunk; chunk = chunk->next)
+		snapshot_item.values_num += chunk->last_value - chunk->first_value + 1;
+
+	if (1 != fwrite(&snapshot_item, sizeof(snapshot_item), 1, file))
+		return FAIL;
+
+	for (chunk = item->tail; NULL != chunk; chunk = chunk->next)
+	{
+		for (i = chunk->first_value; i <= chunk->last_value; i++)
+		{
+			if (SUCCEED != vc_snapshot_write_value(file, item->value_type, &chunk->slots[i]))
+				return FAIL;
+		}
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: saves value cache contents into snapshot file                     *
+ *                                                                            *
+ * Comments: This function must be called on server shutdown after history    *
+ *           cache has been flushed, so the snapshot has all item values      *
+ *           written to database. Items loaded from the previous snapshot and *
+ *           not checked against database since are not saved.                *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_save_snapshot(void)
+{
+	zbx_vc_snapshot_header_t	header;
+	zbx_vc_item_t			*item;
+	zbx_hashset_iter_t		iter;
+	char				*tmp_path;
+	FILE				*file;
+	int				items_num = 0, ret, fd;
+
+	if (NULL == vc_cache || NULL == CONFIG_VALUE_CACHE_SNAPSHOT_FILE)
+		return;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	tmp_path = zbx_dsprintf(NULL, "%s.tmp", CONFIG_VALUE_CACHE_SNAPSHOT_FILE);
+
+	/* cached values can be sensitive, the snapshot must be readable only by server */
+	if (0 != unlink(tmp_path) && ENOENT != errno)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot remove value cache snapshot file \"%s\": %s", tmp_path,
+				zbx_strerror(errno));
+		goto out;
+	}
+
+	if (-1 == (fd = open(tmp_path, O_WRONLY | O_CREAT | O_EXCL, 0600)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot create value cache snapshot file \"%s\": %s", tmp_path,
+				zbx_strerror(errno));
+		goto out;
+	}
+
+	if (NULL == (file = fdopen(fd, "w")))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot open value cache snapshot file \"%s\": %s", tmp_path,
+				zbx_strerror(errno));
+		close(fd);
+		unlink(tmp_path);
+		goto out;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, ZBX_VC_SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = ZBX_VC_SNAPSHOT_VERSION;
+	header.clock = (int)time(NULL);
+
+	ret = (1 == fwrite(&header, sizeof(header), 1, file) ? SUCCEED : FAIL);
+
+	RDLOCK_CACHE;
+
+	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+	while (SUCCEED == ret && NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (0 != item->restored_from)
+			continue;
+
+		if (SUCCEED == (ret = vc_snapshot_write_item(file, item)))
+			items_num++;
+	}
+
+	UNLOCK_CACHE;
+
+	if (0 != fclose(file) || SUCCEED != ret)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot write value cache snapshot file \"%s\": %s", tmp_path,
+				zbx_strerror(errno));
+		ret = FAIL;
+	}
+
+	if (SUCCEED == ret && 0 != rename(tmp_path, CONFIG_VALUE_CACHE_SNAPSHOT_FILE))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot rename value cache snapshot file \"%s\": %s", tmp_path,
+				zbx_strerror(errno));
+		ret = FAIL;
+	}
+
+	if (SUCCEED != ret)
+		unlink(tmp_path);
+	else
+		zabbix_log(LOG_LEVEL_INFORMATION, "saved %d items to value cache snapshot", items_num);
+out:
+	zbx_free(tmp_path);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads value cache snapshot file                                   *
+ *                                                                            *
+ * Parameters: data      - [OUT] the file contents                            *
+ *             data_size - [OUT] the file size                                *
+ *             error     - [OUT] the error message                            *
+ *                                                                            *
+ * Return value: SUCCEED - the file was read                                  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_snapshot_read_file(char **data, size_t *data_size, char **error)
+{
+	int		fd, ret = FAIL;
+	zbx_stat_t	st;
+	size_t		offset = 0;
+	ssize_t		n;
+
+	if (-1 == (fd = open(CONFIG_VALUE_CACHE_SNAPSHOT_FILE, O_RDONLY)))
+	{
+		*error = zbx_dsprintf(NULL, "cannot open file: %s", zbx_strerror(errno));
+		return FAIL;
+	}
+
+	if (0 != zbx_fstat(fd, &st))
+	{
+		*error = zbx_dsprintf(NULL, "cannot obtain file information: %s", zbx_strerror(errno));
+		goto out;
+	}
+
+	if (st.st_uid != geteuid() || 0 != (st.st_mode & (S_IRWXG | S_IRWXO)))
+	{
+		*error = zbx_strdup(NULL, "file must be owned by the server user and not accessible by others");
+		goto out;
+	}
+
+	*data_size = (size_t)st.st_size;
+	*data = (char *)zbx_malloc(NULL, *data_size + 1);
+
+	while (offset < *data_size && 0 < (n = read(fd, *data + offset, *data_size - offset)))
+		offset += (size_t)n;
+
+	if (offset != *data_size)
+	{
+		*error = zbx_dsprintf(NULL, "cannot read file: %s", zbx_strerror(errno));
+		zbx_free(*data);
+		goto out;
+	}
+
+	ret = SUCCEED;
+out:
+	close(fd);
+
+	return ret;
+}
+
+static int	vc_snapshot_read(void *dst, size_t size, const char *data, size_t data_size, size_t *data_pos)
+{
+	if (data_size - *data_pos < size)
+		return FAIL;
+
+	memcpy(dst, data + *data_pos, size);
+	*data_pos += size;
+
+	return SUCCEED;
+}
+
+static int	vc_snapshot_read_str(char **str, const char *data, size_t data_size, size_t *data_pos)
+{
+	const char	*end;
+
+	if (NULL == (end = (const char *)memchr(data + *data_pos, '\0', data_size - *data_pos)))
+		return FAIL;
+
+	*str = (char *)data + *data_pos;
+	*data_pos = (size_t)(end - data) + 1;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads item with its values from value cache snapshot data         *
+ *                                                                            *
+ * Parameters: data          - [IN] the snapshot data                         *
+ *             data_size     - [IN] the snapshot data size                    *
+ *             data_pos      - [IN/OUT] the item position in snapshot data    *
+ *             snapshot_item - [OUT] the item                                 *
+ *             records       - [OUT] the item values, strings are pointing to *
+ *                                   the snapshot data                        *
+ *             logs          - [IN/OUT] the log value buffer                  *
+ *             logs_alloc    - [IN/OUT] the log value buffer size             *
+ *                                                                            *
+ * Return value: SUCCEED - the item was read                                  *
+ *               FAIL    - the snapshot data is invalid                       *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_snapshot_read_item(const char *data, size_t data_size, size_t *data_pos,
+		zbx_vc_snapshot_item_t *snapshot_item, zbx_vector_history_record_t *records, zbx_log_value_t **logs,
+		int *logs_alloc)
+{
+	zbx_history_record_t	record;
+	zbx_log_value_t		*log;
+	int			i, log_fields[3];
+	unsigned char		has_source;
+
+	records->values_num = 0;
+
+	if (SUCCEED != vc_snapshot_read(snapshot_item, sizeof(*snapshot_item), data, data_size, data_pos))
+		return FAIL;
+
+	if (ITEM_VALUE_TYPE_MAX <= snapshot_item->value_type || 0 > snapshot_item->values_num ||
+			(size_t)snapshot_item->values_num > (data_size - *data_pos) / sizeof(zbx_timespec_t))
+	{
+		return FAIL;
+	}
+
+	zbx_vector_history_record_reserve(records, (size_t)snapshot_item->values_num);
+
+	if (ITEM_VALUE_TYPE_LOG == snapshot_item->value_type && snapshot_item->values_num > *logs_alloc)
+	{
+		*logs_alloc = snapshot_item->values_num;
+		*logs = (zbx_log_value_t *)zbx_realloc(*logs, (size_t)*logs_alloc * sizeof(zbx_log_value_t));
+	}
+
+	for (i = 0; i < snapshot_item->values_num; i++)
+	{
+		if (SUCCEED != vc_snapshot_read(&record.timestamp, sizeof(record.timestamp), data, data_size,
+				data_pos))
+		{
+			return FAIL;
+		}
+
+		switch (snapshot_item->value_type)
+		{
+			case ITEM_VALUE_TYPE_FLOAT:
+				if (SUCCEED != vc_snapshot_read(&record.value.dbl, sizeof(record.value.dbl), data,
+						data_size, data_pos))
+				{
+					return FAIL;
+				}
+				break;
+			case ITEM_VALUE_TYPE_UINT64:
+				if (SUCCEED != vc_snapshot_read(&record.value.ui64, sizeof(record.value.ui64), data,
+						data_size, data_pos))
+				{
+					return FAIL;
+				}
+				break;
+			case ITEM_VALUE_TYPE_STR:
+			case ITEM_VALUE_TYPE_TEXT:
+				if (SUCCEED != vc_snapshot_read_str(&record.value.str, data, data_size, data_pos))
+					return FAIL;
+				break;
+			case ITEM_VALUE_TYPE_LOG:
+				log = &(*logs)[i];
+
+				if (SUCCEED != vc_snapshot_read(log_fields, sizeof(log_fields), data, data_size,
+						data_pos) ||
+						SUCCEED != vc_snapshot_read(&has_source, sizeof(has_source), data,
+						data_size, data_pos))
+				{
+					return FAIL;
+				}
+
+				log->timestamp = log_fields[0];
+				log->logeventid = log_fields[1];
+				log->severity = log_fields[2];
+				log->source = NULL;
+
+				if (0 != has_source && SUCCEED != vc_snapshot_read_str(&log->source, data, data_size,
+						data_pos))
+				{
+					return FAIL;
+				}
+
+				if (SUCCEED != vc_snapshot_read_str(&log->value, data, data_size, data_pos))
+					return FAIL;
+
+				record.value.log = log;
+				break;
+		}
+
+		zbx_vector_history_record_append_ptr(records, &record);
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: loads value cache contents from snapshot file                     *
+ *                                                                            *
+ * Comments: This function must be called after value cache initialization    *
+ *           before starting history syncers. The snapshot file is removed    *
+ *           after loading, so it cannot be loaded again after server crash.  *
+ *           Loaded items are checked against database when accessed first    *
+ *           time, see vch_item_check_restored().                             *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_load_snapshot(void)
+{
+	char				*data = NULL, *error = NULL;
+	size_t				data_size, data_pos;
+	int				now, expire_timestamp, items_num = 0, logs_alloc = 0;
+	zbx_vc_snapshot_header_t	header;
+	zbx_vc_snapshot_item_t		snapshot_item;
+	zbx_vector_history_record_t	records;
+	zbx_log_value_t			*logs = NULL;
+	zbx_vc_item_t			*item;
+
+	if (NULL == vc_cache || NULL == CONFIG_VALUE_CACHE_SNAPSHOT_FILE)
+		return;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	zbx_vector_history_record_create(&records);
+
+	now = (int)time(NULL);
+	expire_timestamp = now - ZBX_VC_ITEM_EXPIRE_PERIOD;
+
+	if (SUCCEED != vc_snapshot_read_file(&data, &data_size, &error))
+		goto out;
+
+	if (0 != unlink(CONFIG_VALUE_CACHE_SNAPSHOT_FILE))
 	{
-		zbx_vc_item_t		*item;
-		zbx_hashset_iter_t	iter;
+		error = zbx_dsprintf(NULL, "cannot remove file: %s", zbx_strerror(errno));
+		goto out;
+	}
 
-		WRLOCK_CACHE;
+	if (sizeof(header) > data_size)
+	{
+		error = zbx_strdup(NULL, "invalid file size");
+		goto out;
+	}
 
-		zbx_hashset_iter_reset(&vc_cache->items, &iter);
-		while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+	memcpy(&header, data, sizeof(header));
+	data_pos = sizeof(header);
+
+	if (0 != memcmp(header.magic, ZBX_VC_SNAPSHOT_MAGIC, sizeof(header.magic)) ||
+			ZBX_VC_SNAPSHOT_VERSION != header.version)
+	{
+		error = zbx_strdup(NULL, "incompatible snapshot format");
+		goto out;
+	}
+
+	/* items not accessed during the last day would be removed from cache anyway */
+	if (header.clock > now || header.clock <= expire_timestamp)
+	{
+		error = zbx_strdup(NULL, "snapshot is outdated");
+		goto out;
+	}
+
+	WRLOCK_CACHE;
+
+	while (data_pos < data_size && ZBX_VC_MODE_NORMAL == vc_cache->mode)
+	{
+		zbx_vc_item_t	new_item;
+
+		if (SUCCEED != vc_snapshot_read_item(data, data_size, &data_pos, &snapshot_item, &records, &logs,
+				&logs_alloc))
 		{
-			vch_item_free_cache(item);
-			zbx_hashset_iter_remove(&iter);
+			error = zbx_strdup(NULL, "invalid file format");
+			break;
 		}
 
-		vc_cache->hits = 0;
-		vc_cache->misses = 0;
-		vc_cache->min_free_request = 0;
-		vc_cache->mode = ZBX_VC_MODE_NORMAL;
-		vc_cache->mode_time = 0;
-		vc_cache->last_warning_time = 0;
+		if (snapshot_item.last_accessed <= expire_timestamp ||
+				NULL != zbx_hashset_search(&vc_cache->items, &snapshot_item.itemid))
+		{
+			continue;
+		}
 
-		UNLOCK_CACHE;
+		memset(&new_item, 0, sizeof(new_item));
+		new_item.itemid = snapshot_item.itemid;
+		new_item.value_type = snapshot_item.value_type;
+		new_item.status = snapshot_item.status;
+		new_item.range_sync_hour = snapshot_item.range_sync_hour;
+		new_item.last_accessed = snapshot_item.last_accessed;
+		new_item.active_range = snapshot_item.active_range;
+		new_item.daily_range = snapshot_item.daily_range;
+		new_item.db_cached_from = snapshot_item.db_cached_from;
+		new_item.restored_from = header.clock;
+
+		if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item,
+				sizeof(new_item))))
+		{
+			break;
+		}
+
+		if (0 != records.values_num &&
+				SUCCEED != vch_item_add_values_at_tail(item, records.values, records.values_num))
+		{
+			vc_remove_item(item);
+			break;
+		}
+
+		items_num++;
+	}
+
+	UNLOCK_CACHE;
+
+	/* keep the items loaded before the invalid data, they are checked before use anyway */
+	if (NULL == error)
+	{
+		zabbix_log(LOG_LEVEL_INFORMATION, "loaded %d items from value cache snapshot taken %d seconds ago",
+				items_num, now - header.clock);
+	}
+out:
+	if (NULL != error)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot load value cache snapshot \"%s\": %s",
+				CONFIG_VALUE_CACHE_SNAPSHOT_FILE, error);
 	}
 
+	/* the record values point to snapshot data, they must not be freed */
+	zbx_vector_history_record_destroy(&records);
+	zbx_free(logs);
+	zbx_free(error);
+	zbx_free(data);
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
@@ -2582,6 +3576,8 @@ int	zbx_vc_get_values(zbx_uint64_t itemid, int value_type, zbx_vector_history_re
 	}
 	else if (item->value_type != value_type)
 		goto out;
+	else if (0 != item->restored_from && SUCCEED != vch_item_check_restored(&item))
+		goto out;
 
 	ret = vch_item_get_values(item, values, seconds, count, ts);
 out:
@@ -2648,6 +3644,165 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: passes item values for the specified range to the callback        *
+ *          function without copying them out of cache                        *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             seconds    - [IN] the time period                              *
+ *             count      - [IN] the number of history values                 *
+ *             ts         - [IN] the period end timestamp                     *
+ *             func       - [IN] the callback function                        *
+ *             data       - [IN] the callback data                            *
+ *             values_num - [OUT] the number of values passed to callback     *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was processed successfully  *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ * Comments: The value range is defined the same way as in                    *
+ *           zbx_vc_get_values().                                             *
+ *                                                                            *
+ *           The callback is called with ranges of values in ascending order  *
+ *           and must process each range from the last (newest) to the first  *
+ *           value to get values in the zbx_vc_get_values() order. Ranges are *
+ *           passed from the newest to the oldest one.                        *
+ *                                                                            *
+ *           Cached values are passed directly from cache memory while cache  *
+ *           is locked, so the callback must not call value cache functions   *
+ *           or keep references to the values. If the range cannot be cached, *
+ *           the values are read from database and passed from local memory.  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_foreach_value(zbx_uint64_t itemid, int value_type, int seconds, int count, const zbx_timespec_t *ts,
+		zbx_vc_foreach_func_t func, void *data, int *values_num)
+{
+	zbx_vc_item_t			*item, new_item;
+	zbx_vector_history_record_t	values;
+	zbx_history_record_t		record;
+	int				ret = FAIL, cache_used = 1, i;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d count:%d period:%d end_timestamp"
+			" '%s'", __func__, itemid, value_type, count, seconds, zbx_timespec_str(ts));
+
+	*values_num = 0;
+
+	RDLOCK_CACHE;
+
+	if (ZBX_VC_DISABLED == vc_state)
+		goto out;
+
+	if (ZBX_VC_MODE_LOWMEM == vc_cache->mode)
+		vc_warn_low_memory();
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	{
+		if (ZBX_VC_MODE_NORMAL != vc_cache->mode)
+			goto out;
+
+		memset(&new_item, 0, sizeof(new_item));
+		new_item.itemid = itemid;
+		new_item.value_type = value_type;
+		item = &new_item;
+	}
+	else if (item->value_type != value_type)
+		goto out;
+	else if (0 != item->restored_from && SUCCEED != vch_item_check_restored(&item))
+		goto out;
+
+	ret = vch_item_foreach(item, seconds, count, ts, func, data, values_num);
+out:
+	if (FAIL == ret)
+	{
+		cache_used = 0;
+
+		UNLOCK_CACHE;
+
+		zbx_history_record_vector_create(&values);
+
+		if (SUCCEED == (ret = vc_db_get_values(itemid, value_type, &values, seconds, count, ts)) &&
+				0 != (*values_num = values.values_num))
+		{
+			/* values are returned in descending order, reverse them to match cache chunks */
+			for (i = 0; i < values.values_num / 2; i++)
+			{
+				record = values.values[i];
+				values.values[i] = values.values[values.values_num - i - 1];
+				values.values[values.values_num - i - 1] = record;
+			}
+
+			func(values.values, 0, values.values_num - 1, data);
+		}
+
+		zbx_history_record_vector_destroy(&values, value_type);
+
+		WRLOCK_CACHE;
+
+		if (ZBX_VC_DISABLED != vc_state)
+			vc_remove_item_by_id(itemid);
+
+		if (SUCCEED == ret)
+			vc_update_statistics(NULL, 0, *values_num, time(NULL));
+	}
+
+	UNLOCK_CACHE;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s count:%d cached:%d",
+			__func__, zbx_result_string(ret), *values_num, cache_used);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates aggregate of item values for the specified range       *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             func       - [IN] the aggregate function, see                  *
+ *                               ZBX_VC_AGGREGATE_* defines                   *
+ *             seconds    - [IN] the time period                              *
+ *             count      - [IN] the number of history values                 *
+ *             ts         - [IN] the period end timestamp                     *
+ *             value      - [OUT] the aggregated value - sum, minimum or      *
+ *                                maximum of item value type, average as      *
+ *                                double, not set for count                   *
+ *             values_num - [OUT] the number of values in range               *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was aggregated successfully *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ * Comments: The value range is defined the same way as in                    *
+ *           zbx_vc_get_values(). Sum, average, minimum and maximum are       *
+ *           supported only for numeric items. The aggregated value is        *
+ *           undefined if there are no values in range, except for sum which  *
+ *           is zero.                                                         *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_aggregate(zbx_uint64_t itemid, int value_type, int func, int seconds, int count,
+		const zbx_timespec_t *ts, history_value_t *value, int *values_num)
+{
+	zbx_vc_aggregate_t	agg;
+
+	memset(&agg, 0, sizeof(agg));
+	agg.func = func;
+	agg.value_type = value_type;
+
+	if (SUCCEED != zbx_vc_foreach_value(itemid, value_type, seconds, count, ts, vc_aggregate_records, &agg,
+			values_num))
+	{
+		return FAIL;
+	}
+
+	vc_aggregate_finish(&agg);
+
+	if (ZBX_VC_AGGREGATE_COUNT != func)
+		*value = agg.value;
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: retrieves usage cache statistics                                  *
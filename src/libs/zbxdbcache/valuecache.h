@@ -64,6 +64,13 @@
 /* indicates that all values from database are cached */
 #define ZBX_ITEM_STATUS_CACHED_ALL	1
 
+/* aggregate functions calculated by zbx_vc_get_aggregate() */
+#define ZBX_VC_AGGREGATE_COUNT	0
+#define ZBX_VC_AGGREGATE_SUM	1
+#define ZBX_VC_AGGREGATE_AVG	2
+#define ZBX_VC_AGGREGATE_MIN	3
+#define ZBX_VC_AGGREGATE_MAX	4
+
 /* the cache statistics */
 typedef struct
 {
@@ -98,6 +105,10 @@ void	zbx_vc_destroy(void);
 
 void	zbx_vc_reset(void);
 
+void	zbx_vc_save_snapshot(void);
+
+void	zbx_vc_load_snapshot(void);
+
 void	zbx_vc_enable(void);
 
 void	zbx_vc_disable(void);
@@ -107,6 +118,15 @@ int	zbx_vc_get_values(zbx_uint64_t itemid, int value_type, zbx_vector_history_re
 
 int	zbx_vc_get_value(zbx_uint64_t itemid, int value_type, const zbx_timespec_t *ts, zbx_history_record_t *value);
 
+/* zbx_vc_foreach_value() callback, processes values from records[first] to records[last] */
+typedef void	(*zbx_vc_foreach_func_t)(const zbx_history_record_t *records, int first, int last, void *data);
+
+int	zbx_vc_foreach_value(zbx_uint64_t itemid, int value_type, int seconds, int count, const zbx_timespec_t *ts,
+		zbx_vc_foreach_func_t func, void *data, int *values_num);
+
+int	zbx_vc_get_aggregate(zbx_uint64_t itemid, int value_type, int func, int seconds, int count,
+		const zbx_timespec_t *ts, history_value_t *value, int *values_num);
+
 int	zbx_vc_add_values(zbx_vector_ptr_t *history, int *ret_flush);
 
 int	zbx_vc_get_statistics(zbx_vc_stats_t *stats);
@@ -3267,6 +3267,713 @@ void	zbx_db_insert_autoincrement(zbx_db_insert_t *self, const char *field_name)
 	exit(EXIT_FAILURE);
 }
 
+#define ZBX_DB_COLINSERT_ROWS_MIN	16
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reallocates column value array                                    *
+ *                                                                            *
+ * Parameters: column     - [IN/OUT] the column                               *
+ *             rows_alloc - [IN] the number of values to allocate             *
+ *                                                                            *
+ ******************************************************************************/
+static void	db_column_values_realloc(zbx_db_column_t *column, int rows_alloc)
+{
+	switch (column->field->type)
+	{
+		case ZBX_TYPE_ID:
+		case ZBX_TYPE_UINT:
+			column->values.ui64 = (zbx_uint64_t *)zbx_realloc(column->values.ui64,
+					sizeof(zbx_uint64_t) * (size_t)rows_alloc);
+			break;
+		case ZBX_TYPE_INT:
+			column->values.i32 = (int *)zbx_realloc(column->values.i32, sizeof(int) * (size_t)rows_alloc);
+			break;
+		case ZBX_TYPE_FLOAT:
+			column->values.dbl = (double *)zbx_realloc(column->values.dbl,
+					sizeof(double) * (size_t)rows_alloc);
+			break;
+		case ZBX_TYPE_CHAR:
+		case ZBX_TYPE_TEXT:
+		case ZBX_TYPE_SHORTTEXT:
+		case ZBX_TYPE_LONGTEXT:
+		case ZBX_TYPE_CUID:
+			column->values.str = (zbx_db_strref_t *)zbx_realloc(column->values.str,
+					sizeof(zbx_db_strref_t) * (size_t)rows_alloc);
+			break;
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+			exit(EXIT_FAILURE);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees column value array                                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	db_column_values_free(zbx_db_column_t *column)
+{
+	switch (column->field->type)
+	{
+		case ZBX_TYPE_ID:
+		case ZBX_TYPE_UINT:
+			zbx_free(column->values.ui64);
+			break;
+		case ZBX_TYPE_INT:
+			zbx_free(column->values.i32);
+			break;
+		case ZBX_TYPE_FLOAT:
+			zbx_free(column->values.dbl);
+			break;
+		default:
+			zbx_free(column->values.str);
+			break;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets length of string value truncated to the field size limits    *
+ *                                                                            *
+ * Parameters: field - [IN] the target field                                  *
+ *             str   - [IN] the string value                                  *
+ *                                                                            *
+ * Return value: the string length in bytes                                   *
+ *                                                                            *
+ * Comments: The string is truncated in the same way as DBdyn_escape_field()  *
+ *           does, without escaping.                                          *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	db_column_strlen(const ZBX_FIELD *field, const char *str)
+{
+	const char	*ptr;
+	size_t		max_chars, max_bytes, csize;
+
+	if (ZBX_TYPE_LONGTEXT == field->type && 0 == field->length)
+		max_chars = ZBX_SIZE_T_MAX;
+	else if (ZBX_TYPE_CUID == field->type)
+		max_chars = CUID_LEN;
+	else
+		max_chars = field->length;
+
+#if defined(HAVE_MYSQL) || defined(HAVE_ORACLE)
+	max_bytes = get_string_field_size(field->type);
+#else
+	max_bytes = ZBX_SIZE_T_MAX;
+#endif
+	for (ptr = str; '\0' != *ptr && 0 < max_chars; max_chars--)
+	{
+		/* process non-UTF-8 characters as single byte characters */
+		if (0 == (csize = zbx_utf8_char_len(ptr)))
+			csize = 1;
+
+		if (max_bytes < csize)
+			break;
+
+		ptr += csize;
+		max_bytes -= csize;
+	}
+
+	return (size_t)(ptr - str);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepare for columnar database bulk insert operation               *
+ *                                                                            *
+ * Parameters: self  - [IN] the bulk insert data                              *
+ *             table - [IN] the target table name                             *
+ *             ...   - [IN] names of the fields to insert                     *
+ *             NULL  - [IN] terminating NULL pointer                          *
+ *                                                                            *
+ * Comments: Columnar bulk insert keeps the values in typed arrays per column *
+ *           and the string values in a single buffer, so adding rows does    *
+ *           not allocate memory once the arrays are large enough.            *
+ *                                                                            *
+ *           Usage example:                                                   *
+ *             zbx_db_colinsert_t ins;                                        *
+ *                                                                            *
+ *             zbx_db_colinsert_prepare(&ins, "history", "itemid", "value",   *
+ *                     NULL);                                                 *
+ *             zbx_db_colinsert_reserve(&ins, 2);                             *
+ *             zbx_db_colinsert_add_values(&ins, (zbx_uint64_t)1, 1.0);       *
+ *             zbx_db_colinsert_add_values(&ins, (zbx_uint64_t)2, 2.0);       *
+ *             zbx_db_colinsert_execute(&ins);                                *
+ *             zbx_db_colinsert_clean(&ins);                                  *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_colinsert_prepare(zbx_db_colinsert_t *self, const char *table, ...)
+{
+	va_list		args;
+	const char	*name;
+	int		i;
+
+	if (NULL == (self->table = DBget_table(table)))
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		exit(EXIT_FAILURE);
+	}
+
+	va_start(args, table);
+
+	for (self->columns_num = 0; NULL != va_arg(args, const char *); self->columns_num++)
+		;
+
+	va_end(args);
+
+	if (0 == self->columns_num)
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		exit(EXIT_FAILURE);
+	}
+
+	self->columns = (zbx_db_column_t *)zbx_malloc(NULL, sizeof(zbx_db_column_t) * (size_t)self->columns_num);
+
+	va_start(args, table);
+
+	for (i = 0; i < self->columns_num; i++)
+	{
+		name = va_arg(args, const char *);
+
+		if (NULL == (self->columns[i].field = DBget_field(self->table, name)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "Cannot locate table \"%s\" field \"%s\" in database schema",
+					table, name);
+			THIS_SHOULD_NEVER_HAPPEN;
+			exit(EXIT_FAILURE);
+		}
+
+		self->columns[i].values.ui64 = NULL;
+	}
+
+	va_end(args);
+
+	self->rows_num = 0;
+	self->rows_alloc = 0;
+	self->strings = NULL;
+	self->strings_alloc = 0;
+	self->strings_offset = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reserves space in column value arrays                             *
+ *                                                                            *
+ * Parameters: self     - [IN] the bulk insert data                           *
+ *             rows_num - [IN] the number of rows to reserve                  *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_colinsert_reserve(zbx_db_colinsert_t *self, int rows_num)
+{
+	int	i;
+
+	if (rows_num <= self->rows_alloc)
+		return;
+
+	for (i = 0; i < self->columns_num; i++)
+		db_column_values_realloc(&self->columns[i], rows_num);
+
+	self->rows_alloc = rows_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds row values for columnar database bulk insert operation       *
+ *                                                                            *
+ * Parameters: self - [IN] the bulk insert data                               *
+ *             ...  - [IN] the values to insert                               *
+ *                                                                            *
+ * Comments: The values must be listed in the same order as the field names   *
+ *           for insert preparation function and their types must conform to  *
+ *           the corresponding field types.                                   *
+ *           String values are truncated to the field size and copied into    *
+ *           the string buffer without escaping.                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_colinsert_add_values(zbx_db_colinsert_t *self, ...)
+{
+	va_list		args;
+	int		i, row;
+	const char	*str;
+	zbx_db_strref_t	*ref;
+
+	if (self->rows_num == self->rows_alloc)
+		zbx_db_colinsert_reserve(self, MAX(ZBX_DB_COLINSERT_ROWS_MIN, self->rows_alloc * 2));
+
+	row = self->rows_num++;
+
+	va_start(args, self);
+
+	for (i = 0; i < self->columns_num; i++)
+	{
+		zbx_db_column_t	*column = &self->columns[i];
+
+		switch (column->field->type)
+		{
+			case ZBX_TYPE_ID:
+			case ZBX_TYPE_UINT:
+				column->values.ui64[row] = va_arg(args, zbx_uint64_t);
+				break;
+			case ZBX_TYPE_INT:
+				column->values.i32[row] = va_arg(args, int);
+				break;
+			case ZBX_TYPE_FLOAT:
+				column->values.dbl[row] = va_arg(args, double);
+				break;
+			default:
+				if (NULL == (str = va_arg(args, const char *)))
+					str = "";
+
+				ref = &column->values.str[row];
+				ref->offset = self->strings_offset;
+				ref->len = db_column_strlen(column->field, str);
+
+				zbx_strncpy_alloc(&self->strings, &self->strings_alloc, &self->strings_offset, str,
+						ref->len);
+
+				/* keep the terminating zero written by zbx_strncpy_alloc() in the buffer */
+				self->strings_offset++;
+				break;
+		}
+	}
+
+	va_end(args);
+}
+
+#if defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends data to COPY binary format buffer                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	db_copy_append(char **buf, size_t *buf_alloc, size_t *buf_offset, const void *data, size_t size)
+{
+	if (*buf_offset + size > *buf_alloc)
+	{
+		while (*buf_offset + size > *buf_alloc)
+			*buf_alloc *= 2;
+
+		*buf = (char *)zbx_realloc(*buf, *buf_alloc);
+	}
+
+	memcpy(*buf + *buf_offset, data, size);
+	*buf_offset += size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends integer in network byte order to COPY binary format       *
+ *          buffer                                                            *
+ *                                                                            *
+ * Parameters: buf        - [IN/OUT] the buffer                               *
+ *             buf_alloc  - [IN/OUT] the buffer size                          *
+ *             buf_offset - [IN/OUT] the buffer offset                        *
+ *             value      - [IN] the value to append                          *
+ *             size       - [IN] the integer size in bytes (2, 4 or 8)        *
+ *                                                                            *
+ ******************************************************************************/
+static void	db_copy_append_int(char **buf, size_t *buf_alloc, size_t *buf_offset, zbx_uint64_t value,
+		size_t size)
+{
+	unsigned char	data[8];
+	size_t		i;
+
+	for (i = size; 0 < i; i--)
+	{
+		data[i - 1] = (unsigned char)(value & 0xff);
+		value >>= 8;
+	}
+
+	db_copy_append(buf, buf_alloc, buf_offset, data, size);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends unsigned integer as numeric field to COPY binary format   *
+ *          buffer                                                            *
+ *                                                                            *
+ * Comments: Numeric binary format is a header of 16-bit digit count, weight, *
+ *           sign and display scale followed by base 10000 digits starting    *
+ *           with the most significant one. Trailing zero digits are omitted. *
+ *                                                                            *
+ ******************************************************************************/
+static void	db_copy_append_numeric(char **buf, size_t *buf_alloc, size_t *buf_offset, zbx_uint64_t value)
+{
+	unsigned short	digits[5];
+	int		i, digits_num = 0, zeros_num = 0, weight;
+
+	for (; 0 != value; value /= 10000)
+		digits[digits_num++] = (unsigned short)(value % 10000);
+
+	weight = (0 == digits_num ? 0 : digits_num - 1);
+
+	while (zeros_num < digits_num && 0 == digits[zeros_num])
+		zeros_num++;
+
+	db_copy_append_int(buf, buf_alloc, buf_offset, 8 + 2 * (digits_num - zeros_num), 4);
+	db_copy_append_int(buf, buf_alloc, buf_offset, digits_num - zeros_num, 2);
+	db_copy_append_int(buf, buf_alloc, buf_offset, weight, 2);
+	db_copy_append_int(buf, buf_alloc, buf_offset, 0, 2);	/* positive sign */
+	db_copy_append_int(buf, buf_alloc, buf_offset, 0, 2);	/* display scale */
+
+	for (i = digits_num - 1; i >= zeros_num; i--)
+		db_copy_append_int(buf, buf_alloc, buf_offset, digits[i], 2);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes columnar bulk insert with COPY ... FROM STDIN in binary  *
+ *          format                                                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	db_colinsert_execute_copy(zbx_db_colinsert_t *self)
+{
+	static const char	signature[] = "PGCOPY\n\377\r\n";
+	char			*sql = NULL, *buf;
+	size_t			sql_alloc = 0, sql_offset = 0, buf_alloc, buf_offset = 0;
+	int			i, j, rc;
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "copy %s (", self->table->table);
+
+	for (j = 0; j < self->columns_num; j++)
+	{
+		if (0 != j)
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, self->columns[j].field->name);
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ") from stdin (format binary)");
+
+	/* each field is prefixed with 4 byte length and fixed size values take up to 8 bytes */
+	buf_alloc = 32 + (size_t)self->rows_num * (2 + (size_t)self->columns_num * 12) + self->strings_offset;
+	buf = (char *)zbx_malloc(NULL, buf_alloc);
+
+	/* signature (including its terminating zero), flags and header extension length */
+	db_copy_append(&buf, &buf_alloc, &buf_offset, signature, sizeof(signature));
+	db_copy_append_int(&buf, &buf_alloc, &buf_offset, 0, 4);
+	db_copy_append_int(&buf, &buf_alloc, &buf_offset, 0, 4);
+
+	for (i = 0; i < self->rows_num; i++)
+	{
+		db_copy_append_int(&buf, &buf_alloc, &buf_offset, (zbx_uint64_t)self->columns_num, 2);
+
+		for (j = 0; j < self->columns_num; j++)
+		{
+			const zbx_db_column_t	*column = &self->columns[j];
+			zbx_uint64_t		value;
+
+			switch (column->field->type)
+			{
+				case ZBX_TYPE_ID:
+					db_copy_append_int(&buf, &buf_alloc, &buf_offset, 8, 4);
+					db_copy_append_int(&buf, &buf_alloc, &buf_offset, column->values.ui64[i], 8);
+					break;
+				case ZBX_TYPE_UINT:
+					db_copy_append_numeric(&buf, &buf_alloc, &buf_offset, column->values.ui64[i]);
+					break;
+				case ZBX_TYPE_INT:
+					db_copy_append_int(&buf, &buf_alloc, &buf_offset, 4, 4);
+					db_copy_append_int(&buf, &buf_alloc, &buf_offset,
+							(zbx_uint32_t)column->values.i32[i], 4);
+					break;
+				case ZBX_TYPE_FLOAT:
+					memcpy(&value, &column->values.dbl[i], sizeof(value));
+					db_copy_append_int(&buf, &buf_alloc, &buf_offset, 8, 4);
+					db_copy_append_int(&buf, &buf_alloc, &buf_offset, value, 8);
+					break;
+				default:
+					db_copy_append_int(&buf, &buf_alloc, &buf_offset, column->values.str[i].len, 4);
+					db_copy_append(&buf, &buf_alloc, &buf_offset,
+							self->strings + column->values.str[i].offset,
+							column->values.str[i].len);
+					break;
+			}
+		}
+	}
+
+	/* file trailer - 16-bit -1 field count */
+	db_copy_append_int(&buf, &buf_alloc, &buf_offset, 0xffff, 2);
+
+	if (ZBX_DB_DOWN == (rc = zbx_db_copy(sql, buf, buf_offset)))
+	{
+		do
+		{
+			DBclose();
+			DBconnect(ZBX_DB_CONNECT_NORMAL);
+
+			if (ZBX_DB_DOWN == (rc = zbx_db_copy(sql, buf, buf_offset)))
+			{
+				zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+				connection_failure = 1;
+				sleep(ZBX_DB_WAIT_DOWN);
+			}
+		}
+		while (ZBX_DB_DOWN == rc);
+	}
+
+	zbx_free(buf);
+	zbx_free(sql);
+
+	return ZBX_DB_OK <= rc ? SUCCEED : FAIL;
+}
+#elif defined(HAVE_MYSQL)
+
+#define ZBX_DB_COLINSERT_BATCH_ROWS	1000
+#define ZBX_DB_MYSQL_PARAMS_MAX		65535
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes columnar bulk insert with prepared multi-row insert      *
+ *          statements                                                        *
+ *                                                                            *
+ * Comments: The rows are split into batches limited by the number of rows,   *
+ *           statement parameters and the size of string values. The bound    *
+ *           parameters point directly to the column values.                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	db_colinsert_execute_prepared(zbx_db_colinsert_t *self)
+{
+	char		*sql = NULL, *sql_row = NULL;
+	size_t		sql_alloc = 0, sql_offset = 0, sql_row_alloc = 0, sql_row_offset = 0, prefix_offset,
+			batch_size;
+	int		i, j, rows_max, params_num, rc = ZBX_DB_OK;
+	const ZBX_FIELD	*field;
+	zbx_db_param_t	*params;
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "insert into %s (", self->table->table);
+	zbx_chrcpy_alloc(&sql_row, &sql_row_alloc, &sql_row_offset, '(');
+
+	for (j = 0; j < self->columns_num; j++)
+	{
+		if (0 != j)
+		{
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+			zbx_chrcpy_alloc(&sql_row, &sql_row_alloc, &sql_row_offset, ',');
+		}
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, self->columns[j].field->name);
+		zbx_chrcpy_alloc(&sql_row, &sql_row_alloc, &sql_row_offset, '?');
+	}
+
+	/* MySQL workaround - explicitly add missing text fields with '' default value */
+	for (field = (const ZBX_FIELD *)self->table->fields; NULL != field->name; field++)
+	{
+		switch (field->type)
+		{
+			case ZBX_TYPE_BLOB:
+			case ZBX_TYPE_TEXT:
+			case ZBX_TYPE_SHORTTEXT:
+			case ZBX_TYPE_LONGTEXT:
+			case ZBX_TYPE_CUID:
+				for (j = 0; j < self->columns_num; j++)
+				{
+					if (self->columns[j].field == field)
+						break;
+				}
+
+				if (j != self->columns_num)
+					continue;
+
+				zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+				zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, field->name);
+				zbx_strcpy_alloc(&sql_row, &sql_row_alloc, &sql_row_offset, ",''");
+				break;
+		}
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ") values ");
+	zbx_chrcpy_alloc(&sql_row, &sql_row_alloc, &sql_row_offset, ')');
+	prefix_offset = sql_offset;
+
+	rows_max = MIN(ZBX_DB_COLINSERT_BATCH_ROWS, ZBX_DB_MYSQL_PARAMS_MAX / self->columns_num);
+	params = (zbx_db_param_t *)zbx_malloc(NULL, sizeof(zbx_db_param_t) * (size_t)(rows_max * self->columns_num));
+
+	for (i = 0; i < self->rows_num && ZBX_DB_OK <= rc;)
+	{
+		sql_offset = prefix_offset;
+		params_num = 0;
+		batch_size = 0;
+
+		for (; i < self->rows_num && params_num < rows_max * self->columns_num; i++)
+		{
+			if (0 != params_num && ZBX_MAX_SQL_SIZE < batch_size)
+				break;
+
+			if (0 != params_num)
+				zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, sql_row);
+
+			for (j = 0; j < self->columns_num; j++)
+			{
+				const zbx_db_column_t	*column = &self->columns[j];
+				zbx_db_param_t		*param = &params[params_num++];
+
+				param->type = column->field->type;
+
+				switch (column->field->type)
+				{
+					case ZBX_TYPE_ID:
+					case ZBX_TYPE_UINT:
+						param->value = &column->values.ui64[i];
+						break;
+					case ZBX_TYPE_INT:
+						param->value = &column->values.i32[i];
+						break;
+					case ZBX_TYPE_FLOAT:
+						param->value = &column->values.dbl[i];
+						break;
+					default:
+						param->value = self->strings + column->values.str[i].offset;
+						param->len = column->values.str[i].len;
+						batch_size += param->len;
+						break;
+				}
+
+				batch_size += sizeof(zbx_uint64_t);
+			}
+		}
+
+		if (ZBX_DB_DOWN == (rc = zbx_db_execute_params(sql, params, params_num)))
+		{
+			do
+			{
+				DBclose();
+				DBconnect(ZBX_DB_CONNECT_NORMAL);
+
+				if (ZBX_DB_DOWN == (rc = zbx_db_execute_params(sql, params, params_num)))
+				{
+					zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds",
+							ZBX_DB_WAIT_DOWN);
+					connection_failure = 1;
+					sleep(ZBX_DB_WAIT_DOWN);
+				}
+			}
+			while (ZBX_DB_DOWN == rc);
+		}
+	}
+
+	zbx_free(params);
+	zbx_free(sql_row);
+	zbx_free(sql);
+
+	return ZBX_DB_OK <= rc ? SUCCEED : FAIL;
+}
+
+#undef ZBX_DB_COLINSERT_BATCH_ROWS
+#undef ZBX_DB_MYSQL_PARAMS_MAX
+#else
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes columnar bulk insert with generic bulk insert            *
+ *                                                                            *
+ ******************************************************************************/
+static int	db_colinsert_execute_insert(zbx_db_colinsert_t *self)
+{
+	zbx_db_insert_t		db_insert;
+	const ZBX_FIELD		**fields;
+	zbx_db_value_t		*values;
+	const zbx_db_value_t	**pvalues;
+	int			i, j, ret;
+
+	fields = (const ZBX_FIELD **)zbx_malloc(NULL, sizeof(ZBX_FIELD *) * (size_t)self->columns_num);
+	values = (zbx_db_value_t *)zbx_malloc(NULL, sizeof(zbx_db_value_t) * (size_t)self->columns_num);
+	pvalues = (const zbx_db_value_t **)zbx_malloc(NULL, sizeof(zbx_db_value_t *) * (size_t)self->columns_num);
+
+	for (j = 0; j < self->columns_num; j++)
+	{
+		fields[j] = self->columns[j].field;
+		pvalues[j] = &values[j];
+	}
+
+	zbx_db_insert_prepare_dyn(&db_insert, self->table, fields, self->columns_num);
+
+	for (i = 0; i < self->rows_num; i++)
+	{
+		for (j = 0; j < self->columns_num; j++)
+		{
+			const zbx_db_column_t	*column = &self->columns[j];
+
+			switch (column->field->type)
+			{
+				case ZBX_TYPE_ID:
+				case ZBX_TYPE_UINT:
+					values[j].ui64 = column->values.ui64[i];
+					break;
+				case ZBX_TYPE_INT:
+					values[j].i32 = column->values.i32[i];
+					break;
+				case ZBX_TYPE_FLOAT:
+					values[j].dbl = column->values.dbl[i];
+					break;
+				default:
+					values[j].str = self->strings + column->values.str[i].offset;
+					break;
+			}
+		}
+
+		zbx_db_insert_add_values_dyn(&db_insert, pvalues, self->columns_num);
+	}
+
+	ret = zbx_db_insert_execute(&db_insert);
+	zbx_db_insert_clean(&db_insert);
+
+	zbx_free(pvalues);
+	zbx_free(values);
+	zbx_free(fields);
+
+	return ret;
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes the prepared columnar database bulk insert operation     *
+ *                                                                            *
+ * Parameters: self - [IN] the bulk insert data                               *
+ *                                                                            *
+ * Return value: Returns SUCCEED if the operation completed successfully or   *
+ *               FAIL otherwise.                                              *
+ *                                                                            *
+ * Comments: PostgreSQL rows are loaded with binary COPY and MySQL rows with  *
+ *           prepared multi-row insert statements. Other databases use        *
+ *           generic bulk insert.                                             *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_colinsert_execute(zbx_db_colinsert_t *self)
+{
+	if (0 == self->rows_num)
+		return SUCCEED;
+
+#if defined(HAVE_POSTGRESQL)
+	return db_colinsert_execute_copy(self);
+#elif defined(HAVE_MYSQL)
+	return db_colinsert_execute_prepared(self);
+#else
+	return db_colinsert_execute_insert(self);
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: releases resources allocated by columnar bulk insert operations   *
+ *                                                                            *
+ * Parameters: self - [IN] the bulk insert data                               *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_colinsert_clean(zbx_db_colinsert_t *self)
+{
+	int	i;
+
+	for (i = 0; i < self->columns_num; i++)
+		db_column_values_free(&self->columns[i]);
+
+	zbx_free(self->columns);
+	zbx_free(self->strings);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: determine is it a server or a proxy database                      *
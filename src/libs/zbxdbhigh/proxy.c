@@ -33,6 +33,8 @@
 #include "events.h"
 #include "zbxvault.h"
 #include "zbxavailability.h"
+#include "zbxcompress.h"
+#include "base64.h"
 
 extern char	*CONFIG_SERVER;
 extern char	*CONFIG_VAULTDBPATH;
@@ -46,6 +48,9 @@ extern char	*CONFIG_VAULTDBPATH;
 /* the maximum number of values processed in one batch */
 #define ZBX_HISTORY_VALUES_MAX		256
 
+/* RSM specifics: SLV scripts push values of SLV items by item identifier */
+#define ZBX_RSM_SLV_KEY_PREFIX		"rsm.slv."
+
 typedef struct
 {
 	zbx_uint64_t		druleid;
@@ -86,6 +91,23 @@ typedef struct
 }
 zbx_id_offset_t;
 
+/* pointers to history data row field values */
+typedef struct
+{
+	const char	*clock;
+	const char	*ns;
+	const char	*state;
+	const char	*lastlogsize;
+	const char	*mtime;
+	const char	*value;
+	const char	*timestamp;
+	const char	*source;
+	const char	*severity;
+	const char	*logeventid;
+	const char	*id;
+}
+zbx_history_row_fields_t;
+
 typedef int	(*zbx_client_item_validator_t)(DC_ITEM *item, zbx_socket_t *sock, void *args, char **error);
 
 typedef struct
@@ -2389,6 +2411,53 @@ typedef struct
 }
 zbx_history_data_t;
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: uncompresses text value stored in proxy history                   *
+ *                                                                            *
+ * Parameters: value - [IN] the base64 encoded original value size and        *
+ *                          compressed data                                   *
+ *                                                                            *
+ * Return value: The uncompressed value.                                      *
+ *                                                                            *
+ * Comments: See dc_proxy_history_compress() for encoding.                    *
+ *                                                                            *
+ ******************************************************************************/
+static char	*proxy_history_uncompress(const char *value)
+{
+	char		*data, *out;
+	int		data_size;
+	size_t		out_size = 0;
+	zbx_uint32_t	size;
+
+	data = (char *)zbx_malloc(NULL, strlen(value) + 1);
+	str_base64_decode(value, data, (int)strlen(value) + 1, &data_size);
+
+	if ((int)sizeof(size) > data_size)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot uncompress proxy history value: invalid data");
+		out = zbx_strdup(NULL, "");
+		goto out;
+	}
+
+	memcpy(&size, data, sizeof(size));
+
+	out_size = size;
+	out = (char *)zbx_malloc(NULL, out_size + 1);
+
+	if (SUCCEED != zbx_uncompress(data + sizeof(size), (size_t)data_size - sizeof(size), out, &out_size))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot uncompress proxy history value: %s", zbx_compress_strerror());
+		out_size = 0;
+	}
+
+	out[out_size] = '\0';
+out:
+	zbx_free(data);
+
+	return out;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: read proxy history data from the database                         *
@@ -2486,14 +2555,19 @@ try_again:
 
 			if (0 == (hd->flags & PROXY_HISTORY_FLAG_NOVALUE))
 			{
-				size_t	len1, len2;
+				size_t		len1, len2;
+				const char	*pvalue = row[7];
+				char		*value = NULL;
 
 				hd->timestamp = atoi(row[4]);
 				hd->severity = atoi(row[6]);
 				hd->logeventid = atoi(row[8]);
 
+				if (0 != (hd->flags & PROXY_HISTORY_FLAG_COMPRESSED))
+					pvalue = value = proxy_history_uncompress(row[7]);
+
 				len1 = strlen(row[5]) + 1;
-				len2 = strlen(row[7]) + 1;
+				len2 = strlen(pvalue) + 1;
 
 				if (*string_buffer_alloc < string_buffer_offset + len1 + len2)
 				{
@@ -2508,8 +2582,10 @@ try_again:
 				string_buffer_offset += len1;
 
 				hd->value_offset = string_buffer_offset;
-				memcpy(*string_buffer + hd->value_offset, row[7], len2);
+				memcpy(*string_buffer + hd->value_offset, pvalue, len2);
 				string_buffer_offset += len2;
+
+				zbx_free(value);
 			}
 
 			if (0 != (hd->flags & PROXY_HISTORY_FLAG_META))
@@ -2531,6 +2607,31 @@ try_again:
 	return data_num;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if history value is a JSON object that can be embedded into *
+ *          history data without string encoding                              *
+ *                                                                            *
+ * Parameters: value - [IN] the history value                                 *
+ *                                                                            *
+ * Return value: SUCCEED - the value is a JSON object without leading or      *
+ *                         trailing whitespace                                *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	is_json_object_value(const char *value)
+{
+	struct zbx_json_parse	jp;
+
+	if ('{' != *value)
+		return FAIL;
+
+	if (SUCCEED != zbx_json_open(value, &jp) || '\0' != jp.end[1])
+		return FAIL;
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: add history records to output json                                *
@@ -2541,13 +2642,16 @@ try_again:
  *             errcodes      - [IN] the item configuration status codes       *
  *             records       - [IN] the records to add                        *
  *             string_buffer - [IN] the string buffer holding string values   *
+ *             json_values   - [IN] 1 - JSON object values can be embedded    *
+ *                                      into history data as is               *
+ *                                  0 - all values must be sent as strings    *
  *             lastid        - [OUT] the id of last added record              *
  *                                                                            *
  * Return value: The total number of records added.                           *
  *                                                                            *
  ******************************************************************************/
 static int	proxy_add_hist_data(struct zbx_json *j, int records_num, const DC_ITEM *dc_items, const int *errcodes,
-		const zbx_vector_ptr_t *records, const char *string_buffer, zbx_uint64_t *lastid)
+		const zbx_vector_ptr_t *records, const char *string_buffer, int json_values, zbx_uint64_t *lastid)
 {
 	int				i;
 	const zbx_history_data_t	*hd;
@@ -2603,8 +2707,17 @@ static int	proxy_add_hist_data(struct zbx_json *j, int records_num, const DC_ITE
 				if (0 != hd->logeventid)
 					zbx_json_adduint64(j, ZBX_PROTO_TAG_LOGEVENTID, hd->logeventid);
 
-				zbx_json_addstring(j, ZBX_PROTO_TAG_VALUE, string_buffer + hd->value_offset,
-						ZBX_JSON_TYPE_STRING);
+				/* RSM specifics: test results are JSON objects, embedding them as is */
+				/* avoids escaping on proxy and unescaping on server                 */
+				if (0 != json_values && SUCCEED == is_json_object_value(string_buffer + hd->value_offset))
+				{
+					zbx_json_addraw(j, ZBX_PROTO_TAG_VALUE, string_buffer + hd->value_offset);
+				}
+				else
+				{
+					zbx_json_addstring(j, ZBX_PROTO_TAG_VALUE, string_buffer + hd->value_offset,
+							ZBX_JSON_TYPE_STRING);
+				}
 			}
 
 			if (0 != (hd->flags & PROXY_HISTORY_FLAG_META))
@@ -2625,7 +2738,24 @@ static int	proxy_add_hist_data(struct zbx_json *j, int records_num, const DC_ITE
 	return records_num;
 }
 
-int	proxy_get_hist_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add proxy history data to output json                             *
+ *                                                                            *
+ * Parameters: j           - [IN/OUT] the json output buffer                  *
+ *             lastid      - [OUT] the id of last added record                *
+ *             more        - [OUT] set to ZBX_PROXY_DATA_MORE if there might  *
+ *                                 be more data to send                       *
+ *             json_values - [IN] 1 - the receiving server accepts JSON       *
+ *                                    object values embedded as is, such      *
+ *                                    data is marked with the                 *
+ *                                    ZBX_PROTO_TAG_JSON_VALUES tag           *
+ *                                0 - otherwise                               *
+ *                                                                            *
+ * Return value: The number of records added.                                 *
+ *                                                                            *
+ ******************************************************************************/
+int	proxy_get_hist_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more, int json_values)
 {
 	int			records_num = 0, data_num, i, *errcodes = NULL, items_alloc = 0;
 	zbx_uint64_t		id;
@@ -2686,7 +2816,8 @@ int	proxy_get_hist_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more)
 
 		DCconfig_get_items_by_itemids(dc_items, itemids.values, errcodes, itemids.values_num);
 
-		records_num = proxy_add_hist_data(j, records_num, dc_items, errcodes, &records, string_buffer, lastid);
+		records_num = proxy_add_hist_data(j, records_num, dc_items, errcodes, &records, string_buffer,
+				json_values, lastid);
 		DCconfig_clean_items(dc_items, errcodes, itemids.values_num);
 
 		/* got less data than requested - either no more data to read or the history is full of */
@@ -2701,8 +2832,14 @@ int	proxy_get_hist_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more)
 	}
 
 	if (0 != records_num)
+	{
 		zbx_json_close(j);
 
+		/* let the server know that JSON object values must not be decoded */
+		if (0 != json_values)
+			zbx_json_adduint64(j, ZBX_PROTO_TAG_JSON_VALUES, 1);
+	}
+
 	zbx_hashset_destroy(&itemids_added);
 
 	zbx_free(dc_items);
@@ -3117,6 +3254,127 @@ static void	log_client_timediff(int level, struct zbx_json_parse *jp, const zbx_
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: locates the known history data fields in json row                 *
+ *                                                                            *
+ * Parameters: jp_row - [IN] JSON with history data row                       *
+ *             fields - [OUT] pointers to the field values, NULL if the field *
+ *                            is not present                                  *
+ *                                                                            *
+ * Comments: The row is scanned only once instead of looking up each field    *
+ *           by name, which would rescan the (possibly large) value field     *
+ *           for every lookup.                                                *
+ *           Only the first occurrence of a field is used.                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	parse_history_data_row_fields(const struct zbx_json_parse *jp_row,
+		zbx_history_row_fields_t *fields)
+{
+	const char	*p = NULL, *pvalue, **pfield;
+	char		name[MAX_STRING_LEN];
+
+	memset(fields, 0, sizeof(zbx_history_row_fields_t));
+
+	while (NULL != (pvalue = zbx_json_pair_next(jp_row, p, name, sizeof(name))))
+	{
+		p = pvalue;
+
+		if (0 == strcmp(name, ZBX_PROTO_TAG_CLOCK))
+			pfield = &fields->clock;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_NS))
+			pfield = &fields->ns;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_STATE))
+			pfield = &fields->state;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_LASTLOGSIZE))
+			pfield = &fields->lastlogsize;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_MTIME))
+			pfield = &fields->mtime;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_VALUE))
+			pfield = &fields->value;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_LOGTIMESTAMP))
+			pfield = &fields->timestamp;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_LOGSOURCE))
+			pfield = &fields->source;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_LOGSEVERITY))
+			pfield = &fields->severity;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_LOGEVENTID))
+			pfield = &fields->logeventid;
+		else if (0 == strcmp(name, ZBX_PROTO_TAG_ID))
+			pfield = &fields->id;
+		else
+			continue;
+
+		if (NULL == *pfield)
+			*pfield = pvalue;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: decodes history data field value located by                      *
+ *          parse_history_data_row_fields()                                   *
+ *                                                                            *
+ * Parameters: pfield       - [IN] pointer to the field value, can be NULL    *
+ *             string       - [IN/OUT] the output buffer                      *
+ *             string_alloc - [IN/OUT] the output buffer size                 *
+ *                                                                            *
+ * Return value:  SUCCEED - the field value was decoded successfully          *
+ *                FAIL    - the field is missing or has non primitive value   *
+ *                                                                            *
+ ******************************************************************************/
+static int	parse_history_data_row_field(const char *pfield, char **string, size_t *string_alloc)
+{
+	if (NULL == pfield || NULL == zbx_json_decodevalue_dyn(pfield, string, string_alloc, NULL))
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: decodes history data value field                                  *
+ *                                                                            *
+ * Parameters: pfield       - [IN] pointer to the field value, can be NULL    *
+ *             json_values  - [IN] 1 - the sender embeds JSON object values   *
+ *                                     as is (see ZBX_PROTO_TAG_JSON_VALUES)  *
+ *                                 0 - all values are sent as strings         *
+ *             string       - [IN/OUT] the output buffer                      *
+ *             string_alloc - [IN/OUT] the output buffer size                 *
+ *                                                                            *
+ * Return value:  SUCCEED - the field value was decoded successfully          *
+ *                FAIL    - the field is missing or invalid                   *
+ *                                                                            *
+ * Comments: JSON object values embedded by proxies are copied without        *
+ *           decoding.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	parse_history_data_row_value_field(const char *pfield, int json_values, char **string,
+		size_t *string_alloc)
+{
+	struct zbx_json_parse	jp;
+	size_t			len;
+
+	if (0 == json_values || NULL == pfield || '{' != *pfield)
+		return parse_history_data_row_field(pfield, string, string_alloc);
+
+	if (SUCCEED != zbx_json_brackets_open(pfield, &jp))
+		return FAIL;
+
+	len = (size_t)(jp.end - jp.start + 1);
+
+	if (*string_alloc <= len)
+	{
+		*string_alloc = len + 1;
+		*string = (char *)zbx_realloc(*string, *string_alloc);
+	}
+
+	memcpy(*string, jp.start, len);
+	(*string)[len] = '\0';
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: parses agent value from history data json row                     *
@@ -3124,6 +3382,8 @@ static void	log_client_timediff(int level, struct zbx_json_parse *jp, const zbx_
  * Parameters: jp_row       - [IN] JSON with history data row                 *
  *             unique_shift - [IN/OUT] auto increment nanoseconds to ensure   *
  *                                     unique value of timestamps             *
+ *             json_values  - [IN] 1 - JSON object values are embedded as is  *
+ *                                 0 - all values are sent as strings         *
  *             av           - [OUT] the agent value                           *
  *                                                                            *
  * Return value:  SUCCEED - the value was parsed successfully                 *
@@ -3131,20 +3391,23 @@ static void	log_client_timediff(int level, struct zbx_json_parse *jp, const zbx_
  *                                                                            *
  ******************************************************************************/
 static int	parse_history_data_row_value(const struct zbx_json_parse *jp_row, zbx_timespec_t *unique_shift,
-		zbx_agent_value_t *av)
+		int json_values, zbx_agent_value_t *av)
 {
-	char	*tmp = NULL;
-	size_t	tmp_alloc = 0;
-	int	ret = FAIL;
+	char				*tmp = NULL;
+	size_t				tmp_alloc = 0, value_alloc = 0;
+	int				ret = FAIL;
+	zbx_history_row_fields_t	fields;
 
 	memset(av, 0, sizeof(zbx_agent_value_t));
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_CLOCK, &tmp, &tmp_alloc, NULL))
+	parse_history_data_row_fields(jp_row, &fields);
+
+	if (SUCCEED == parse_history_data_row_field(fields.clock, &tmp, &tmp_alloc))
 	{
 		if (FAIL == is_uint31(tmp, &av->ts.sec))
 			goto out;
 
-		if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_NS, &tmp, &tmp_alloc, NULL))
+		if (SUCCEED == parse_history_data_row_field(fields.ns, &tmp, &tmp_alloc))
 		{
 			if (FAIL == is_uint_n_range(tmp, tmp_alloc, &av->ts.ns, sizeof(av->ts.ns),
 				0LL, 999999999LL))
@@ -3169,49 +3432,47 @@ static int	parse_history_data_row_value(const struct zbx_json_parse *jp_row, zbx
 	else
 		zbx_timespec(&av->ts);
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_STATE, &tmp, &tmp_alloc, NULL))
+	if (SUCCEED == parse_history_data_row_field(fields.state, &tmp, &tmp_alloc))
 		av->state = (unsigned char)atoi(tmp);
 
 	/* Unsupported item meta information must be ignored for backwards compatibility. */
 	/* New agents will not send meta information for items in unsupported state.      */
 	if (ITEM_STATE_NOTSUPPORTED != av->state)
 	{
-		if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LASTLOGSIZE, &tmp, &tmp_alloc, NULL))
+		if (SUCCEED == parse_history_data_row_field(fields.lastlogsize, &tmp, &tmp_alloc))
 		{
 			av->meta = 1;	/* contains meta information */
 
 			is_uint64(tmp, &av->lastlogsize);
 
-			if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_MTIME, &tmp, &tmp_alloc, NULL))
+			if (SUCCEED == parse_history_data_row_field(fields.mtime, &tmp, &tmp_alloc))
 				av->mtime = atoi(tmp);
 		}
 	}
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_VALUE, &tmp, &tmp_alloc, NULL))
-		av->value = zbx_strdup(av->value, tmp);
+	/* decode value directly into the agent value to avoid copying large values */
+	if (SUCCEED != parse_history_data_row_value_field(fields.value, json_values, &av->value, &value_alloc))
+		zbx_free(av->value);
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LOGTIMESTAMP, &tmp, &tmp_alloc, NULL))
+	if (SUCCEED == parse_history_data_row_field(fields.timestamp, &tmp, &tmp_alloc))
 		av->timestamp = atoi(tmp);
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LOGSOURCE, &tmp, &tmp_alloc, NULL))
+	if (SUCCEED == parse_history_data_row_field(fields.source, &tmp, &tmp_alloc))
 		av->source = zbx_strdup(av->source, tmp);
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LOGSEVERITY, &tmp, &tmp_alloc, NULL))
+	if (SUCCEED == parse_history_data_row_field(fields.severity, &tmp, &tmp_alloc))
 		av->severity = atoi(tmp);
 
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LOGEVENTID, &tmp, &tmp_alloc, NULL))
+	if (SUCCEED == parse_history_data_row_field(fields.logeventid, &tmp, &tmp_alloc))
 		av->logeventid = atoi(tmp);
 
-	if (SUCCEED != zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_ID, &tmp, &tmp_alloc, NULL) ||
-			SUCCEED != is_uint64(tmp, &av->id))
-	{
+	if (SUCCEED != parse_history_data_row_field(fields.id, &tmp, &tmp_alloc) || SUCCEED != is_uint64(tmp, &av->id))
 		av->id = 0;
-	}
-
-	zbx_free(tmp);
 
 	ret = SUCCEED;
 out:
+	zbx_free(tmp);
+
 	return ret;
 }
 
@@ -3325,7 +3586,7 @@ static int	parse_history_data(struct zbx_json_parse *jp_data, const char **pnext
 		if (SUCCEED != parse_history_data_row_hostkey(&jp_row, &hostkeys[*values_num]))
 			continue;
 
-		if (SUCCEED != parse_history_data_row_value(&jp_row, unique_shift, &values[*values_num]))
+		if (SUCCEED != parse_history_data_row_value(&jp_row, unique_shift, 0, &values[*values_num]))
 			continue;
 
 		(*values_num)++;
@@ -3355,6 +3616,8 @@ out:
  *             parsed_num   - [OUT] the number of values parsed               *
  *             unique_shift - [IN/OUT] auto increment nanoseconds to ensure   *
  *                                     unique value of timestamps             *
+ *             json_values  - [IN] 1 - JSON object values are embedded as is  *
+ *                                 0 - all values are sent as strings         *
  *             info         - [OUT] address of a pointer to the info string   *
  *                                  (should be freed by the caller)           *
  *                                                                            *
@@ -3367,7 +3630,7 @@ out:
  ******************************************************************************/
 static int	parse_history_data_by_itemids(struct zbx_json_parse *jp_data, const char **pnext,
 		zbx_agent_value_t *values, zbx_uint64_t *itemids, int *values_num, int *parsed_num,
-		zbx_timespec_t *unique_shift, char **error)
+		zbx_timespec_t *unique_shift, int json_values, char **error)
 {
 	struct zbx_json_parse	jp_row;
 	int			ret = FAIL;
@@ -3400,7 +3663,7 @@ static int	parse_history_data_by_itemids(struct zbx_json_parse *jp_data, const c
 		if (SUCCEED != parse_history_data_row_itemid(&jp_row, &itemids[*values_num]))
 			continue;
 
-		if (SUCCEED != parse_history_data_row_value(&jp_row, unique_shift, &values[*values_num]))
+		if (SUCCEED != parse_history_data_row_value(&jp_row, unique_shift, json_values, &values[*values_num]))
 			continue;
 
 		(*values_num)++;
@@ -3454,6 +3717,8 @@ static int	proxy_item_validator(DC_ITEM *item, zbx_socket_t *sock, void *args, c
  *             jp_data    - [IN] JSON with history data array                 *
  *             session    - [IN] the data session                             *
  *             nodata_win - [OUT] counter of delayed values                   *
+ *             json_values - [IN] 1 - JSON object values are embedded as is   *
+ *                                0 - all values are sent as strings          *
  *             info       - [OUT] address of a pointer to the info            *
  *                                     string (should be freed by the caller) *
  *             mode       - [IN]  item retrieve mode is used to retrieve only *
@@ -3469,7 +3734,7 @@ static int	proxy_item_validator(DC_ITEM *item, zbx_socket_t *sock, void *args, c
  ******************************************************************************/
 static int	process_history_data_by_itemids(zbx_socket_t *sock, zbx_client_item_validator_t validator_func,
 		void *validator_args, struct zbx_json_parse *jp_data, zbx_data_session_t *session,
-		zbx_proxy_suppress_t *nodata_win, char **info, unsigned int mode)
+		zbx_proxy_suppress_t *nodata_win, int json_values, char **info, unsigned int mode)
 {
 	const char		*pnext = NULL;
 	int			ret = SUCCEED, processed_num = 0, total_num = 0, values_num, read_num, i, *errcodes;
@@ -3489,7 +3754,7 @@ static int	process_history_data_by_itemids(zbx_socket_t *sock, zbx_client_item_v
 	sec = zbx_time();
 
 	while (SUCCEED == parse_history_data_by_itemids(jp_data, &pnext, values, itemids, &values_num, &read_num,
-			&unique_shift, &error) && 0 != values_num)
+			&unique_shift, json_values, &error) && 0 != values_num)
 	{
 		DCconfig_get_items_by_itemids_partial(items, itemids, errcodes, (size_t)values_num, mode);
 
@@ -3518,6 +3783,7 @@ static int	process_history_data_by_itemids(zbx_socket_t *sock, zbx_client_item_v
 
 				DCconfig_clean_items(&items[i], &errcodes[i], 1);
 				errcodes[i] = FAIL;
+				continue;
 			}
 
 			/* RSM specifics: ignore history data from proxy if it's older than 90 seconds */
@@ -3531,6 +3797,7 @@ static int	process_history_data_by_itemids(zbx_socket_t *sock, zbx_client_item_v
 						items[i].itemid, items[i].host.host, items[i].key_orig,
 						values[i].value, now - values[i].ts.sec);
 
+				DCconfig_clean_items(&items[i], &errcodes[i], 1);
 				errcodes[i] = FAIL;
 				continue;
 			}
@@ -3854,7 +4121,7 @@ static int	process_client_history_data(zbx_socket_t *sock, struct zbx_json_parse
 			session = zbx_dc_get_or_create_data_session(hostid, token);
 
 		if (SUCCEED != (ret = process_history_data_by_itemids(sock, validator_func, validator_args, &jp_data,
-				session, NULL, info, ZBX_ITEM_GET_ALL)))
+				session, NULL, 0, info, ZBX_ITEM_GET_ALL)))
 		{
 			goto out;
 		}
@@ -3911,6 +4178,175 @@ int	process_sender_history_data(zbx_socket_t *sock, struct zbx_json_parse *jp, z
 	return process_client_history_data(sock, jp, ts, sender_item_validator, &rights, info);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: validates RSM SLV item of value pushed by item identifier         *
+ *                                                                            *
+ * Parameters: item  - [IN] the item data                                     *
+ *             error - [OUT] the error message                                *
+ *                                                                            *
+ * Return value:  SUCCEED - the validation was successful                     *
+ *                FAIL    - otherwise                                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	rsm_slv_item_validator(const DC_ITEM *item, char **error)
+{
+	char	key_short[VALUE_ERRMSG_MAX * ZBX_MAX_BYTES_IN_UTF8_CHAR + 1];
+
+	if (0 != item->host.proxy_hostid || ITEM_TYPE_TRAPPER != item->type ||
+			0 != strncmp(item->key_orig, ZBX_RSM_SLV_KEY_PREFIX, ZBX_CONST_STRLEN(ZBX_RSM_SLV_KEY_PREFIX)))
+	{
+		*error = zbx_dsprintf(*error, "cannot process item \"%s\" value: only trapper items with \"%s\" key"
+				" prefix on hosts monitored by server are accepted",
+				zbx_truncate_itemkey(item->key_orig, VALUE_ERRMSG_MAX, key_short, sizeof(key_short)),
+				ZBX_RSM_SLV_KEY_PREFIX);
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes a batch of values pushed by RSM SLV scripts             *
+ *                                                                            *
+ * Parameters: items      - [IN] the item data buffer                         *
+ *             errcodes   - [IN] the item error code buffer                   *
+ *             itemids    - [IN] the item identifiers                         *
+ *             values     - [IN] the item values                              *
+ *             values_num - [IN] the number of values                         *
+ *                                                                            *
+ * Return value: The number of processed values.                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	process_rsm_slv_values(DC_ITEM *items, int *errcodes, const zbx_uint64_t *itemids,
+		zbx_agent_value_t *values, int values_num)
+{
+	int	i, processed_num;
+	char	*error = NULL;
+
+	DCconfig_get_items_by_itemids_partial(items, itemids, errcodes, (size_t)values_num, ZBX_ITEM_GET_PROCESS);
+
+	for (i = 0; i < values_num; i++)
+	{
+		if (SUCCEED != errcodes[i])
+			continue;
+
+		if (SUCCEED != rsm_slv_item_validator(&items[i], &error))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "%s", error);
+			zbx_free(error);
+
+			DCconfig_clean_items(&items[i], &errcodes[i], 1);
+			errcodes[i] = FAIL;
+		}
+	}
+
+	processed_num = process_history_data(items, values, errcodes, (size_t)values_num, NULL);
+
+	DCconfig_clean_items(items, errcodes, (size_t)values_num);
+	zbx_agent_values_clean(values, (size_t)values_num);
+
+	return processed_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes values pushed by RSM SLV scripts                        *
+ *                                                                            *
+ * Parameters: jp   - [IN] the request with item identifier, clock and value  *
+ *                         arrays of the same size                            *
+ *             info - [OUT] address of a pointer to the info string           *
+ *                          (should be freed by the caller)                   *
+ *                                                                            *
+ * Return value:  SUCCEED - the values were processed                         *
+ *                FAIL    - the request is malformed                          *
+ *                                                                            *
+ * Comments: The caller must authenticate the client. Values are identified   *
+ *           by item identifiers only and sent as columns, so neither host,   *
+ *           key lookups nor per value JSON objects are involved.             *
+ *                                                                            *
+ ******************************************************************************/
+int	process_rsm_slv_history_data(const struct zbx_json_parse *jp, char **info)
+{
+	struct zbx_json_parse	jp_itemids, jp_clocks, jp_values;
+	const char		*pitemid = NULL, *pclock = NULL, *pvalue = NULL;
+	char			itemid_str[MAX_ID_LEN + 1], clock_str[MAX_ID_LEN + 1];
+	int			values_num = 0, processed_num = 0, total_num, *errcodes, ret = FAIL;
+	size_t			value_alloc;
+	double			sec;
+	zbx_uint64_t		itemids[ZBX_HISTORY_VALUES_MAX];
+	zbx_agent_value_t	values[ZBX_HISTORY_VALUES_MAX];
+	DC_ITEM			*items;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (SUCCEED != zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_ITEMIDS, &jp_itemids) ||
+			SUCCEED != zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_CLOCKS, &jp_clocks) ||
+			SUCCEED != zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_VALUES, &jp_values))
+	{
+		*info = zbx_strdup(*info, zbx_json_strerror());
+		goto out;
+	}
+
+	total_num = zbx_json_count(&jp_itemids);
+
+	if (total_num != zbx_json_count(&jp_clocks) || total_num != zbx_json_count(&jp_values))
+	{
+		*info = zbx_dsprintf(*info, "\"%s\", \"%s\" and \"%s\" arrays must be of the same size",
+				ZBX_PROTO_TAG_ITEMIDS, ZBX_PROTO_TAG_CLOCKS, ZBX_PROTO_TAG_VALUES);
+		goto out;
+	}
+
+	items = (DC_ITEM *)zbx_malloc(NULL, sizeof(DC_ITEM) * ZBX_HISTORY_VALUES_MAX);
+	errcodes = (int *)zbx_malloc(NULL, sizeof(int) * ZBX_HISTORY_VALUES_MAX);
+
+	sec = zbx_time();
+
+	/* the arrays are of the same size, so the clock and value positions follow the item identifier */
+	while (NULL != (pitemid = zbx_json_next(&jp_itemids, pitemid)))
+	{
+		zbx_agent_value_t	*av = &values[values_num];
+
+		pclock = zbx_json_next(&jp_clocks, pclock);
+		pvalue = zbx_json_next(&jp_values, pvalue);
+
+		memset(av, 0, sizeof(zbx_agent_value_t));
+		value_alloc = 0;
+
+		if (NULL == zbx_json_decodevalue(pitemid, itemid_str, sizeof(itemid_str), NULL) ||
+				SUCCEED != is_uint64(itemid_str, &itemids[values_num]) ||
+				NULL == zbx_json_decodevalue(pclock, clock_str, sizeof(clock_str), NULL) ||
+				FAIL == is_uint31(clock_str, &av->ts.sec) ||
+				NULL == zbx_json_decodevalue_dyn(pvalue, &av->value, &value_alloc, NULL))
+		{
+			zbx_free(av->value);
+			continue;
+		}
+
+		if (ZBX_HISTORY_VALUES_MAX == ++values_num)
+		{
+			processed_num += process_rsm_slv_values(items, errcodes, itemids, values, values_num);
+			values_num = 0;
+		}
+	}
+
+	if (0 != values_num)
+		processed_num += process_rsm_slv_values(items, errcodes, itemids, values, values_num);
+
+	zbx_free(errcodes);
+	zbx_free(items);
+
+	*info = zbx_dsprintf(*info, "processed: %d; failed: %d; total: %d; seconds spent: " ZBX_FS_DBL,
+			processed_num, total_num - processed_num, total_num, zbx_time() - sec);
+
+	ret = SUCCEED;
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
+
 static void	zbx_drule_ip_free(zbx_drule_ip_t *ip)
 {
 	zbx_vector_ptr_clear_ext(&ip->services, zbx_ptr_free);
@@ -4490,6 +4926,30 @@ int	zbx_get_proxy_protocol_version(struct zbx_json_parse *jp)
 		return ZBX_COMPONENT_VERSION(3, 2);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if server accepts JSON object values embedded into history *
+ *          data without string encoding                                      *
+ *                                                                            *
+ * Parameters: jp - [IN] JSON with server request or response                 *
+ *                                                                            *
+ * Return value: 1 - JSON object values can be sent as is                     *
+ *               0 - otherwise                                                *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_get_proxy_json_values(const struct zbx_json_parse *jp)
+{
+	char	value[MAX_ID_LEN + 1];
+
+	if (NULL != jp && SUCCEED == zbx_json_value_by_name(jp, ZBX_PROTO_TAG_JSON_VALUES, value, sizeof(value),
+			NULL) && 0 == strcmp(value, "1"))
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: parse tasks contents and saves the received tasks                 *
@@ -4683,8 +5143,8 @@ int	process_proxy_data(const DC_PROXY *proxy, struct zbx_json_parse *jp, zbx_tim
 		}
 
 		if (SUCCEED != (ret = process_history_data_by_itemids(NULL, proxy_item_validator,
-				(void *)&proxy->hostid, &jp_data, session, &proxy_diff.nodata_win, &error_step,
-				ZBX_ITEM_GET_PROCESS)))
+				(void *)&proxy->hostid, &jp_data, session, &proxy_diff.nodata_win,
+				zbx_get_proxy_json_values(jp), &error_step, ZBX_ITEM_GET_PROCESS)))
 		{
 			zbx_strcatnl_alloc(error, &error_alloc, &error_offset, error_step);
 		}
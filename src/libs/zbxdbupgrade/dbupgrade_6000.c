@@ -1301,6 +1301,130 @@ static int	DBpatch_6000004(void)
 	return ret;
 }
 
+/* 6000004, 1 - create table changelog */
+static int	DBpatch_6000004_1(void)
+{
+	const ZBX_TABLE	table =
+			{"changelog", "changelogid", 0,
+				{
+					{"changelogid", NULL, NULL, NULL, 0, ZBX_TYPE_ID, ZBX_NOTNULL, 0},
+					{"object"   , "0", NULL, NULL, 0, ZBX_TYPE_INT, ZBX_NOTNULL, 0},
+					{"objectid" , NULL, NULL, NULL, 0, ZBX_TYPE_ID , ZBX_NOTNULL, 0},
+					{"operation", "0", NULL, NULL, 0, ZBX_TYPE_INT, ZBX_NOTNULL, 0},
+					{"clock"    , "0", NULL, NULL, 0, ZBX_TYPE_INT, ZBX_NOTNULL, 0},
+					{0}
+				},
+				NULL
+			};
+
+	if (SUCCEED != DBcreate_table(&table))
+		return FAIL;
+
+	/* changelog records are identified by database generated sequence written by triggers */
+#if defined(HAVE_MYSQL)
+	if (ZBX_DB_OK > DBexecute("alter table changelog modify changelogid bigint unsigned not null auto_increment"))
+		return FAIL;
+#elif defined(HAVE_POSTGRESQL)
+	if (ZBX_DB_OK > DBexecute("create sequence changelog_changelogid_seq owned by changelog.changelogid"))
+		return FAIL;
+
+	if (ZBX_DB_OK > DBexecute("alter table changelog alter column changelogid"
+			" set default nextval('changelog_changelogid_seq')"))
+	{
+		return FAIL;
+	}
+#elif defined(HAVE_ORACLE)
+	if (ZBX_DB_OK > DBexecute("create sequence changelog_seq start with 1 increment by 1 nomaxvalue"))
+		return FAIL;
+
+	if (ZBX_DB_OK > DBexecute("create trigger changelog_tr before insert on changelog for each row"
+			" begin"
+				" select changelog_seq.nextval into :new.changelogid from dual;"
+			" end;"))
+	{
+		return FAIL;
+	}
+#endif
+	return SUCCEED;
+}
+
+/* 6000004, 2 - add clock index to table changelog */
+static int	DBpatch_6000004_2(void)
+{
+	return DBcreate_index("changelog", "changelog_1", "clock", 0);
+}
+
+/* 6000004, 3 - create triggers registering changes of items and removal of hosts in changelog */
+/* (on MySQL with binary logging enabled requires SUPER privilege or log_bin_trust_function_creators=1) */
+static int	DBpatch_6000004_3(void)
+{
+	static const struct
+	{
+		const char	*table;
+		const char	*field;
+		int		object;
+		const char	*operation;
+		int		id;
+		const char	*row;
+	}
+	triggers[] =
+	{
+		{"items", "itemid", 3, "insert", 1, "new"},
+		{"items", "itemid", 3, "update", 2, "new"},
+		{"items", "itemid", 3, "delete", 3, "old"},
+		{"hosts", "hostid", 1, "delete", 3, "old"}
+	};
+
+	int	ret = FAIL;
+	size_t	i;
+
+	for (i = 0; i < ARRSIZE(triggers); i++)
+	{
+#if defined(HAVE_MYSQL)
+		if (ZBX_DB_OK > DBexecute("create trigger %s_changelog_%s after %s on %s"
+				" for each row"
+				" insert into changelog (object,objectid,operation,clock)"
+				" values (%d,%s.%s,%d,unix_timestamp())",
+				triggers[i].table, triggers[i].operation, triggers[i].operation, triggers[i].table,
+				triggers[i].object, triggers[i].row, triggers[i].field, triggers[i].id))
+		{
+			zabbix_log(LOG_LEVEL_CRIT, "cannot create changelog trigger: if binary logging is enabled,"
+					" database user must have SUPER privilege or log_bin_trust_function_creators"
+					" must be set to 1");
+			goto out;
+		}
+#elif defined(HAVE_POSTGRESQL)
+		DB_EXEC("create function changelog_%s_%s() returns trigger language 'plpgsql' as $$"
+				" begin"
+					" insert into changelog (object,objectid,operation,clock)"
+					" values (%d,%s.%s,%d,cast(extract(epoch from now()) as int));"
+					" return null;"
+				" end;"
+				" $$",
+				triggers[i].table, triggers[i].operation,
+				triggers[i].object, triggers[i].row, triggers[i].field, triggers[i].id);
+		DB_EXEC("create trigger %s_changelog_%s after %s on %s"
+				" for each row execute procedure changelog_%s_%s()",
+				triggers[i].table, triggers[i].operation, triggers[i].operation, triggers[i].table,
+				triggers[i].table, triggers[i].operation);
+#elif defined(HAVE_ORACLE)
+		DB_EXEC("create trigger %s_changelog_%s after %s on %s"
+				" for each row"
+				" begin"
+					" insert into changelog (object,objectid,operation,clock)"
+					" values (%d,:%s.%s,%d,"
+						"(cast(sys_extract_utc(systimestamp) as date)-date'1970-01-01')*86400);"
+				" end;",
+				triggers[i].table, triggers[i].operation, triggers[i].operation, triggers[i].table,
+				triggers[i].object, triggers[i].row, triggers[i].field, triggers[i].id);
+#endif
+	}
+
+	ret = SUCCEED;
+out:
+	return ret;
+}
+
 #undef HTTPSTEP_ITEM_TYPE_RSPCODE
 #undef HTTPSTEP_ITEM_TYPE_TIME
 #undef HTTPSTEP_ITEM_TYPE_IN
@@ -1345,5 +1469,8 @@ DBPATCH_ADD(6000001, 0, 0)
 DBPATCH_ADD(6000002, 0, 0)
 DBPATCH_ADD(6000003, 0, 0)
 DBPATCH_ADD(6000004, 0, 0)
+DBPATCH_RSM(6000004, 1, 0, 1)	/* create table changelog */
+DBPATCH_RSM(6000004, 2, 0, 0)	/* add clock index to table changelog */
+DBPATCH_RSM(6000004, 3, 0, 1)	/* create triggers registering changes of items and removal of hosts in changelog */
 
 DBPATCH_END()
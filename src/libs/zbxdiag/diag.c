@@ -152,6 +152,14 @@ void	diag_add_mem_stats(struct zbx_json *json, const char *name, const zbx_mem_s
 	zbx_json_adduint64(json, "used", stats->used_size);
 	zbx_json_close(json);
 
+	if (0 != stats->slabs_num)
+	{
+		zbx_json_addobject(json, "slabs");
+		zbx_json_adduint64(json, "num", stats->slabs_num);
+		zbx_json_adduint64(json, "free", stats->slab_free_size);
+		zbx_json_close(json);
+	}
+
 	zbx_json_addobject(json, "chunks");
 	zbx_json_adduint64(json, "free", stats->free_chunks);
 	zbx_json_adduint64(json, "used", stats->used_chunks);
@@ -497,14 +505,15 @@ static void	zbx_json_addhex(struct zbx_json *j, const char *name, zbx_uint64_t v
 void	diag_add_locks_info(struct zbx_json *json)
 {
 	int		i;
+	char		name[32];
 #ifdef HAVE_VMINFO_T_UPDATES
-	const char	*names[ZBX_MUTEX_COUNT] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
+	const char	*names[ZBX_MUTEX_HISTORY_QUEUE] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
 				"ZBX_MUTEX_CACHE_IDS", "ZBX_MUTEX_SELFMON", "ZBX_MUTEX_CPUSTATS", "ZBX_MUTEX_DISKSTATS",
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
 				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_KSTAT", "ZBX_MUTEX_MODBUS",
 				"ZBX_MUTEX_TREND_FUNC"};
 #else
-	const char	*names[ZBX_MUTEX_COUNT] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
+	const char	*names[ZBX_MUTEX_HISTORY_QUEUE] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
 				"ZBX_MUTEX_CACHE_IDS", "ZBX_MUTEX_SELFMON", "ZBX_MUTEX_CPUSTATS", "ZBX_MUTEX_DISKSTATS",
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
 				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_MODBUS",
@@ -512,13 +521,21 @@ void	diag_add_locks_info(struct zbx_json *json)
 #endif
 	zbx_json_addarray(json, ZBX_DIAG_LOCKS);
 
-	for (i = 0; i < ZBX_MUTEX_COUNT; i++)
+	for (i = 0; i < ZBX_MUTEX_HISTORY_QUEUE; i++)
 	{
 		zbx_json_addobject(json, NULL);
 		zbx_json_addhex(json, names[i], (zbx_uint64_t)zbx_mutex_addr_get(i));
 		zbx_json_close(json);
 	}
 
+	for (i = ZBX_MUTEX_HISTORY_QUEUE; i < ZBX_MUTEX_COUNT; i++)
+	{
+		zbx_snprintf(name, sizeof(name), "ZBX_MUTEX_HISTORY_QUEUE_%d", i - ZBX_MUTEX_HISTORY_QUEUE);
+		zbx_json_addobject(json, NULL);
+		zbx_json_addhex(json, name, (zbx_uint64_t)zbx_mutex_addr_get(i));
+		zbx_json_close(json);
+	}
+
 	zbx_json_addobject(json, NULL);
 	zbx_json_addhex(json, "ZBX_RWLOCK_CONFIG", (zbx_uint64_t)zbx_rwlock_addr_get(ZBX_RWLOCK_CONFIG));
 	zbx_json_close(json);
@@ -529,6 +546,168 @@ void	diag_add_locks_info(struct zbx_json *json)
 	zbx_json_close(json);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add hashset statistics to json                                    *
+ *                                                                            *
+ * Parameters: json  - [OUT] the output json                                  *
+ *             stats - [IN] the hashset statistics                            *
+ *             size  - [IN] the estimated memory size used by hashset         *
+ *                                                                            *
+ ******************************************************************************/
+static void	diag_add_hashset_stats(struct zbx_json *json, const zbx_hashset_stats_t *stats, zbx_uint64_t size)
+{
+	zbx_json_adduint64(json, "entries", (zbx_uint64_t)stats->num_data);
+	zbx_json_adduint64(json, "slots", (zbx_uint64_t)stats->num_slots);
+	zbx_json_adduint64(json, "size", size);
+	zbx_json_addfloat(json, "load", 0 != stats->num_slots ?
+			(double)stats->num_data / stats->num_slots : 0);
+	zbx_json_addint64(json, "probe.max", stats->probe_max);
+	zbx_json_addfloat(json, "probe.avg", 0 != stats->num_data ?
+			(double)stats->probe_total / stats->num_data : 0);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compare configuration cache hashset statistics by size for        *
+ *          descending sorting                                                *
+ *                                                                            *
+ ******************************************************************************/
+static int	diag_configcache_hashset_compare_size(const void *d1, const void *d2)
+{
+	const zbx_dc_hashset_stats_t	*s1 = *(const zbx_dc_hashset_stats_t * const *)d1;
+	const zbx_dc_hashset_stats_t	*s2 = *(const zbx_dc_hashset_stats_t * const *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(s2->size, s1->size);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add requested configuration cache diagnostic information to json  *
+ *          data                                                              *
+ *                                                                            *
+ * Parameters: jp    - [IN] the request                                       *
+ *             json  - [IN/OUT] the json to update                            *
+ *             error - [OUT] error message                                    *
+ *                                                                            *
+ * Return value: SUCCEED - the information was added successfully             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	diag_add_configcache_info(const struct zbx_json_parse *jp, struct zbx_json *json, char **error)
+{
+	zbx_vector_ptr_t	tops;
+	int			ret;
+	double			time1, time2, time_total = 0;
+	zbx_uint64_t		fields;
+	zbx_diag_map_t		field_map[] = {
+					{"", ZBX_DIAG_CONFIGCACHE_MEMORY | ZBX_DIAG_CONFIGCACHE_STRPOOL},
+					{"memory", ZBX_DIAG_CONFIGCACHE_MEMORY},
+					{"strpool", ZBX_DIAG_CONFIGCACHE_STRPOOL},
+					{NULL, 0}
+					};
+
+	zbx_vector_ptr_create(&tops);
+
+	if (SUCCEED == (ret = diag_parse_request(jp, field_map, &fields, &tops, error)))
+	{
+		int	i;
+
+		zbx_json_addobject(json, ZBX_DIAG_CONFIGCACHE);
+
+		if (0 != (fields & ZBX_DIAG_CONFIGCACHE_MEMORY))
+		{
+			zbx_mem_stats_t	mem;
+
+			time1 = zbx_time();
+			zbx_dc_get_mem_stats(&mem);
+			time2 = zbx_time();
+			time_total += time2 - time1;
+
+			diag_add_mem_stats(json, "memory", &mem);
+		}
+
+		if (0 != (fields & ZBX_DIAG_CONFIGCACHE_STRPOOL))
+		{
+			zbx_dc_strpool_stats_t	strpool;
+
+			time1 = zbx_time();
+			zbx_dc_get_strpool_stats(&strpool);
+			time2 = zbx_time();
+			time_total += time2 - time1;
+
+			zbx_json_addobject(json, "strpool");
+			diag_add_hashset_stats(json, &strpool.stats, strpool.size);
+			zbx_json_adduint64(json, "refs", strpool.refs_num);
+			zbx_json_addfloat(json, "len.avg", 0 != strpool.stats.num_data ?
+					(double)strpool.len_total / strpool.stats.num_data : 0);
+			zbx_json_close(json);
+		}
+
+		if (0 != tops.values_num)
+		{
+			zbx_json_addobject(json, "top");
+
+			for (i = 0; i < tops.values_num; i++)
+			{
+				zbx_diag_map_t	*map = (zbx_diag_map_t *)tops.values[i];
+
+				if (0 == strcmp(map->name, "hashsets"))
+				{
+					zbx_vector_ptr_t	hashsets;
+					int			j, limit;
+
+					zbx_vector_ptr_create(&hashsets);
+
+					time1 = zbx_time();
+					zbx_dc_get_hashset_stats(&hashsets);
+					time2 = zbx_time();
+					time_total += time2 - time1;
+
+					zbx_vector_ptr_sort(&hashsets, diag_configcache_hashset_compare_size);
+					limit = MIN((int)map->value, hashsets.values_num);
+
+					zbx_json_addarray(json, map->name);
+
+					for (j = 0; j < limit; j++)
+					{
+						zbx_dc_hashset_stats_t	*hs = (zbx_dc_hashset_stats_t *)hashsets.values[j];
+
+						zbx_json_addobject(json, NULL);
+						zbx_json_addstring(json, "name", hs->name, ZBX_JSON_TYPE_STRING);
+						diag_add_hashset_stats(json, &hs->stats, hs->size);
+						zbx_json_close(json);
+					}
+
+					zbx_json_close(json);
+
+					zbx_vector_ptr_clear_ext(&hashsets, zbx_ptr_free);
+					zbx_vector_ptr_destroy(&hashsets);
+				}
+				else
+				{
+					*error = zbx_dsprintf(*error, "Unsupported top field: %s", map->name);
+					ret = FAIL;
+					break;
+				}
+			}
+
+			zbx_json_close(json);
+		}
+
+		zbx_json_addfloat(json, "time", time_total);
+
+		zbx_json_close(json);
+	}
+
+	zbx_vector_ptr_clear_ext(&tops, (zbx_ptr_free_func_t)diag_map_free);
+	zbx_vector_ptr_destroy(&tops);
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get diagnostic information                                        *
@@ -626,6 +805,9 @@ static void	diag_prepare_default_request(struct zbx_json *j, unsigned int flags)
 
 	if (0 != (flags & (1 << ZBX_DIAGINFO_LOCKS)))
 		diag_add_section_request(j, ZBX_DIAG_LOCKS, NULL);
+
+	if (0 != (flags & (1 << ZBX_DIAGINFO_CONFIGCACHE)))
+		diag_add_section_request(j, ZBX_DIAG_CONFIGCACHE, "hashsets", NULL);
 }
 
 /******************************************************************************
@@ -864,6 +1046,37 @@ static void	diag_log_alerting(struct zbx_json_parse *jp, char **out, size_t *out
 	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "==");
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: log configuration cache diagnostic information                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	diag_log_config_cache(struct zbx_json_parse *jp, char **out, size_t *out_alloc, size_t *out_offset)
+{
+	struct zbx_json_parse	jp_strpool;
+	char			*msg = NULL;
+
+	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset,
+			"== configuration cache diagnostic information ==");
+
+	diag_get_simple_values(jp, &msg);
+	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "%s", msg);
+	zbx_free(msg);
+
+	diag_log_memory_info(jp, "memory", "$.memory", out, out_alloc, out_offset);
+
+	if (SUCCEED == zbx_json_brackets_by_name(jp, "strpool", &jp_strpool))
+	{
+		diag_get_simple_values(&jp_strpool, &msg);
+		zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "strpool: %s", msg);
+		zbx_free(msg);
+	}
+
+	diag_log_top_view(jp, "top.hashsets", "$.top.hashsets", out, out_alloc, out_offset);
+
+	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "==");
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: log diagnostic information                                        *
@@ -926,6 +1139,8 @@ void	zbx_diag_log_info(unsigned int flags, char **result)
 						&result_offset);
 				zbx_strlog_alloc(LOG_LEVEL_INFORMATION, result, &result_alloc, &result_offset, "==");
 			}
+			else if (0 == strcmp(section, ZBX_DIAG_CONFIGCACHE))
+				diag_log_config_cache(&jp_section, result, &result_alloc, &result_offset);
 		}
 	}
 	else
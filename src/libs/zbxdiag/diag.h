@@ -63,6 +63,9 @@
 
 #define ZBX_DIAG_ALERTING_SIMPLE	(ZBX_DIAG_ALERTING_ALERTS)
 
+#define ZBX_DIAG_CONFIGCACHE_MEMORY	0x00000001
+#define ZBX_DIAG_CONFIGCACHE_STRPOOL	0x00000002
+
 typedef struct
 {
 	char		*name;
@@ -83,5 +86,6 @@ int	diag_add_historycache_info(const struct zbx_json_parse *jp, struct zbx_json
 
 int	diag_add_preproc_info(const struct zbx_json_parse *jp, struct zbx_json *json, char **error);
 void	diag_add_locks_info(struct zbx_json *json);
+int	diag_add_configcache_info(const struct zbx_json_parse *jp, struct zbx_json *json, char **error);
 
 #endif
@@ -172,6 +172,53 @@ int	zbx_history_get_values(zbx_uint64_t itemid, int value_type, int start, int c
 	return ret;
 }
 
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: counts item values in history storage                                   *
+ *                                                                                  *
+ * Parameters:  itemid     - [IN] the itemid                                        *
+ *              value_type - [IN] the item value type                               *
+ *              start      - [IN] the period start timestamp                        *
+ *              end        - [IN] the period end timestamp                          *
+ *              count      - [OUT] the number of values                             *
+ *                                                                                  *
+ * Return value: SUCCEED - the values were counted successfully                     *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: This function counts values in ]<start>,<end>] interval. Storage       *
+ *           backends without count support read the values and count them.        *
+ *                                                                                  *
+ ************************************************************************************/
+int	zbx_history_count_values(zbx_uint64_t itemid, int value_type, int start, int end, int *count)
+{
+	int			ret;
+	zbx_history_iface_t	*writer = &history_ifaces[value_type];
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d start:%d end:%d",
+			__func__, itemid, value_type, start, end);
+
+	if (NULL != writer->count_values)
+	{
+		ret = writer->count_values(writer, itemid, start, end, count);
+	}
+	else
+	{
+		zbx_vector_history_record_t	values;
+
+		zbx_history_record_vector_create(&values);
+
+		if (SUCCEED == (ret = writer->get_values(writer, itemid, start, 0, end, &values)))
+			*count = values.values_num;
+
+		zbx_history_record_vector_destroy(&values, value_type);
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s count:%d", __func__, zbx_result_string(ret),
+			SUCCEED == ret ? *count : 0);
+
+	return ret;
+}
+
 /************************************************************************************
  *                                                                                  *
  * Purpose: checks if the value type requires trends data calculations              *
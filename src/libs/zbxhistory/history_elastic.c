@@ -25,6 +25,10 @@
 
 #include "history.h"
 
+#ifdef HAVE_ZLIB
+#include "zlib.h"
+#endif
+
 /* curl_multi_wait() is supported starting with version 7.28.0 (0x071c00) */
 #if defined(HAVE_LIBCURL) && LIBCURL_VERSION_NUM >= 0x071c00
 
@@ -33,10 +37,17 @@
 #define		ZBX_IDX_JSON_ALLOCATE		256
 #define		ZBX_JSON_ALLOCATE		2048
 
+/* the size of bulk request body after which new request is started */
+#define		ZBX_ELASTIC_BULK_SIZE_MAX	(1024 * 1024)
+
+/* the maximum number of bulk requests sent at the same time */
+#define		ZBX_ELASTIC_REQUESTS_MAX	4
+
 const char	*value_type_str[] = {"dbl", "str", "log", "uint", "text"};
 
 extern char	*CONFIG_HISTORY_STORAGE_URL;
 extern int	CONFIG_HISTORY_STORAGE_PIPELINES;
+extern int	CONFIG_HISTORY_STORAGE_COMPRESSION;
 extern int	CONFIG_ALLOW_UNSUPPORTED_DB_VERSIONS;
 
 static zbx_uint32_t	ZBX_ELASTIC_SVERSION = ZBX_DBVERSION_UNDEFINED;
@@ -44,23 +55,11 @@ static zbx_uint32_t	ZBX_ELASTIC_SVERSION = ZBX_DBVERSION_UNDEFINED;
 typedef struct
 {
 	char	*base_url;
-	char	*post_url;
-	char	*buf;
+	char	*bulk_url;
 	CURL	*handle;
 }
 zbx_elastic_data_t;
 
-typedef struct
-{
-	unsigned char		initialized;
-	zbx_vector_ptr_t	ifaces;
-
-	CURLM			*handle;
-}
-zbx_elastic_writer_t;
-
-static zbx_elastic_writer_t	writer;
-
 typedef struct
 {
 	char	*data;
@@ -71,14 +70,53 @@ zbx_httppage_t;
 
 static zbx_httppage_t	page_r;
 
+/* bulk API request */
 typedef struct
 {
-	zbx_httppage_t	page;
-	char		errbuf[CURL_ERROR_SIZE];
+	const char		*url;
+
+	char			*body;
+	size_t			body_alloc;
+	size_t			body_offset;
+
+	/* the gzip compressed body, created when the request is sent for the first time */
+	char			*body_gz;
+	size_t			body_gz_size;
+
+	/* the end offsets of documents (action and source lines) in request body */
+	zbx_vector_uint64_t	docs;
 }
-zbx_curlpage_t;
+zbx_elastic_bulk_t;
 
-static zbx_curlpage_t	page_w[ITEM_VALUE_TYPE_MAX];
+typedef struct
+{
+	CURL			*handle;
+	zbx_elastic_bulk_t	*bulk;
+	zbx_httppage_t		page;
+	char			errbuf[CURL_ERROR_SIZE];
+}
+zbx_elastic_conn_t;
+
+typedef struct
+{
+	unsigned char		initialized;
+
+	/* the number of initialized history storage interfaces using the writer */
+	int			ifaces_num;
+
+	/* the queued and the failed bulk requests */
+	zbx_vector_ptr_t	bulks;
+	zbx_vector_ptr_t	retries;
+
+	zbx_elastic_conn_t	conns[ZBX_ELASTIC_REQUESTS_MAX];
+	struct curl_slist	*headers;
+	struct curl_slist	*headers_gz;
+
+	CURLM			*handle;
+}
+zbx_elastic_writer_t;
+
+static zbx_elastic_writer_t	writer;
 
 static size_t	curl_write_cb(void *ptr, size_t size, size_t nmemb, void *userdata)
 {
@@ -230,14 +268,8 @@ static void	elastic_close(zbx_history_iface_t *hist)
 {
 	zbx_elastic_data_t	*data = hist->data.elastic_data;
 
-	zbx_free(data->buf);
-	zbx_free(data->post_url);
-
 	if (NULL != data->handle)
 	{
-		if (NULL != writer.handle)
-			curl_multi_remove_handle(writer.handle, data->handle);
-
 		curl_easy_cleanup(data->handle);
 		data->handle = NULL;
 	}
@@ -319,15 +351,111 @@ static int	elastic_is_error_present(zbx_httppage_t *page, char **err)
 
 /************************************************************************************
  *                                                                                  *
- * Purpose: initializes elastic writer for a new batch of history values            *
+ * Purpose: creates bulk request                                                    *
+ *                                                                                  *
+ * Parameters: url - [IN] the bulk API url                                          *
+ *                                                                                  *
+ * Return value: the created bulk request                                           *
+ *                                                                                  *
+ ************************************************************************************/
+static zbx_elastic_bulk_t	*elastic_bulk_create(const char *url)
+{
+	zbx_elastic_bulk_t	*bulk;
+
+	bulk = (zbx_elastic_bulk_t *)zbx_malloc(NULL, sizeof(zbx_elastic_bulk_t));
+	memset(bulk, 0, sizeof(zbx_elastic_bulk_t));
+	bulk->url = url;
+	zbx_vector_uint64_create(&bulk->docs);
+
+	return bulk;
+}
+
+static void	elastic_bulk_free(zbx_elastic_bulk_t *bulk)
+{
+	zbx_vector_uint64_destroy(&bulk->docs);
+	zbx_free(bulk->body);
+	zbx_free(bulk->body_gz);
+	zbx_free(bulk);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: appends document with its action line to bulk request                   *
+ *                                                                                  *
+ * Parameters: bulk - [IN/OUT] the bulk request                                     *
+ *             doc  - [IN] the action and source lines of the document              *
+ *             len  - [IN] the document length                                      *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_bulk_append(zbx_elastic_bulk_t *bulk, const char *doc, size_t len)
+{
+	zbx_strncpy_alloc(&bulk->body, &bulk->body_alloc, &bulk->body_offset, doc, len);
+	zbx_vector_uint64_append(&bulk->docs, (zbx_uint64_t)bulk->body_offset);
+}
+
+#ifdef HAVE_ZLIB
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: compresses bulk request body with gzip                                  *
+ *                                                                                  *
+ * Parameters: bulk - [IN/OUT] the bulk request                                     *
+ *                                                                                  *
+ * Return value: SUCCEED - the body was compressed successfully                     *
+ *               FAIL    - otherwise                                                *
+ *                                                                                  *
+ ************************************************************************************/
+static int	elastic_bulk_compress(zbx_elastic_bulk_t *bulk)
+{
+	z_stream	zs;
+	int		rc;
+
+	memset(&zs, 0, sizeof(zs));
+
+	/* window bits above 15 select gzip format instead of zlib */
+	if (Z_OK != (rc = deflateInit2(&zs, Z_BEST_SPEED, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot initialize gzip compression: %d", rc);
+		return FAIL;
+	}
+
+	bulk->body_gz_size = deflateBound(&zs, (uLong)bulk->body_offset);
+	bulk->body_gz = (char *)zbx_malloc(bulk->body_gz, bulk->body_gz_size);
+
+	zs.next_in = (Bytef *)bulk->body;
+	zs.avail_in = (uInt)bulk->body_offset;
+	zs.next_out = (Bytef *)bulk->body_gz;
+	zs.avail_out = (uInt)bulk->body_gz_size;
+
+	rc = deflate(&zs, Z_FINISH);
+	bulk->body_gz_size = zs.total_out;
+	deflateEnd(&zs);
+
+	if (Z_STREAM_END != rc)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot compress elasticsearch bulk request: %d", rc);
+		zbx_free(bulk->body_gz);
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+#endif
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: initializes elastic writer, the writer is kept between flushes so that  *
+ *          connections to elastic storage are reused                               *
  *                                                                                  *
  ************************************************************************************/
 static void	elastic_writer_init(void)
 {
+	int	i;
+
 	if (0 != writer.initialized)
 		return;
 
-	zbx_vector_ptr_create(&writer.ifaces);
+	zbx_vector_ptr_create(&writer.bulks);
+	zbx_vector_ptr_create(&writer.retries);
 
 	if (NULL == (writer.handle = curl_multi_init()))
 	{
@@ -335,6 +463,38 @@ static void	elastic_writer_init(void)
 		exit(EXIT_FAILURE);
 	}
 
+	writer.headers = curl_slist_append(writer.headers, "Content-Type: application/x-ndjson");
+	writer.headers_gz = curl_slist_append(writer.headers_gz, "Content-Type: application/x-ndjson");
+	writer.headers_gz = curl_slist_append(writer.headers_gz, "Content-Encoding: gzip");
+
+	for (i = 0; i < ZBX_ELASTIC_REQUESTS_MAX; i++)
+	{
+		zbx_elastic_conn_t	*conn = &writer.conns[i];
+		CURLoption		opt;
+		CURLcode		err;
+
+		if (NULL == (conn->handle = curl_easy_init()))
+		{
+			zbx_error("Cannot initialize cURL session");
+			exit(EXIT_FAILURE);
+		}
+
+		if (CURLE_OK != (err = curl_easy_setopt(conn->handle, opt = CURLOPT_POST, 1L)) ||
+				CURLE_OK != (err = curl_easy_setopt(conn->handle, opt = CURLOPT_WRITEFUNCTION,
+						curl_write_cb)) ||
+				CURLE_OK != (err = curl_easy_setopt(conn->handle, opt = CURLOPT_WRITEDATA,
+						&conn->page)) ||
+				CURLE_OK != (err = curl_easy_setopt(conn->handle, opt = CURLOPT_FAILONERROR, 1L)) ||
+				CURLE_OK != (err = curl_easy_setopt(conn->handle, opt = CURLOPT_ERRORBUFFER,
+						conn->errbuf)) ||
+				CURLE_OK != (err = curl_easy_setopt(conn->handle, opt = CURLOPT_TCP_KEEPALIVE, 1L)) ||
+				CURLE_OK != (err = curl_easy_setopt(conn->handle, opt = CURLOPT_PRIVATE, conn)) ||
+				CURLE_OK != (err = curl_easy_setopt(conn->handle, opt = ZBX_CURLOPT_ACCEPT_ENCODING, "")))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot set cURL option %d: [%s]", (int)opt, curl_easy_strerror(err));
+		}
+	}
+
 	writer.initialized = 1;
 }
 
@@ -348,237 +508,335 @@ static void	elastic_writer_release(void)
 {
 	int	i;
 
-	for (i = 0; i < writer.ifaces.values_num; i++)
-		elastic_close((zbx_history_iface_t *)writer.ifaces.values[i]);
+	if (0 == writer.initialized)
+		return;
+
+	for (i = 0; i < ZBX_ELASTIC_REQUESTS_MAX; i++)
+	{
+		zbx_elastic_conn_t	*conn = &writer.conns[i];
+
+		if (NULL != conn->bulk)
+		{
+			curl_multi_remove_handle(writer.handle, conn->handle);
+			elastic_bulk_free(conn->bulk);
+			conn->bulk = NULL;
+		}
+
+		curl_easy_cleanup(conn->handle);
+		zbx_free(conn->page.data);
+		memset(&conn->page, 0, sizeof(conn->page));
+	}
 
 	curl_multi_cleanup(writer.handle);
 	writer.handle = NULL;
 
-	zbx_vector_ptr_destroy(&writer.ifaces);
+	curl_slist_free_all(writer.headers);
+	writer.headers = NULL;
+	curl_slist_free_all(writer.headers_gz);
+	writer.headers_gz = NULL;
+
+	zbx_vector_ptr_clear_ext(&writer.bulks, (zbx_clean_func_t)elastic_bulk_free);
+	zbx_vector_ptr_destroy(&writer.bulks);
+	zbx_vector_ptr_clear_ext(&writer.retries, (zbx_clean_func_t)elastic_bulk_free);
+	zbx_vector_ptr_destroy(&writer.retries);
 
 	writer.initialized = 0;
 }
 
 /************************************************************************************
  *                                                                                  *
- * Purpose: adds history storage interface to be flushed later                      *
+ * Purpose: starts sending bulk request over free writer connection                 *
+ *                                                                                  *
+ * Parameters: conn - [IN/OUT] the writer connection                                *
+ *             bulk - [IN] the bulk request                                         *
  *                                                                                  *
- * Parameters: db_insert - [IN] bulk insert data                                    *
+ * Return value: SUCCEED - the request was started                                  *
+ *               FAIL    - otherwise                                                *
  *                                                                                  *
  ************************************************************************************/
-static void	elastic_writer_add_iface(zbx_history_iface_t *hist)
+static int	elastic_writer_send(zbx_elastic_conn_t *conn, zbx_elastic_bulk_t *bulk)
 {
-	zbx_elastic_data_t	*data = hist->data.elastic_data;
+	const char		*body = bulk->body;
+	size_t			body_size = bulk->body_offset;
+	struct curl_slist	*headers = writer.headers;
 	CURLoption		opt;
 	CURLcode		err;
 
-	elastic_writer_init();
-
-	if (NULL == (data->handle = curl_easy_init()))
+#ifdef HAVE_ZLIB
+	if (0 != CONFIG_HISTORY_STORAGE_COMPRESSION &&
+			(NULL != bulk->body_gz || SUCCEED == elastic_bulk_compress(bulk)))
 	{
-		zabbix_log(LOG_LEVEL_ERR, "cannot initialize cURL session");
-		return;
+		body = bulk->body_gz;
+		body_size = bulk->body_gz_size;
+		headers = writer.headers_gz;
 	}
-
-	if (CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_URL, data->post_url)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_POST, 1L)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_POSTFIELDS, data->buf)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_WRITEFUNCTION,
-					curl_write_cb)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_WRITEDATA,
-					&page_w[hist->value_type].page)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_FAILONERROR, 1L)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_ERRORBUFFER,
-					page_w[hist->value_type].errbuf)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = ZBX_CURLOPT_ACCEPT_ENCODING, "")))
+#endif
+	if (CURLE_OK != (err = curl_easy_setopt(conn->handle, opt = CURLOPT_URL, bulk->url)) ||
+			CURLE_OK != (err = curl_easy_setopt(conn->handle, opt = CURLOPT_HTTPHEADER, headers)) ||
+			CURLE_OK != (err = curl_easy_setopt(conn->handle, opt = CURLOPT_POSTFIELDSIZE,
+					(long)body_size)) ||
+			CURLE_OK != (err = curl_easy_setopt(conn->handle, opt = CURLOPT_POSTFIELDS, body)))
 	{
 		zabbix_log(LOG_LEVEL_ERR, "cannot set cURL option %d: [%s]", (int)opt, curl_easy_strerror(err));
-		goto out;
+		return FAIL;
 	}
 
-	*page_w[hist->value_type].errbuf = '\0';
+	zabbix_log(LOG_LEVEL_DEBUG, "sending %d documents to %s", bulk->docs.values_num, bulk->url);
+
+	*conn->errbuf = '\0';
+	conn->page.offset = 0;
 
-	if (CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_PRIVATE, &page_w[hist->value_type])))
+	if (0 < conn->page.alloc)
+		*conn->page.data = '\0';
+
+	conn->bulk = bulk;
+	curl_multi_add_handle(writer.handle, conn->handle);
+
+	return SUCCEED;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: checks per document results of bulk request                             *
+ *                                                                                  *
+ * Parameters: bulk - [IN] the sent bulk request                                    *
+ *             page - [IN] the bulk API response                                    *
+ *                                                                                  *
+ * Return value: bulk request with documents to be retried or NULL                  *
+ *                                                                                  *
+ * Comments: Documents rejected because of elastic storage load or internal errors  *
+ *           (HTTP status 429 or 5xx) are retried, documents rejected for other     *
+ *           reasons (for example mapping errors) are dropped.                      *
+ *                                                                                  *
+ ************************************************************************************/
+static zbx_elastic_bulk_t	*elastic_writer_check_items(const zbx_elastic_bulk_t *bulk, zbx_httppage_t *page)
+{
+	struct zbx_json_parse	jp, jp_values, jp_items, jp_item, jp_index;
+	const char		*errors, *p = NULL;
+	char			status[MAX_ID_LEN + 1];
+	int			i, dropped = 0;
+	zbx_elastic_bulk_t	*retry = NULL;
+
+	if (SUCCEED != zbx_json_open(page->data, &jp) || SUCCEED != zbx_json_brackets_open(jp.start, &jp_values))
+		return NULL;
+
+	if (NULL == (errors = zbx_json_pair_by_name(&jp_values, "errors")) || 0 != strncmp("true", errors, 4))
+		return NULL;
+
+	if (SUCCEED != zbx_json_brackets_by_name(&jp, "items", &jp_items))
 	{
-		zabbix_log(LOG_LEVEL_ERR, "cannot set cURL option %d: [%s]", (int)opt, curl_easy_strerror(err));
-		goto out;
+		char	*error = NULL;
+
+		/* unknown response format, retry the whole request */
+		if (SUCCEED == elastic_is_error_present(page, &error))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %s", error);
+			zbx_free(error);
+		}
+
+		retry = elastic_bulk_create(bulk->url);
+		elastic_bulk_append(retry, bulk->body, bulk->body_offset);
+
+		return retry;
 	}
 
-	page_w[hist->value_type].page.offset = 0;
+	for (i = 0; i < bulk->docs.values_num && NULL != (p = zbx_json_next(&jp_items, p)); i++)
+	{
+		size_t	start, end;
+		int	code;
+
+		if (SUCCEED != zbx_json_brackets_open(p, &jp_item) ||
+				SUCCEED != zbx_json_brackets_by_name(&jp_item, "index", &jp_index) ||
+				SUCCEED != zbx_json_value_by_name(&jp_index, "status", status, sizeof(status), NULL))
+		{
+			continue;
+		}
+
+		if (200 <= (code = atoi(status)) && 300 > code)
+			continue;
 
-	if (0 < page_w[hist->value_type].page.alloc)
-		*page_w[hist->value_type].page.data = '\0';
+		if (429 != code && 500 > code)
+		{
+			if (0 == dropped++)
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %.*s",
+						(int)(jp_index.end - jp_index.start + 1), jp_index.start);
+			}
 
-	curl_multi_add_handle(writer.handle, data->handle);
+			continue;
+		}
 
-	zbx_vector_ptr_append(&writer.ifaces, hist);
+		if (NULL == retry)
+			retry = elastic_bulk_create(bulk->url);
 
-	return;
-out:
-	elastic_close(hist);
+		start = (0 == i ? 0 : (size_t)bulk->docs.values[i - 1]);
+		end = (size_t)bulk->docs.values[i];
+		elastic_bulk_append(retry, bulk->body + start, end - start);
+	}
+
+	if (0 != dropped)
+		zabbix_log(LOG_LEVEL_WARNING, "elasticsearch rejected %d documents", dropped);
+
+	if (NULL != retry)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "elasticsearch failed to store %d documents, retrying",
+				retry->docs.values_num);
+	}
+
+	return retry;
 }
 
 /************************************************************************************
  *                                                                                  *
- * Purpose: posts historical data to elastic storage                                *
+ * Purpose: processes finished bulk request                                         *
+ *                                                                                  *
+ * Parameters: conn   - [IN/OUT] the writer connection                              *
+ *             result - [IN] the transfer result                                    *
  *                                                                                  *
  ************************************************************************************/
-static int	elastic_writer_flush(void)
+static void	elastic_writer_complete(zbx_elastic_conn_t *conn, CURLcode result)
 {
-	struct curl_slist	*curl_headers = NULL;
-	int			i, running, previous, msgnum;
-	CURLMsg			*msg;
-	zbx_vector_ptr_t	retries;
-	CURLcode		err;
-	int			ret = SUCCEED;
-
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+	zbx_elastic_bulk_t	*bulk = conn->bulk, *retry = NULL;
+	long int		response_code = 0;
 
-	/* The writer might be uninitialized only if the history */
-	/* was already flushed. In that case, return SUCCEED */
-	if (0 == writer.initialized)
-		goto end;
+	curl_multi_remove_handle(writer.handle, conn->handle);
+	conn->bulk = NULL;
 
-	zbx_vector_ptr_create(&retries);
+	if (CURLE_HTTP_RETURNED_ERROR == result)
+	{
+		char	http_status[MAX_STRING_LEN];
 
-	curl_headers = curl_slist_append(curl_headers, "Content-Type: application/x-ndjson");
+		if (CURLE_OK == curl_easy_getinfo(conn->handle, CURLINFO_RESPONSE_CODE, &response_code))
+			zbx_snprintf(http_status, sizeof(http_status), "HTTP status code: %ld", response_code);
+		else
+			zbx_strlcpy(http_status, "unknown HTTP status code", sizeof(http_status));
 
-	for (i = 0; i < writer.ifaces.values_num; i++)
-	{
-		zbx_history_iface_t	*hist = (zbx_history_iface_t *)writer.ifaces.values[i];
-		zbx_elastic_data_t	*data = hist->data.elastic_data;
+		zabbix_log(LOG_LEVEL_ERR, "cannot send data to elasticsearch, %s%s%s", http_status,
+				'\0' != *conn->errbuf ? ", HTTP error message: " : "", conn->errbuf);
 
-		if (CURLE_OK != (err = curl_easy_setopt(data->handle, CURLOPT_HTTPHEADER, curl_headers)))
+		/* If the error is due to malformed data, there is no sense on re-trying to send, */
+		/* but overloaded or unavailable storage is retried the same way as transport errors. */
+		if (429 == response_code || 500 <= response_code)
 		{
-			zabbix_log(LOG_LEVEL_ERR, "cannot set cURL option %d: [%s]", (int)CURLOPT_HTTPHEADER,
-					curl_easy_strerror(err));
-			ret = FAIL;
-			goto clean;
+			zbx_vector_ptr_append(&writer.retries, bulk);
+			return;
 		}
+	}
+	else if (CURLE_OK != result)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %s",
+				'\0' != *conn->errbuf ? conn->errbuf : curl_easy_strerror(result));
 
-		zabbix_log(LOG_LEVEL_DEBUG, "sending %s", data->buf);
+		/* If the error is due to curl internal problems or unrelated */
+		/* problems with HTTP, we put the request in a retry list     */
+		zbx_vector_ptr_append(&writer.retries, bulk);
+		return;
 	}
+	else if (NULL != (retry = elastic_writer_check_items(bulk, &conn->page)))
+		zbx_vector_ptr_append(&writer.retries, retry);
 
-try_again:
-	previous = 0;
+	elastic_bulk_free(bulk);
+}
 
-	do
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: posts historical data to elastic storage                                *
+ *                                                                                  *
+ * Comments: Bulk requests are pipelined over a bounded number of connections,      *
+ *           a new request is sent as soon as any of the previous ones completes.   *
+ *           Failed requests and documents are resent after the storage down        *
+ *           timeout until they succeed.                                            *
+ *                                                                                  *
+ ************************************************************************************/
+static int	elastic_writer_flush(void)
+{
+	int	i, running, msgnum, inflight;
+	CURLMsg	*msg;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	/* The writer might have no requests only if the history */
+	/* was already flushed. In that case, return SUCCEED     */
+	if (0 == writer.initialized || 0 == writer.bulks.values_num)
+		goto end;
+
+	while (1)
 	{
 		int		fds;
 		CURLMcode	code;
-		char		*error;
-		zbx_curlpage_t	*curl_page;
 
-		if (CURLM_OK != (code = curl_multi_perform(writer.handle, &running)))
+		inflight = 0;
+
+		for (i = 0; i < ZBX_ELASTIC_REQUESTS_MAX; i++)
 		{
-			zabbix_log(LOG_LEVEL_ERR, "cannot perform on curl multi handle: %s", curl_multi_strerror(code));
-			break;
+			zbx_elastic_conn_t	*conn = &writer.conns[i];
+
+			while (NULL == conn->bulk && 0 != writer.bulks.values_num)
+			{
+				zbx_elastic_bulk_t	*bulk = (zbx_elastic_bulk_t *)writer.bulks.values[0];
+
+				zbx_vector_ptr_remove(&writer.bulks, 0);
+
+				if (SUCCEED != elastic_writer_send(conn, bulk))
+					elastic_bulk_free(bulk);
+			}
+
+			if (NULL != conn->bulk)
+				inflight++;
 		}
 
-		if (CURLM_OK != (code = curl_multi_wait(writer.handle, NULL, 0, ZBX_HISTORY_STORAGE_DOWN, &fds)))
+		if (0 == inflight)
 		{
-			zabbix_log(LOG_LEVEL_ERR, "cannot wait on curl multi handle: %s", curl_multi_strerror(code));
-			break;
-		}
+			if (0 == writer.retries.values_num)
+				break;
 
-		if (previous == running)
+			/* We have requests to retry, put them back in the queue and start */
+			/* sending again after sleeping for ZBX_HISTORY_STORAGE_DOWN / 1000 */
+			zbx_vector_ptr_append_array(&writer.bulks, writer.retries.values, writer.retries.values_num);
+			zbx_vector_ptr_clear(&writer.retries);
+
+			sleep(ZBX_HISTORY_STORAGE_DOWN / 1000);
 			continue;
+		}
+
+		if (CURLM_OK != (code = curl_multi_perform(writer.handle, &running)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot perform on curl multi handle: %s", curl_multi_strerror(code));
+			break;
+		}
 
 		while (NULL != (msg = curl_multi_info_read(writer.handle, &msgnum)))
 		{
-			/* If the error is due to malformed data, there is no sense on re-trying to send. */
-			/* That's why we actually check for transport and curl errors separately */
-			if (CURLE_HTTP_RETURNED_ERROR == msg->data.result)
-			{
-				if (CURLE_OK == curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE,
-						(char **)&curl_page) && '\0' != *curl_page->errbuf)
-				{
-					zabbix_log(LOG_LEVEL_ERR, "cannot send data to elasticsearch, HTTP error"
-							" message: %s", curl_page->errbuf);
-				}
-				else
-				{
-					char		http_status[MAX_STRING_LEN];
-					long int	response_code;
-
-					if (CURLE_OK == curl_easy_getinfo(msg->easy_handle,
-							CURLINFO_RESPONSE_CODE, &response_code))
-					{
-						zbx_snprintf(http_status, sizeof(http_status), "HTTP status code: %ld",
-								response_code);
-					}
-					else
-					{
-						zbx_strlcpy(http_status, "unknown HTTP status code",
-								sizeof(http_status));
-					}
-
-					zabbix_log(LOG_LEVEL_ERR, "cannot send data to elasticsearch, %s", http_status);
-				}
-			}
-			else if (CURLE_OK != msg->data.result)
-			{
-				if (CURLE_OK == curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE,
-						(char **)&curl_page) && '\0' != *curl_page->errbuf)
-				{
-					zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %s",
-							curl_page->errbuf);
-				}
-				else
-				{
-					zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %s",
-							curl_easy_strerror(msg->data.result));
-				}
-
-				/* If the error is due to curl internal problems or unrelated */
-				/* problems with HTTP, we put the handle in a retry list and */
-				/* remove it from the current execution loop */
-				zbx_vector_ptr_append(&retries, msg->easy_handle);
-				curl_multi_remove_handle(writer.handle, msg->easy_handle);
-			}
-			else if (CURLE_OK == curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&curl_page)
-					&& SUCCEED == elastic_is_error_present(&curl_page->page, &error))
+			zbx_elastic_conn_t	*conn;
+
+			if (CURLMSG_DONE != msg->msg ||
+					CURLE_OK != curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&conn))
 			{
-				zabbix_log(LOG_LEVEL_WARNING, "%s() cannot send data to elasticsearch: %s",
-						__func__, error);
-				zbx_free(error);
-
-				/* If the error is due to elastic internal problems (for example an index */
-				/* became read-only), we put the handle in a retry list and */
-				/* remove it from the current execution loop */
-				zbx_vector_ptr_append(&retries, msg->easy_handle);
-				curl_multi_remove_handle(writer.handle, msg->easy_handle);
+				continue;
 			}
-		}
-
-		previous = running;
-	}
-	while (running);
 
-	/* We check if we have handles to retry. If yes, we put them back in the multi */
-	/* handle and go to the beginning of the do while() for try sending the data again */
-	/* after sleeping for ZBX_HISTORY_STORAGE_DOWN / 1000 (seconds) */
-	if (0 < retries.values_num)
-	{
-		for (i = 0; i < retries.values_num; i++)
-			curl_multi_add_handle(writer.handle, retries.values[i]);
+			elastic_writer_complete(conn, msg->data.result);
+		}
 
-		zbx_vector_ptr_clear(&retries);
+		/* start the queued requests without waiting if any of the requests completed */
+		if (running < inflight)
+			continue;
 
-		sleep(ZBX_HISTORY_STORAGE_DOWN / 1000);
-		goto try_again;
+		if (CURLM_OK != (code = curl_multi_wait(writer.handle, NULL, 0, ZBX_HISTORY_STORAGE_DOWN, &fds)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot wait on curl multi handle: %s", curl_multi_strerror(code));
+			break;
+		}
 	}
-clean:
-	curl_slist_free_all(curl_headers);
-
-	zbx_vector_ptr_destroy(&retries);
-
-	elastic_writer_release();
 
+	/* drop the requests that could not be sent because of cURL multi handle failure, */
+	/* the writer is reinitialized on the next flush                                 */
+	if (0 != inflight)
+		elastic_writer_release();
 end:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 
-	return ret;
+	return SUCCEED;
 }
 
 /******************************************************************************************************************
@@ -600,8 +858,12 @@ static void	elastic_destroy(zbx_history_iface_t *hist)
 
 	elastic_close(hist);
 
+	zbx_free(data->bulk_url);
 	zbx_free(data->base_url);
 	zbx_free(data);
+
+	if (0 == --writer.ifaces_num)
+		elastic_writer_release();
 }
 
 /************************************************************************************
@@ -631,7 +893,7 @@ static int	elastic_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, in
 	CURLcode		err;
 	struct zbx_json		query;
 	struct curl_slist	*curl_headers = NULL;
-	char			*scroll_id = NULL, *scroll_query = NULL, errbuf[CURL_ERROR_SIZE];
+	char			*url = NULL, *scroll_id = NULL, *scroll_query = NULL, errbuf[CURL_ERROR_SIZE];
 	CURLoption		opt;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
@@ -645,7 +907,7 @@ static int	elastic_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, in
 		return FAIL;
 	}
 
-	zbx_snprintf_alloc(&data->post_url, &url_alloc, &url_offset, "%s/%s*/_search?scroll=10s", data->base_url,
+	zbx_snprintf_alloc(&url, &url_alloc, &url_offset, "%s/%s*/_search?scroll=10s", data->base_url,
 			value_type_str[hist->value_type]);
 
 	/* prepare the json query for elasticsearch, apply ranges if needed */
@@ -693,7 +955,7 @@ static int	elastic_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, in
 
 	curl_headers = curl_slist_append(curl_headers, "Content-Type: application/json");
 
-	if (CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_URL, data->post_url)) ||
+	if (CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_URL, url)) ||
 			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_POSTFIELDS, query.buffer)) ||
 			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_WRITEFUNCTION,
 					curl_write_cb)) ||
@@ -707,7 +969,7 @@ static int	elastic_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, in
 		goto out;
 	}
 
-	zabbix_log(LOG_LEVEL_DEBUG, "sending query to %s; post data: %s", data->post_url, query.buffer);
+	zabbix_log(LOG_LEVEL_DEBUG, "sending query to %s; post data: %s", url, query.buffer);
 
 	page_r.offset = 0;
 	*errbuf = '\0';
@@ -718,9 +980,9 @@ static int	elastic_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, in
 	}
 
 	url_offset = 0;
-	zbx_snprintf_alloc(&data->post_url, &url_alloc, &url_offset, "%s/_search/scroll", data->base_url);
+	zbx_snprintf_alloc(&url, &url_alloc, &url_offset, "%s/_search/scroll", data->base_url);
 
-	if (CURLE_OK != (err = curl_easy_setopt(data->handle, CURLOPT_URL, data->post_url)))
+	if (CURLE_OK != (err = curl_easy_setopt(data->handle, CURLOPT_URL, url)))
 	{
 		zabbix_log(LOG_LEVEL_ERR, "cannot set cURL option %d: [%s]", (int)CURLOPT_URL,
 				curl_easy_strerror(err));
@@ -812,10 +1074,10 @@ static int	elastic_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, in
 	if (NULL != scroll_id)
 	{
 		url_offset = 0;
-		zbx_snprintf_alloc(&data->post_url, &url_alloc, &url_offset, "%s/_search/scroll/%s", data->base_url,
+		zbx_snprintf_alloc(&url, &url_alloc, &url_offset, "%s/_search/scroll/%s", data->base_url,
 				scroll_id);
 
-		if (CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_URL, data->post_url)) ||
+		if (CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_URL, url)) ||
 				CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_POSTFIELDS, "")) ||
 				CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_CUSTOMREQUEST, "DELETE")))
 		{
@@ -825,7 +1087,7 @@ static int	elastic_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, in
 			goto out;
 		}
 
-		zabbix_log(LOG_LEVEL_DEBUG, "elasticsearch closing scroll %s", data->post_url);
+		zabbix_log(LOG_LEVEL_DEBUG, "elasticsearch closing scroll %s", url);
 
 		page_r.offset = 0;
 		*errbuf = '\0';
@@ -840,6 +1102,7 @@ out:
 
 	zbx_json_free(&query);
 
+	zbx_free(url);
 	zbx_free(scroll_id);
 	zbx_free(scroll_query);
 
@@ -864,11 +1127,15 @@ static int	elastic_add_values(zbx_history_iface_t *hist, const zbx_vector_ptr_t
 	int			i, num = 0;
 	ZBX_DC_HISTORY		*h;
 	struct zbx_json		json_idx, json;
-	size_t			buf_alloc = 0, buf_offset = 0;
+	char			*buf = NULL;
+	size_t			buf_alloc = 0, buf_offset;
 	char			pipeline[14]; /* index name length + suffix "-pipeline" */
+	zbx_elastic_bulk_t	*bulk = NULL;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
+	elastic_writer_init();
+
 	zbx_json_init(&json_idx, ZBX_IDX_JSON_ALLOCATE);
 
 	zbx_json_addobject(&json_idx, "index");
@@ -914,19 +1181,24 @@ static int	elastic_add_values(zbx_history_iface_t *hist, const zbx_vector_ptr_t
 
 		zbx_json_close(&json);
 
-		zbx_snprintf_alloc(&data->buf, &buf_alloc, &buf_offset, "%s\n%s\n", json_idx.buffer, json.buffer);
+		buf_offset = 0;
+		zbx_snprintf_alloc(&buf, &buf_alloc, &buf_offset, "%s\n%s\n", json_idx.buffer, json.buffer);
 
 		zbx_json_free(&json);
 
-		num++;
-	}
+		/* split values into several bulk requests to send them in parallel */
+		if (NULL == bulk || ZBX_ELASTIC_BULK_SIZE_MAX < bulk->body_offset + buf_offset)
+		{
+			bulk = elastic_bulk_create(data->bulk_url);
+			zbx_vector_ptr_append(&writer.bulks, bulk);
+		}
 
-	if (num > 0)
-	{
-		data->post_url = zbx_dsprintf(NULL, "%s/_bulk?refresh=true", data->base_url);
-		elastic_writer_add_iface(hist);
+		elastic_bulk_append(bulk, buf, buf_offset);
+
+		num++;
 	}
 
+	zbx_free(buf);
 	zbx_json_free(&json_idx);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
@@ -977,16 +1249,18 @@ int	zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type
 	memset(data, 0, sizeof(zbx_elastic_data_t));
 	data->base_url = zbx_strdup(NULL, CONFIG_HISTORY_STORAGE_URL);
 	zbx_rtrim(data->base_url, "/");
-	data->buf = NULL;
-	data->post_url = NULL;
+	data->bulk_url = zbx_dsprintf(NULL, "%s/_bulk?refresh=true", data->base_url);
 	data->handle = NULL;
 
+	writer.ifaces_num++;
+
 	hist->value_type = value_type;
 	hist->data.elastic_data = data;
 	hist->destroy = elastic_destroy;
 	hist->add_values = elastic_add_values;
 	hist->flush = elastic_flush;
 	hist->get_values = elastic_get_values;
+	hist->count_values = NULL;
 	hist->requires_trends = 0;
 
 	return SUCCEED;
@@ -121,9 +121,9 @@ static void	sql_writer_release(void)
 
 	for (i = 0; i < writer.dbinserts.values_num; i++)
 	{
-		zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)writer.dbinserts.values[i];
+		zbx_db_colinsert_t	*db_insert = (zbx_db_colinsert_t *)writer.dbinserts.values[i];
 
-		zbx_db_insert_clean(db_insert);
+		zbx_db_colinsert_clean(db_insert);
 		zbx_free(db_insert);
 	}
 	zbx_vector_ptr_clear(&writer.dbinserts);
@@ -139,7 +139,7 @@ static void	sql_writer_release(void)
  * Parameters: db_insert - [IN] bulk insert data                                    *
  *                                                                                  *
  ************************************************************************************/
-static void	sql_writer_add_dbinsert(zbx_db_insert_t *db_insert)
+static void	sql_writer_add_dbinsert(zbx_db_colinsert_t *db_insert)
 {
 	sql_writer_init();
 	zbx_vector_ptr_append(&writer.dbinserts, db_insert);
@@ -165,8 +165,8 @@ static int	sql_writer_flush(void)
 
 		for (i = 0; i < writer.dbinserts.values_num; i++)
 		{
-			zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)writer.dbinserts.values[i];
-			zbx_db_insert_execute(db_insert);
+			zbx_db_colinsert_t	*db_insert = (zbx_db_colinsert_t *)writer.dbinserts.values[i];
+			zbx_db_colinsert_execute(db_insert);
 		}
 	}
 	while (ZBX_DB_DOWN == (txn_error = DBcommit()));
@@ -194,11 +194,12 @@ static int	sql_writer_flush(void)
 
 static void	add_history_dbl(const zbx_vector_ptr_t *history)
 {
-	int		i;
-	zbx_db_insert_t	*db_insert;
+	int			i;
+	zbx_db_colinsert_t	*db_insert;
 
-	db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
-	zbx_db_insert_prepare(db_insert, "history", "itemid", "clock", "ns", "value", NULL);
+	db_insert = (zbx_db_colinsert_t *)zbx_malloc(NULL, sizeof(zbx_db_colinsert_t));
+	zbx_db_colinsert_prepare(db_insert, "history", "itemid", "clock", "ns", "value", NULL);
+	zbx_db_colinsert_reserve(db_insert, history->values_num);
 
 	for (i = 0; i < history->values_num; i++)
 	{
@@ -207,7 +208,7 @@ static void	add_history_dbl(const zbx_vector_ptr_t *history)
 		if (ITEM_VALUE_TYPE_FLOAT != h->value_type)
 			continue;
 
-		zbx_db_insert_add_values(db_insert, h->itemid, h->ts.sec, h->ts.ns, h->value.dbl);
+		zbx_db_colinsert_add_values(db_insert, h->itemid, h->ts.sec, h->ts.ns, h->value.dbl);
 	}
 
 	sql_writer_add_dbinsert(db_insert);
@@ -215,11 +216,12 @@ static void	add_history_dbl(const zbx_vector_ptr_t *history)
 
 static void	add_history_uint(const zbx_vector_ptr_t *history)
 {
-	int		i;
-	zbx_db_insert_t	*db_insert;
+	int			i;
+	zbx_db_colinsert_t	*db_insert;
 
-	db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
-	zbx_db_insert_prepare(db_insert, "history_uint", "itemid", "clock", "ns", "value", NULL);
+	db_insert = (zbx_db_colinsert_t *)zbx_malloc(NULL, sizeof(zbx_db_colinsert_t));
+	zbx_db_colinsert_prepare(db_insert, "history_uint", "itemid", "clock", "ns", "value", NULL);
+	zbx_db_colinsert_reserve(db_insert, history->values_num);
 
 	for (i = 0; i < history->values_num; i++)
 	{
@@ -228,7 +230,7 @@ static void	add_history_uint(const zbx_vector_ptr_t *history)
 		if (ITEM_VALUE_TYPE_UINT64 != h->value_type)
 			continue;
 
-		zbx_db_insert_add_values(db_insert, h->itemid, h->ts.sec, h->ts.ns, h->value.ui64);
+		zbx_db_colinsert_add_values(db_insert, h->itemid, h->ts.sec, h->ts.ns, h->value.ui64);
 	}
 
 	sql_writer_add_dbinsert(db_insert);
@@ -236,11 +238,12 @@ static void	add_history_uint(const zbx_vector_ptr_t *history)
 
 static void	add_history_str(const zbx_vector_ptr_t *history)
 {
-	int		i;
-	zbx_db_insert_t	*db_insert;
+	int			i;
+	zbx_db_colinsert_t	*db_insert;
 
-	db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
-	zbx_db_insert_prepare(db_insert, "history_str", "itemid", "clock", "ns", "value", NULL);
+	db_insert = (zbx_db_colinsert_t *)zbx_malloc(NULL, sizeof(zbx_db_colinsert_t));
+	zbx_db_colinsert_prepare(db_insert, "history_str", "itemid", "clock", "ns", "value", NULL);
+	zbx_db_colinsert_reserve(db_insert, history->values_num);
 
 	for (i = 0; i < history->values_num; i++)
 	{
@@ -249,7 +252,7 @@ static void	add_history_str(const zbx_vector_ptr_t *history)
 		if (ITEM_VALUE_TYPE_STR != h->value_type)
 			continue;
 
-		zbx_db_insert_add_values(db_insert, h->itemid, h->ts.sec, h->ts.ns, h->value.str);
+		zbx_db_colinsert_add_values(db_insert, h->itemid, h->ts.sec, h->ts.ns, h->value.str);
 	}
 
 	sql_writer_add_dbinsert(db_insert);
@@ -257,11 +260,12 @@ static void	add_history_str(const zbx_vector_ptr_t *history)
 
 static void	add_history_text(const zbx_vector_ptr_t *history)
 {
-	int		i;
-	zbx_db_insert_t	*db_insert;
+	int			i;
+	zbx_db_colinsert_t	*db_insert;
 
-	db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
-	zbx_db_insert_prepare(db_insert, "history_text", "itemid", "clock", "ns", "value", NULL);
+	db_insert = (zbx_db_colinsert_t *)zbx_malloc(NULL, sizeof(zbx_db_colinsert_t));
+	zbx_db_colinsert_prepare(db_insert, "history_text", "itemid", "clock", "ns", "value", NULL);
+	zbx_db_colinsert_reserve(db_insert, history->values_num);
 
 	for (i = 0; i < history->values_num; i++)
 	{
@@ -270,7 +274,7 @@ static void	add_history_text(const zbx_vector_ptr_t *history)
 		if (ITEM_VALUE_TYPE_TEXT != h->value_type)
 			continue;
 
-		zbx_db_insert_add_values(db_insert, h->itemid, h->ts.sec, h->ts.ns, h->value.str);
+		zbx_db_colinsert_add_values(db_insert, h->itemid, h->ts.sec, h->ts.ns, h->value.str);
 	}
 
 	sql_writer_add_dbinsert(db_insert);
@@ -279,11 +283,12 @@ static void	add_history_text(const zbx_vector_ptr_t *history)
 static void	add_history_log(const zbx_vector_ptr_t *history)
 {
 	int			i;
-	zbx_db_insert_t	*db_insert;
+	zbx_db_colinsert_t	*db_insert;
 
-	db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
-	zbx_db_insert_prepare(db_insert, "history_log", "itemid", "clock", "ns", "timestamp", "source", "severity",
+	db_insert = (zbx_db_colinsert_t *)zbx_malloc(NULL, sizeof(zbx_db_colinsert_t));
+	zbx_db_colinsert_prepare(db_insert, "history_log", "itemid", "clock", "ns", "timestamp", "source", "severity",
 			"value", "logeventid", NULL);
+	zbx_db_colinsert_reserve(db_insert, history->values_num);
 
 	for (i = 0; i < history->values_num; i++)
 	{
@@ -295,7 +300,7 @@ static void	add_history_log(const zbx_vector_ptr_t *history)
 
 		log = h->value.log;
 
-		zbx_db_insert_add_values(db_insert, h->itemid, h->ts.sec, h->ts.ns, log->timestamp,
+		zbx_db_colinsert_add_values(db_insert, h->itemid, h->ts.sec, h->ts.ns, log->timestamp,
 				ZBX_NULL2EMPTY_STR(log->source), log->severity, log->value, log->logeventid);
 	}
 
@@ -570,6 +575,44 @@ out:
 	return ret;
 }
 
+/*********************************************************************************
+ *                                                                               *
+ * Purpose: counts item history values in database                               *
+ *                                                                               *
+ * Parameters:  itemid        - [IN] the itemid                                  *
+ *              value_type    - [IN] the value type (see ITEM_VALUE_TYPE_* defs) *
+ *              seconds       - [IN] the time period to count                    *
+ *              end_timestamp - [IN] the period end timestamp                    *
+ *              count         - [OUT] the number of values                       *
+ *                                                                               *
+ * Return value: SUCCEED - the history values were counted successfully         *
+ *               FAIL - otherwise                                                *
+ *                                                                               *
+ *********************************************************************************/
+static int	db_count_values_by_time(zbx_uint64_t itemid, int value_type, int seconds, int end_timestamp,
+		int *count)
+{
+	DB_RESULT		result;
+	DB_ROW			row;
+	zbx_vc_history_table_t	*table = &vc_history_tables[value_type];
+
+	result = DBselect(
+			"select count(*)"
+			" from %s"
+			" where itemid=" ZBX_FS_UI64
+				" and clock>%d and clock<=%d",
+			table->name, itemid, end_timestamp - seconds, end_timestamp);
+
+	if (NULL == result)
+		return FAIL;
+
+	*count = (NULL != (row = DBfetch(result)) ? atoi(row[0]) : 0);
+
+	DBfree_result(result);
+
+	return SUCCEED;
+}
+
 /******************************************************************************************************************
  *                                                                                                                *
  * history interface support                                                                                      *
@@ -618,6 +661,25 @@ static int	sql_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, int st
 	return db_read_values_by_time_and_count(itemid, hist->value_type, values, end - start, count, end);
 }
 
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: counts item history values in history storage                           *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *              itemid  - [IN] the itemid                                           *
+ *              start   - [IN] the period start timestamp                           *
+ *              end     - [IN] the period end timestamp                             *
+ *              count   - [OUT] the number of values                                *
+ *                                                                                  *
+ * Return value: SUCCEED - the history values were counted successfully             *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ ************************************************************************************/
+static int	sql_count_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, int start, int end, int *count)
+{
+	return db_count_values_by_time(itemid, hist->value_type, end - start, end, count);
+}
+
 /************************************************************************************
  *                                                                                  *
  * Purpose: sends history data to the storage                                       *
@@ -683,6 +745,7 @@ int	zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type, ch
 	hist->add_values = sql_add_values;
 	hist->flush = sql_flush;
 	hist->get_values = sql_get_values;
+	hist->count_values = sql_count_values;
 
 	switch (value_type)
 	{
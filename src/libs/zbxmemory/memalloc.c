@@ -82,6 +82,24 @@
  *  lo_bound             `size' fields in chunk B                   hi_bound  *
  *  (aligned)            have MEM_FLG_USED bit set                 (aligned)  *
  *                                                                            *
+ * (*) slab: a used chunk of MEM_SLAB_SIZE bytes split into objects of the    *
+ *     same size, used for allocations up to MEM_SLAB_MAX_SIZE bytes when     *
+ *     slabs are enabled                                                      *
+ *                                                                            *
+ *                     +---- offset ----+                                     *
+ *                     |                v                                     *
+ *                                                                            *
+ *      |--------|-----------|--------|-------|--------|-------|...           *
+ *        size     slab        offset   object  offset   object               *
+ *                 header                                                     *
+ *                                                                            *
+ *     each object is prefixed with 8 bytes containing MEM_FLG_USED and       *
+ *     MEM_FLG_SLAB bits and the object offset from the slab header, free     *
+ *     objects contain pointer to the next free object in the same slab       *
+ *                                                                            *
+ *     slabs having free objects are stored in doubly-linked lists according  *
+ *     to their object size, full slabs are not linked anywhere               *
+ *                                                                            *
  ******************************************************************************/
 
 static void	*ALIGN4(void *ptr);
@@ -108,6 +126,11 @@ static void	*__mem_malloc(zbx_mem_info_t *info, zbx_uint64_t size);
 static void	*__mem_realloc(zbx_mem_info_t *info, void *old, zbx_uint64_t size);
 static void	__mem_free(zbx_mem_info_t *info, void *ptr);
 
+static void	*mem_malloc(zbx_mem_info_t *info, zbx_uint64_t size);
+static void	*mem_slab_malloc(zbx_mem_info_t *info, zbx_uint64_t size);
+static void	*mem_slab_realloc(zbx_mem_info_t *info, void *object, zbx_uint64_t size);
+static void	mem_slab_free(zbx_mem_info_t *info, void *object);
+
 #define MEM_SIZE_FIELD		sizeof(zbx_uint64_t)
 
 #define MEM_FLG_USED		((__UINT64_C(1))<<63)
@@ -118,6 +141,24 @@ static void	__mem_free(zbx_mem_info_t *info, void *ptr);
 #define MEM_MIN_SIZE		__UINT64_C(128)
 #define MEM_MAX_SIZE		__UINT64_C(0x1000000000)	/* 64 GB */
 
+#define MEM_FLG_SLAB		((__UINT64_C(1))<<62)
+
+#define SLAB_OBJECT(ptr)	(((*(zbx_uint64_t *)(ptr)) & MEM_FLG_SLAB) != 0)
+#define SLAB_OFFSET(ptr)	((*(zbx_uint64_t *)(ptr)) & ~(MEM_FLG_USED | MEM_FLG_SLAB))
+
+#define MEM_SLAB_SIZE		4096
+
+typedef struct mem_slab
+{
+	struct mem_slab	*prev;
+	struct mem_slab	*next;
+	void		*free_objects;
+	unsigned int	object_size;
+	unsigned int	objects_num;
+	unsigned int	used_num;
+}
+mem_slab_t;
+
 /* helper functions */
 
 static void	*ALIGN4(void *ptr)
@@ -325,9 +366,12 @@ static void	*__mem_realloc(zbx_mem_info_t *info, void *old, zbx_uint64_t size)
 	zbx_uint64_t	chunk_size, new_chunk_size;
 	int		next_free;
 
-	size = mem_proper_alloc_size(size);
-
 	chunk = (void *)((char *)old - MEM_SIZE_FIELD);
+
+	if (SLAB_OBJECT(chunk))
+		return mem_slab_realloc(info, chunk, size);
+
+	size = mem_proper_alloc_size(size);
 	chunk_size = CHUNK_SIZE(chunk);
 
 	next_chunk = (void *)((char *)chunk + MEM_SIZE_FIELD + chunk_size + MEM_SIZE_FIELD);
@@ -524,6 +568,175 @@ static void	__mem_free(zbx_mem_info_t *info, void *ptr)
 	}
 }
 
+/* slab functions */
+
+static int	mem_slab_by_size(zbx_uint64_t size)
+{
+	return (size - 1) >> 3;
+}
+
+static void	mem_slab_link(zbx_mem_info_t *info, mem_slab_t *slab)
+{
+	int	index;
+
+	index = mem_slab_by_size(slab->object_size);
+
+	if (NULL != info->slabs[index])
+		((mem_slab_t *)info->slabs[index])->prev = slab;
+
+	slab->prev = NULL;
+	slab->next = (mem_slab_t *)info->slabs[index];
+
+	info->slabs[index] = slab;
+}
+
+static void	mem_slab_unlink(zbx_mem_info_t *info, mem_slab_t *slab)
+{
+	if (NULL != slab->prev)
+		slab->prev->next = slab->next;
+	else
+		info->slabs[mem_slab_by_size(slab->object_size)] = slab->next;
+
+	if (NULL != slab->next)
+		slab->next->prev = slab->prev;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocate new slab and split it into free objects                  *
+ *                                                                            *
+ * Parameters: info        - [IN] the memory information                      *
+ *             object_size - [IN] the slab object size                        *
+ *                                                                            *
+ * Return value: The allocated slab or NULL if there is not enough memory.    *
+ *                                                                            *
+ ******************************************************************************/
+static mem_slab_t	*mem_slab_create(zbx_mem_info_t *info, unsigned int object_size)
+{
+	mem_slab_t	*slab;
+	void		*chunk;
+	char		*object;
+	unsigned int	i;
+	zbx_uint64_t	free_size;
+
+	if (NULL == (chunk = __mem_malloc(info, MEM_SLAB_SIZE)))
+		return NULL;
+
+	slab = (mem_slab_t *)((char *)chunk + MEM_SIZE_FIELD);
+	object = (char *)ALIGN8(slab + 1);
+
+	slab->object_size = object_size;
+	slab->objects_num = (MEM_SLAB_SIZE - (object - (char *)slab)) / (MEM_SIZE_FIELD + object_size);
+	slab->used_num = 0;
+	slab->free_objects = NULL;
+
+	/* link objects in the order of their addresses */
+	object += (slab->objects_num - 1) * (MEM_SIZE_FIELD + object_size);
+
+	for (i = 0; i < slab->objects_num; i++)
+	{
+		*(zbx_uint64_t *)object = MEM_FLG_USED | MEM_FLG_SLAB | (zbx_uint64_t)(object - (char *)slab);
+		*(void **)(object + MEM_SIZE_FIELD) = slab->free_objects;
+		slab->free_objects = object;
+		object -= MEM_SIZE_FIELD + object_size;
+	}
+
+	/* the slab is used heap memory, its free objects are accounted separately */
+	free_size = (zbx_uint64_t)slab->objects_num * object_size;
+	info->slab_free_size += free_size;
+	info->slabs_num++;
+
+	mem_slab_link(info, slab);
+
+	return slab;
+}
+
+static void	mem_slab_destroy(zbx_mem_info_t *info, mem_slab_t *slab)
+{
+	zbx_uint64_t	free_size;
+
+	mem_slab_unlink(info, slab);
+
+	free_size = (zbx_uint64_t)slab->objects_num * slab->object_size;
+	info->slab_free_size -= free_size;
+	info->slabs_num--;
+
+	__mem_free(info, slab);
+}
+
+static void	*mem_slab_malloc(zbx_mem_info_t *info, zbx_uint64_t size)
+{
+	mem_slab_t	*slab;
+	void		*object;
+
+	if (NULL == (slab = (mem_slab_t *)info->slabs[mem_slab_by_size(size)]) &&
+			NULL == (slab = mem_slab_create(info, (mem_slab_by_size(size) + 1) << 3)))
+	{
+		return NULL;
+	}
+
+	object = slab->free_objects;
+	slab->free_objects = *(void **)((char *)object + MEM_SIZE_FIELD);
+
+	if (++slab->used_num == slab->objects_num)
+		mem_slab_unlink(info, slab);
+
+	info->slab_free_size -= slab->object_size;
+
+	return object;
+}
+
+static void	*mem_slab_realloc(zbx_mem_info_t *info, void *object, zbx_uint64_t size)
+{
+	mem_slab_t	*slab;
+	void		*chunk;
+
+	slab = (mem_slab_t *)((char *)object - SLAB_OFFSET(object));
+
+	if (size <= slab->object_size)
+		return object;
+
+	if (NULL == (chunk = mem_malloc(info, size)))
+		return NULL;
+
+	memcpy((char *)chunk + MEM_SIZE_FIELD, (char *)object + MEM_SIZE_FIELD, slab->object_size);
+	mem_slab_free(info, object);
+
+	return chunk;
+}
+
+static void	mem_slab_free(zbx_mem_info_t *info, void *object)
+{
+	mem_slab_t	*slab;
+
+	slab = (mem_slab_t *)((char *)object - SLAB_OFFSET(object));
+
+	*(void **)((char *)object + MEM_SIZE_FIELD) = slab->free_objects;
+	slab->free_objects = object;
+
+	info->slab_free_size += slab->object_size;
+
+	if (slab->used_num-- == slab->objects_num)
+	{
+		mem_slab_link(info, slab);
+		return;
+	}
+
+	/* release empty slab unless it is the only one with free objects of this size */
+	if (0 == slab->used_num && (NULL != slab->prev || NULL != slab->next))
+		mem_slab_destroy(info, slab);
+}
+
+static void	*mem_malloc(zbx_mem_info_t *info, zbx_uint64_t size)
+{
+	void	*chunk;
+
+	if (0 != info->use_slabs && MEM_SLAB_MAX_SIZE >= size && NULL != (chunk = mem_slab_malloc(info, size)))
+		return chunk;
+
+	return __mem_malloc(info, size);
+}
+
 /* public memory interface */
 
 int	zbx_mem_create(zbx_mem_info_t **info, zbx_uint64_t size, const char *descr, const char *param, int allow_oom,
@@ -586,6 +799,11 @@ int	zbx_mem_create(zbx_mem_info_t **info, zbx_uint64_t size, const char *descr,
 	size -= (char *)((*info)->buckets + MEM_BUCKET_COUNT) - (char *)base;
 	base = (void *)((*info)->buckets + MEM_BUCKET_COUNT);
 
+	(*info)->slabs = (void **)base;
+	memset((*info)->slabs, 0, MEM_SLAB_COUNT * ZBX_PTR_SIZE);
+	size -= MEM_SLAB_COUNT * ZBX_PTR_SIZE;
+	base = (void *)((*info)->slabs + MEM_SLAB_COUNT);
+
 	zbx_strlcpy((char *)base, descr, size);
 	(*info)->mem_descr = (char *)base;
 	size -= strlen(descr) + 1;
@@ -597,6 +815,7 @@ int	zbx_mem_create(zbx_mem_info_t **info, zbx_uint64_t size, const char *descr,
 	base = (void *)((char *)base + strlen(param) + 1);
 
 	(*info)->allow_oom = allow_oom;
+	(*info)->use_slabs = 0;
 
 	/* prepare shared memory for further allocation by creating one big chunk */
 	(*info)->lo_bound = ALIGN8(base);
@@ -613,6 +832,8 @@ int	zbx_mem_create(zbx_mem_info_t **info, zbx_uint64_t size, const char *descr,
 
 	(*info)->used_size = 0;
 	(*info)->free_size = (*info)->total_size;
+	(*info)->slab_free_size = 0;
+	(*info)->slabs_num = 0;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "valid user addresses: [%p, %p] total size: " ZBX_FS_SIZE_T,
 			(void *)((char *)(*info)->lo_bound + MEM_SIZE_FIELD),
@@ -647,7 +868,7 @@ void	*__zbx_mem_malloc(const char *file, int line, zbx_mem_info_t *info, const v
 		exit(EXIT_FAILURE);
 	}
 
-	chunk = __mem_malloc(info, size);
+	chunk = mem_malloc(info, size);
 
 	if (NULL == chunk)
 	{
@@ -680,7 +901,7 @@ void	*__zbx_mem_realloc(const char *file, int line, zbx_mem_info_t *info, void *
 	}
 
 	if (NULL == old)
-		chunk = __mem_malloc(info, size);
+		chunk = mem_malloc(info, size);
 	else
 		chunk = __mem_realloc(info, old, size);
 
@@ -711,7 +932,10 @@ void	__zbx_mem_free(const char *file, int line, zbx_mem_info_t *info, void *ptr)
 		exit(EXIT_FAILURE);
 	}
 
-	__mem_free(info, ptr);
+	if (SLAB_OBJECT((char *)ptr - MEM_SIZE_FIELD))
+		mem_slab_free(info, (char *)ptr - MEM_SIZE_FIELD);
+	else
+		__mem_free(info, ptr);
 }
 
 void	zbx_mem_clear(zbx_mem_info_t *info)
@@ -726,12 +950,31 @@ void	zbx_mem_clear(zbx_mem_info_t *info)
 	mem_set_chunk_size(info->buckets[index], info->total_size);
 	mem_set_prev_chunk(info->buckets[index], NULL);
 	mem_set_next_chunk(info->buckets[index], NULL);
+	memset(info->slabs, 0, MEM_SLAB_COUNT * ZBX_PTR_SIZE);
 	info->used_size = 0;
 	info->free_size = info->total_size;
+	info->slab_free_size = 0;
+	info->slabs_num = 0;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: serve small allocations from slabs                                *
+ *                                                                            *
+ * Parameters: info - [IN] the memory information                             *
+ *                                                                            *
+ * Comments: Slabs reduce per allocation overhead and fragmentation of the    *
+ *           shared memory caused by frequently allocated and freed small     *
+ *           objects. Must be called before any allocations are made.         *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_mem_enable_slabs(zbx_mem_info_t *info)
+{
+	info->use_slabs = 1;
+}
+
 void	zbx_mem_get_stats(const zbx_mem_info_t *info, zbx_mem_stats_t *stats)
 {
 	void		*chunk;
@@ -763,6 +1006,8 @@ void	zbx_mem_get_stats(const zbx_mem_info_t *info, zbx_mem_stats_t *stats)
 	stats->used_chunks = stats->overhead / (2 * MEM_SIZE_FIELD) + 1 - stats->free_chunks;
 	stats->free_size = info->free_size;
 	stats->used_size = info->used_size;
+	stats->slab_free_size = info->slab_free_size;
+	stats->slabs_num = info->slabs_num;
 }
 
 void	zbx_mem_dump_stats(int level, zbx_mem_info_t *info)
@@ -796,6 +1041,12 @@ void	zbx_mem_dump_stats(int level, zbx_mem_info_t *info)
 	zabbix_log(level, "of those, %10llu bytes are used by allocation overhead",
 			(unsigned long long)stats.overhead);
 
+	if (0 != info->use_slabs)
+	{
+		zabbix_log(level, "%llu slabs with %llu bytes in free objects",
+				(unsigned long long)stats.slabs_num, (unsigned long long)stats.slab_free_size);
+	}
+
 	zabbix_log(level, "================================");
 }
 
@@ -814,6 +1065,7 @@ size_t	zbx_mem_required_size(int chunks_num, const char *descr, const char *para
 	size += sizeof(zbx_mem_info_t);
 	size += ZBX_PTR_SIZE - 1;			/* ensure we allocate enough to align bucket pointers */
 	size += ZBX_PTR_SIZE * MEM_BUCKET_COUNT;
+	size += ZBX_PTR_SIZE * MEM_SLAB_COUNT;
 	size += strlen(descr) + 1;
 	size += strlen(param) + 1;
 	size += (MEM_SIZE_FIELD - 1) + 8;		/* ensure we allocate enough to align the first chunk */
@@ -158,7 +158,8 @@ static void	rtc_process_diaginfo(const char *data, char **result)
 
 	if (0 == strcmp(buf, "all"))
 	{
-		scope = (1 << ZBX_DIAGINFO_HISTORYCACHE) | (1 << ZBX_DIAGINFO_PREPROCESSING) | (1 << ZBX_DIAGINFO_LOCKS);
+		scope = (1 << ZBX_DIAGINFO_HISTORYCACHE) | (1 << ZBX_DIAGINFO_PREPROCESSING) | (1 << ZBX_DIAGINFO_LOCKS) |
+				(1 << ZBX_DIAGINFO_CONFIGCACHE);
 	}
 	else if (0 == strcmp(buf, ZBX_DIAG_HISTORYCACHE))
 	{
@@ -172,6 +173,10 @@ static void	rtc_process_diaginfo(const char *data, char **result)
 	{
 		scope = 1 << ZBX_DIAGINFO_LOCKS;
 	}
+	else if (0 == strcmp(buf, ZBX_DIAG_CONFIGCACHE))
+	{
+		scope = 1 << ZBX_DIAGINFO_CONFIGCACHE;
+	}
 	else
 	{
 		if (NULL == *result)
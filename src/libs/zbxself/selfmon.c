@@ -62,6 +62,10 @@ typedef struct
 
 	/* the process state cache */
 	zbx_stat_process_cache_t	cache;
+
+	/* RSM specifics: the maximum delay of RSM test start against its scheduled time */
+	/* during the last poller statistics interval, -1 if no RSM tests were started   */
+	int				rsm_lateness;
 }
 zbx_stat_process_t;
 
@@ -278,6 +282,7 @@ int	init_selfmon_collector(char **error)
 		for (proc_num = 0; proc_num < process_forks; proc_num++)
 		{
 			collector->process[proc_type][proc_num].cache.state = ZBX_PROCESS_STATE_IDLE;
+			collector->process[proc_type][proc_num].rsm_lateness = -1;
 		}
 	}
 
@@ -647,6 +652,57 @@ unlock:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: stores RSM test start lateness of the current process             *
+ *                                                                            *
+ * Parameters: lateness - [IN] the maximum delay of RSM test start against    *
+ *                             its scheduled time, -1 if no RSM tests were    *
+ *                             started                                        *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_selfmon_set_rsm_lateness(int lateness)
+{
+	if (ZBX_PROCESS_TYPE_UNKNOWN == process_type)
+		return;
+
+	LOCK_SM;
+
+	collector->process[process_type][process_num - 1].rsm_lateness = lateness;
+
+	UNLOCK_SM;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets the maximum RSM test start lateness of processes of the      *
+ *          specified type                                                    *
+ *                                                                            *
+ * Parameters: proc_type - [IN] type of process; ZBX_PROCESS_TYPE_*           *
+ *                                                                            *
+ * Return value: the maximum delay of RSM test start in seconds, 0 if no RSM  *
+ *               tests were started during the last statistics interval       *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_selfmon_get_rsm_lateness(unsigned char proc_type)
+{
+	int	proc_num, process_forks, lateness = 0;
+
+	process_forks = get_process_type_forks(proc_type);
+
+	LOCK_SM;
+
+	for (proc_num = 0; proc_num < process_forks; proc_num++)
+	{
+		if (lateness < collector->process[proc_type][proc_num].rsm_lateness)
+			lateness = collector->process[proc_type][proc_num].rsm_lateness;
+	}
+
+	UNLOCK_SM;
+
+	return lateness;
+}
+
 static int	sleep_remains;
 
 /******************************************************************************
@@ -1203,10 +1203,10 @@ static void	count_one_str(int *count, int op, const char *value, const char *pat
 static int	evaluate_COUNT(zbx_variant_t *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts,
 		int limit, int unique, char **error)
 {
-	int				arg1, op = OP_UNKNOWN, numeric_search, nparams, count = 0, i, ret = FAIL;
+	int				arg1, op = OP_UNKNOWN, numeric_search, nparams, count = 0, i, ret = FAIL, count_all;
 	int				seconds = 0, nvalues = 0, time_shift;
 	char				*operator = NULL, *pattern2 = NULL, *pattern = NULL, buf[ZBX_MAX_UINT64_LEN];
-	double				arg3_dbl;
+	double				arg3_dbl = 0;
 	zbx_uint64_t			pattern_ui64, pattern2_ui64;
 	zbx_value_type_t		arg1_type;
 	zbx_vector_ptr_t		regexps;
@@ -1391,6 +1391,30 @@ static int	evaluate_COUNT(zbx_variant_t *value, DC_ITEM *item, const char *param
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
+	/* values are not counted one by one if both pattern and operator are empty or "" is searched */
+	count_all = ((NULL == pattern || '\0' == *pattern) && (NULL == operator || '\0' == *operator ||
+			OP_LIKE == op || OP_REGEXP == op || OP_IREGEXP == op));
+
+	if (0 != count_all && COUNT_ALL == unique)
+	{
+		history_value_t	result;
+
+		/* number of values in range can be taken directly from value cache */
+		if (FAIL == zbx_vc_get_aggregate(item->itemid, item->value_type, ZBX_VC_AGGREGATE_COUNT, seconds,
+				nvalues, &ts_end, &result, &count))
+		{
+			*error = zbx_strdup(*error, "cannot get values from value cache");
+			goto out;
+		}
+
+		if (count > limit)
+			count = limit;
+
+		zbx_variant_set_dbl(value, count);
+		ret = SUCCEED;
+		goto out;
+	}
+
 	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
@@ -1536,16 +1560,13 @@ out:
 static int	evaluate_SUM(zbx_variant_t *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts,
 		char **error)
 {
-	int				arg1, i, ret = FAIL, seconds = 0, nvalues = 0, time_shift;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	history_value_t			result;
-	zbx_timespec_t			ts_end = *ts;
+	int			arg1, ret = FAIL, seconds = 0, nvalues = 0, time_shift, values_num;
+	zbx_value_type_t	arg1_type;
+	history_value_t		result;
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
 		*error = zbx_strdup(*error, "invalid value type");
@@ -1579,32 +1600,16 @@ static int	evaluate_SUM(zbx_variant_t *value, DC_ITEM *item, const char *paramet
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == zbx_vc_get_aggregate(item->itemid, item->value_type, ZBX_VC_AGGREGATE_SUM, seconds, nvalues,
+			&ts_end, &result, &values_num))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-	{
-		result.dbl = 0;
-
-		for (i = 0; i < values.values_num; i++)
-			result.dbl += values.values[i].value.dbl;
-	}
-	else
-	{
-		result.ui64 = 0;
-
-		for (i = 0; i < values.values_num; i++)
-			result.ui64 += values.values[i].value.ui64;
-	}
-
 	zbx_history_value2variant(&result, item->value_type, value);
 	ret = SUCCEED;
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
@@ -1628,15 +1633,13 @@ out:
 static int	evaluate_AVG(zbx_variant_t *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts,
 		char **error)
 {
-	int				arg1, ret = FAIL, i, seconds = 0, nvalues = 0, time_shift;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int			arg1, ret = FAIL, seconds = 0, nvalues = 0, time_shift, values_num;
+	zbx_value_type_t	arg1_type;
+	history_value_t		result;
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
 		*error = zbx_strdup(*error, "invalid value type");
@@ -1670,29 +1673,16 @@ static int	evaluate_AVG(zbx_variant_t *value, DC_ITEM *item, const char *paramet
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == zbx_vc_get_aggregate(item->itemid, item->value_type, ZBX_VC_AGGREGATE_AVG, seconds, nvalues,
+			&ts_end, &result, &values_num))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (0 < values_num)
 	{
-		double	avg = 0;
-
-		if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-		{
-			for (i = 0; i < values.values_num; i++)
-				avg += values.values[i].value.dbl / (i + 1) - avg / (i + 1);
-		}
-		else
-		{
-			for (i = 0; i < values.values_num; i++)
-				avg += (double)values.values[i].value.ui64;
-
-			avg = avg / values.values_num;
-		}
-		zbx_variant_set_dbl(value, avg);
+		zbx_variant_set_dbl(value, result.dbl);
 
 		ret = SUCCEED;
 	}
@@ -1702,8 +1692,6 @@ static int	evaluate_AVG(zbx_variant_t *value, DC_ITEM *item, const char *paramet
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
@@ -1746,13 +1734,6 @@ static int	evaluate_LAST(zbx_variant_t *value, DC_ITEM *item, const char *parame
 #define EVALUATE_MIN	0
 #define EVALUATE_MAX	1
 
-#define LOOP_FIND_MIN_OR_MAX(type, mode_op)							\
-	for (i = 1; i < values.values_num; i++)							\
-	{											\
-		if (values.values[i].value.type mode_op values.values[index].value.type)	\
-			index = i;								\
-	}											\
-
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluate function 'min' or 'max' for the item                     *
@@ -1772,15 +1753,13 @@ static int	evaluate_LAST(zbx_variant_t *value, DC_ITEM *item, const char *parame
 static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const DC_ITEM *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error, int min_or_max)
 {
-	int				arg1, i, ret = FAIL, seconds = 0, nvalues = 0, time_shift;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int			arg1, ret = FAIL, seconds = 0, nvalues = 0, time_shift, values_num;
+	zbx_value_type_t	arg1_type;
+	history_value_t		result;
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
 		*error = zbx_strdup(*error, "invalid value type");
@@ -1814,40 +1793,17 @@ static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const DC_ITEM *item, const
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == zbx_vc_get_aggregate(item->itemid, item->value_type,
+			EVALUATE_MIN == min_or_max ? ZBX_VC_AGGREGATE_MIN : ZBX_VC_AGGREGATE_MAX, seconds, nvalues,
+			&ts_end, &result, &values_num))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (0 < values_num)
 	{
-		int	index = 0;
-
-		if (ITEM_VALUE_TYPE_UINT64 == item->value_type)
-		{
-			if (EVALUATE_MIN == min_or_max)
-			{
-				LOOP_FIND_MIN_OR_MAX(ui64, <);
-			}
-			else
-			{
-				LOOP_FIND_MIN_OR_MAX(ui64, >);
-			}
-		}
-		else
-		{
-			if (EVALUATE_MIN == min_or_max)
-			{
-				LOOP_FIND_MIN_OR_MAX(dbl, <);
-			}
-			else
-			{
-				LOOP_FIND_MIN_OR_MAX(dbl, >);
-			}
-		}
-
-		zbx_history_value2variant(&values.values[index].value, item->value_type, value);
+		zbx_history_value2variant(&result, item->value_type, value);
 		ret = SUCCEED;
 	}
 	else
@@ -1856,8 +1812,6 @@ static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const DC_ITEM *item, const
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
@@ -402,13 +402,13 @@ int	zbx_tfc_init(char **error)
 	/* (8 + 8) * 3 - overhead for 3 allocations */
 	size_actual -= size_reserved + sizeof(zbx_tfc_t) + (8 + 8) * 3;
 
-	/* 5/4 - reversing critical load factor which is accounted for when inserting new hashset entry */
-	/* but ignored when creating hashset with the specified size                                    */
-	cache->slots_num = size_actual / (16 * 5 / 4 + sizeof(zbx_tfc_slot_t));
+	/* the index is created with 5/2 slots per entry so it can hold all entries without growing, */
+	/* slots of removed entries are then reclaimed in place                                      */
+	cache->slots_num = size_actual / (sizeof(zbx_hashset_slot_t) * 5 / 2 + sizeof(zbx_tfc_slot_t));
 
 	zabbix_log(LOG_LEVEL_DEBUG, "%s(): slots:%u", __func__, cache->slots_num);
 
-	zbx_hashset_create_ext(&cache->index, cache->slots_num, tfc_hash_func, tfc_compare_func,
+	zbx_hashset_create_ext(&cache->index, cache->slots_num * 5 / 2, tfc_hash_func, tfc_compare_func,
 			NULL, tfc_malloc_func, tfc_realloc_func, tfc_free_func);
 
 	cache->lru_head = UINT32_MAX;
@@ -26,6 +26,7 @@ int	CONFIG_UNREACHABLE_POLLER_FORKS;
 int	CONFIG_HTTPPOLLER_FORKS;
 int	CONFIG_IPMIPOLLER_FORKS;
 int	CONFIG_TIMER_FORKS;
+int	CONFIG_RSM_TEST_WINDOW;
 int	CONFIG_TRAPPER_FORKS;
 int	CONFIG_SNMPTRAPPER_FORKS;
 int	CONFIG_JAVAPOLLER_FORKS;
@@ -42,17 +43,24 @@ char	*CONFIG_SOURCE_IP;
 int	CONFIG_TRAPPER_TIMEOUT;
 int	CONFIG_HOUSEKEEPING_FREQUENCY;
 int	CONFIG_MAX_HOUSEKEEPER_DELETE;
+int	CONFIG_HOUSEKEEPING_PARTITIONS;
+int	CONFIG_MAX_HOUSEKEEPER_LOAD;
 int	CONFIG_SENDER_FREQUENCY;
 int	CONFIG_HISTSYNCER_FORKS;
 int	CONFIG_HISTSYNCER_FREQUENCY;
 int	CONFIG_CONFSYNCER_FORKS;
 int	CONFIG_CONFSYNCER_FREQUENCY;
 zbx_uint64_t	CONFIG_CONF_CACHE_SIZE;
+int	CONFIG_CACHE_LOAD_WORKERS;
+char	*CONFIG_CACHE_SNAPSHOT_FILE;
 zbx_uint64_t	CONFIG_HISTORY_CACHE_SIZE;
 zbx_uint64_t	CONFIG_HISTORY_INDEX_CACHE_SIZE;
+int	CONFIG_HISTORY_CACHE_COMPRESS_SIZE;
+int	CONFIG_PROXY_HISTORY_COMPRESS_SIZE;
 zbx_uint64_t	CONFIG_TRENDS_CACHE_SIZE;
 zbx_uint64_t	CONFIG_TEXT_CACHE_SIZE;
 zbx_uint64_t	CONFIG_VALUE_CACHE_SIZE;
+char	*CONFIG_VALUE_CACHE_SNAPSHOT_FILE;
 int	CONFIG_DISABLE_HOUSEKEEPING;
 int	CONFIG_UNREACHABLE_PERIOD;
 int	CONFIG_UNREACHABLE_DELAY;
@@ -127,6 +135,7 @@ int	CONFIG_DOUBLE_PRECISION		= ZBX_DB_DBL_PRECISION_ENABLED;
 char	*CONFIG_HISTORY_STORAGE_URL;
 char	*CONFIG_HISTORY_STORAGE_OPTS;
 int	CONFIG_HISTORY_STORAGE_PIPELINES = 0;
+int	CONFIG_HISTORY_STORAGE_COMPRESSION = 0;
 char	*CONFIG_EXPORT_DIR;
 
 char		*CONFIG_EXPORT_TYPE = NULL;
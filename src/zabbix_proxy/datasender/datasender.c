@@ -85,7 +85,7 @@ static void	get_hist_upload_state(const char *buffer, int *state)
  ******************************************************************************/
 static int	proxy_data_sender(int *more, int now, int *hist_upload_state)
 {
-	static int		data_timestamp = 0, task_timestamp = 0, upload_state = SUCCEED;
+	static int		data_timestamp = 0, task_timestamp = 0, upload_state = SUCCEED, json_values = 0;
 
 	zbx_socket_t		sock;
 	struct zbx_json		j;
@@ -112,7 +112,7 @@ static int	proxy_data_sender(int *more, int now, int *hist_upload_state)
 		if (SUCCEED == get_interface_availability_data(&j, &availability_ts))
 			flags |= ZBX_DATASENDER_AVAILABILITY;
 
-		history_records = proxy_get_hist_data(&j, &history_lastid, &more_history);
+		history_records = proxy_get_hist_data(&j, &history_lastid, &more_history, json_values);
 		if (0 != history_lastid)
 			flags |= ZBX_DATASENDER_HISTORY;
 
@@ -214,6 +214,9 @@ static int	proxy_data_sender(int *more, int now, int *hist_upload_state)
 			{
 				if (SUCCEED == zbx_json_brackets_by_name(&jp, ZBX_PROTO_TAG_TASKS, &jp_tasks))
 					flags |= ZBX_DATASENDER_TASKS_RECV;
+
+				/* server announces support of JSON object values in every response */
+				json_values = zbx_get_proxy_json_values(&jp);
 			}
 
 			if (0 != (flags & ZBX_DATASENDER_DB_UPDATE))
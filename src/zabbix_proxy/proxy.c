@@ -92,8 +92,9 @@ const char	*help_message[] = {
 	"                                 target is not specified",
 	"      " ZBX_SNMP_CACHE_RELOAD "          Reload SNMP cache",
 	"      " ZBX_DIAGINFO "=section           Log internal diagnostic information of the",
-	"                                 section (historycache, preprocessing, locks) or",
-	"                                 everything if section is not specified",
+	"                                 section (historycache, preprocessing, locks,",
+	"                                 configcache) or everything if section is not",
+	"                                 specified",
 	"",
 	"      Log level control targets:",
 	"        process-type             All processes of specified type",
@@ -191,6 +192,7 @@ int	CONFIG_TRAPPER_TIMEOUT		= 300;
 int	CONFIG_HOUSEKEEPING_FREQUENCY	= 1;
 int	CONFIG_PROXY_LOCAL_BUFFER	= 0;
 int	CONFIG_PROXY_OFFLINE_BUFFER	= 1;
+int	CONFIG_PROXY_HISTORY_COMPRESS_SIZE	= 0;
 
 int	CONFIG_HEARTBEAT_FREQUENCY	= 60;
 
@@ -207,11 +209,15 @@ int	CONFIG_VMWARE_PERF_FREQUENCY	= 60;
 int	CONFIG_VMWARE_TIMEOUT		= 10;
 
 zbx_uint64_t	CONFIG_CONF_CACHE_SIZE		= 8 * ZBX_MEBIBYTE;
+int	CONFIG_CACHE_LOAD_WORKERS	= 4;
+char	*CONFIG_CACHE_SNAPSHOT_FILE	= NULL;
 zbx_uint64_t	CONFIG_HISTORY_CACHE_SIZE	= 16 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_HISTORY_INDEX_CACHE_SIZE	= 4 * ZBX_MEBIBYTE;
+int	CONFIG_HISTORY_CACHE_COMPRESS_SIZE	= 0;
 zbx_uint64_t	CONFIG_TRENDS_CACHE_SIZE	= 0;
 zbx_uint64_t	CONFIG_TREND_FUNC_CACHE_SIZE	= 0;
 zbx_uint64_t	CONFIG_VALUE_CACHE_SIZE		= 0;
+char	*CONFIG_VALUE_CACHE_SNAPSHOT_FILE	= NULL;
 zbx_uint64_t	CONFIG_VMWARE_CACHE_SIZE	= 8 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_EXPORT_FILE_SIZE;
 
@@ -308,6 +314,9 @@ int	CONFIG_TCP_MAX_BACKLOG_SIZE	= SOMAXCONN;
 
 char   epp_passphrase[128]		= "";
 
+/* the period at the beginning of RSM test cycle to spread RSM tests over, 0 - whole cycle */
+int	CONFIG_RSM_TEST_WINDOW		= 0;
+
 int	CONFIG_DOUBLE_PRECISION		= ZBX_DB_DBL_PRECISION_ENABLED;
 
 zbx_vector_ptr_t	zbx_addrs;
@@ -728,16 +737,22 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			1},
 		{"CacheSize",			&CONFIG_CONF_CACHE_SIZE,		TYPE_UINT64,
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(64) * ZBX_GIBIBYTE},
+		{"CacheLoadWorkers",		&CONFIG_CACHE_LOAD_WORKERS,		TYPE_INT,
+			PARM_OPT,	0,			32},
 		{"HistoryCacheSize",		&CONFIG_HISTORY_CACHE_SIZE,		TYPE_UINT64,
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"HistoryIndexCacheSize",	&CONFIG_HISTORY_INDEX_CACHE_SIZE,	TYPE_UINT64,
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"HistoryCacheCompressSize",	&CONFIG_HISTORY_CACHE_COMPRESS_SIZE,	TYPE_INT,
+			PARM_OPT,	0,			ZBX_MEBIBYTE},
 		{"HousekeepingFrequency",	&CONFIG_HOUSEKEEPING_FREQUENCY,		TYPE_INT,
 			PARM_OPT,	0,			24},
 		{"ProxyLocalBuffer",		&CONFIG_PROXY_LOCAL_BUFFER,		TYPE_INT,
 			PARM_OPT,	0,			720},
 		{"ProxyOfflineBuffer",		&CONFIG_PROXY_OFFLINE_BUFFER,		TYPE_INT,
 			PARM_OPT,	1,			720},
+		{"ProxyHistoryCompressSize",	&CONFIG_PROXY_HISTORY_COMPRESS_SIZE,	TYPE_INT,
+			PARM_OPT,	0,			ZBX_MEBIBYTE},
 		{"HeartbeatFrequency",		&CONFIG_HEARTBEAT_FREQUENCY,		TYPE_INT,
 			PARM_OPT,	0,			ZBX_PROXY_HEARTBEAT_FREQUENCY_MAX},
 		{"ConfigFrequency",		&CONFIG_PROXYCONFIG_FREQUENCY,		TYPE_INT,
@@ -888,6 +903,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			INT_MAX},
 		{"StartODBCPollers",		&CONFIG_ODBCPOLLER_FORKS,		TYPE_INT,
 			PARM_OPT,	0,			1000},
+		{"RSMTestWindow",		&CONFIG_RSM_TEST_WINDOW,		TYPE_INT,
+			PARM_OPT,	0,			SEC_PER_HOUR},
 		{NULL}
 	};
 
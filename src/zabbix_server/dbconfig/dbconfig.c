@@ -67,7 +67,11 @@ ZBX_THREAD_ENTRY(dbconfig_thread, args)
 
 	zbx_rtc_notify_config_sync(&rtc);
 
-	nextcheck = (int)time(NULL) + CONFIG_CONFSYNCER_FREQUENCY;
+	/* tables loaded from snapshot can be outdated, they are compared with database right away */
+	if (SUCCEED == DCconfig_snapshot_loaded())
+		nextcheck = (int)time(NULL);
+	else
+		nextcheck = (int)time(NULL) + CONFIG_CONFSYNCER_FREQUENCY;
 
 	while (ZBX_IS_RUNNING())
 	{
@@ -39,9 +39,37 @@ static int	hk_period;
 /* the maximum number of housekeeping periods to be removed per single housekeeping cycle */
 #define HK_MAX_DELETE_PERIODS		4
 
+/* the number of native partitions to be created ahead of the current time */
+#define HK_PARTITIONS_AHEAD		7
+
+/* the interval of creating native partitions ahead, independent of housekeeping frequency */
+#define HK_PARTITIONS_CREATE_PERIOD	SEC_PER_HOUR
+
+/* the delete chunk size limits, the chunk size is adapted to delete execution time */
+#define HK_DELETE_CHUNK_MIN		100
+#define HK_DELETE_CHUNK_MAX		10000
+
+/* the target execution time of single delete statement, in seconds */
+#define HK_DELETE_CHUNK_TIME		0.5
+
+/* the history write latency per value increase housekeeper backs off at */
+#define HK_WRITE_LATENCY_FACTOR		2
+#define HK_WRITE_LATENCY_MARGIN		0.0001
+
+/* the maximum time housekeeper backs off after single delete statement, in seconds */
+#define HK_BACKOFF_TIME_MAX		60
+
 /* global configuration data containing housekeeping configuration */
 static zbx_config_t	cfg;
 
+/* the current delete chunk size */
+static int		hk_delete_chunk = HK_DELETE_CHUNK_MIN * 10;
+
+/* the history write latency before housekeeping cycle started */
+static double		hk_write_latency;
+
+static zbx_hk_stats_t	hk_stats;
+
 /* Housekeeping rule definition.                                */
 /* A housekeeping rule describes table from which records older */
 /* than history setting must be removed according to optional   */
@@ -153,33 +181,50 @@ typedef struct
 
 	/* the item delete queue */
 	zbx_vector_ptr_t	delete_queue;
+
+	/* the time range covered by one native partition of target table */
+	int			partition_period;
+
+	/* the longest storage period of items stored in target table, -1 if storage */
+	/* period of some item cannot be resolved                                     */
+	int			history_max;
 }
 zbx_hk_history_rule_t;
 
+/* native partition of history (trends) table */
+typedef struct
+{
+	char	*name;
+
+	/* the partition upper bound, records with older timestamps are stored in the partition */
+	int	clock_to;
+}
+zbx_hk_partition_t;
+
 /* The history item rules, used for housekeeping history and trends tables */
 /* The order of the rules must match the order of value types in zbx_item_value_type_t. */
 static zbx_hk_history_rule_t	hk_history_rules[] = {
 	{.table = "history",		.history = "history",	.poption_mode = &cfg.hk.history_mode,
 			.poption_global = &cfg.hk.history_global,	.poption = &cfg.hk.history,
-			.type = ITEM_VALUE_TYPE_FLOAT},
+			.type = ITEM_VALUE_TYPE_FLOAT,	.partition_period = SEC_PER_DAY},
 	{.table = "history_str",	.history = "history",	.poption_mode = &cfg.hk.history_mode,
 			.poption_global = &cfg.hk.history_global,	.poption = &cfg.hk.history,
-			.type = ITEM_VALUE_TYPE_STR},
+			.type = ITEM_VALUE_TYPE_STR,	.partition_period = SEC_PER_DAY},
 	{.table = "history_log",	.history = "history",	.poption_mode = &cfg.hk.history_mode,
 			.poption_global = &cfg.hk.history_global,	.poption = &cfg.hk.history,
-			.type = ITEM_VALUE_TYPE_LOG},
+			.type = ITEM_VALUE_TYPE_LOG,	.partition_period = SEC_PER_DAY},
 	{.table = "history_uint",	.history = "history",	.poption_mode = &cfg.hk.history_mode,
 			.poption_global = &cfg.hk.history_global,	.poption = &cfg.hk.history,
-			.type = ITEM_VALUE_TYPE_UINT64},
+			.type = ITEM_VALUE_TYPE_UINT64,	.partition_period = SEC_PER_DAY},
 	{.table = "history_text",	.history = "history",	.poption_mode = &cfg.hk.history_mode,
 			.poption_global = &cfg.hk.history_global,	.poption = &cfg.hk.history,
-			.type = ITEM_VALUE_TYPE_TEXT},
+			.type = ITEM_VALUE_TYPE_TEXT,	.partition_period = SEC_PER_DAY},
 	{.table = "trends",		.history = "trends",	.poption_mode = &cfg.hk.trends_mode,
 			.poption_global = &cfg.hk.trends_global,	.poption = &cfg.hk.trends,
-			.type = ITEM_VALUE_TYPE_FLOAT},
+			.type = ITEM_VALUE_TYPE_FLOAT,	.partition_period = SEC_PER_WEEK},
 	{.table = "trends_uint",	.history = "trends",	.poption_mode = &cfg.hk.trends_mode,
 			.poption_global = &cfg.hk.trends_global,	.poption = &cfg.hk.trends,
-			.type = ITEM_VALUE_TYPE_UINT64},
+			.type = ITEM_VALUE_TYPE_UINT64,	.partition_period = SEC_PER_WEEK},
 	{NULL}
 };
 
@@ -362,9 +407,11 @@ static void	hk_history_item_update(zbx_hk_history_rule_t *rules, zbx_hk_history_
  ******************************************************************************/
 static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 {
-	DB_RESULT	result;
-	DB_ROW		row;
-	char		*tmp = NULL;
+	DB_RESULT		result;
+	DB_ROW			row;
+	char			*tmp = NULL;
+	int			history_max = 0, trends_max = 0;
+	zbx_hk_history_rule_t	*rule;
 
 	result = DBselect(
 			"select i.itemid,i.value_type,i.history,i.trends,h.hostid"
@@ -379,7 +426,6 @@ static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 	{
 		zbx_uint64_t		itemid, hostid;
 		int			history, trends, value_type;
-		zbx_hk_history_rule_t	*rule;
 
 		ZBX_STR2UINT64(itemid, row[0]);
 		value_type = atoi(row[1]);
@@ -396,18 +442,23 @@ static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "invalid history storage period '%s' for itemid '%s'",
 						tmp, row[0]);
+				history_max = -1;
 				continue;
 			}
 
 			if (0 != history && (ZBX_HK_HISTORY_MIN > history || ZBX_HK_PERIOD_MAX < history))
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "invalid history storage period for itemid '%s'", row[0]);
+				history_max = -1;
 				continue;
 			}
 
 			if (0 != history && ZBX_HK_OPTION_DISABLED != *rule->poption_global)
 				history = *rule->poption;
 
+			if (-1 != history_max)
+				history_max = MAX(history_max, history);
+
 			hk_history_item_update(rules, rule, ITEM_VALUE_TYPE_MAX, now, itemid, history);
 		}
 
@@ -427,23 +478,32 @@ static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "invalid trends storage period '%s' for itemid '%s'",
 						tmp, row[0]);
+				trends_max = -1;
 				continue;
 			}
 			else if (0 != trends && (ZBX_HK_TRENDS_MIN > trends || ZBX_HK_PERIOD_MAX < trends))
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "invalid trends storage period for itemid '%s'", row[0]);
+				trends_max = -1;
 				continue;
 			}
 
 			if (0 != trends && ZBX_HK_OPTION_DISABLED != *rule->poption_global)
 				trends = *rule->poption;
 
+			if (-1 != trends_max)
+				trends_max = MAX(trends_max, trends);
+
 			hk_history_item_update(rules + HK_UPDATE_CACHE_OFFSET_TREND_FLOAT, rule,
 					HK_UPDATE_CACHE_TREND_COUNT, now, itemid, trends);
 		}
 	}
 	DBfree_result(result);
 
+	/* item data can be stored in several tables after value type has been changed */
+	for (rule = rules; NULL != rule->table; rule++)
+		rule->history_max = (rule - rules < HK_UPDATE_CACHE_OFFSET_TREND_FLOAT ? history_max : trends_max);
+
 	zbx_free(tmp);
 }
 
@@ -563,6 +623,488 @@ out:
 #endif
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: delete limited count of rows from table                           *
+ *                                                                            *
+ * Parameters: tablename - [IN] the table name                                *
+ *             filter    - [IN] the condition of rows to delete               *
+ *             order     - [IN] the order in which limited count of rows is   *
+ *                              deleted, NULL if not important                *
+ *             limit     - [IN] the maximum number of rows to delete,         *
+ *                              0 - unlimited                                 *
+ *                                                                            *
+ * Return value: number of deleted rows or less than 0 if an error occurred   *
+ *                                                                            *
+ ******************************************************************************/
+static int	DBdelete_from_table(const char *tablename, const char *filter, const char *order, int limit)
+{
+	if (0 == limit)
+	{
+		return DBexecute(
+				"delete from %s"
+				" where %s",
+				tablename,
+				filter);
+	}
+	else
+	{
+#if defined(HAVE_ORACLE)
+		ZBX_UNUSED(order);
+
+		return DBexecute(
+				"delete from %s"
+				" where %s"
+					" and rownum<=%d",
+				tablename,
+				filter,
+				limit);
+#elif defined(HAVE_MYSQL)
+		return DBexecute(
+				"delete from %s"
+				" where %s%s%s limit %d",
+				tablename,
+				filter,
+				NULL != order ? " order by " : "",
+				ZBX_NULL2EMPTY_STR(order),
+				limit);
+#elif defined(HAVE_POSTGRESQL)
+		return DBexecute(
+				"delete from %s"
+				" where %s and ctid = any(array(select ctid from %s"
+					" where %s%s%s limit %d))",
+				tablename,
+				filter,
+				tablename,
+				filter,
+				NULL != order ? " order by " : "",
+				ZBX_NULL2EMPTY_STR(order),
+				limit);
+#elif defined(HAVE_SQLITE3)
+		ZBX_UNUSED(order);
+
+		return DBexecute(
+				"delete from %s"
+				" where %s",
+				tablename,
+				filter);
+#endif
+	}
+
+	return 0;
+}
+
+static void	hk_sleep(double seconds)
+{
+	struct timespec	ts;
+
+	ts.tv_sec = (time_t)seconds;
+	ts.tv_nsec = (long)((seconds - (double)ts.tv_sec) * 1e9);
+
+	nanosleep(&ts, NULL);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adapt delete chunk size and throttle housekeeper after executing  *
+ *          delete statement                                                  *
+ *                                                                            *
+ * Parameters: time_delete - [IN] the delete statement execution time         *
+ *             deleted     - [IN] the number of deleted rows                  *
+ *             chunk       - [IN] the row limit of delete statement           *
+ *                                                                            *
+ * Comments: The chunk size is halved when delete takes longer than target    *
+ *           time and increased when full chunk is deleted fast enough.       *
+ *           When MaxHousekeeperLoad is below 100 housekeeper sleeps to keep  *
+ *           its share of time spent deleting within the configured load and  *
+ *           backs off while history write latency is raised compared to the  *
+ *           latency before housekeeping started.                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_delete_throttle(double time_delete, int deleted, int chunk)
+{
+	if (HK_DELETE_CHUNK_TIME < time_delete)
+		hk_delete_chunk = MAX(hk_delete_chunk / 2, HK_DELETE_CHUNK_MIN);
+	else if (deleted >= chunk && HK_DELETE_CHUNK_TIME / 2 > time_delete)
+		hk_delete_chunk = MIN(hk_delete_chunk + hk_delete_chunk / 4, HK_DELETE_CHUNK_MAX);
+
+	if (ZBX_DB_OK < deleted)
+		hk_stats.deleted += (zbx_uint64_t)deleted;
+
+	if (100 > CONFIG_MAX_HOUSEKEEPER_LOAD)
+	{
+		double	time_sleep, latency_max;
+		int	i;
+
+		time_sleep = time_delete * (100 - CONFIG_MAX_HOUSEKEEPER_LOAD) / CONFIG_MAX_HOUSEKEEPER_LOAD;
+		hk_sleep(time_sleep);
+		hk_stats.throttled += time_sleep;
+
+		latency_max = hk_write_latency * HK_WRITE_LATENCY_FACTOR + HK_WRITE_LATENCY_MARGIN;
+
+		for (i = 0; i < HK_BACKOFF_TIME_MAX && ZBX_IS_RUNNING(); i++)
+		{
+			if (latency_max >= zbx_dc_get_history_write_latency())
+				break;
+
+			zbx_sleep(1);
+			hk_stats.throttled++;
+		}
+	}
+
+	zbx_dc_set_hk_stats(&hk_stats);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: delete rows from table in chunks                                  *
+ *                                                                            *
+ * Parameters: tablename - [IN] the table name                                *
+ *             filter    - [IN] the condition of rows to delete               *
+ *             order     - [IN] the order in which rows are deleted, NULL if  *
+ *                              not important                                 *
+ *             limit     - [IN] the maximum number of rows to delete,         *
+ *                              0 - unlimited                                 *
+ *                                                                            *
+ * Return value: number of deleted rows or less than 0 if an error occurred   *
+ *               before any rows were deleted                                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_delete_from_table(const char *tablename, const char *filter, const char *order, int limit)
+{
+	int	deleted = 0, chunk, rc;
+	double	sec;
+
+	do
+	{
+		chunk = hk_delete_chunk;
+
+		if (0 != limit && chunk > limit - deleted)
+			chunk = limit - deleted;
+
+		sec = zbx_time();
+		rc = DBdelete_from_table(tablename, filter, order, chunk);
+		hk_delete_throttle(zbx_time() - sec, rc, chunk);
+
+		if (ZBX_DB_OK > rc)
+			return 0 == deleted ? rc : deleted;
+
+		deleted += rc;
+	}
+	while (rc >= chunk && (0 == limit || deleted < limit) && ZBX_IS_RUNNING());
+
+	return deleted;
+}
+
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+static void	hk_partition_free(zbx_hk_partition_t *partition)
+{
+	zbx_free(partition->name);
+	zbx_free(partition);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get native partitions of history (trends) table                   *
+ *                                                                            *
+ * Parameters: table      - [IN] the table name                               *
+ *             partitions - [OUT] the table partitions with numeric upper     *
+ *                                bound                                       *
+ *             maxvalue   - [OUT] the name of partition with unlimited upper  *
+ *                                bound, if any                               *
+ *                                                                            *
+ * Return value: SUCCEED - the table is partitioned by range of clock column  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partitions_get(const char *table, zbx_vector_ptr_t *partitions, char **maxvalue)
+{
+	DB_RESULT	result;
+	DB_ROW		row;
+	int		ret = FAIL;
+
+#if defined(HAVE_MYSQL)
+	result = DBselect(
+			"select partition_name,partition_description"
+			" from information_schema.partitions"
+			" where table_schema=database()"
+				" and table_name='%s'"
+				" and partition_method='RANGE'"
+				" and partition_expression in ('clock','`clock`')",
+			table);
+#else
+	result = DBselect(
+			"select c.relname,pg_get_expr(c.relpartbound,c.oid)"
+			" from pg_partitioned_table pt"
+				" join pg_class p on p.oid=pt.partrelid"
+				" left join pg_inherits i on i.inhparent=p.oid"
+				" left join pg_class c on c.oid=i.inhrelid"
+			" where p.relname='%s'"
+				" and p.relnamespace=(select oid from pg_namespace where nspname=current_schema())"
+				" and pg_get_partkeydef(p.oid)='RANGE (clock)'",
+			table);
+#endif
+	while (NULL != (row = DBfetch(result)))
+	{
+		const char		*bound = row[1];
+		zbx_hk_partition_t	*partition;
+
+		ret = SUCCEED;
+
+		/* partitioned table without partitions */
+		if (SUCCEED == DBis_null(row[0]))
+			continue;
+#if defined(HAVE_POSTGRESQL)
+		/* the bound is printed as "FOR VALUES FROM (<from>) TO (<to>)" or "DEFAULT" */
+		if (NULL == (bound = strstr(bound, " TO (")))
+			continue;
+
+		bound += ZBX_CONST_STRLEN(" TO (");
+
+		if ('\'' == *bound)
+			bound++;
+#endif
+		if (0 == isdigit(*bound))
+		{
+			*maxvalue = zbx_strdup(*maxvalue, row[0]);
+			continue;
+		}
+
+		partition = (zbx_hk_partition_t *)zbx_malloc(NULL, sizeof(zbx_hk_partition_t));
+		partition->name = zbx_strdup(NULL, row[0]);
+		partition->clock_to = atoi(bound);
+		zbx_vector_ptr_append(partitions, partition);
+	}
+	DBfree_result(result);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create native partitions of history (trends) table ahead of the   *
+ *          current time                                                      *
+ *                                                                            *
+ * Parameters: rule       - [IN] the history housekeeping rule                *
+ *             partitions - [IN] the existing table partitions                *
+ *             maxvalue   - [IN] the name of partition with unlimited upper   *
+ *                               bound, can be NULL                           *
+ *             now        - [IN] the current timestamp                        *
+ *                                                                            *
+ * Comments: New partitions continue from the upper bound of the last         *
+ *           existing partition and are aligned to partition period.          *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_partitions_create(const zbx_hk_history_rule_t *rule, const zbx_vector_ptr_t *partitions,
+		const char *maxvalue, int now)
+{
+	int	i, clock_from = 0, clock_to, clock_until;
+
+	for (i = 0; i < partitions->values_num; i++)
+		clock_from = MAX(clock_from, ((const zbx_hk_partition_t *)partitions->values[i])->clock_to);
+
+	if (0 == clock_from)
+		clock_from = now - now % rule->partition_period;
+
+	clock_until = now - now % rule->partition_period + HK_PARTITIONS_AHEAD * rule->partition_period;
+
+	for (; clock_from < clock_until; clock_from = clock_to)
+	{
+		char		name[ZBX_TABLENAME_LEN_MAX];
+		time_t		time_from = clock_from;
+		struct tm	*tm;
+		int		rc;
+
+		clock_to = clock_from - clock_from % rule->partition_period + rule->partition_period;
+
+		tm = gmtime(&time_from);
+		zbx_snprintf(name, sizeof(name), "%s_p%04d%02d%02d", rule->table, tm->tm_year + 1900,
+				tm->tm_mon + 1, tm->tm_mday);
+#if defined(HAVE_MYSQL)
+		if (NULL != maxvalue)
+		{
+			rc = DBexecute("alter table %s reorganize partition %s into"
+					" (partition %s values less than (%d),partition %s values less than maxvalue)",
+					rule->table, maxvalue, name, clock_to, maxvalue);
+		}
+		else
+		{
+			rc = DBexecute("alter table %s add partition (partition %s values less than (%d))",
+					rule->table, name, clock_to);
+		}
+#else
+		if (NULL != maxvalue)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot create partitions of table \"%s\": partition \"%s\""
+					" has no upper bound", rule->table, maxvalue);
+			break;
+		}
+
+		rc = DBexecute("create table %s partition of %s for values from (%d) to (%d)", name, rule->table,
+				clock_from, clock_to);
+#endif
+		if (ZBX_DB_OK > rc)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot create partition \"%s\" of table \"%s\"", name,
+					rule->table);
+			break;
+		}
+
+		zabbix_log(LOG_LEVEL_DEBUG, "created partition \"%s\" of table \"%s\"", name, rule->table);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: drop native partitions of history (trends) table containing only  *
+ *          expired records                                                   *
+ *                                                                            *
+ * Parameters: rule       - [IN] the history housekeeping rule                *
+ *             partitions - [IN] the existing table partitions                *
+ *             keep_from  - [IN] the oldest timestamp of records to keep      *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_partitions_drop(const zbx_hk_history_rule_t *rule, const zbx_vector_ptr_t *partitions,
+		int keep_from)
+{
+	int	i, rc;
+
+	for (i = 0; i < partitions->values_num; i++)
+	{
+		const zbx_hk_partition_t	*partition = (const zbx_hk_partition_t *)partitions->values[i];
+
+		if (partition->clock_to > keep_from)
+			continue;
+#if defined(HAVE_MYSQL)
+		rc = DBexecute("alter table %s drop partition %s", rule->table, partition->name);
+#else
+		rc = DBexecute("drop table %s", partition->name);
+#endif
+		if (ZBX_DB_OK > rc)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot drop partition \"%s\" of table \"%s\"", partition->name,
+					rule->table);
+			continue;
+		}
+
+		zabbix_log(LOG_LEVEL_DEBUG, "dropped partition \"%s\" of table \"%s\"", partition->name,
+				rule->table);
+	}
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create native partitions of history and trends tables ahead of    *
+ *          the current time                                                  *
+ *                                                                            *
+ * Parameters: now - [IN] the current timestamp                               *
+ *                                                                            *
+ * Comments: Partitions are created regardless of housekeeping mode and       *
+ *           frequency, otherwise inserts would fail once the last partition  *
+ *           is filled.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_partitions_create_all(int now)
+{
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+	zbx_hk_history_rule_t	*rule;
+	zbx_vector_ptr_t	partitions;
+	char			*maxvalue;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() now:%d", __func__, now);
+
+	zbx_vector_ptr_create(&partitions);
+
+	for (rule = hk_history_rules; NULL != rule->table; rule++)
+	{
+		maxvalue = NULL;
+
+		if (SUCCEED == hk_partitions_get(rule->table, &partitions, &maxvalue))
+			hk_partitions_create(rule, &partitions, maxvalue, now);
+
+		zbx_free(maxvalue);
+		zbx_vector_ptr_clear_ext(&partitions, (zbx_clean_func_t)hk_partition_free);
+	}
+
+	zbx_vector_ptr_destroy(&partitions);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+#else
+	ZBX_UNUSED(now);
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: drop expired native partitions of history (trends) table          *
+ *                                                                            *
+ * Parameters: rule      - [IN] the history housekeeping rule                 *
+ *             now       - [IN] the current timestamp                         *
+ *             drop_from - [OUT] the timestamp before which records are       *
+ *                               removed by dropping partitions, 0 if         *
+ *                               partitions are not dropped                   *
+ *                                                                            *
+ * Return value: SUCCEED - the table is partitioned by range of clock column  *
+ *               FAIL    - the table is not partitioned, records must be      *
+ *                         deleted                                            *
+ *                                                                            *
+ * Comments: Partitions are dropped according to the global storage period    *
+ *           if it is overridden, otherwise according to the longest item     *
+ *           storage period. Records of items with shorter storage periods    *
+ *           are left for the delete queue. Partitions are not dropped if     *
+ *           storage period of some item cannot be resolved.                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partitions_process(zbx_hk_history_rule_t *rule, int now, int *drop_from)
+{
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+	zbx_vector_ptr_t	partitions;
+	char			*maxvalue = NULL;
+	int			ret, history;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() table:%s now:%d", __func__, rule->table, now);
+
+	*drop_from = 0;
+	zbx_vector_ptr_create(&partitions);
+
+	if (SUCCEED != (ret = hk_partitions_get(rule->table, &partitions, &maxvalue)))
+		goto out;
+
+	if (-1 == rule->history_max)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "partitions of table \"%s\" are not dropped: storage period of some"
+				" items cannot be resolved", rule->table);
+		goto out;
+	}
+
+	if (ZBX_HK_OPTION_DISABLED != *rule->poption_global)
+		history = *rule->poption;
+	else
+		history = rule->history_max;
+
+	if (0 != history && history < now)
+	{
+		*drop_from = now - history;
+		hk_partitions_drop(rule, &partitions, *drop_from);
+	}
+out:
+	zbx_free(maxvalue);
+	zbx_vector_ptr_clear_ext(&partitions, (zbx_clean_func_t)hk_partition_free);
+	zbx_vector_ptr_destroy(&partitions);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s drop_from:%d", __func__, zbx_result_string(ret), *drop_from);
+
+	return ret;
+#else
+	ZBX_UNUSED(rule);
+	ZBX_UNUSED(now);
+	ZBX_UNUSED(drop_from);
+
+	return FAIL;
+#endif
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: performs housekeeping for history and trends tables               *
@@ -572,7 +1114,7 @@ out:
  ******************************************************************************/
 static int	housekeeping_history_and_trends(int now)
 {
-	int			deleted = 0, i, rc;
+	int			deleted = 0, i, rc, partitioned, drop_from;
 	zbx_hk_history_rule_t	*rule;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() now:%d", __func__, now);
@@ -580,6 +1122,14 @@ static int	housekeeping_history_and_trends(int now)
 	/* prepare delete queues for all history housekeeping rules */
 	hk_history_delete_queue_prepare_all(hk_history_rules, now);
 
+	for (rule = hk_history_rules; NULL != rule->table; rule++)
+	{
+		if (0 != rule->item_cache.num_slots)
+			hk_stats.backlog += (zbx_uint64_t)rule->delete_queue.values_num;
+	}
+
+	zbx_dc_set_hk_stats(&hk_stats);
+
 	/* Loop through the history rules. Each rule is a history table (such as history_log, trends_uint, etc) */
 	/* we need to clear records from */
 	for (rule = hk_history_rules; NULL != rule->table; rule++)
@@ -597,6 +1147,13 @@ static int	housekeeping_history_and_trends(int now)
 			continue;
 		}
 
+		/* Natively partitioned tables are cleaned by dropping expired partitions, */
+		/* only records of items with shorter storage periods are deleted.        */
+		if (0 != CONFIG_HOUSEKEEPING_PARTITIONS && SUCCEED == hk_partitions_process(rule, now, &drop_from))
+			partitioned = 1;
+		else
+			partitioned = 0;
+
 		/* process delete queue for the housekeeping rule */
 
 		zbx_vector_ptr_sort(&rule->delete_queue, hk_item_update_cache_compare);
@@ -604,9 +1161,22 @@ static int	housekeeping_history_and_trends(int now)
 		for (i = 0; i < rule->delete_queue.values_num; i++)
 		{
 			zbx_hk_delete_queue_t	*item_record = (zbx_hk_delete_queue_t *)rule->delete_queue.values[i];
+			char			filter[MAX_STRING_LEN];
+
+			hk_stats.backlog--;
+
+			/* the expired records are removed together with their partitions */
+			if (0 != partitioned && item_record->min_clock <= drop_from)
+				continue;
+
+			zbx_snprintf(filter, sizeof(filter), "itemid=" ZBX_FS_UI64 " and clock<%d",
+					item_record->itemid, item_record->min_clock);
+
+			/* records of items with shorter storage periods in partitioned tables are */
+			/* deleted at limited rate, the rest is left for the next cycles           */
+			rc = hk_delete_from_table(rule->table, filter, "clock",
+					0 == partitioned ? 0 : CONFIG_MAX_HOUSEKEEPER_DELETE);
 
-			rc = DBexecute("delete from %s where itemid=" ZBX_FS_UI64 " and clock<%d",
-					rule->table, item_record->itemid, item_record->min_clock);
 			if (ZBX_DB_OK < rc)
 				deleted += rc;
 		}
@@ -669,7 +1239,9 @@ static int	housekeeping_process_rule(int now, zbx_hk_rule_t *rule)
 		size_t			sql_alloc = 0, sql_offset;
 		zbx_vector_uint64_t	ids_uint64;
 		zbx_vector_str_t	ids_str;
-		int			ret;
+		zbx_uint64_t		lastid = 0;
+		int			ret, chunk;
+		double			sec;
 
 		if (0 == id_field_str_type)
 			zbx_vector_uint64_create(&ids_uint64);
@@ -678,22 +1250,40 @@ static int	housekeeping_process_rule(int now, zbx_hk_rule_t *rule)
 
 		rule->min_clock = MIN(keep_from, rule->min_clock + HK_MAX_DELETE_PERIODS * hk_period);
 
-		zbx_snprintf(buffer, sizeof(buffer),
-			"select %s"
-			" from %s"
-			" where clock<%d%s%s"
-			" order by %s",
-			rule->field_name, rule->table, rule->min_clock, '\0' != *rule->filter ? " and " : "",
-			rule->filter, rule->field_name);
-
 		while (1)
 		{
+			chunk = hk_delete_chunk;
+
+			if (0 != CONFIG_MAX_HOUSEKEEPER_DELETE && chunk > CONFIG_MAX_HOUSEKEEPER_DELETE)
+				chunk = CONFIG_MAX_HOUSEKEEPER_DELETE;
+
+			/* numeric IDs are selected in primary key order starting after the last deleted ID, */
+			/* so that index scan does not pass already deleted records                          */
+			if (0 == id_field_str_type)
+			{
+				zbx_snprintf(buffer, sizeof(buffer),
+					"select %s"
+					" from %s"
+					" where %s>" ZBX_FS_UI64
+						" and clock<%d%s%s"
+					" order by %s",
+					rule->field_name, rule->table, rule->field_name, lastid, rule->min_clock,
+					'\0' != *rule->filter ? " and " : "", rule->filter, rule->field_name);
+			}
+			else
+			{
+				zbx_snprintf(buffer, sizeof(buffer),
+					"select %s"
+					" from %s"
+					" where clock<%d%s%s"
+					" order by %s",
+					rule->field_name, rule->table, rule->min_clock,
+					'\0' != *rule->filter ? " and " : "", rule->filter, rule->field_name);
+			}
+
 			/* Select IDs of records that must be deleted, this allows to avoid locking for every   */
 			/* record the search encounters when using delete statement, thus eliminates deadlocks. */
-			if (0 == CONFIG_MAX_HOUSEKEEPER_DELETE)
-				result = DBselect("%s", buffer);
-			else
-				result = DBselectN(buffer, CONFIG_MAX_HOUSEKEEPER_DELETE);
+			result = DBselectN(buffer, chunk);
 
 			while (NULL != (row = DBfetch(result)))
 			{
@@ -714,6 +1304,8 @@ static int	housekeeping_process_rule(int now, zbx_hk_rule_t *rule)
 			{
 				if (0 == ids_uint64.values_num)
 					break;
+
+				lastid = ids_uint64.values[ids_uint64.values_num - 1];
 			}
 			else
 			{
@@ -735,7 +1327,9 @@ static int	housekeeping_process_rule(int now, zbx_hk_rule_t *rule)
 						(const char**)ids_str.values, ids_str.values_num);
 			}
 
+			sec = zbx_time();
 			ret = DBexecute("%s", sql);
+			hk_delete_throttle(zbx_time() - sec, ret, chunk);
 
 			if (0 == id_field_str_type)
 				zbx_vector_uint64_clear(&ids_uint64);
@@ -761,62 +1355,6 @@ static int	housekeeping_process_rule(int now, zbx_hk_rule_t *rule)
 	return deleted;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: delete limited count of rows from table                           *
- *                                                                            *
- * Return value: number of deleted rows or less than 0 if an error occurred   *
- *                                                                            *
- ******************************************************************************/
-static int	DBdelete_from_table(const char *tablename, const char *filter, int limit)
-{
-	if (0 == limit)
-	{
-		return DBexecute(
-				"delete from %s"
-				" where %s",
-				tablename,
-				filter);
-	}
-	else
-	{
-#if defined(HAVE_ORACLE)
-		return DBexecute(
-				"delete from %s"
-				" where %s"
-					" and rownum<=%d",
-				tablename,
-				filter,
-				limit);
-#elif defined(HAVE_MYSQL)
-		return DBexecute(
-				"delete from %s"
-				" where %s limit %d",
-				tablename,
-				filter,
-				limit);
-#elif defined(HAVE_POSTGRESQL)
-		return DBexecute(
-				"delete from %s"
-				" where %s and ctid = any(array(select ctid from %s"
-					" where %s limit %d))",
-				tablename,
-				filter,
-				tablename,
-				filter,
-				limit);
-#elif defined(HAVE_SQLITE3)
-		return DBexecute(
-				"delete from %s"
-				" where %s",
-				tablename,
-				filter);
-#endif
-	}
-
-	return 0;
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: perform problem table cleanup                                     *
@@ -839,7 +1377,7 @@ static int	hk_problem_cleanup(const char *table, int source, int object, zbx_uin
 	zbx_snprintf(filter, sizeof(filter), "source=%d and object=%d and objectid=" ZBX_FS_UI64,
 			source, object, objectid);
 
-	ret = DBdelete_from_table(table, filter, CONFIG_MAX_HOUSEKEEPER_DELETE);
+	ret = hk_delete_from_table(table, filter, NULL, CONFIG_MAX_HOUSEKEEPER_DELETE);
 
 	if (ZBX_DB_OK > ret || (0 != CONFIG_MAX_HOUSEKEEPER_DELETE && ret >= CONFIG_MAX_HOUSEKEEPER_DELETE))
 		*more = 1;
@@ -867,7 +1405,7 @@ static int	hk_table_cleanup(const char *table, const char *field, zbx_uint64_t i
 
 	zbx_snprintf(filter, sizeof(filter), "%s=" ZBX_FS_UI64, field, id);
 
-	ret = DBdelete_from_table(table, filter, CONFIG_MAX_HOUSEKEEPER_DELETE);
+	ret = hk_delete_from_table(table, filter, NULL, CONFIG_MAX_HOUSEKEEPER_DELETE);
 
 	if (ZBX_DB_OK > ret || (0 != CONFIG_MAX_HOUSEKEEPER_DELETE && ret >= CONFIG_MAX_HOUSEKEEPER_DELETE))
 		*more = 1;
@@ -992,7 +1530,7 @@ static int	housekeeping_sessions(int now)
 		size_t	sql_alloc = 0, sql_offset = 0;
 
 		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "lastaccess<%d", now - cfg.hk.sessions);
-		rc = DBdelete_from_table("sessions", sql, CONFIG_MAX_HOUSEKEEPER_DELETE);
+		rc = hk_delete_from_table("sessions", sql, NULL, CONFIG_MAX_HOUSEKEEPER_DELETE);
 		zbx_free(sql);
 
 		if (ZBX_DB_OK <= rc)
@@ -1112,8 +1650,8 @@ static int	get_housekeeping_period(double time_slept)
 ZBX_THREAD_ENTRY(housekeeper_thread, args)
 {
 	int			now, d_history_and_trends, d_cleanup, d_events, d_problems, d_sessions, d_services,
-				d_audit, sleeptime, records;
-	double			sec, time_slept, time_now;
+				d_audit, sleeptime, records, hk_next, partitions_next = 0;
+	double			sec, time_slept, time_now, time_idle;
 	char			sleeptext[25];
 	zbx_ipc_async_socket_t	rtc;
 
@@ -1126,15 +1664,16 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 
 	update_selfmon_counter(ZBX_PROCESS_STATE_BUSY);
 
+	/* the time of the next scheduled housekeeping, 0 if housekeeping is executed only on user command */
 	if (0 == CONFIG_HOUSEKEEPING_FREQUENCY)
 	{
-		sleeptime = ZBX_IPC_WAIT_FOREVER;
+		hk_next = 0;
 		zbx_setproctitle("%s [waiting for user command]", get_process_type_string(process_type));
 		zbx_snprintf(sleeptext, sizeof(sleeptext), "waiting for user command");
 	}
 	else
 	{
-		sleeptime = HOUSEKEEPER_STARTUP_DELAY * SEC_PER_MIN;
+		hk_next = (int)time(NULL) + HOUSEKEEPER_STARTUP_DELAY * SEC_PER_MIN;
 		zbx_setproctitle("%s [startup idle for %d minutes]", get_process_type_string(process_type),
 				HOUSEKEEPER_STARTUP_DELAY);
 		zbx_snprintf(sleeptext, sizeof(sleeptext), "idle for %d hour(s)", CONFIG_HOUSEKEEPING_FREQUENCY);
@@ -1144,13 +1683,35 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 
 	zbx_rtc_subscribe(&rtc, process_type, process_num);
 
+	time_idle = zbx_time();
+
 	while (ZBX_IS_RUNNING())
 	{
 		zbx_uint32_t	rtc_cmd;
 		unsigned char	*rtc_data;
 		int		hk_execute = 0;
 
-		sec = zbx_time();
+		now = (int)time(NULL);
+
+		if (0 != CONFIG_HOUSEKEEPING_PARTITIONS && partitions_next <= now)
+		{
+			DBconnect(ZBX_DB_CONNECT_NORMAL);
+			hk_partitions_create_all(now);
+			DBclose();
+
+			partitions_next = now + HK_PARTITIONS_CREATE_PERIOD;
+		}
+
+		if (0 == hk_next)
+			sleeptime = ZBX_IPC_WAIT_FOREVER;
+		else
+			sleeptime = MAX(hk_next - now, 0);
+
+		if (0 != CONFIG_HOUSEKEEPING_PARTITIONS &&
+				(ZBX_IPC_WAIT_FOREVER == sleeptime || partitions_next - now < sleeptime))
+		{
+			sleeptime = partitions_next - now;
+		}
 
 		while (SUCCEED == zbx_rtc_wait(&rtc, &rtc_cmd, &rtc_data, sleeptime) && 0 != rtc_cmd)
 		{
@@ -1178,13 +1739,12 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 		if (!ZBX_IS_RUNNING())
 			break;
 
-		if (0 == CONFIG_HOUSEKEEPING_FREQUENCY)
-			sleeptime = ZBX_IPC_WAIT_FOREVER;
-		else
-			sleeptime = CONFIG_HOUSEKEEPING_FREQUENCY * SEC_PER_HOUR;
+		/* woken up to create partitions only */
+		if (0 == hk_execute && (0 == hk_next || (int)time(NULL) < hk_next))
+			continue;
 
 		time_now = zbx_time();
-		time_slept = time_now - sec;
+		time_slept = time_now - time_idle;
 		zbx_update_env(time_now);
 
 		hk_period = get_housekeeping_period(time_slept);
@@ -1205,6 +1765,9 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 			hk_history_compression_update(&cfg.db);
 		}
 
+		memset(&hk_stats, 0, sizeof(hk_stats));
+		hk_write_latency = zbx_dc_get_history_write_latency();
+
 		zbx_setproctitle("%s [removing old history and trends]",
 				get_process_type_string(process_type));
 		sec = zbx_time();
@@ -1232,10 +1795,13 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 		d_cleanup = housekeeping_cleanup();
 		sec = zbx_time() - sec;
 
+		zbx_dc_set_hk_stats(&hk_stats);
+
 		zabbix_log(LOG_LEVEL_WARNING, "%s [deleted %d hist/trends, %d items/triggers, %d events, %d problems,"
-				" %d sessions, %d alarms, %d audit, %d records in " ZBX_FS_DBL " sec, %s]",
-				get_process_type_string(process_type), d_history_and_trends, d_cleanup, d_events,
-				d_problems, d_sessions, d_services, d_audit, records, sec, sleeptext);
+				" %d sessions, %d alarms, %d audit, %d records in " ZBX_FS_DBL " sec, throttled "
+				ZBX_FS_DBL " sec, %s]", get_process_type_string(process_type), d_history_and_trends,
+				d_cleanup, d_events, d_problems, d_sessions, d_services, d_audit, records, sec,
+				hk_stats.throttled, sleeptext);
 
 		zbx_config_clean(&cfg);
 
@@ -1244,6 +1810,11 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 		zbx_dc_cleanup_data_sessions();
 		zbx_vc_housekeeping_value_cache();
 
+		time_idle = zbx_time();
+
+		if (0 != CONFIG_HOUSEKEEPING_FREQUENCY)
+			hk_next = (int)time_idle + CONFIG_HOUSEKEEPING_FREQUENCY * SEC_PER_HOUR;
+
 		zbx_setproctitle("%s [deleted %d hist/trends, %d items/triggers, %d events, %d sessions, %d alarms,"
 				" %d audit items, %d records in " ZBX_FS_DBL " sec, %s]",
 				get_process_type_string(process_type), d_history_and_trends, d_cleanup, d_events,
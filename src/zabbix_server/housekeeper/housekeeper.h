@@ -24,6 +24,8 @@
 
 extern int	CONFIG_HOUSEKEEPING_FREQUENCY;
 extern int	CONFIG_MAX_HOUSEKEEPER_DELETE;
+extern int	CONFIG_HOUSEKEEPING_PARTITIONS;
+extern int	CONFIG_MAX_HOUSEKEEPER_LOAD;
 
 ZBX_THREAD_ENTRY(housekeeper_thread, args);
 
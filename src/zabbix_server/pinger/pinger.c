@@ -38,13 +38,26 @@ extern ZBX_THREAD_LOCAL unsigned char	process_type;
 extern unsigned char			program_type;
 extern ZBX_THREAD_LOCAL int		server_num, process_num;
 
+/* items processed by the pinger, requeued with single configuration cache lock */
+typedef struct
+{
+	zbx_uint64_t	*itemids;
+	int		*lastclocks;
+	int		*errcodes;
+	int		num;
+}
+zbx_requeue_batch_t;
+
 /******************************************************************************
  *                                                                            *
  * Purpose: process new item value                                            *
  *                                                                            *
+ * Comments: The item is added to requeue batch, which must be requeued by    *
+ *           the caller.                                                      *
+ *                                                                            *
  ******************************************************************************/
 static void	process_value(zbx_uint64_t itemid, zbx_uint64_t *value_ui64, double *value_dbl,	zbx_timespec_t *ts,
-		int ping_result, char *error)
+		int ping_result, char *error, zbx_requeue_batch_t *requeue)
 {
 	DC_ITEM		item;
 	int		errcode;
@@ -85,7 +98,9 @@ static void	process_value(zbx_uint64_t itemid, zbx_uint64_t *value_ui64, double
 		free_result(&value);
 	}
 clean:
-	DCrequeue_items(&item.itemid, &ts->sec, &errcode, 1);
+	requeue->itemids[requeue->num] = itemid;
+	requeue->lastclocks[requeue->num] = ts->sec;
+	requeue->errcodes[requeue->num++] = errcode;
 
 	DCconfig_clean_items(&item, &errcode, 1);
 
@@ -100,12 +115,18 @@ clean:
 static void	process_values(icmpitem_t *items, int first_index, int last_index, ZBX_FPING_HOST *hosts,
 		int hosts_count, zbx_timespec_t *ts, int ping_result, char *error)
 {
-	int		i, h;
-	zbx_uint64_t	value_uint64;
-	double		value_dbl;
+	int			i, h;
+	zbx_uint64_t		value_uint64;
+	double			value_dbl;
+	zbx_requeue_batch_t	requeue;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
+	requeue.num = 0;
+	requeue.itemids = (zbx_uint64_t *)zbx_malloc(NULL, sizeof(zbx_uint64_t) * (size_t)(last_index - first_index));
+	requeue.lastclocks = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)(last_index - first_index));
+	requeue.errcodes = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)(last_index - first_index));
+
 	for (h = 0; h < hosts_count; h++)
 	{
 		const ZBX_FPING_HOST	*host = &hosts[h];
@@ -130,14 +151,14 @@ static void	process_values(icmpitem_t *items, int first_index, int last_index, Z
 
 			if (NOTSUPPORTED == ping_result)
 			{
-				process_value(item->itemid, NULL, NULL, ts, NOTSUPPORTED, error);
+				process_value(item->itemid, NULL, NULL, ts, NOTSUPPORTED, error, &requeue);
 				continue;
 			}
 
 			if (0 == host->cnt)
 			{
 				process_value(item->itemid, NULL, NULL, ts, NOTSUPPORTED,
-						(char *)"Cannot send ICMP ping packets to this host.");
+						(char *)"Cannot send ICMP ping packets to this host.", &requeue);
 				continue;
 			}
 
@@ -145,7 +166,7 @@ static void	process_values(icmpitem_t *items, int first_index, int last_index, Z
 			{
 				case ICMPPING:
 					value_uint64 = (0 != host->rcv ? 1 : 0);
-					process_value(item->itemid, &value_uint64, NULL, ts, SUCCEED, NULL);
+					process_value(item->itemid, &value_uint64, NULL, ts, SUCCEED, NULL, &requeue);
 					break;
 				case ICMPPINGSEC:
 					switch (item->type)
@@ -164,16 +185,23 @@ static void	process_values(icmpitem_t *items, int first_index, int last_index, Z
 					if (0 < value_dbl && ZBX_FLOAT_PRECISION > value_dbl)
 						value_dbl = ZBX_FLOAT_PRECISION;
 
-					process_value(item->itemid, NULL, &value_dbl, ts, SUCCEED, NULL);
+					process_value(item->itemid, NULL, &value_dbl, ts, SUCCEED, NULL, &requeue);
 					break;
 				case ICMPPINGLOSS:
 					value_dbl = (100 * (host->cnt - host->rcv)) / (double)host->cnt;
-					process_value(item->itemid, NULL, &value_dbl, ts, SUCCEED, NULL);
+					process_value(item->itemid, NULL, &value_dbl, ts, SUCCEED, NULL, &requeue);
 					break;
 			}
 		}
 	}
 
+	if (0 != requeue.num)
+		DCrequeue_items(requeue.itemids, requeue.lastclocks, requeue.errcodes, (size_t)requeue.num);
+
+	zbx_free(requeue.errcodes);
+	zbx_free(requeue.lastclocks);
+	zbx_free(requeue.itemids);
+
 	zbx_preprocessor_flush();
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
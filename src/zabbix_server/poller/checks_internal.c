@@ -528,6 +528,39 @@ int	get_value_internal(const DC_ITEM *item, AGENT_RESULT *result)
 			SET_DBL_RESULT(result, value);
 		}
 	}
+	else if (0 == strcmp(tmp, "rsm"))			/* zabbix[rsm,<type>,lateness] */
+	{
+		unsigned char	process_type;
+
+		if (3 != nparams)
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid number of parameters."));
+			goto out;
+		}
+
+		process_type = get_process_type_by_name(get_rparam(&request, 1));
+
+		if (ZBX_PROCESS_TYPE_POLLER != process_type && ZBX_PROCESS_TYPE_UNREACHABLE != process_type)
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid second parameter."));
+			goto out;
+		}
+
+		if (NULL == (tmp = get_rparam(&request, 2)) || 0 != strcmp(tmp, "lateness"))
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid third parameter."));
+			goto out;
+		}
+
+		if (0 == get_process_type_forks(process_type))
+		{
+			SET_MSG_RESULT(result, zbx_dsprintf(NULL, "No \"%s\" processes started.",
+					get_process_type_string(process_type)));
+			goto out;
+		}
+
+		SET_UI64_RESULT(result, zbx_selfmon_get_rsm_lateness(process_type));
+	}
 	else if (0 == strcmp(tmp, "wcache"))			/* zabbix[wcache,<cache>,<mode>] */
 	{
 		if (2 > nparams || nparams > 3)
@@ -188,6 +188,32 @@ int	zbx_get_value_internal_ext(const char *param1, const AGENT_REQUEST *request,
 			goto out;
 		}
 	}
+	else if (0 == strcmp(param1, "housekeeper"))		/* zabbix["housekeeper",<mode>] */
+	{
+		zbx_hk_stats_t	stats;
+
+		if (2 != nparams)
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid number of parameters."));
+			goto out;
+		}
+
+		zbx_dc_get_hk_stats(&stats);
+
+		param2 = get_rparam(request, 1);
+
+		if (0 == strcmp(param2, "deleted"))
+			SET_UI64_RESULT(result, stats.deleted);
+		else if (0 == strcmp(param2, "backlog"))
+			SET_UI64_RESULT(result, stats.backlog);
+		else if (0 == strcmp(param2, "throttled"))
+			SET_DBL_RESULT(result, stats.throttled);
+		else
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid second parameter."));
+			goto out;
+		}
+	}
 	else if (0 == strcmp(param1, "lld_queue"))
 	{
 		zbx_uint64_t	value;
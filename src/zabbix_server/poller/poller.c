@@ -771,6 +771,9 @@ void	zbx_clean_items(DC_ITEM *items, int num, AGENT_RESULT *results)
  *                                                                            *
  * Parameters: poller_type - [IN] poller type (ZBX_POLLER_TYPE_...)           *
  *             nextcheck   - [OUT] item nextcheck                             *
+ *             rsm_delay   - [IN/OUT] the maximum delay of RSM test start     *
+ *                                    against its scheduled time, -1 if no    *
+ *                                    RSM tests were started                  *
  *                                                                            *
  * Return value: number of items processed                                    *
  *                                                                            *
@@ -778,13 +781,14 @@ void	zbx_clean_items(DC_ITEM *items, int num, AGENT_RESULT *results)
  *           see DCconfig_get_poller_items()                                  *
  *                                                                            *
  ******************************************************************************/
-static int	get_values(unsigned char poller_type, int *nextcheck)
+static int	get_values(unsigned char poller_type, int *nextcheck, int *rsm_delay)
 {
 	DC_ITEM			item, *items;
 	AGENT_RESULT		results[MAX_POLLER_ITEMS];
-	int			errcodes[MAX_POLLER_ITEMS];
+	int			errcodes[MAX_POLLER_ITEMS], lastclocks[MAX_POLLER_ITEMS];
+	zbx_uint64_t		itemids[MAX_POLLER_ITEMS];
 	zbx_timespec_t		timespec;
-	int			i, num, last_available = INTERFACE_AVAILABLE_UNKNOWN;
+	int			i, num, now, last_available = INTERFACE_AVAILABLE_UNKNOWN;
 	zbx_vector_ptr_t	add_results;
 	unsigned char		*data = NULL;
 	size_t			data_alloc = 0, data_offset = 0;
@@ -800,6 +804,18 @@ static int	get_values(unsigned char poller_type, int *nextcheck)
 		goto exit;
 	}
 
+	/* RSM specifics: track how late RSM tests are started compared to their cycle schedule */
+	now = (int)time(NULL);
+
+	for (i = 0; i < num; i++)
+	{
+		if (ITEM_TYPE_SIMPLE != items[i].type || SUCCEED != zbx_is_rsm_test_key(items[i].key_orig))
+			continue;
+
+		if (*rsm_delay < now - items[i].nextcheck)
+			*rsm_delay = now - items[i].nextcheck;
+	}
+
 	zbx_vector_ptr_create(&add_results);
 
 	zbx_prepare_items(items, errcodes, num, results, MACRO_EXPAND_YES);
@@ -900,10 +916,13 @@ static int	get_values(unsigned char poller_type, int *nextcheck)
 					items[i].flags, NULL, &timespec, items[i].state, results[i].msg);
 		}
 
-		DCpoller_requeue_items(&items[i].itemid, &timespec.sec, &errcodes[i], 1, poller_type,
-				nextcheck);
+		itemids[i] = items[i].itemid;
+		lastclocks[i] = timespec.sec;
 	}
 
+	/* requeue the whole batch with single configuration cache lock */
+	DCpoller_requeue_items(itemids, lastclocks, errcodes, (size_t)num, poller_type, nextcheck);
+
 	zbx_preprocessor_flush();
 	zbx_clean_items(items, num, results);
 	DCconfig_clean_items(items, NULL, num);
@@ -926,8 +945,9 @@ exit:
 
 ZBX_THREAD_ENTRY(poller_thread, args)
 {
-	int			nextcheck, sleeptime = -1, processed = 0, old_processed = 0;
+	int			nextcheck, sleeptime = -1, processed = 0, old_processed = 0, rsm_delay = -1;
 	double			sec, total_sec = 0.0, old_total_sec = 0.0;
+	char			rsm_stat[64];
 	time_t			last_stat_time;
 	unsigned char		poller_type;
 	zbx_ipc_async_socket_t	rtc;
@@ -976,28 +996,37 @@ ZBX_THREAD_ENTRY(poller_thread, args)
 					old_total_sec);
 		}
 
-		processed += get_values(poller_type, &nextcheck);
+		processed += get_values(poller_type, &nextcheck, &rsm_delay);
 		total_sec += zbx_time() - sec;
 
 		sleeptime = calculate_sleeptime(nextcheck, POLLER_DELAY);
 
 		if (0 != sleeptime || STAT_INTERVAL <= time(NULL) - last_stat_time)
 		{
+			if (0 <= rsm_delay)
+				zbx_snprintf(rsm_stat, sizeof(rsm_stat), ", RSM tests late %d sec", rsm_delay);
+			else
+				*rsm_stat = '\0';
+
 			if (0 == sleeptime)
 			{
-				zbx_setproctitle("%s #%d [got %d values in " ZBX_FS_DBL " sec, getting values]",
-					get_process_type_string(process_type), process_num, processed, total_sec);
+				zbx_setproctitle("%s #%d [got %d values in " ZBX_FS_DBL " sec%s, getting values]",
+					get_process_type_string(process_type), process_num, processed, total_sec,
+					rsm_stat);
 			}
 			else
 			{
-				zbx_setproctitle("%s #%d [got %d values in " ZBX_FS_DBL " sec, idle %d sec]",
+				zbx_setproctitle("%s #%d [got %d values in " ZBX_FS_DBL " sec%s, idle %d sec]",
 					get_process_type_string(process_type), process_num, processed, total_sec,
-					sleeptime);
+					rsm_stat, sleeptime);
 				old_processed = processed;
 				old_total_sec = total_sec;
 			}
+			zbx_selfmon_set_rsm_lateness(rsm_delay);
+
 			processed = 0;
 			total_sec = 0.0;
+			rsm_delay = -1;
 			last_stat_time = time(NULL);
 		}
 
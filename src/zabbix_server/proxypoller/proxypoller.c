@@ -162,6 +162,9 @@ static int	get_data_from_proxy(DC_PROXY *proxy, const char *request, char **data
 
 	zbx_json_addstring(&j, "request", request, ZBX_JSON_TYPE_STRING);
 
+	if (0 == strcmp(request, ZBX_PROTO_VALUE_PROXY_DATA))
+		zbx_json_adduint64(&j, ZBX_PROTO_TAG_JSON_VALUES, 1);
+
 	if (0 != proxy->auto_compress)
 	{
 		if (SUCCEED != zbx_compress(j.buffer, j.buffer_size, &buffer, &buffer_size))
@@ -112,8 +112,8 @@ const char	*help_message[] = {
 	"      " ZBX_SECRETS_RELOAD "              Reload secrets from Vault",
 	"      " ZBX_DIAGINFO "=section            Log internal diagnostic information of the",
 	"                                  section (historycache, preprocessing, alerting,",
-	"                                  lld, valuecache, locks) or everything if section is",
-	"                                  not specified",
+	"                                  lld, valuecache, locks, configcache) or everything if",
+	"                                  section is not specified",
 	"      " ZBX_SERVICE_CACHE_RELOAD "        Reload service manager cache",
 	"      " ZBX_HA_STATUS "                   Display HA cluster status",
 	"      " ZBX_HA_REMOVE_NODE "=target       Remove the HA node specified by its name or ID",
@@ -222,10 +222,14 @@ char	*CONFIG_SERVER			= NULL;		/* not used in zabbix_server, required for linkin
 
 int	CONFIG_HOUSEKEEPING_FREQUENCY	= 1;
 int	CONFIG_MAX_HOUSEKEEPER_DELETE	= 5000;		/* applies for every separate field value */
+int	CONFIG_HOUSEKEEPING_PARTITIONS	= 0;
+int	CONFIG_MAX_HOUSEKEEPER_LOAD	= 100;
 int	CONFIG_HISTSYNCER_FORKS		= 4;
 int	CONFIG_HISTSYNCER_FREQUENCY	= 1;
 int	CONFIG_CONFSYNCER_FORKS		= 1;
 int	CONFIG_CONFSYNCER_FREQUENCY	= 60;
+int	CONFIG_CACHE_LOAD_WORKERS	= 4;
+char	*CONFIG_CACHE_SNAPSHOT_FILE	= NULL;
 
 int	CONFIG_PROBLEMHOUSEKEEPING_FREQUENCY = 60;
 
@@ -237,9 +241,12 @@ int	CONFIG_VMWARE_TIMEOUT		= 10;
 zbx_uint64_t	CONFIG_CONF_CACHE_SIZE		= 32 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_HISTORY_CACHE_SIZE	= 16 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_HISTORY_INDEX_CACHE_SIZE	= 4 * ZBX_MEBIBYTE;
+int	CONFIG_HISTORY_CACHE_COMPRESS_SIZE	= 0;
+int	CONFIG_PROXY_HISTORY_COMPRESS_SIZE	= 0;
 zbx_uint64_t	CONFIG_TRENDS_CACHE_SIZE	= 4 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_TREND_FUNC_CACHE_SIZE	= 4 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_VALUE_CACHE_SIZE		= 8 * ZBX_MEBIBYTE;
+char	*CONFIG_VALUE_CACHE_SNAPSHOT_FILE	= NULL;
 zbx_uint64_t	CONFIG_VMWARE_CACHE_SIZE	= 8 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_EXPORT_FILE_SIZE		= ZBX_GIBIBYTE;
 
@@ -337,6 +344,7 @@ static char	*CONFIG_SOCKET_PATH	= NULL;
 char	*CONFIG_HISTORY_STORAGE_URL		= NULL;
 char	*CONFIG_HISTORY_STORAGE_OPTS		= NULL;
 int	CONFIG_HISTORY_STORAGE_PIPELINES	= 0;
+int	CONFIG_HISTORY_STORAGE_COMPRESSION	= 0;
 
 char	*CONFIG_STATS_ALLOWED_IP	= NULL;
 int	CONFIG_TCP_MAX_BACKLOG_SIZE	= SOMAXCONN;
@@ -344,6 +352,9 @@ int	CONFIG_TCP_MAX_BACKLOG_SIZE	= SOMAXCONN;
 /* a passphrase for EPP data encryption used in proxy poller */
 char	epp_passphrase[128]		= "";
 
+/* the period at the beginning of RSM test cycle to spread RSM tests over, 0 - whole cycle */
+int	CONFIG_RSM_TEST_WINDOW		= 0;
+
 int	CONFIG_DOUBLE_PRECISION		= ZBX_DB_DBL_PRECISION_ENABLED;
 
 char	*CONFIG_WEBSERVICE_URL	= NULL;
@@ -682,12 +693,18 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 	err |= (FAIL == check_cfg_feature_str("HistoryStorageTypes", CONFIG_HISTORY_STORAGE_OPTS, "cURL library"));
 	err |= (FAIL == check_cfg_feature_int("HistoryStorageDateIndex", CONFIG_HISTORY_STORAGE_PIPELINES,
 			"cURL library"));
+	err |= (FAIL == check_cfg_feature_int("HistoryStorageCompression", CONFIG_HISTORY_STORAGE_COMPRESSION,
+			"cURL library"));
 	err |= (FAIL == check_cfg_feature_str("VaultToken", CONFIG_VAULTTOKEN, "cURL library"));
 	err |= (FAIL == check_cfg_feature_str("VaultDBPath", CONFIG_VAULTDBPATH, "cURL library"));
 
 	err |= (FAIL == check_cfg_feature_int("StartReportWriters", CONFIG_REPORTWRITER_FORKS, "cURL library"));
 #endif
 
+#if !defined(HAVE_ZLIB)
+	err |= (FAIL == check_cfg_feature_int("HistoryStorageCompression", CONFIG_HISTORY_STORAGE_COMPRESSION,
+			"zlib support"));
+#endif
 #if !defined(HAVE_LIBXML2) || !defined(HAVE_LIBCURL)
 	err |= (FAIL == check_cfg_feature_int("StartVMwareCollectors", CONFIG_VMWARE_FORKS, "VMware support"));
 
@@ -780,18 +797,30 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"HistoryIndexCacheSize",	&CONFIG_HISTORY_INDEX_CACHE_SIZE,	TYPE_UINT64,
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"HistoryCacheCompressSize",	&CONFIG_HISTORY_CACHE_COMPRESS_SIZE,	TYPE_INT,
+			PARM_OPT,	0,			ZBX_MEBIBYTE},
 		{"TrendCacheSize",		&CONFIG_TRENDS_CACHE_SIZE,		TYPE_UINT64,
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"TrendFunctionCacheSize",	&CONFIG_TREND_FUNC_CACHE_SIZE,		TYPE_UINT64,
 			PARM_OPT,	0,			__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"ValueCacheSize",		&CONFIG_VALUE_CACHE_SIZE,		TYPE_UINT64,
 			PARM_OPT,	0,			__UINT64_C(64) * ZBX_GIBIBYTE},
+		{"ValueCacheSnapshotFile",	&CONFIG_VALUE_CACHE_SNAPSHOT_FILE,	TYPE_STRING,
+			PARM_OPT,	0,			0},
 		{"CacheUpdateFrequency",	&CONFIG_CONFSYNCER_FREQUENCY,		TYPE_INT,
 			PARM_OPT,	1,			SEC_PER_HOUR},
+		{"CacheLoadWorkers",		&CONFIG_CACHE_LOAD_WORKERS,		TYPE_INT,
+			PARM_OPT,	0,			32},
+		{"CacheSnapshotFile",		&CONFIG_CACHE_SNAPSHOT_FILE,		TYPE_STRING,
+			PARM_OPT,	0,			0},
 		{"HousekeepingFrequency",	&CONFIG_HOUSEKEEPING_FREQUENCY,		TYPE_INT,
 			PARM_OPT,	0,			24},
 		{"MaxHousekeeperDelete",	&CONFIG_MAX_HOUSEKEEPER_DELETE,		TYPE_INT,
 			PARM_OPT,	0,			1000000},
+		{"HousekeepingPartitions",	&CONFIG_HOUSEKEEPING_PARTITIONS,	TYPE_INT,
+			PARM_OPT,	0,			1},
+		{"MaxHousekeeperLoad",		&CONFIG_MAX_HOUSEKEEPER_LOAD,		TYPE_INT,
+			PARM_OPT,	1,			100},
 		{"TmpDir",			&CONFIG_TMPDIR,				TYPE_STRING,
 			PARM_OPT,	0,			0},
 		{"FpingLocation",		&CONFIG_FPING_LOCATION,			TYPE_STRING,
@@ -928,6 +957,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			0},
 		{"HistoryStorageDateIndex",	&CONFIG_HISTORY_STORAGE_PIPELINES,	TYPE_INT,
 			PARM_OPT,	0,			1},
+		{"HistoryStorageCompression",	&CONFIG_HISTORY_STORAGE_COMPRESSION,	TYPE_INT,
+			PARM_OPT,	0,			1},
 		{"ExportDir",			&CONFIG_EXPORT_DIR,			TYPE_STRING,
 			PARM_OPT,	0,			0},
 		{"ExportType",			&CONFIG_EXPORT_TYPE,			TYPE_STRING_LIST,
@@ -956,6 +987,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			0},
 		{"StartODBCPollers",		&CONFIG_ODBCPOLLER_FORKS,		TYPE_INT,
 			PARM_OPT,	0,			1000},
+		{"RSMTestWindow",		&CONFIG_RSM_TEST_WINDOW,		TYPE_INT,
+			PARM_OPT,	0,			SEC_PER_HOUR},
 		{NULL}
 	};
 
@@ -1196,6 +1229,8 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 		return FAIL;
 	}
 
+	zbx_vc_load_snapshot();
+
 	if (SUCCEED != zbx_tfc_init(&error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize trends read cache: %s", error);
@@ -1892,7 +1927,8 @@ void	zbx_on_exit(int ret)
 		zbx_ipc_service_free_env();
 		free_configuration_cache();
 
-		/* free history value cache */
+		/* save and free history value cache */
+		zbx_vc_save_snapshot();
 		zbx_vc_destroy();
 
 		/* free vmware support */
@@ -68,6 +68,9 @@ int	zbx_send_proxy_data_response(const DC_PROXY *proxy, zbx_socket_t *sock, cons
 	if (NULL != info && '\0' != *info)
 		zbx_json_addstring(&json, ZBX_PROTO_TAG_INFO, info, ZBX_JSON_TYPE_STRING);
 
+	/* JSON object values can be sent without string encoding */
+	zbx_json_adduint64(&json, ZBX_PROTO_TAG_JSON_VALUES, 1);
+
 	if (0 != tasks.values_num)
 		zbx_tm_json_serialize_tasks(&json, &tasks);
 
@@ -244,11 +247,12 @@ static int	send_data_to_server(zbx_socket_t *sock, char **buffer, size_t buffer_
  *                                                                            *
  * Purpose: sends 'proxy data' request to server                              *
  *                                                                            *
- * Parameters: sock - [IN] the connection socket                              *
- *             ts   - [IN] the connection timestamp                           *
+ * Parameters: sock       - [IN] the connection socket                        *
+ *             jp_request - [IN] the received JSON request                    *
+ *             ts         - [IN] the connection timestamp                     *
  *                                                                            *
  ******************************************************************************/
-void	zbx_send_proxy_data(zbx_socket_t *sock, zbx_timespec_t *ts)
+void	zbx_send_proxy_data(zbx_socket_t *sock, struct zbx_json_parse *jp_request, zbx_timespec_t *ts)
 {
 	struct zbx_json		j;
 	zbx_uint64_t		areg_lastid = 0, history_lastid = 0, discovery_lastid = 0;
@@ -271,7 +275,7 @@ void	zbx_send_proxy_data(zbx_socket_t *sock, zbx_timespec_t *ts)
 
 	zbx_json_addstring(&j, ZBX_PROTO_TAG_SESSION, zbx_dc_get_session_token(), ZBX_JSON_TYPE_STRING);
 	get_interface_availability_data(&j, &availability_ts);
-	proxy_get_hist_data(&j, &history_lastid, &more_history);
+	proxy_get_hist_data(&j, &history_lastid, &more_history, zbx_get_proxy_json_values(jp_request));
 	proxy_get_dhis_data(&j, &discovery_lastid, &more_discovery);
 	proxy_get_areg_data(&j, &areg_lastid, &more_areg);
 
@@ -157,6 +157,50 @@ static void	recv_senderhistory(zbx_socket_t *sock, struct zbx_json_parse *jp, zb
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes the values pushed by RSM SLV scripts                    *
+ *                                                                            *
+ * Comments: Values are identified by item identifiers only, so the request   *
+ *           must be authenticated with session or API token of a Super admin *
+ *           user.                                                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	recv_rsm_slv_data(zbx_socket_t *sock, struct zbx_json_parse *jp)
+{
+	char		*info = NULL;
+	int		ret;
+	zbx_user_t	user;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	zbx_user_init(&user);
+
+	if (FAIL == zbx_get_user_from_json(jp, &user, NULL) || USER_TYPE_SUPER_ADMIN > user.type)
+	{
+		info = zbx_strdup(info, "Permission denied.");
+		zabbix_log(LOG_LEVEL_WARNING, "cannot process SLV data from \"%s\": %s", sock->peer, info);
+		ret = FAIL;
+	}
+	else if (SUCCEED != (ret = process_rsm_slv_history_data(jp, &info)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "received invalid SLV data from \"%s\": %s", sock->peer, info);
+	}
+	else if (!ZBX_IS_RUNNING())
+	{
+		info = zbx_strdup(info, "Zabbix server shutdown in progress");
+		zabbix_log(LOG_LEVEL_WARNING, "cannot process SLV data from \"%s\": %s", sock->peer, info);
+		ret = FAIL;
+	}
+
+	zbx_send_response_same(sock, ret, info, CONFIG_TIMEOUT);
+
+	zbx_free(info);
+	zbx_user_free(&user);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: process heartbeat sent by proxy servers                           *
@@ -1106,6 +1150,11 @@ static int	process_trap(zbx_socket_t *sock, char *s, ssize_t bytes_received, zbx
 			{
 				recv_senderhistory(sock, &jp, ts);
 			}
+			else if (0 == strcmp(value, ZBX_PROTO_VALUE_RSM_SLV_DATA))
+			{
+				if (0 != (program_type & ZBX_PROGRAM_TYPE_SERVER))
+					recv_rsm_slv_data(sock, &jp);
+			}
 			else if (0 == strcmp(value, ZBX_PROTO_VALUE_PROXY_TASKS))
 			{
 				if (0 != (program_type & ZBX_PROGRAM_TYPE_PROXY_PASSIVE))
@@ -1116,7 +1165,7 @@ static int	process_trap(zbx_socket_t *sock, char *s, ssize_t bytes_received, zbx
 				if (0 != (program_type & ZBX_PROGRAM_TYPE_SERVER))
 					zbx_recv_proxy_data(sock, &jp, ts);
 				else if (0 != (program_type & ZBX_PROGRAM_TYPE_PROXY_PASSIVE))
-					zbx_send_proxy_data(sock, ts);
+					zbx_send_proxy_data(sock, &jp, ts);
 			}
 			else if (0 == strcmp(value, ZBX_PROTO_VALUE_PROXY_HEARTBEAT))
 			{
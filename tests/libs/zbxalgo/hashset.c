@@ -0,0 +1,457 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2022 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxalgo.h"
+
+#define	INSERT_REMOVE	1
+#define	RESERVE		2
+#define	ITER_REMOVE	3
+#define	COLLISIONS	4
+#define	CHURN		5
+
+/* the number of remove/insert rounds when checking reuse of removed entry slots */
+#define HASHSET_TEST_ROUNDS	10
+
+static zbx_uint64_t	hash_mod, hash_base;
+
+/* hash function mapping keys to a few distinct hashes to force long probing sequences */
+static zbx_hash_t	collision_hash_func(const void *data)
+{
+	return (zbx_hash_t)(hash_base + *(const zbx_uint64_t *)data % hash_mod);
+}
+
+static void	mock_read_keys(const char *path, zbx_vector_uint64_t *keys)
+{
+	zbx_mock_error_t	err;
+	zbx_mock_handle_t	hkeys, hkey;
+
+	hkeys = zbx_mock_get_parameter_handle(path);
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hkeys, &hkey))))
+	{
+		zbx_uint64_t	key;
+
+		if (ZBX_MOCK_SUCCESS != (err = zbx_mock_uint64(hkey, &key)))
+			fail_msg("Cannot read vector member: %s", zbx_mock_error_string(err));
+
+		zbx_vector_uint64_append(keys, key);
+	}
+}
+
+static void	hashset_insert_key(zbx_hashset_t *hs, zbx_uint64_t key)
+{
+	zbx_uint64_t	*data;
+	int		num_data = hs->num_data;
+
+	data = (zbx_uint64_t *)zbx_hashset_insert(hs, &key, sizeof(key));
+	zbx_mock_assert_ptr_ne("inserted entry", NULL, data);
+	zbx_mock_assert_uint64_eq("inserted key", key, *data);
+	zbx_mock_assert_int_eq("number of entries", num_data + 1, hs->num_data);
+
+	/* inserting existing key must return the same entry */
+	zbx_mock_assert_ptr_eq("reinserted entry", data, zbx_hashset_insert(hs, &key, sizeof(key)));
+	zbx_mock_assert_int_eq("number of entries", num_data + 1, hs->num_data);
+}
+
+static void	hashset_check_key(zbx_hashset_t *hs, zbx_uint64_t key, int present)
+{
+	zbx_uint64_t	*data;
+
+	data = (zbx_uint64_t *)zbx_hashset_search(hs, &key);
+
+	if (SUCCEED == present)
+	{
+		if (NULL == data)
+			fail_msg("key " ZBX_FS_UI64 " was not found", key);
+
+		zbx_mock_assert_uint64_eq("found key", key, *data);
+	}
+	else if (NULL != data)
+		fail_msg("removed key " ZBX_FS_UI64 " was found", key);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks that every entry is reachable from the slot it hashes to   *
+ *          and that the stored probe distance is correct                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	hashset_check_slots(const zbx_hashset_t *hs)
+{
+	int	slot, home, i;
+
+	for (slot = 0; slot < hs->num_slots; slot++)
+	{
+		if (NULL == hs->slots[slot].entry)
+			continue;
+
+		if (0 > (home = slot - hs->slots[slot].distance))
+			home += hs->num_slots;
+
+		zbx_mock_assert_int_eq("home slot", (int)(hs->slots[slot].hash % hs->num_slots), home);
+
+		for (i = home; i != slot; i = (i + 1) % hs->num_slots)
+		{
+			if (NULL == hs->slots[i].entry)
+				fail_msg("empty slot %d in probing sequence from slot %d to %d", i, home, slot);
+		}
+	}
+}
+
+static void	test_hashset_insert_remove(void)
+{
+	zbx_hashset_t		hs;
+	zbx_vector_uint64_t	keys, removed;
+	int			i;
+
+	zbx_vector_uint64_create(&keys);
+	zbx_vector_uint64_create(&removed);
+
+	mock_read_keys("in.keys", &keys);
+	mock_read_keys("in.remove", &removed);
+
+	zbx_hashset_create(&hs, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	/* searching and removing in hashset without slots must be safe */
+	hashset_check_key(&hs, keys.values[0], FAIL);
+	zbx_hashset_remove(&hs, &keys.values[0]);
+
+	for (i = 0; i < keys.values_num; i++)
+		hashset_insert_key(&hs, keys.values[i]);
+
+	for (i = 0; i < removed.values_num; i++)
+	{
+		zbx_hashset_remove(&hs, &removed.values[i]);
+		hashset_check_key(&hs, removed.values[i], FAIL);
+	}
+
+	zbx_mock_assert_int_eq("number of entries", keys.values_num - removed.values_num, hs.num_data);
+
+	zbx_vector_uint64_sort(&removed, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	for (i = 0; i < keys.values_num; i++)
+	{
+		hashset_check_key(&hs, keys.values[i], FAIL == zbx_vector_uint64_bsearch(&removed, keys.values[i],
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC) ? SUCCEED : FAIL);
+	}
+
+	/* removed keys must be insertable again */
+	for (i = 0; i < removed.values_num; i++)
+		hashset_insert_key(&hs, removed.values[i]);
+
+	for (i = 0; i < keys.values_num; i++)
+		hashset_check_key(&hs, keys.values[i], SUCCEED);
+
+	zbx_mock_assert_int_eq("number of entries", keys.values_num, hs.num_data);
+
+	zbx_hashset_clear(&hs);
+	zbx_mock_assert_int_eq("number of entries", 0, hs.num_data);
+
+	for (i = 0; i < keys.values_num; i++)
+		hashset_check_key(&hs, keys.values[i], FAIL);
+
+	zbx_hashset_destroy(&hs);
+
+	zbx_vector_uint64_destroy(&removed);
+	zbx_vector_uint64_destroy(&keys);
+}
+
+static void	test_hashset_reserve(void)
+{
+	zbx_hashset_t		hs;
+	zbx_vector_ptr_t	entries;
+	zbx_uint64_t		key, count;
+	int			i, num_slots, round;
+
+	count = zbx_mock_get_parameter_uint64("in.count");
+
+	zbx_vector_ptr_create(&entries);
+	zbx_hashset_create(&hs, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	zbx_mock_assert_result_eq("reserve", SUCCEED, zbx_hashset_reserve(&hs, (int)count));
+	num_slots = hs.num_slots;
+
+	/* reserved slots must be enough to insert the requested number of entries without rehashing */
+	for (key = 1; key <= count; key++)
+	{
+		hashset_insert_key(&hs, key);
+		zbx_vector_ptr_append(&entries, zbx_hashset_search(&hs, &key));
+	}
+
+	zbx_mock_assert_int_eq("number of slots", num_slots, hs.num_slots);
+
+	for (; key <= count * 4; key++)
+	{
+		hashset_insert_key(&hs, key);
+		zbx_vector_ptr_append(&entries, zbx_hashset_search(&hs, &key));
+	}
+
+	if (hs.num_slots <= num_slots)
+		fail_msg("number of slots %d did not grow from %d", hs.num_slots, num_slots);
+
+	/* entries must not move when the slot array is reallocated */
+	for (i = 0; i < entries.values_num; i++)
+	{
+		key = (zbx_uint64_t)i + 1;
+		zbx_mock_assert_ptr_eq("entry after rehash", entries.values[i], zbx_hashset_search(&hs, &key));
+	}
+
+	/* slots of removed entries must be reused instead of growing the slot array while the number of */
+	/* entries does not change                                                                       */
+	num_slots = hs.num_slots;
+
+	for (round = 0; round < HASHSET_TEST_ROUNDS; round++)
+	{
+		for (key = count * (zbx_uint64_t)round + 1; key <= count * (zbx_uint64_t)(round + 4); key++)
+			zbx_hashset_remove(&hs, &key);
+
+		for (key = count * (zbx_uint64_t)(round + 4) + 1; key <= count * (zbx_uint64_t)(round + 5); key++)
+			hashset_insert_key(&hs, key);
+
+		zbx_mock_assert_int_eq("number of entries", (int)count, hs.num_data);
+		zbx_mock_assert_int_eq("number of slots", num_slots, hs.num_slots);
+
+		for (key = count * (zbx_uint64_t)(round + 4) + 1; key <= count * (zbx_uint64_t)(round + 5); key++)
+			hashset_check_key(&hs, key, SUCCEED);
+	}
+
+	zbx_hashset_destroy(&hs);
+	zbx_vector_ptr_destroy(&entries);
+}
+
+static void	test_hashset_iter_remove(void)
+{
+	zbx_hashset_t		hs;
+	zbx_hashset_iter_t	iter;
+	zbx_uint64_t		key, count, *data;
+	zbx_vector_uint64_t	visited;
+	int			i;
+
+	count = zbx_mock_get_parameter_uint64("in.count");
+
+	zbx_vector_uint64_create(&visited);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.hashes"))
+	{
+		/* make probing clusters start at the end of slot array and wrap around to its beginning */
+		zbx_hashset_create(&hs, 0, collision_hash_func, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		zbx_mock_assert_result_eq("reserve", SUCCEED, zbx_hashset_reserve(&hs, (int)count));
+
+		hash_mod = zbx_mock_get_parameter_uint64("in.hashes");
+		hash_base = (zbx_uint64_t)hs.num_slots - hash_mod / 2;
+	}
+	else
+		zbx_hashset_create(&hs, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	for (key = 1; key <= count; key++)
+		hashset_insert_key(&hs, key);
+
+	/* remove every even key while iterating, all entries must be visited exactly once */
+	zbx_hashset_iter_reset(&hs, &iter);
+
+	while (NULL != (data = (zbx_uint64_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (*data > count || 0 == *data)
+			fail_msg("iterator returned unexpected key " ZBX_FS_UI64, *data);
+
+		zbx_vector_uint64_append(&visited, *data);
+
+		if (0 == *data % 2)
+			zbx_hashset_iter_remove(&iter);
+	}
+
+	zbx_vector_uint64_sort(&visited, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_mock_assert_int_eq("visited entries", (int)count, visited.values_num);
+
+	for (i = 0; i < visited.values_num; i++)
+		zbx_mock_assert_uint64_eq("visited key", (zbx_uint64_t)i + 1, visited.values[i]);
+
+	zbx_mock_assert_int_eq("number of entries", (int)(count - count / 2), hs.num_data);
+	hashset_check_slots(&hs);
+
+	for (key = 1; key <= count; key++)
+		hashset_check_key(&hs, key, 0 == key % 2 ? FAIL : SUCCEED);
+
+	/* remove the rest while iterating */
+	zbx_vector_uint64_clear(&visited);
+	zbx_hashset_iter_reset(&hs, &iter);
+
+	while (NULL != (data = (zbx_uint64_t *)zbx_hashset_iter_next(&iter)))
+	{
+		zbx_vector_uint64_append(&visited, *data);
+		zbx_hashset_iter_remove(&iter);
+	}
+
+	zbx_vector_uint64_sort(&visited, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&visited, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_mock_assert_int_eq("visited entries", (int)(count - count / 2), visited.values_num);
+	zbx_mock_assert_int_eq("number of entries", 0, hs.num_data);
+
+	zbx_hashset_iter_reset(&hs, &iter);
+	zbx_mock_assert_ptr_eq("iterator of empty hashset", NULL, zbx_hashset_iter_next(&iter));
+
+	zbx_hashset_destroy(&hs);
+	zbx_vector_uint64_destroy(&visited);
+}
+
+static void	test_hashset_collisions(void)
+{
+	zbx_hashset_t		hs;
+	zbx_hashset_stats_t	stats;
+	zbx_uint64_t		key, count;
+	int			num_slots;
+
+	count = zbx_mock_get_parameter_uint64("in.count");
+	hash_mod = zbx_mock_get_parameter_uint64("in.hashes");
+	hash_base = 0;
+
+	zbx_hashset_create(&hs, 0, collision_hash_func, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	hashset_insert_key(&hs, 1);
+	num_slots = hs.num_slots;
+
+	for (key = 2; key <= count; key++)
+		hashset_insert_key(&hs, key);
+
+	if (hs.num_slots <= num_slots)
+		fail_msg("number of slots %d did not grow from %d", hs.num_slots, num_slots);
+
+	zbx_hashset_get_stats(&hs, &stats);
+	zbx_mock_assert_int_eq("number of entries", (int)count, stats.num_data);
+
+	if (stats.num_data * 3 > stats.num_slots * 2)
+		fail_msg("load factor exceeded: %d entries in %d slots", stats.num_data, stats.num_slots);
+
+	/* remove entries from the middle of probing sequences, the following entries must stay reachable */
+	for (key = 1; key <= count; key += 3)
+		zbx_hashset_remove(&hs, &key);
+
+	hashset_check_slots(&hs);
+
+	for (key = 1; key <= count; key++)
+		hashset_check_key(&hs, key, 1 == key % 3 ? FAIL : SUCCEED);
+
+	for (key = 1; key <= count; key += 3)
+		hashset_insert_key(&hs, key);
+
+	for (key = 1; key <= count; key++)
+		hashset_check_key(&hs, key, SUCCEED);
+
+	for (key = 1; key <= count; key++)
+	{
+		zbx_hashset_remove(&hs, &key);
+		hashset_check_key(&hs, key, FAIL);
+
+		if (key < count)
+			hashset_check_key(&hs, key + 1, SUCCEED);
+	}
+
+	zbx_hashset_get_stats(&hs, &stats);
+	zbx_mock_assert_int_eq("number of entries", 0, stats.num_data);
+	zbx_mock_assert_uint64_eq("total probe distance", 0, stats.probe_total);
+
+	zbx_hashset_destroy(&hs);
+}
+
+static void	test_hashset_churn(void)
+{
+	zbx_hashset_t	hs;
+	zbx_uint64_t	key, count, steps, step;
+	int		num_slots = 0;
+
+	count = zbx_mock_get_parameter_uint64("in.count");
+	steps = zbx_mock_get_parameter_uint64("in.steps");
+
+	zbx_hashset_create(&hs, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	for (key = 1; key <= count; key++)
+		hashset_insert_key(&hs, key);
+
+	/* keep a sliding window of entries, inserting the newest key and removing the oldest one */
+	for (step = 1; step <= steps; step++)
+	{
+		hashset_insert_key(&hs, step + count);
+
+		zbx_hashset_remove(&hs, &step);
+		hashset_check_key(&hs, step, FAIL);
+
+		zbx_mock_assert_int_eq("number of entries", (int)count, hs.num_data);
+
+		/* the slot array must stop growing once it has adapted to the number of entries */
+		if (step == count)
+			num_slots = hs.num_slots;
+		else if (step > count)
+			zbx_mock_assert_int_eq("number of slots", num_slots, hs.num_slots);
+	}
+
+	hashset_check_slots(&hs);
+
+	for (key = steps + 1; key <= steps + count; key++)
+		hashset_check_key(&hs, key, SUCCEED);
+
+	zbx_hashset_destroy(&hs);
+}
+
+static int	get_type(const char *str)
+{
+	if (0 == strcmp(str, "INSERT_REMOVE"))
+		return INSERT_REMOVE;
+	if (0 == strcmp(str, "RESERVE"))
+		return RESERVE;
+	if (0 == strcmp(str, "ITER_REMOVE"))
+		return ITER_REMOVE;
+	if (0 == strcmp(str, "COLLISIONS"))
+		return COLLISIONS;
+	if (0 == strcmp(str, "CHURN"))
+		return CHURN;
+
+	fail_msg("unknown cmocka step type: %s", str);
+	return FAIL;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_UNUSED(state);
+
+	switch (get_type(zbx_mock_get_parameter_string("in.type")))
+	{
+		case INSERT_REMOVE:
+			test_hashset_insert_remove();
+			break;
+		case RESERVE:
+			test_hashset_reserve();
+			break;
+		case ITER_REMOVE:
+			test_hashset_iter_remove();
+			break;
+		case COLLISIONS:
+			test_hashset_collisions();
+			break;
+		case CHURN:
+			test_hashset_churn();
+			break;
+		default:
+			fail_msg("unknown cmocka step type: %s", zbx_mock_get_parameter_string("in.type"));
+	}
+}
@@ -0,0 +1,173 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2022 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "mutexs.h"
+#include "dbcache.h"
+#include "dbconfig.h"
+#include "dc_item_queue_test.h"
+
+/* defines from dbconfig.c */
+#define ZBX_LOC_QUEUE	1
+#define ZBX_LOC_WHEEL	3
+
+#define DC_ITEM_QUEUE_TEST_ITEMS_MAX	16
+
+static ZBX_DC_ITEM	*get_item(ZBX_DC_ITEM *items, int *items_num, zbx_uint64_t itemid)
+{
+	int	i;
+
+	for (i = 0; i < *items_num; i++)
+	{
+		if (items[i].itemid == itemid)
+			return &items[i];
+	}
+
+	if (DC_ITEM_QUEUE_TEST_ITEMS_MAX == *items_num)
+		fail_msg("too many test items");
+
+	memset(&items[*items_num], 0, sizeof(ZBX_DC_ITEM));
+	items[*items_num].itemid = itemid;
+	items[*items_num].type = ITEM_TYPE_SIMPLE;
+
+	return &items[(*items_num)++];
+}
+
+static unsigned char	str_to_location(const char *str)
+{
+	if (0 == strcmp(str, "WHEEL"))
+		return ZBX_LOC_WHEEL;
+	if (0 == strcmp(str, "QUEUE"))
+		return ZBX_LOC_QUEUE;
+
+	fail_msg("unknown queue location \"%s\"", str);
+
+	return 0;
+}
+
+static int	get_time(zbx_mock_handle_t hstep, const char *name, int start)
+{
+	const char	*str;
+
+	str = zbx_mock_get_object_member_string(hstep, name);
+
+	if (0 == strcmp(str, "FAIL"))
+		return FAIL;
+
+	/* times are specified as offsets from the timer wheel start */
+	return start + atoi(str);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_dc_item_queue_t	queue;
+	zbx_mock_handle_t	hsteps, hstep;
+	zbx_mock_error_t	err;
+	ZBX_DC_ITEM		items[DC_ITEM_QUEUE_TEST_ITEMS_MAX], *item;
+	int			items_num = 0, start, step = 0;
+	char			msg[MAX_STRING_LEN];
+
+	ZBX_UNUSED(state);
+
+	start = (int)zbx_mock_get_parameter_uint64("in.start");
+	dc_item_queue_create_test(&queue, start);
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hsteps, &hstep)))
+	{
+		const char	*op;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read step: %s", zbx_mock_error_string(err));
+
+		step++;
+		op = zbx_mock_get_object_member_string(hstep, "op");
+
+		if (0 == strcmp(op, "insert"))
+		{
+			item = get_item(items, &items_num, zbx_mock_get_object_member_uint64(hstep, "itemid"));
+			item->nextcheck = get_time(hstep, "nextcheck", start);
+			dc_item_queue_insert_test(&queue, item);
+
+			zbx_snprintf(msg, sizeof(msg), "step %d: item location", step);
+			zbx_mock_assert_int_eq(msg, str_to_location(zbx_mock_get_object_member_string(hstep,
+					"location")), item->location);
+		}
+		else if (0 == strcmp(op, "remove"))
+		{
+			item = get_item(items, &items_num, zbx_mock_get_object_member_uint64(hstep, "itemid"));
+			dc_item_queue_remove_test(&queue, item);
+		}
+		else if (0 == strcmp(op, "requeue"))
+		{
+			item = get_item(items, &items_num, zbx_mock_get_object_member_uint64(hstep, "itemid"));
+			dc_item_queue_remove_test(&queue, item);
+			item->nextcheck = get_time(hstep, "nextcheck", start);
+			dc_item_queue_insert_test(&queue, item);
+
+			zbx_snprintf(msg, sizeof(msg), "step %d: item location", step);
+			zbx_mock_assert_int_eq(msg, str_to_location(zbx_mock_get_object_member_string(hstep,
+					"location")), item->location);
+		}
+		else if (0 == strcmp(op, "advance"))
+		{
+			dc_item_queue_advance_test(&queue, get_time(hstep, "now", start));
+		}
+		else if (0 == strcmp(op, "check"))
+		{
+			zbx_snprintf(msg, sizeof(msg), "step %d: nextcheck", step);
+			zbx_mock_assert_int_eq(msg, get_time(hstep, "nextcheck", start),
+					dc_config_get_queue_nextcheck_test(&queue));
+
+			zbx_snprintf(msg, sizeof(msg), "step %d: number of items in wheel", step);
+			zbx_mock_assert_int_eq(msg, zbx_mock_get_object_member_int(hstep, "wheel"), queue.wheel_num);
+
+			zbx_snprintf(msg, sizeof(msg), "step %d: number of items in heap", step);
+			zbx_mock_assert_int_eq(msg, zbx_mock_get_object_member_int(hstep, "heap"),
+					queue.heap.elems_num);
+		}
+		else if (0 == strcmp(op, "pop"))
+		{
+			const zbx_binary_heap_elem_t	*min;
+
+			/* due items are taken by pollers from the heap in nextcheck order */
+			zbx_snprintf(msg, sizeof(msg), "step %d: heap is empty", step);
+			zbx_mock_assert_int_eq(msg, FAIL, zbx_binary_heap_empty(&queue.heap));
+
+			min = zbx_binary_heap_find_min(&queue.heap);
+			item = (ZBX_DC_ITEM *)min->data;
+
+			zbx_snprintf(msg, sizeof(msg), "step %d: popped item", step);
+			zbx_mock_assert_uint64_eq(msg, zbx_mock_get_object_member_uint64(hstep, "itemid"),
+					item->itemid);
+
+			dc_item_queue_remove_test(&queue, item);
+		}
+		else
+			fail_msg("unknown operation \"%s\"", op);
+	}
+
+	dc_item_queue_destroy_test(&queue);
+}
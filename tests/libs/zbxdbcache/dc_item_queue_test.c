@@ -0,0 +1,65 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2022 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "dc_item_queue_test.h"
+
+void	dc_item_queue_create_test(zbx_dc_item_queue_t *queue, int wheel_start)
+{
+	size_t	size;
+
+	zbx_binary_heap_create(&queue->heap, __config_heap_elem_compare, ZBX_BINARY_HEAP_OPTION_DIRECT);
+
+	size = sizeof(ZBX_DC_ITEM *) * ZBX_DC_QUEUE_WHEEL_SIZE;
+	queue->wheel = (ZBX_DC_ITEM **)zbx_malloc(NULL, size);
+	memset(queue->wheel, 0, size);
+
+	size = sizeof(zbx_uint64_t) * (ZBX_DC_QUEUE_WHEEL_SIZE / ZBX_DC_QUEUE_WHEEL_WORD_BITS);
+	queue->wheel_used = (zbx_uint64_t *)zbx_malloc(NULL, size);
+	memset(queue->wheel_used, 0, size);
+
+	queue->wheel_start = wheel_start;
+	queue->wheel_num = 0;
+}
+
+void	dc_item_queue_destroy_test(zbx_dc_item_queue_t *queue)
+{
+	zbx_binary_heap_destroy(&queue->heap);
+	zbx_free(queue->wheel);
+	zbx_free(queue->wheel_used);
+}
+
+void	dc_item_queue_insert_test(zbx_dc_item_queue_t *queue, ZBX_DC_ITEM *item)
+{
+	dc_item_queue_insert(queue, item);
+}
+
+void	dc_item_queue_remove_test(zbx_dc_item_queue_t *queue, ZBX_DC_ITEM *item)
+{
+	dc_item_queue_remove(queue, item);
+}
+
+void	dc_item_queue_advance_test(zbx_dc_item_queue_t *queue, int now)
+{
+	dc_item_queue_advance(queue, now);
+}
+
+int	dc_config_get_queue_nextcheck_test(zbx_dc_item_queue_t *queue)
+{
+	return dc_config_get_queue_nextcheck(queue);
+}
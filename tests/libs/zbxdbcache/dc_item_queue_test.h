@@ -0,0 +1,30 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2022 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef DC_ITEM_QUEUE_TEST_H
+#define DC_ITEM_QUEUE_TEST_H
+
+void	dc_item_queue_create_test(zbx_dc_item_queue_t *queue, int wheel_start);
+void	dc_item_queue_destroy_test(zbx_dc_item_queue_t *queue);
+void	dc_item_queue_insert_test(zbx_dc_item_queue_t *queue, ZBX_DC_ITEM *item);
+void	dc_item_queue_remove_test(zbx_dc_item_queue_t *queue, ZBX_DC_ITEM *item);
+void	dc_item_queue_advance_test(zbx_dc_item_queue_t *queue, int now);
+int	dc_config_get_queue_nextcheck_test(zbx_dc_item_queue_t *queue);
+
+#endif /* DC_ITEM_QUEUE_TEST_H */
@@ -104,3 +104,32 @@ int	zbx_vc_get_cache_state(int *mode, zbx_uint64_t *hits, zbx_uint64_t *misses)
 
 	return SUCCEED;
 }
+
+typedef struct
+{
+	zbx_vector_history_record_t	*values;
+	int				value_type;
+}
+zbx_vc_test_foreach_t;
+
+static void	vc_test_foreach_append(const zbx_history_record_t *records, int first, int last, void *data)
+{
+	zbx_vc_test_foreach_t	*foreach = (zbx_vc_test_foreach_t *)data;
+	int			i;
+
+	/* append values in the same (descending) order as zbx_vc_get_values() returns them */
+	for (i = last; i >= first; i--)
+	{
+		vc_history_record_vector_append(foreach->values, foreach->value_type,
+				(zbx_history_record_t *)&records[i]);
+	}
+}
+
+int	zbx_vc_foreach_value_get_values(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values,
+		int seconds, int count, const zbx_timespec_t *ts, int *values_num)
+{
+	zbx_vc_test_foreach_t	foreach = {values, value_type};
+
+	return zbx_vc_foreach_value(itemid, value_type, seconds, count, ts, vc_test_foreach_append, &foreach,
+			values_num);
+}
@@ -26,5 +26,7 @@ int	zbx_vc_precache_values(zbx_uint64_t itemid, int value_type, int seconds, int
 int	zbx_vc_get_item_state(zbx_uint64_t itemid, int *status, int *active_range, int *values_total,
 		int *db_cached_from);
 int	zbx_vc_get_cache_state(int *mode, zbx_uint64_t *hits, zbx_uint64_t *misses);
+int	zbx_vc_foreach_value_get_values(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values,
+		int seconds, int count, const zbx_timespec_t *ts, int *values_num);
 
 #endif
@@ -55,7 +55,37 @@ void	zbx_vc_test_get_values_setup(zbx_mock_handle_t *handle, zbx_uint64_t *itemi
 	zbx_history_record_vector_clean(expected, *value_type);
 }
 
+static void	zbx_vc_test_foreach_value_setup(zbx_mock_handle_t *handle, zbx_uint64_t *itemid,
+		unsigned char *value_type, zbx_timespec_t *ts, int *err, zbx_vector_history_record_t *expected,
+		zbx_vector_history_record_t *returned, int *seconds, int *count)
+{
+	int	values_num;
+
+	/* perform request */
+
+	*handle = zbx_mock_get_parameter_handle("in.test");
+	zbx_vcmock_set_time(*handle, "time");
+	zbx_vcmock_set_mode(*handle, "cache mode");
+
+	zbx_vcmock_get_request_params(*handle, itemid, value_type, seconds, count, ts);
+	*err = zbx_vc_foreach_value_get_values(*itemid, *value_type, returned, *seconds, *count, ts, &values_num);
+	zbx_vc_flush_stats();
+	zbx_mock_assert_result_eq("zbx_vc_foreach_value() return value", SUCCEED, *err);
+	zbx_mock_assert_int_eq("zbx_vc_foreach_value() number of values", returned->values_num, values_num);
+
+	/* validate results */
+
+	zbx_vcmock_read_values(zbx_mock_get_parameter_handle("out.values"), *value_type, expected);
+	zbx_vcmock_check_records("Values passed to callback", *value_type,  expected, returned);
+
+	zbx_history_record_vector_clean(returned, *value_type);
+	zbx_history_record_vector_clean(expected, *value_type);
+}
+
 void	zbx_mock_test_entry(void **state)
 {
 	zbx_vc_common_test_func(state, NULL, NULL, zbx_vc_test_get_values_setup, 1);
+
+	/* zbx_vc_foreach_value() must pass the same values and update cache the same way as zbx_vc_get_values() */
+	zbx_vc_common_test_func(state, NULL, NULL, zbx_vc_test_foreach_value_setup, 1);
 }
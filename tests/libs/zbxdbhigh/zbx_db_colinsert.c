@@ -0,0 +1,294 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2022 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "db.h"
+#include "zbxdb.h"
+
+#define COLINSERT_COLUMNS_MAX	8
+
+/* the value of row field, the used member depends on field type */
+typedef union
+{
+	zbx_uint64_t	ui64;
+	int		i32;
+	double		dbl;
+	const char	*str;
+}
+zbx_colinsert_value_t;
+
+#if defined(HAVE_POSTGRESQL)
+static char	*copy_sql = NULL, *copy_data = NULL;
+static size_t	copy_data_alloc = 0, copy_data_offset = 0;
+
+int	__wrap_zbx_db_copy(const char *sql, const char *data, size_t size);
+
+int	__wrap_zbx_db_copy(const char *sql, const char *data, size_t size)
+{
+	size_t	i;
+
+	copy_sql = zbx_strdup(copy_sql, sql);
+
+	for (i = 0; i < size; i++)
+	{
+		zbx_snprintf_alloc(&copy_data, &copy_data_alloc, &copy_data_offset, "%02x",
+				(unsigned int)(unsigned char)data[i]);
+	}
+
+	return ZBX_DB_OK;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes whitespace from hex dump used for readability in test     *
+ *          case data                                                         *
+ *                                                                            *
+ ******************************************************************************/
+static char	*hex_dump_compact(const char *str)
+{
+	char	*out, *ptr;
+
+	ptr = out = zbx_strdup(NULL, str);
+
+	for (; '\0' != *str; str++)
+	{
+		if (NULL == strchr(" \t\r\n", *str))
+			*ptr++ = *str;
+	}
+
+	*ptr = '\0';
+
+	return out;
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads row field values from test case data                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	read_row(const zbx_db_colinsert_t *ins, zbx_mock_handle_t hrow, zbx_colinsert_value_t *values)
+{
+	int	i;
+
+	for (i = 0; i < ins->columns_num; i++)
+	{
+		const char	*name = ins->columns[i].field->name;
+
+		switch (ins->columns[i].field->type)
+		{
+			case ZBX_TYPE_ID:
+			case ZBX_TYPE_UINT:
+				values[i].ui64 = zbx_mock_get_object_member_uint64(hrow, name);
+				break;
+			case ZBX_TYPE_INT:
+				values[i].i32 = zbx_mock_get_object_member_int(hrow, name);
+				break;
+			case ZBX_TYPE_FLOAT:
+				values[i].dbl = zbx_mock_get_object_member_float(hrow, name);
+				break;
+			default:
+				values[i].str = zbx_mock_get_object_member_string(hrow, name);
+				break;
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds row to bulk insert with the same field lists as history and  *
+ *          trend writers use                                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	add_row(zbx_db_colinsert_t *ins, const zbx_colinsert_value_t *v)
+{
+	const char	*table = ins->table->table;
+
+	if (0 == strcmp(table, "history"))
+	{
+		zbx_db_colinsert_add_values(ins, v[0].ui64, v[1].i32, v[2].i32, v[3].dbl);
+	}
+	else if (0 == strcmp(table, "history_uint"))
+	{
+		zbx_db_colinsert_add_values(ins, v[0].ui64, v[1].i32, v[2].i32, v[3].ui64);
+	}
+	else if (0 == strcmp(table, "history_str") || 0 == strcmp(table, "history_text"))
+	{
+		zbx_db_colinsert_add_values(ins, v[0].ui64, v[1].i32, v[2].i32, v[3].str);
+	}
+	else if (0 == strcmp(table, "history_log"))
+	{
+		zbx_db_colinsert_add_values(ins, v[0].ui64, v[1].i32, v[2].i32, v[3].i32, v[4].str, v[5].i32,
+				v[6].str, v[7].i32);
+	}
+	else if (0 == strcmp(table, "trends"))
+	{
+		zbx_db_colinsert_add_values(ins, v[0].ui64, v[1].i32, v[2].i32, v[3].dbl, v[4].dbl, v[5].dbl);
+	}
+	else if (0 == strcmp(table, "trends_uint"))
+	{
+		zbx_db_colinsert_add_values(ins, v[0].ui64, v[1].i32, v[2].i32, v[3].ui64, v[4].ui64, v[5].ui64);
+	}
+	else
+		fail_msg("unsupported table \"%s\"", table);
+}
+
+static void	prepare(zbx_db_colinsert_t *ins, const char *table)
+{
+	if (0 == strcmp(table, "history") || 0 == strcmp(table, "history_uint") ||
+			0 == strcmp(table, "history_str") || 0 == strcmp(table, "history_text"))
+	{
+		zbx_db_colinsert_prepare(ins, table, "itemid", "clock", "ns", "value", NULL);
+	}
+	else if (0 == strcmp(table, "history_log"))
+	{
+		zbx_db_colinsert_prepare(ins, table, "itemid", "clock", "ns", "timestamp", "source", "severity",
+				"value", "logeventid", NULL);
+	}
+	else if (0 == strcmp(table, "trends") || 0 == strcmp(table, "trends_uint"))
+	{
+		zbx_db_colinsert_prepare(ins, table, "itemid", "clock", "num", "value_min", "value_avg",
+				"value_max", NULL);
+	}
+	else
+		fail_msg("unsupported table \"%s\"", table);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks the values stored in bulk insert columns                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	check_rows(const zbx_db_colinsert_t *ins, zbx_mock_handle_t hrows)
+{
+	zbx_mock_handle_t	hrow;
+	zbx_mock_error_t	err;
+	zbx_colinsert_value_t	values[COLINSERT_COLUMNS_MAX];
+	int			i, row = 0;
+	char			msg[MAX_STRING_LEN];
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hrows, &hrow)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read expected row: %s", zbx_mock_error_string(err));
+
+		if (row >= ins->rows_num)
+			fail_msg("expected more than %d rows", ins->rows_num);
+
+		read_row(ins, hrow, values);
+
+		for (i = 0; i < ins->columns_num; i++)
+		{
+			const zbx_db_column_t	*column = &ins->columns[i];
+
+			zbx_snprintf(msg, sizeof(msg), "row %d field %s", row + 1, column->field->name);
+
+			switch (column->field->type)
+			{
+				case ZBX_TYPE_ID:
+				case ZBX_TYPE_UINT:
+					zbx_mock_assert_uint64_eq(msg, values[i].ui64, column->values.ui64[row]);
+					break;
+				case ZBX_TYPE_INT:
+					zbx_mock_assert_int_eq(msg, values[i].i32, column->values.i32[row]);
+					break;
+				case ZBX_TYPE_FLOAT:
+					zbx_mock_assert_double_eq(msg, values[i].dbl, column->values.dbl[row]);
+					break;
+				default:
+					zbx_mock_assert_str_eq(msg, values[i].str,
+							ins->strings + column->values.str[row].offset);
+					zbx_mock_assert_uint64_eq(msg, strlen(values[i].str),
+							column->values.str[row].len);
+					break;
+			}
+		}
+
+		row++;
+	}
+
+	zbx_mock_assert_int_eq("number of rows", row, ins->rows_num);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_db_colinsert_t	ins;
+	zbx_mock_handle_t	hrows, hrow;
+	zbx_mock_error_t	err;
+	zbx_colinsert_value_t	values[COLINSERT_COLUMNS_MAX];
+
+	ZBX_UNUSED(state);
+
+	prepare(&ins, zbx_mock_get_parameter_string("in.table"));
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.reserve"))
+		zbx_db_colinsert_reserve(&ins, (int)zbx_mock_get_parameter_uint64("in.reserve"));
+
+	hrows = zbx_mock_get_parameter_handle("in.rows");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hrows, &hrow)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read row: %s", zbx_mock_error_string(err));
+
+		read_row(&ins, hrow, values);
+		add_row(&ins, values);
+	}
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("out.rows"))
+		check_rows(&ins, zbx_mock_get_parameter_handle("out.rows"));
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("out.rows_alloc"))
+	{
+		zbx_mock_assert_int_eq("allocated rows", (int)zbx_mock_get_parameter_uint64("out.rows_alloc"),
+				ins.rows_alloc);
+	}
+
+#if defined(HAVE_POSTGRESQL)
+	{
+		char	*data;
+
+		zbx_mock_assert_result_eq("execute result", SUCCEED, zbx_db_colinsert_execute(&ins));
+
+		if (0 == ins.rows_num)
+		{
+			zbx_mock_assert_ptr_eq("copy statement", NULL, copy_sql);
+		}
+		else
+		{
+			zbx_mock_assert_str_eq("copy statement", zbx_mock_get_parameter_string("out.copy.sql"),
+					copy_sql);
+
+			data = hex_dump_compact(zbx_mock_get_parameter_string("out.copy.data"));
+			zbx_mock_assert_str_eq("copy data", data, copy_data);
+			zbx_free(data);
+		}
+
+		zbx_free(copy_sql);
+		zbx_free(copy_data);
+		copy_data_alloc = copy_data_offset = 0;
+	}
+#endif
+	zbx_db_colinsert_clean(&ins);
+}
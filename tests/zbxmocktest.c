@@ -67,6 +67,8 @@ int	CONFIG_TRAPPER_TIMEOUT		= 300;
 
 int	CONFIG_HOUSEKEEPING_FREQUENCY	= 1;
 int	CONFIG_MAX_HOUSEKEEPER_DELETE	= 5000;		/* applies for every separate field value */
+int	CONFIG_HOUSEKEEPING_PARTITIONS	= 0;
+int	CONFIG_MAX_HOUSEKEEPER_LOAD	= 100;
 int	CONFIG_HISTSYNCER_FORKS		= 4;
 int	CONFIG_HISTSYNCER_FREQUENCY	= 1;
 int	CONFIG_CONFSYNCER_FORKS		= 1;
@@ -79,10 +81,15 @@ int	CONFIG_VMWARE_PERF_FREQUENCY	= 60;
 int	CONFIG_VMWARE_TIMEOUT		= 10;
 
 zbx_uint64_t	CONFIG_CONF_CACHE_SIZE		= 8 * 0;
+int	CONFIG_CACHE_LOAD_WORKERS	= 0;
+char	*CONFIG_CACHE_SNAPSHOT_FILE	= NULL;
 zbx_uint64_t	CONFIG_HISTORY_CACHE_SIZE	= 16 * 0;
 zbx_uint64_t	CONFIG_HISTORY_INDEX_CACHE_SIZE	= 4 * 0;
+int	CONFIG_HISTORY_CACHE_COMPRESS_SIZE	= 0;
+int	CONFIG_PROXY_HISTORY_COMPRESS_SIZE	= 0;
 zbx_uint64_t	CONFIG_TRENDS_CACHE_SIZE	= 4 * 0;
 zbx_uint64_t	CONFIG_VALUE_CACHE_SIZE		= 8 * 0;
+char	*CONFIG_VALUE_CACHE_SNAPSHOT_FILE	= NULL;
 zbx_uint64_t	CONFIG_VMWARE_CACHE_SIZE	= 8 * 0;
 zbx_uint64_t	CONFIG_EXPORT_FILE_SIZE;
 zbx_uint64_t	CONFIG_TREND_FUNC_CACHE_SIZE	= 0;
@@ -179,6 +186,7 @@ char	*CONFIG_SOCKET_PATH			= NULL;
 char	*CONFIG_HISTORY_STORAGE_URL		= NULL;
 char	*CONFIG_HISTORY_STORAGE_OPTS		= NULL;
 int	CONFIG_HISTORY_STORAGE_PIPELINES	= 0;
+int	CONFIG_HISTORY_STORAGE_COMPRESSION	= 0;
 
 /* not used in tests, defined for linking with comms.c */
 int	CONFIG_TCP_MAX_BACKLOG_SIZE	= SOMAXCONN;
@@ -205,6 +213,7 @@ int	CONFIG_BUFFER_SEND		= 5;
 int	CONFIG_MAX_LINES_PER_SECOND	= 20;
 
 int	CONFIG_DOUBLE_PRECISION		= ZBX_DB_DBL_PRECISION_ENABLED;
+int	CONFIG_RSM_TEST_WINDOW		= 0;
 
 char	**CONFIG_ALIASES		= NULL;
 char	**CONFIG_USER_PARAMETERS	= NULL;
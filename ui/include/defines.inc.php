@@ -19,14 +19,14 @@
 **/
 
 /* RSM specifics: specific defines */
-define('ZABBIX_DB_VERSION_RSM',		22);
+define('ZABBIX_DB_VERSION_RSM',		3);
 /* RSM specifics: end */
 
 define('ZABBIX_VERSION',		'6.0.8');
 define('ZABBIX_API_VERSION',	'6.0.8');
 define('ZABBIX_EXPORT_VERSION',	'6.0');
 
-define('ZABBIX_DB_VERSION',		6000000);
+define('ZABBIX_DB_VERSION',		6000004);
 
 define('DB_VERSION_SUPPORTED',						0);
 define('DB_VERSION_LOWER_THAN_MINIMUM',				1);